@@ -1,50 +1,201 @@
-/*
- ***************************************************************************** 
- * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
- *
- * Copyright (c) 2022 Yogender Solanki
- *
- * This program is free software: you can redistribute it and/or modify it
- * under the terms of the GNU Lesser General Public License as published by the
- * Free Software Foundation, either version 3 of the License, or (at your
- * option) any later version.
- *
- * This program is distributed in the hope that it will be useful, but WITHOUT
- * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
- * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
- * for more details.
- *
- * You should have received a copy of the GNU Lesser General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- *****************************************************************************
- */
-#pragma once
-
-#include <boost/log/core.hpp>
-#include <boost/log/expressions.hpp>
-#include <boost/log/trivial.hpp>
-#include <boost/log/utility/setup/common_attributes.hpp>
-#include <boost/log/utility/setup/console.hpp>
-#include <boost/log/utility/setup/file.hpp>
-#include <iostream>
-
-#define LOG_TRACE BOOST_LOG_TRIVIAL(trace) << __FUNCTION__ << "/ "
-#define LOG_DEBUG BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << " "
-#define LOG_INFO BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << " "
-#define LOG_WARNING BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << " "
-#define LOG_ERROR BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << " "
-#define LOG_FATAL BOOST_LOG_TRIVIAL(fatal) << __FUNCTION__ << " "
-
-namespace logging = boost::log;
-
-static bool InitDone = false;
-
-static void init_logging()
-{
-    logging::core::get()->set_filter(logging::trivial::severity >= logging::trivial::info);
-    boost::log::add_console_log(
-        std::cout,
-        boost::log::keywords::format = "[%TimeStamp%] [%ThreadID%] [%Severity%] %Message%");
-    logging::add_common_attributes();
-    InitDone = true;
-}
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/log/utility/setup/common_attributes.hpp>
+#include <boost/log/utility/setup/console.hpp>
+#include <boost/log/utility/setup/file.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+
+/*
+ * Statements below this level are compiled out, 0 trace, 1 debug, 2 info,
+ * 3 warning, 4 error, 5 fatal. Release builds drop trace and debug, which
+ * every FUSE callback would otherwise format on entry.
+ */
+#ifndef TFUSE_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define TFUSE_LOG_MIN_LEVEL 2
+#else
+#define TFUSE_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+// Warnings and errors one statement logs per window, the rest are counted
+#define LOG_RATE_LIMIT 10
+#define LOG_RATE_WINDOW_MS 1000
+
+/*
+ * Rate limit of one logging statement. A backend that went away makes every
+ * caller fail the same way, only the first few of each window are written
+ * and the next one that is reports how many were dropped.
+ */
+class log_rate_limit {
+public:
+    // 0 when the message is dropped, else 1 + the messages dropped before it
+    inline uint64_t admit()
+    {
+        int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+        int64_t start = windowStart.load(std::memory_order_relaxed);
+        if (now - start >= LOG_RATE_WINDOW_MS
+            && windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+            inWindow.store(0, std::memory_order_relaxed);
+        }
+        if (inWindow.fetch_add(1, std::memory_order_relaxed) < LOG_RATE_LIMIT) {
+            return suppressed.exchange(0, std::memory_order_relaxed) + 1;
+        }
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+private:
+    std::atomic<int64_t> windowStart { INT64_MIN / 2 };
+    std::atomic<uint32_t> inWindow { 0 };
+    std::atomic<uint64_t> suppressed { 0 };
+};
+
+struct log_suppressed {
+    uint64_t count;
+};
+
+template <typename Stream>
+inline Stream& operator<<(Stream& out, const log_suppressed& note)
+{
+    if (note.count > 0) {
+        out << "(" << note.count << " similar dropped) ";
+    }
+    return out;
+}
+
+// Limiter private to the statement it is expanded in
+#define LOG_RATE_SITE() ([]() -> log_rate_limit& { static log_rate_limit site; return site; }())
+
+#define LOG_DISABLED if (true) {} else BOOST_LOG_TRIVIAL(trace)
+#define LOG_LIMITED(severity)                                                      \
+    for (uint64_t logAdmit = LOG_RATE_SITE().admit(); logAdmit != 0; logAdmit = 0) \
+    BOOST_LOG_TRIVIAL(severity) << log_suppressed { logAdmit - 1 } << __FUNCTION__ << " "
+
+#if TFUSE_LOG_MIN_LEVEL <= 0
+#define LOG_TRACE BOOST_LOG_TRIVIAL(trace) << __FUNCTION__ << "/ "
+#else
+#define LOG_TRACE LOG_DISABLED
+#endif
+#if TFUSE_LOG_MIN_LEVEL <= 1
+#define LOG_DEBUG BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << " "
+#else
+#define LOG_DEBUG LOG_DISABLED
+#endif
+#if TFUSE_LOG_MIN_LEVEL <= 2
+#define LOG_INFO BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << " "
+#else
+#define LOG_INFO LOG_DISABLED
+#endif
+#if TFUSE_LOG_MIN_LEVEL <= 3
+#define LOG_WARNING LOG_LIMITED(warning)
+#else
+#define LOG_WARNING LOG_DISABLED
+#endif
+#define LOG_ERROR LOG_LIMITED(error)
+#define LOG_FATAL BOOST_LOG_TRIVIAL(fatal) << __FUNCTION__ << " "
+
+namespace logging = boost::log;
+
+/*
+ * Records are queued by the calling thread on the sink's lock-free queue and
+ * formatted and written by the sink's own thread, a slow console never holds
+ * up a FUSE callback.
+ */
+typedef logging::sinks::asynchronous_sink<logging::sinks::text_ostream_backend> async_console_sink;
+
+static bool InitDone = false;
+
+// Shared by every translation unit, logging is set up in main and started
+// from wherever the process is ready for threads
+inline boost::shared_ptr<async_console_sink>& console_sink()
+{
+    static boost::shared_ptr<async_console_sink> sink;
+    return sink;
+}
+
+inline boost::thread& console_sink_thread()
+{
+    static boost::thread thread;
+    return thread;
+}
+
+// Write out what is still queued, before the process exits
+static void flush_logging()
+{
+    auto& sink = console_sink();
+    if (sink) {
+        logging::core::get()->remove_sink(sink);
+        sink->stop();
+        if (console_sink_thread().joinable()) {
+            console_sink_thread().join();
+        }
+        sink->flush();
+        sink.reset();
+    }
+}
+
+/*
+ * Without startThread records are only queued until start_logging, for a
+ * process that forks first and would lose the thread.
+ */
+static void init_logging(bool startThread = true)
+{
+    logging::core::get()->set_filter(logging::trivial::severity >= logging::trivial::info);
+
+    auto backend = boost::make_shared<logging::sinks::text_ostream_backend>();
+    backend->add_stream(boost::shared_ptr<std::ostream>(&std::cout, boost::null_deleter()));
+    auto& sink = console_sink();
+    sink = boost::make_shared<async_console_sink>(backend, startThread);
+    sink->set_formatter(logging::parse_formatter("[%TimeStamp%] [%ThreadID%] [%Severity%] %Message%"));
+    logging::core::get()->add_sink(sink);
+
+    logging::add_common_attributes();
+    std::atexit(flush_logging);
+    InitDone = true;
+}
+
+// Start writing out records of a sink set up without its thread
+static void start_logging()
+{
+    auto sink = console_sink();
+    if (sink && !console_sink_thread().joinable()) {
+        console_sink_thread() = boost::thread([sink]() { sink->run(); });
+    }
+}
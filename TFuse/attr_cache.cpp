@@ -0,0 +1,202 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <attr_cache.h>
+#include <path_util.h>
+
+attr_cache::attr_cache(size_t capacity, uint32_t ttlMs, size_t shardCount)
+    : _enabled(capacity > 0 && ttlMs > 0)
+    , ttl(ttlMs)
+    , hitCount(0)
+    , missCount(0)
+{
+    if (shardCount == 0) {
+        shardCount = 1;
+    }
+    if (capacity < shardCount) {
+        shardCount = capacity > 0 ? capacity : 1;
+    }
+    shardCapacity = capacity / shardCount;
+    for (size_t i = 0; i < shardCount; i++) {
+        shards.emplace_back(new shard());
+    }
+}
+
+size_t attr_cache::shard_index(const std::string& path) const
+{
+    return std::hash<std::string>()(path) % shards.size();
+}
+
+bool attr_cache::get(const std::string& path, Fuse::FuseStat& stats)
+{
+    if (!_enabled) {
+        return false;
+    }
+
+    shard& s = *shards[shard_index(path)];
+    boost::mutex::scoped_lock lock(s.lock);
+    auto it = s.entries.find(path);
+    if (it == s.entries.end()) {
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (clock::now() >= it->second.expiry) {
+        erase_locked(s, it);
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    s.lru.splice(s.lru.begin(), s.lru, it->second.lru);
+    stats = it->second.stats;
+    hitCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool attr_cache::peek(const std::string& path, Fuse::FuseStat& stats)
+{
+    if (!_enabled) {
+        return false;
+    }
+    shard& s = *shards[shard_index(path)];
+    boost::mutex::scoped_lock lock(s.lock);
+    auto it = s.entries.find(path);
+    if (it == s.entries.end() || clock::now() >= it->second.expiry) {
+        return false;
+    }
+    stats = it->second.stats;
+    return true;
+}
+
+uint64_t attr_cache::fill_token(const std::string& path)
+{
+    if (!_enabled) {
+        return 0;
+    }
+    shard& s = *shards[shard_index(path)];
+    boost::mutex::scoped_lock lock(s.lock);
+    return s.epoch;
+}
+
+void attr_cache::put(const std::string& path, const Fuse::FuseStat& stats, uint64_t token)
+{
+    if (!_enabled) {
+        return;
+    }
+    shard& s = *shards[shard_index(path)];
+    boost::mutex::scoped_lock lock(s.lock);
+    if (s.epoch != token) {
+        return;
+    }
+    insert_locked(s, path, stats);
+}
+
+std::vector<uint64_t> attr_cache::fill_snapshot()
+{
+    std::vector<uint64_t> snapshot;
+    if (!_enabled) {
+        return snapshot;
+    }
+    snapshot.reserve(shards.size());
+    for (auto& s : shards) {
+        boost::mutex::scoped_lock lock(s->lock);
+        snapshot.push_back(s->epoch);
+    }
+    return snapshot;
+}
+
+void attr_cache::put(const std::string& path, const Fuse::FuseStat& stats, const std::vector<uint64_t>& snapshot)
+{
+    if (!_enabled || snapshot.size() != shards.size()) {
+        return;
+    }
+    size_t idx = shard_index(path);
+    put(path, stats, snapshot[idx]);
+}
+
+void attr_cache::insert_locked(shard& s, const std::string& path, const Fuse::FuseStat& stats)
+{
+    auto expiry = clock::now() + ttl;
+    auto it = s.entries.find(path);
+    if (it != s.entries.end()) {
+        it->second.stats = stats;
+        it->second.expiry = expiry;
+        s.lru.splice(s.lru.begin(), s.lru, it->second.lru);
+        return;
+    }
+
+    while (!s.lru.empty() && s.entries.size() >= shardCapacity) {
+        erase_locked(s, s.entries.find(*s.lru.back()));
+    }
+
+    it = s.entries.emplace(path, entry()).first;
+    it->second.stats = stats;
+    it->second.expiry = expiry;
+    s.lru.push_front(&it->first);
+    it->second.lru = s.lru.begin();
+}
+
+void attr_cache::erase_locked(shard& s, std::unordered_map<std::string, entry>::iterator it)
+{
+    s.lru.erase(it->second.lru);
+    s.entries.erase(it);
+}
+
+void attr_cache::invalidate(const std::string& path)
+{
+    if (!_enabled) {
+        return;
+    }
+    shard& s = *shards[shard_index(path)];
+    boost::mutex::scoped_lock lock(s.lock);
+    s.epoch++;
+    auto it = s.entries.find(path);
+    if (it != s.entries.end()) {
+        erase_locked(s, it);
+    }
+}
+
+void attr_cache::invalidate_tree(const std::string& path)
+{
+    if (!_enabled) {
+        return;
+    }
+    // Children hash to any shard, so every shard has to be scanned
+    for (auto& s : shards) {
+        boost::mutex::scoped_lock lock(s->lock);
+        s->epoch++;
+        for (auto it = s->entries.begin(); it != s->entries.end();) {
+            auto next = std::next(it);
+            if (is_path_under(it->first, path)) {
+                erase_locked(*s, it);
+            }
+            it = next;
+        }
+    }
+}
+
+void attr_cache::clear()
+{
+    for (auto& s : shards) {
+        boost::mutex::scoped_lock lock(s->lock);
+        s->epoch++;
+        s->entries.clear();
+        s->lru.clear();
+    }
+}
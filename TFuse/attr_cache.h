@@ -0,0 +1,113 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <FuseService.h>
+
+#define ATTR_CACHE_DEFAULT_TTL_MS 1000
+#define ATTR_CACHE_DEFAULT_CAPACITY 65536
+#define ATTR_CACHE_DEFAULT_SHARDS 16
+
+/*
+ * Bounded cache of FuseStat keyed by path.
+ *
+ * Entries live for ttlMs and are evicted in LRU order once a shard is full.
+ * Every shard carries an epoch that is bumped by invalidation, a getattr that
+ * raced with a mutation presents the epoch it saw before going to the host and
+ * its result is dropped if the shard moved on in the meantime.
+ *
+ * A ttlMs or capacity of 0 disables the cache.
+ */
+class attr_cache {
+public:
+    attr_cache(size_t capacity, uint32_t ttlMs, size_t shardCount);
+
+    inline bool enabled() const
+    {
+        return _enabled;
+    }
+
+    bool get(const std::string& path, Fuse::FuseStat& stats);
+    // get without counting a hit or miss or touching the LRU order
+    bool peek(const std::string& path, Fuse::FuseStat& stats);
+    // Epoch to hand back to put() for a lookup about to go to the host
+    uint64_t fill_token(const std::string& path);
+    void put(const std::string& path, const Fuse::FuseStat& stats, uint64_t token);
+
+    // Epochs of all shards, for fills whose paths are not known up front (readdir)
+    std::vector<uint64_t> fill_snapshot();
+    void put(const std::string& path, const Fuse::FuseStat& stats, const std::vector<uint64_t>& snapshot);
+
+    void invalidate(const std::string& path);
+    // Drop path and everything below it, scans every shard so it is kept
+    // for renames of directories
+    void invalidate_tree(const std::string& path);
+    void clear();
+
+    inline uint64_t hits() const
+    {
+        return hitCount.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t misses() const
+    {
+        return missCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    struct entry {
+        Fuse::FuseStat stats;
+        clock::time_point expiry;
+        std::list<const std::string*>::iterator lru;
+    };
+
+    struct shard {
+        boost::mutex lock;
+        uint64_t epoch = 0;
+        std::unordered_map<std::string, entry> entries;
+        // Most recently used at the front, points at the keys of entries
+        std::list<const std::string*> lru;
+    };
+
+    size_t shard_index(const std::string& path) const;
+    void insert_locked(shard& s, const std::string& path, const Fuse::FuseStat& stats);
+    void erase_locked(shard& s, std::unordered_map<std::string, entry>::iterator it);
+
+    bool _enabled;
+    size_t shardCapacity;
+    std::chrono::milliseconds ttl;
+    std::vector<std::unique_ptr<shard>> shards;
+
+    std::atomic<uint64_t> hitCount;
+    std::atomic<uint64_t> missCount;
+};
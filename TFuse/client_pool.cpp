@@ -0,0 +1,623 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+#include <Logger.h>
+#include <client_pool.h>
+
+wait_histogram::wait_histogram()
+    : total(0)
+    , sumUs(0)
+    , maxUs(0)
+{
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void wait_histogram::record(uint64_t us)
+{
+    size_t idx = 0;
+    while (idx < CLIENT_POOL_WAIT_BUCKETS - 1 && (us >> idx) != 0) {
+        idx++;
+    }
+    buckets[idx].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sumUs.fetch_add(us, std::memory_order_relaxed);
+
+    uint64_t seen = maxUs.load(std::memory_order_relaxed);
+    while (us > seen && !maxUs.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t wait_histogram::percentile(double p) const
+{
+    uint64_t samples = count();
+    if (samples == 0) {
+        return 0;
+    }
+    auto target = static_cast<uint64_t>(std::ceil(samples * p / 100.0));
+    target = std::max<uint64_t>(target, 1);
+
+    uint64_t seen = 0;
+    for (size_t idx = 0; idx < CLIENT_POOL_WAIT_BUCKETS; idx++) {
+        seen += buckets[idx].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(bucket_upper(idx), max());
+        }
+    }
+    return max();
+}
+
+static inline int64_t ticks(std::chrono::steady_clock::time_point time)
+{
+    return time.time_since_epoch().count();
+}
+
+client_pool::client_pool(client_factory clientFactory, const client_pool_config& conf)
+    : factory(clientFactory)
+    , config(conf)
+    , waiters(0)
+    , retiringCount(0)
+    , inUse(0)
+    , peakInUse(0)
+    , latencyUs(0)
+    , bytesRead(0)
+    , bytesWritten(0)
+{
+    config.minClients = std::max<size_t>(config.minClients, 1);
+    config.maxClients = std::max(config.maxClients, config.minClients);
+    config.maxInflight = std::max<size_t>(config.maxInflight, 1);
+
+    slotCount = std::max<size_t>(boost::thread::hardware_concurrency(), 1);
+    slots.reset(new fast_slot[slotCount]);
+    for (size_t i = 0; i < slotCount; i++) {
+        slots[i].busy.store(false, std::memory_order_relaxed);
+    }
+}
+
+client_pool::~client_pool()
+{
+    {
+        boost::mutex::scoped_lock guard(lock);
+        stopping = true;
+        wakeup.notify_all();
+    }
+    if (maintainer != nullptr) {
+        maintainer->join();
+        maintainer.reset();
+    }
+}
+
+void client_pool::start()
+{
+    std::vector<ThriftClientPtr> created;
+    for (size_t i = 0; i < config.minClients; i++) {
+        created.push_back(factory(nextId++));
+        created.back()->mark_used(ticks(clock::now()));
+    }
+
+    {
+        boost::mutex::scoped_lock guard(lock);
+        clients = created;
+        // Interleaved so that consecutive callers land on different connections
+        for (size_t i = 0; i < config.maxInflight; i++) {
+            for (auto& client : created) {
+                idle.push_back(client);
+            }
+        }
+        lastGrow = clock::now();
+    }
+
+    LOG_INFO << "Client pool started with " << config.minClients << " connections, up to " << config.maxClients;
+}
+
+void client_pool::start_maintainer()
+{
+    boost::mutex::scoped_lock guard(lock);
+    if (maintainer == nullptr && !stopping) {
+        maintainer.reset(new boost::thread([this]() { maintainer_loop(); }));
+    }
+}
+
+size_t client_pool::slot_hint() const
+{
+    static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+    return hint % slotCount;
+}
+
+bool client_pool::take_slot(size_t idx, ThriftClientPtr& client)
+{
+    fast_slot& slot = slots[idx];
+    if (slot.busy.exchange(true, std::memory_order_acquire)) {
+        return false;
+    }
+    bool found = slot.client != nullptr;
+    if (found) {
+        client = std::move(slot.client);
+        slot.client.reset();
+    }
+    slot.busy.store(false, std::memory_order_release);
+    return found;
+}
+
+bool client_pool::put_slot(size_t idx, const ThriftClientPtr& client)
+{
+    fast_slot& slot = slots[idx];
+    if (slot.busy.exchange(true, std::memory_order_acquire)) {
+        return false;
+    }
+    bool stored = slot.client == nullptr;
+    if (stored) {
+        slot.client = client;
+    }
+    slot.busy.store(false, std::memory_order_release);
+    return stored;
+}
+
+bool client_pool::steal_slot(ThriftClientPtr& client)
+{
+    for (size_t i = 0; i < slotCount; i++) {
+        if (take_slot(i, client)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void client_pool::note_acquired()
+{
+    size_t now = inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+    size_t peak = peakInUse.load(std::memory_order_relaxed);
+    while (now > peak && !peakInUse.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+}
+
+bool client_pool::take_locked(ThriftClientPtr& client)
+{
+    while (true) {
+        if (!idle.empty()) {
+            client = idle.front();
+            idle.pop_front();
+        } else if (!steal_slot(client)) {
+            return false;
+        }
+        if (retiringCount.load(std::memory_order_acquire) == 0 || !drop_if_retiring_locked(client)) {
+            return true;
+        }
+    }
+}
+
+bool client_pool::drop_if_retiring_locked(const ThriftClientPtr& client)
+{
+    auto it = retiring.find(client.get());
+    if (it == retiring.end()) {
+        return false;
+    }
+    if (--it->second == 0) {
+        LOG_INFO << "Closing connection " << client->get_client_id();
+        retiring.erase(it);
+        retiringCount.fetch_sub(1, std::memory_order_release);
+    }
+    return true;
+}
+
+void client_pool::return_locked(const ThriftClientPtr& client)
+{
+    if (client->is_broken()) {
+        quarantine_locked(client);
+        return;
+    }
+    if (retiringCount.load(std::memory_order_acquire) != 0 && drop_if_retiring_locked(client)) {
+        return;
+    }
+    idle.push_back(client);
+    available.notify_one();
+}
+
+void client_pool::add_client_locked(const ThriftClientPtr& client)
+{
+    client->mark_used(ticks(clock::now()));
+    clients.push_back(client);
+    for (size_t i = 0; i < config.maxInflight; i++) {
+        idle.push_back(client);
+    }
+    available.notify_all();
+}
+
+ThriftClientPtr client_pool::acquire()
+{
+    ThriftClientPtr client;
+    if (take_slot(slot_hint(), client)) {
+        bool usable = retiringCount.load(std::memory_order_acquire) == 0;
+        if (!usable) {
+            boost::mutex::scoped_lock guard(lock);
+            usable = !drop_if_retiring_locked(client);
+        }
+        if (usable) {
+            waitTimes.record(0);
+            note_acquired();
+            return client;
+        }
+    }
+
+    auto start = clock::now();
+    // Pairs with the fence in release(), either the releaser sees this waiter
+    // or the scan below sees the client it parked in its slot.
+    waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    boost::mutex::scoped_lock guard(lock);
+    auto poll = boost::chrono::milliseconds(std::max<uint32_t>(config.growWaitMs, 1));
+    while (!take_locked(client)) {
+        if (clock::now() - start >= std::chrono::milliseconds(config.growWaitMs) && grow(guard)) {
+            continue;
+        }
+        if (clients.empty() && clock::now() - start >= std::chrono::milliseconds(CLIENT_POOL_UNAVAILABLE_MS)) {
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            throw TTransportException(TTransportException::NOT_OPEN, "No connection to the host");
+        }
+        available.wait_for(guard, poll);
+    }
+    waiters.fetch_sub(1, std::memory_order_relaxed);
+    guard.unlock();
+
+    waitTimes.record(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count());
+    note_acquired();
+    return client;
+}
+
+bool client_pool::try_acquire(ThriftClientPtr& client)
+{
+    if (take_slot(slot_hint(), client)) {
+        bool usable = retiringCount.load(std::memory_order_acquire) == 0;
+        if (!usable) {
+            boost::mutex::scoped_lock guard(lock);
+            usable = !drop_if_retiring_locked(client);
+        }
+        if (usable) {
+            note_acquired();
+            return true;
+        }
+    }
+
+    boost::mutex::scoped_lock guard(lock);
+    if (!take_locked(client)) {
+        return false;
+    }
+    note_acquired();
+    return true;
+}
+
+void client_pool::release(const ThriftClientPtr& client)
+{
+    inUse.fetch_sub(1, std::memory_order_relaxed);
+    client->mark_used(ticks(clock::now()));
+
+    if (!client->is_broken() && retiringCount.load(std::memory_order_acquire) == 0) {
+        size_t hint = slot_hint();
+        if (put_slot(hint, client)) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+            // Someone is blocked in acquire(), hand it over through the queue
+            ThriftClientPtr parked;
+            if (!take_slot(hint, parked)) {
+                return;
+            }
+            boost::mutex::scoped_lock guard(lock);
+            return_locked(parked);
+            return;
+        }
+    }
+
+    boost::mutex::scoped_lock guard(lock);
+    return_locked(client);
+}
+
+/*
+ * Open one more connection for a caller that waited too long. Called and
+ * returns with guard held, the connect itself runs unlocked.
+ */
+bool client_pool::grow(boost::mutex::scoped_lock& guard)
+{
+    auto now = clock::now();
+    if (growing || clients.size() + reconnectsPending >= config.maxClients || now < growBlockedUntil) {
+        return false;
+    }
+    growing = true;
+    int id = nextId++;
+    guard.unlock();
+
+    ThriftClientPtr client;
+    try {
+        client = factory(id);
+    } catch (const std::exception& ex) {
+        LOG_ERROR << "Unable to add connection to client pool " << ex.what();
+    }
+
+    guard.lock();
+    growing = false;
+    if (client == nullptr) {
+        growBlockedUntil = clock::now() + std::chrono::milliseconds(CLIENT_POOL_GROW_RETRY_MS);
+        return false;
+    }
+    add_client_locked(client);
+    lastGrow = clock::now();
+    LOG_INFO << "Client pool grew to " << clients.size() << " connections";
+    return true;
+}
+
+/*
+ * Take a connection out of rotation. Its tokens are pulled out of the queue
+ * and the slots, the ones still handed out (less the returned ones the caller
+ * holds) are dropped as they come back and the client is closed with the last
+ * of them.
+ */
+void client_pool::retire_locked(const ThriftClientPtr& client, size_t returned)
+{
+    clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
+
+    size_t outstanding = config.maxInflight - returned;
+    for (auto it = idle.begin(); it != idle.end();) {
+        if (*it == client) {
+            it = idle.erase(it);
+            outstanding--;
+        } else {
+            ++it;
+        }
+    }
+    for (size_t i = 0; i < slotCount; i++) {
+        fast_slot& slot = slots[i];
+        while (slot.busy.exchange(true, std::memory_order_acquire)) {
+        }
+        if (slot.client == client) {
+            slot.client.reset();
+            outstanding--;
+        }
+        slot.busy.store(false, std::memory_order_release);
+    }
+
+    if (outstanding > 0) {
+        retiring[client.get()] = outstanding;
+        retiringCount.fetch_add(1, std::memory_order_seq_cst);
+    } else {
+        LOG_INFO << "Closing connection " << client->get_client_id();
+    }
+}
+
+/*
+ * A broken client came back. The first of its tokens retires the connection
+ * and schedules a replacement, the others only drop out.
+ */
+void client_pool::quarantine_locked(const ThriftClientPtr& client)
+{
+    if (std::find(clients.begin(), clients.end(), client) == clients.end()) {
+        drop_if_retiring_locked(client);
+        return;
+    }
+
+    LOG_WARNING << "Connection " << client->get_client_id() << " is broken, replacing it";
+    retire_locked(client, 1);
+    if (reconnectsPending++ == 0) {
+        nextReconnect = clock::now() + std::chrono::milliseconds(reconnectBackoffMs);
+    }
+    wakeup.notify_all();
+}
+
+/*
+ * Replace broken connections until one attempt fails, which doubles the
+ * backoff. Called and returns with guard held.
+ */
+void client_pool::reconnect(boost::mutex::scoped_lock& guard)
+{
+    while (reconnectsPending > 0 && !stopping) {
+        int id = nextId++;
+        guard.unlock();
+
+        ThriftClientPtr client;
+        try {
+            client = factory(id);
+        } catch (const std::exception& ex) {
+            LOG_WARNING << "Reconnect to the host failed " << ex.what();
+        }
+
+        guard.lock();
+        if (client == nullptr) {
+            reconnectBackoffMs = std::min<uint32_t>(reconnectBackoffMs * 2, CLIENT_POOL_RECONNECT_MAX_MS);
+            nextReconnect = clock::now() + std::chrono::milliseconds(reconnectBackoffMs);
+            return;
+        }
+        reconnectsPending--;
+        reconnectBackoffMs = CLIENT_POOL_RECONNECT_MIN_MS;
+        add_client_locked(client);
+        LOG_INFO << "Reconnected to the host on " << client->get_client_id();
+    }
+}
+
+bool client_pool::take_stale_locked(int64_t staleBefore, ThriftClientPtr& client)
+{
+    for (auto it = idle.begin(); it != idle.end(); ++it) {
+        if ((*it)->last_used() <= staleBefore) {
+            client = *it;
+            idle.erase(it);
+            return true;
+        }
+    }
+    for (size_t i = 0; i < slotCount; i++) {
+        fast_slot& slot = slots[i];
+        if (slot.busy.exchange(true, std::memory_order_acquire)) {
+            continue;
+        }
+        bool stale = slot.client != nullptr && slot.client->last_used() <= staleBefore;
+        if (stale) {
+            client = std::move(slot.client);
+            slot.client.reset();
+        }
+        slot.busy.store(false, std::memory_order_release);
+        if (stale) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Ping the connections nobody used for pingMs, one token at a time so the
+ * rest of the pool stays available to callers. Connections in use prove
+ * themselves, a dead one would have failed a caller already. Called and
+ * returns with guard held.
+ */
+void client_pool::probe_idle(boost::mutex::scoped_lock& guard)
+{
+    int64_t staleBefore = ticks(clock::now() - std::chrono::milliseconds(config.pingMs));
+    ThriftClientPtr client;
+    while (!stopping && take_stale_locked(staleBefore, client)) {
+        guard.unlock();
+        auto start = clock::now();
+        try {
+            client->ping();
+            // Keeps the average fresh on a pool that gets no calls, so a
+            // recovered replica is picked again
+            record_latency(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count());
+        } catch (std::exception& ex) {
+            if (thrift_client::breaks_connection(ex)) {
+                client->mark_broken();
+            }
+            LOG_WARNING << "Ping failed on " << client->get_client_id() << " " << ex.what();
+        }
+        // Probed either way, it is not picked again this round
+        client->mark_used(ticks(clock::now()));
+        guard.lock();
+        return_locked(client);
+        client.reset();
+    }
+}
+
+void client_pool::shrink_locked()
+{
+    // Busiest moment since the last check, a connection is spare if that
+    // still fit into one connection less
+    size_t peak = peakInUse.exchange(inUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    bool quiet = clock::now() - lastGrow >= std::chrono::milliseconds(config.idleMs);
+    if (quiet && clients.size() > config.minClients
+        && peak + config.maxInflight <= clients.size() * config.maxInflight) {
+        auto client = clients.back();
+        retire_locked(client, 0);
+        LOG_INFO << "Client pool shrank to " << clients.size() << " connections";
+    }
+}
+
+void client_pool::maintainer_loop()
+{
+    bool shrinking = config.idleMs > 0 && config.maxClients > config.minClients;
+    // Stats are logged on the shrink check, or every minute without one
+    auto statsPeriod = std::chrono::milliseconds(shrinking ? config.idleMs : 60000);
+    auto now = clock::now();
+    auto nextShrink = now + std::chrono::milliseconds(config.idleMs);
+    auto nextPing = now + std::chrono::milliseconds(config.pingMs);
+    auto nextStats = now + statsPeriod;
+    uint64_t lastCount = waitTimes.count();
+
+    boost::mutex::scoped_lock guard(lock);
+    while (!stopping) {
+        auto due = nextStats;
+        if (shrinking) {
+            due = std::min(due, nextShrink);
+        }
+        if (config.pingMs > 0) {
+            due = std::min(due, nextPing);
+        }
+        if (reconnectsPending > 0) {
+            due = std::min(due, nextReconnect);
+        }
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(due - clock::now()).count();
+        if (wait > 0) {
+            wakeup.wait_for(guard, boost::chrono::milliseconds(wait));
+        }
+        if (stopping) {
+            break;
+        }
+
+        now = clock::now();
+        if (reconnectsPending > 0 && now >= nextReconnect) {
+            reconnect(guard);
+        }
+        if (shrinking && now >= nextShrink) {
+            nextShrink = now + std::chrono::milliseconds(config.idleMs);
+            shrink_locked();
+        }
+        if (config.pingMs > 0 && now >= nextPing) {
+            nextPing = now + std::chrono::milliseconds(config.pingMs);
+            probe_idle(guard);
+        }
+        if (now >= nextStats) {
+            nextStats = now + statsPeriod;
+            if (waitTimes.count() != lastCount) {
+                lastCount = waitTimes.count();
+                guard.unlock();
+                log_stats();
+                guard.lock();
+            }
+        }
+    }
+}
+
+size_t client_pool::size()
+{
+    boost::mutex::scoped_lock guard(lock);
+    return clients.size();
+}
+
+void client_pool::record_latency(uint64_t us)
+{
+    // Concurrent updates may drop a sample, that only slows the average down
+    uint64_t average = latencyUs.load(std::memory_order_relaxed);
+    if (average >= CLIENT_POOL_FAILURE_LATENCY_US) {
+        // First answer after a failure starts the average over
+        latencyUs.store(us, std::memory_order_relaxed);
+        return;
+    }
+    latencyUs.store(average - average / CLIENT_POOL_LATENCY_WEIGHT + us / CLIENT_POOL_LATENCY_WEIGHT,
+        std::memory_order_relaxed);
+}
+
+void client_pool::record_failure()
+{
+    uint64_t average = latencyUs.load(std::memory_order_relaxed);
+    if (average < CLIENT_POOL_FAILURE_LATENCY_US) {
+        latencyUs.store(CLIENT_POOL_FAILURE_LATENCY_US, std::memory_order_relaxed);
+    }
+}
+void client_pool::log_stats()
+{
+    LOG_INFO << "Client pool connections " << size()
+             << " acquisitions " << waitTimes.count()
+             << " wait p50 " << waitTimes.percentile(50) << " us"
+             << " p90 " << waitTimes.percentile(90) << " us"
+             << " p99 " << waitTimes.percentile(99) << " us"
+             << " max " << waitTimes.max() << " us"
+             << " call latency " << latency() << " us";
+}
@@ -0,0 +1,274 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <thrift_client.h>
+
+#define CLIENT_POOL_DEFAULT_MIN 8
+#define CLIENT_POOL_DEFAULT_MAX 32
+#define CLIENT_POOL_DEFAULT_GROW_WAIT_MS 5
+#define CLIENT_POOL_DEFAULT_IDLE_MS 30000
+#define CLIENT_POOL_DEFAULT_PING_MS 10000
+// Back off this long after a connection attempt failed
+#define CLIENT_POOL_GROW_RETRY_MS 1000
+// Reconnect backoff for broken connections, doubled per failed attempt
+#define CLIENT_POOL_RECONNECT_MIN_MS 100
+#define CLIENT_POOL_RECONNECT_MAX_MS 10000
+// A caller gives up after this long when no connection is left at all
+#define CLIENT_POOL_UNAVAILABLE_MS 5000
+// Weight of the newest sample in the latency average is 1/this
+#define CLIENT_POOL_LATENCY_WEIGHT 8
+// A failed call counts as at least this slow
+#define CLIENT_POOL_FAILURE_LATENCY_US 1000000
+#define CLIENT_POOL_WAIT_BUCKETS 32
+#define CLIENT_POOL_CACHE_LINE 64
+
+struct client_pool_config {
+    // Backend the pool connects to, used to label its metrics
+    std::string target;
+    size_t minClients = CLIENT_POOL_DEFAULT_MIN;
+    size_t maxClients = CLIENT_POOL_DEFAULT_MAX;
+    // Callers one connection takes at a time, above 1 only for pipelined clients
+    size_t maxInflight = 1;
+    uint32_t growWaitMs = CLIENT_POOL_DEFAULT_GROW_WAIT_MS;
+    uint32_t idleMs = CLIENT_POOL_DEFAULT_IDLE_MS;
+    // Idle connections are pinged this often, 0 disables the probe
+    uint32_t pingMs = CLIENT_POOL_DEFAULT_PING_MS;
+};
+
+// Creates and connects the client with the given id, throws when it cannot
+typedef std::function<ThriftClientPtr(int id)> client_factory;
+
+/*
+ * Histogram of waits in power of two microsecond buckets, bucket 0 holds the
+ * waits under a microsecond. Recording is a few relaxed increments.
+ */
+class wait_histogram {
+public:
+    wait_histogram();
+
+    void record(uint64_t us);
+    // Upper bound of the bucket holding the p-th percentile (0 < p <= 100)
+    uint64_t percentile(double p) const;
+
+    inline uint64_t count() const
+    {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t sum() const
+    {
+        return sumUs.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t max() const
+    {
+        return maxUs.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t bucket_count(size_t idx) const
+    {
+        return buckets[idx].load(std::memory_order_relaxed);
+    }
+
+    // Largest wait of bucket idx, the last bucket has no bound
+    static inline uint64_t bucket_upper(size_t idx)
+    {
+        return idx == 0 ? 0 : (uint64_t(1) << idx) - 1;
+    }
+
+private:
+    std::atomic<uint64_t> buckets[CLIENT_POOL_WAIT_BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sumUs;
+    std::atomic<uint64_t> maxUs;
+};
+
+/*
+ * Pool of thrift clients handed out one caller at a time.
+ *
+ * Every FUSE thread hashes to a fast slot that caches one idle client, a
+ * thread that releases into and acquires from its own slot touches no shared
+ * lock. Clients that do not fit a slot go to a shared queue and callers that
+ * find their slot empty take from the queue or steal from the other slots.
+ *
+ * The pool starts with minClients connections. A caller that waited
+ * growWaitMs for a client opens another one, up to maxClients, and a
+ * connection above minClients is closed again once a whole idleMs window went
+ * by in which it was never needed. A pipelined client is handed out
+ * maxInflight times concurrently.
+ *
+ * A client that comes back marked broken is taken out of rotation right
+ * away, together with every other token of it, and a replacement is
+ * connected in the background with exponential backoff. A connection that
+ * sat unused for pingMs, in the queue or in a slot, is pinged so a dead
+ * backend is noticed before callers hit it.
+ * When no connection is left callers fail after CLIENT_POOL_UNAVAILABLE_MS
+ * instead of hanging.
+ *
+ * Callers report how long their calls took, the moving average of that and
+ * the number of clients handed out tell replica selection how busy the
+ * backend behind the pool is.
+ */
+class client_pool {
+public:
+    client_pool(client_factory factory, const client_pool_config& conf);
+    ~client_pool();
+
+    // Open the first minClients connections, throws if one fails
+    void start();
+    // Reconnects, shrinks and probes from now on. The thread is not inherited
+    // by a fork, start it in the process that uses the pool.
+    void start_maintainer();
+
+    ThriftClientPtr acquire();
+    bool try_acquire(ThriftClientPtr& client);
+    void release(const ThriftClientPtr& client);
+
+    size_t size();
+
+    void record_latency(uint64_t us);
+    void record_failure();
+
+    // Payload moved to and from the backend
+    inline void record_read(uint64_t bytes)
+    {
+        bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    inline void record_written(uint64_t bytes)
+    {
+        bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    inline uint64_t bytes_read() const
+    {
+        return bytesRead.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t bytes_written() const
+    {
+        return bytesWritten.load(std::memory_order_relaxed);
+    }
+
+    inline const std::string& target() const
+    {
+        return config.target;
+    }
+
+    // Moving average of call latency in microseconds
+    inline uint64_t latency() const
+    {
+        return latencyUs.load(std::memory_order_relaxed);
+    }
+
+    // Clients handed out right now
+    inline size_t outstanding() const
+    {
+        return inUse.load(std::memory_order_relaxed);
+    }
+
+    inline const wait_histogram& waits() const
+    {
+        return waitTimes;
+    }
+
+    void log_stats();
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    // Padded so that neighbouring slots do not share a cache line
+    struct fast_slot {
+        std::atomic<bool> busy;
+        ThriftClientPtr client;
+        char pad[CLIENT_POOL_CACHE_LINE - sizeof(std::atomic<bool>) - sizeof(ThriftClientPtr)];
+    };
+
+    bool take_slot(size_t idx, ThriftClientPtr& client);
+    bool put_slot(size_t idx, const ThriftClientPtr& client);
+    bool steal_slot(ThriftClientPtr& client);
+    size_t slot_hint() const;
+
+    bool take_locked(ThriftClientPtr& client);
+    // One token of a client unused since staleBefore, from the queue or a slot
+    bool take_stale_locked(int64_t staleBefore, ThriftClientPtr& client);
+    bool drop_if_retiring_locked(const ThriftClientPtr& client);
+    void return_locked(const ThriftClientPtr& client);
+    void add_client_locked(const ThriftClientPtr& client);
+    bool grow(boost::mutex::scoped_lock& guard);
+    void retire_locked(const ThriftClientPtr& client, size_t returned);
+    void quarantine_locked(const ThriftClientPtr& client);
+    void reconnect(boost::mutex::scoped_lock& guard);
+    void probe_idle(boost::mutex::scoped_lock& guard);
+    void shrink_locked();
+    void note_acquired();
+    void maintainer_loop();
+
+    client_factory factory;
+    client_pool_config config;
+
+    std::unique_ptr<fast_slot[]> slots;
+    size_t slotCount;
+
+    boost::mutex lock;
+    boost::condition_variable available;
+    std::deque<ThriftClientPtr> idle;
+    std::vector<ThriftClientPtr> clients;
+    // Retired clients and how many of their tokens are still handed out
+    std::unordered_map<thrift_client*, size_t> retiring;
+    int nextId = 0;
+    bool growing = false;
+    clock::time_point growBlockedUntil;
+    clock::time_point lastGrow;
+    // Broken connections still to be replaced
+    size_t reconnectsPending = 0;
+    uint32_t reconnectBackoffMs = CLIENT_POOL_RECONNECT_MIN_MS;
+    clock::time_point nextReconnect;
+
+    std::atomic<size_t> waiters;
+    std::atomic<size_t> retiringCount;
+    std::atomic<size_t> inUse;
+    std::atomic<size_t> peakInUse;
+    std::atomic<uint64_t> latencyUs;
+    std::atomic<uint64_t> bytesRead;
+    std::atomic<uint64_t> bytesWritten;
+
+    wait_histogram waitTimes;
+
+    boost::condition_variable wakeup;
+    bool stopping = false;
+    std::unique_ptr<boost::thread> maintainer;
+};
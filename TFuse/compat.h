@@ -82,6 +82,10 @@
 #define S_IFIFO                         0010000
 #endif
 
+#if !defined(RENAME_EXCHANGE)
+#define RENAME_EXCHANGE                 (1 << 1)
+#endif
+
 #if defined(__APPLE__)
 #define st_atim                         st_atimespec
 #define st_ctim                         st_ctimespec
@@ -0,0 +1,102 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <dir_stream.h>
+
+dir_page_ptr dir_stream::lookup(int64_t offset, size_t& start)
+{
+    std::shared_future<dir_page_ptr> waitFor;
+    {
+        boost::mutex::scoped_lock guard(lock);
+        if (current != nullptr) {
+            if (current->offset == offset) {
+                start = 0;
+                return current;
+            }
+            for (size_t i = 0; i < current->entries.size(); i++) {
+                auto& entry = current->entries[i];
+                if (entry.__isset.offset && entry.offset == offset) {
+                    if (i + 1 < current->entries.size() || !current->more) {
+                        start = i + 1;
+                        return current;
+                    }
+                    // Stopped right at the end of the page, continue with the next one
+                    offset = current->nextOffset;
+                    break;
+                }
+            }
+        }
+
+        if (!hasPending || pendingOffset != offset) {
+            return nullptr;
+        }
+        waitFor = pending;
+        hasPending = false;
+    }
+
+    dir_page_ptr page = waitFor.get();
+    set_current(page);
+    start = 0;
+    return page;
+}
+
+void dir_stream::set_current(dir_page_ptr page)
+{
+    boost::mutex::scoped_lock guard(lock);
+    current = page;
+}
+
+void dir_stream::prefetch(int64_t offset, std::function<dir_page_ptr(void)> fetch, worker_pool& workers)
+{
+    auto promise = std::make_shared<std::promise<dir_page_ptr>>();
+    {
+        boost::mutex::scoped_lock guard(lock);
+        if (hasPending && pendingOffset == offset) {
+            return;
+        }
+        hasPending = true;
+        pendingOffset = offset;
+        pending = promise->get_future().share();
+    }
+
+    bool submitted = workers.submit([promise, fetch]() {
+        promise->set_value(fetch());
+    });
+    if (!submitted) {
+        boost::mutex::scoped_lock guard(lock);
+        hasPending = false;
+    }
+}
+
+dir_stream_ptr dir_stream_table::get(uint64_t fh, const std::string& path)
+{
+    boost::mutex::scoped_lock guard(lock);
+    auto& stream = streams[fh];
+    if (stream == nullptr || stream->get_path() != path) {
+        stream = std::make_shared<dir_stream>(path);
+    }
+    return stream;
+}
+
+void dir_stream_table::remove(uint64_t fh)
+{
+    boost::mutex::scoped_lock guard(lock);
+    streams.erase(fh);
+}
@@ -0,0 +1,108 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <FuseService.h>
+
+#include <worker_pool.h>
+
+#define READDIR_DEFAULT_PAGE_SIZE 1024
+
+/*
+ * One page of a directory listing as returned by the host.
+ *
+ * offset is the cookie the page was requested with, every entry carries the
+ * cookie that resumes right after it and nextOffset continues after the last
+ * entry when more is set.
+ */
+struct dir_page {
+    int64_t offset = 0;
+    int status = Fuse::StatusCode::FUSE_SUCCESS;
+    std::vector<Fuse::FuseDirEntry> entries;
+    bool more = false;
+    int64_t nextOffset = 0;
+};
+
+typedef std::shared_ptr<dir_page> dir_page_ptr;
+
+/*
+ * Listing state of one open directory handle.
+ *
+ * Keeps the page currently being handed to filler, so a readdir that stopped
+ * on a full buffer resumes without going back to the host, and at most one
+ * page fetched ahead of it on the worker pool.
+ */
+class dir_stream {
+private:
+    boost::mutex lock;
+    std::string path;
+    dir_page_ptr current;
+
+    bool hasPending = false;
+    int64_t pendingOffset = 0;
+    std::shared_future<dir_page_ptr> pending;
+
+public:
+    dir_stream(const std::string& dirPath)
+        : path(dirPath)
+    {
+    }
+
+    inline const std::string& get_path() const
+    {
+        return path;
+    }
+
+    /*
+     * Page holding the entries that follow offset, together with the index of
+     * the first of them. Waits for a prefetch that covers offset, returns null
+     * if the page has to be fetched.
+     */
+    dir_page_ptr lookup(int64_t offset, size_t& start);
+    void set_current(dir_page_ptr page);
+    // Fetch the page at offset in the background unless it is already pending
+    void prefetch(int64_t offset, std::function<dir_page_ptr(void)> fetch, worker_pool& workers);
+};
+
+typedef std::shared_ptr<dir_stream> dir_stream_ptr;
+
+/*
+ * Open directory handles mapped to their listing state.
+ */
+class dir_stream_table {
+private:
+    boost::mutex lock;
+    std::unordered_map<uint64_t, dir_stream_ptr> streams;
+
+public:
+    dir_stream_ptr get(uint64_t fh, const std::string& path);
+    void remove(uint64_t fh);
+};
@@ -0,0 +1,357 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <cstdio>
+#include <fstream>
+
+#include <fcntl.h>
+#if defined(_WIN32)
+#include <io.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <Logger.h>
+#include <disk_cache.h>
+
+static int open_slab(const std::string& path)
+{
+#if defined(_WIN32)
+    return _open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY | _O_NOINHERIT, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+#endif
+}
+
+static void close_slab(int fd)
+{
+#if defined(_WIN32)
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+// Positioned I/O, returns the bytes moved or -1. Neither call moves a file
+// position, so concurrent callers need no lock.
+static int64_t slab_io(int fd, char* buf, size_t length, uint64_t offset, bool forWrite)
+{
+#if defined(_WIN32)
+    OVERLAPPED at = {};
+    at.Offset = static_cast<DWORD>(offset);
+    at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD moved = 0;
+    auto handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    BOOL done = forWrite ? WriteFile(handle, buf, static_cast<DWORD>(length), &moved, &at)
+                         : ReadFile(handle, buf, static_cast<DWORD>(length), &moved, &at);
+    return done ? static_cast<int64_t>(moved) : -1;
+#else
+    auto at = static_cast<off_t>(offset);
+    return forWrite ? pwrite(fd, buf, length, at) : pread(fd, buf, length, at);
+#endif
+}
+
+disk_cache::disk_cache(const std::string& cacheDir, uint64_t capacityBytes, uint32_t blockBytes)
+    : dir(cacheDir)
+    , blockSize(blockBytes)
+    , hitCount(0)
+    , missCount(0)
+{
+    if (!dir.empty() && dir.back() != '/' && dir.back() != '\\') {
+        dir += '/';
+    }
+    slotCount = static_cast<uint32_t>(std::max<uint64_t>(capacityBytes / blockSize, 1));
+
+    // Opened without truncating, the slots of the last mount are reused
+    auto slabPath = dir + DISK_CACHE_SLAB_FILE;
+    slabFd = open_slab(slabPath);
+    if (slabFd < 0) {
+        throw std::runtime_error("Cannot open disk cache slab " + slabPath);
+    }
+    pins.assign(slotCount, 0);
+    dropped.assign(slotCount, false);
+
+    load_index();
+    std::vector<bool> used(slotCount, false);
+    for (auto& entry : lru) {
+        used[entry.slot] = true;
+    }
+    for (uint32_t slot = slotCount; slot > 0; slot--) {
+        if (!used[slot - 1]) {
+            freeSlots.push_back(slot - 1);
+        }
+    }
+    LOG_INFO << "Disk cache in " << dir << " holds " << lru.size() << " of " << slotCount << " blocks";
+}
+
+disk_cache::~disk_cache()
+{
+    boost::mutex::scoped_lock guard(lock);
+    save_index();
+    close_slab(slabFd);
+}
+
+bool disk_cache::get(const std::string& path, int64_t index, const Fuse::FuseStat& stat, char* buf, size_t& length)
+{
+    boost::mutex::scoped_lock guard(lock);
+    auto file = files.find(path);
+    if (file == files.end()) {
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    auto block = file->second.find(index);
+    if (block == file->second.end()) {
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto entry = block->second;
+    if (entry->fileSize != stat.size || entry->mtime != stat.modificationTime) {
+        // Changed on the host, nothing cached for the old content is any good
+        invalidate_locked(path);
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint32_t slot = entry->slot;
+    length = entry->length;
+    lru.splice(lru.begin(), lru, entry);
+    pins[slot]++;
+    guard.unlock();
+
+    bool copied = read_slot(slot, buf, length);
+
+    guard.lock();
+    if (!copied) {
+        LOG_WARNING << "Disk cache read failed for slot " << slot;
+        // Unless it was dropped or replaced meanwhile
+        auto again = files.find(path);
+        if (again != files.end()) {
+            auto still = again->second.find(index);
+            if (still != again->second.end() && still->second->slot == slot) {
+                drop_locked(still->second);
+            }
+        }
+    }
+    unpin_locked(slot);
+    (copied ? hitCount : missCount).fetch_add(1, std::memory_order_relaxed);
+    return copied;
+}
+
+void disk_cache::put(const std::string& path, int64_t index, const Fuse::FuseStat& stat, const char* data, size_t length)
+{
+    boost::mutex::scoped_lock guard(lock);
+    auto file = files.find(path);
+    if (file != files.end() && file->second.count(index) > 0) {
+        drop_locked(file->second[index]);
+    }
+    // Evicted slots that are still being read only come free later
+    while (freeSlots.empty() && !lru.empty()) {
+        drop_locked(std::prev(lru.end()));
+    }
+    if (freeSlots.empty()) {
+        return;
+    }
+    uint32_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    uint64_t seen = invalidations;
+    guard.unlock();
+
+    bool written = write_slot(slot, data, length);
+
+    guard.lock();
+    if (!written) {
+        LOG_WARNING << "Disk cache write failed for slot " << slot;
+    }
+    if (!written || invalidations != seen) {
+        // The data may be older than what the invalidation made current
+        freeSlots.push_back(slot);
+        return;
+    }
+    file = files.find(path);
+    if (file != files.end() && file->second.count(index) > 0) {
+        drop_locked(file->second[index]);
+    }
+    lru.push_front({ path, index, stat.size, stat.modificationTime, static_cast<uint32_t>(length), slot });
+    files[path][index] = lru.begin();
+}
+
+void disk_cache::invalidate(const std::string& path)
+{
+    boost::mutex::scoped_lock guard(lock);
+    invalidate_locked(path);
+}
+
+void disk_cache::invalidate_locked(const std::string& path)
+{
+    invalidations++;
+    auto file = files.find(path);
+    if (file == files.end()) {
+        return;
+    }
+    std::vector<entry_ref> entries;
+    for (auto& block : file->second) {
+        entries.push_back(block.second);
+    }
+    for (auto entry : entries) {
+        drop_locked(entry);
+    }
+}
+
+bool disk_cache::read_slot(uint32_t slot, char* buf, size_t length)
+{
+    uint64_t offset = static_cast<uint64_t>(slot) * blockSize;
+    size_t done = 0;
+    while (done < length) {
+        int64_t moved = slab_io(slabFd, buf + done, length - done, offset + done, false);
+        if (moved <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(moved);
+    }
+    return true;
+}
+
+bool disk_cache::write_slot(uint32_t slot, const char* data, size_t length)
+{
+    uint64_t offset = static_cast<uint64_t>(slot) * blockSize;
+    size_t done = 0;
+    while (done < length) {
+        int64_t moved = slab_io(slabFd, const_cast<char*>(data) + done, length - done, offset + done, true);
+        if (moved <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(moved);
+    }
+    return true;
+}
+
+void disk_cache::drop_locked(entry_ref entry)
+{
+    auto file = files.find(entry->path);
+    file->second.erase(entry->index);
+    if (file->second.empty()) {
+        files.erase(file);
+    }
+    free_slot_locked(entry->slot);
+    lru.erase(entry);
+}
+
+void disk_cache::free_slot_locked(uint32_t slot)
+{
+    if (pins[slot] > 0) {
+        dropped[slot] = true;
+        return;
+    }
+    freeSlots.push_back(slot);
+}
+
+void disk_cache::unpin_locked(uint32_t slot)
+{
+    if (--pins[slot] == 0 && dropped[slot]) {
+        dropped[slot] = false;
+        freeSlots.push_back(slot);
+    }
+}
+
+template <typename T>
+static bool read_value(std::istream& in, T& value)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+template <typename T>
+static void write_value(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void disk_cache::load_index()
+{
+    auto indexPath = dir + DISK_CACHE_INDEX_FILE;
+    std::ifstream in(indexPath, std::ios::binary);
+    if (!in.is_open()) {
+        return;
+    }
+
+    uint32_t magic = 0, savedBlockSize = 0, savedSlots = 0;
+    uint64_t count = 0;
+    if (read_value(in, magic) && magic == DISK_CACHE_INDEX_MAGIC
+        && read_value(in, savedBlockSize) && savedBlockSize == blockSize
+        && read_value(in, savedSlots) && read_value(in, count)) {
+        for (uint64_t i = 0; i < count; i++) {
+            block_entry entry;
+            uint32_t pathLength = 0;
+            if (!read_value(in, pathLength)) {
+                break;
+            }
+            entry.path.resize(pathLength);
+            if (!in.read(&entry.path[0], pathLength)
+                || !read_value(in, entry.index) || !read_value(in, entry.fileSize)
+                || !read_value(in, entry.mtime) || !read_value(in, entry.length)
+                || !read_value(in, entry.slot)) {
+                break;
+            }
+            // Slots past a shrunk capacity are gone
+            if (entry.slot >= slotCount || entry.length > blockSize) {
+                continue;
+            }
+            lru.push_back(entry);
+            files[entry.path][entry.index] = std::prev(lru.end());
+        }
+    } else {
+        LOG_INFO << "Disk cache index does not match the configuration, starting empty";
+    }
+    in.close();
+    std::remove(indexPath.c_str());
+}
+
+void disk_cache::save_index()
+{
+    auto indexPath = dir + DISK_CACHE_INDEX_FILE;
+    auto tempPath = indexPath + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        LOG_WARNING << "Cannot write disk cache index " << tempPath;
+        return;
+    }
+
+    write_value(out, static_cast<uint32_t>(DISK_CACHE_INDEX_MAGIC));
+    write_value(out, blockSize);
+    write_value(out, slotCount);
+    write_value(out, static_cast<uint64_t>(lru.size()));
+    for (auto& entry : lru) {
+        write_value(out, static_cast<uint32_t>(entry.path.size()));
+        out.write(entry.path.data(), entry.path.size());
+        write_value(out, entry.index);
+        write_value(out, entry.fileSize);
+        write_value(out, entry.mtime);
+        write_value(out, entry.length);
+        write_value(out, entry.slot);
+    }
+    out.close();
+    std::remove(indexPath.c_str());
+    if (!out || std::rename(tempPath.c_str(), indexPath.c_str()) != 0) {
+        LOG_WARNING << "Cannot write disk cache index " << indexPath;
+        std::remove(tempPath.c_str());
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <FuseService.h>
+
+#define DISK_CACHE_DEFAULT_CAPACITY_MB 10240
+#define DISK_CACHE_SLAB_FILE "blocks.dat"
+#define DISK_CACHE_INDEX_FILE "index.dat"
+// First word of the index file, bump when its layout changes
+#define DISK_CACHE_INDEX_MAGIC 0x54464443u
+
+/*
+ * File content cached in fixed size blocks on local disk, kept across
+ * remounts.
+ *
+ * Blocks live in slots of one slab file in dir, evicted in LRU order once
+ * every slot is taken. A block remembers the size and modification time the
+ * file had when it was fetched and only answers while the file still has
+ * them. Changes made through this mount drop the blocks of the path right
+ * away.
+ *
+ * Slots are read and written with positioned I/O on the slab outside of the
+ * lock, which only guards the index. A slot being read is pinned and is not
+ * handed out again before the copy finished, a slot being written belongs
+ * to no entry until the write completed. A put that raced with an
+ * invalidation is dropped.
+ *
+ * Which slot holds what is written to an index file on a clean shutdown and
+ * read back at the next mount. The index is deleted as soon as it has been
+ * loaded, after a crash the cache starts out empty rather than trusting
+ * slots that may have been half written.
+ */
+class disk_cache {
+public:
+    disk_cache(const std::string& dir, uint64_t capacityBytes, uint32_t blockBytes);
+    ~disk_cache();
+
+    inline uint32_t block_size() const
+    {
+        return blockSize;
+    }
+
+    /*
+     * Copy block index of path into buf, which holds block_size() bytes.
+     * length receives the bytes the block holds, less than block_size() only
+     * for the block the file ends in. False when the block is not cached or
+     * stat shows the file changed since.
+     */
+    bool get(const std::string& path, int64_t index, const Fuse::FuseStat& stat, char* buf, size_t& length);
+    void put(const std::string& path, int64_t index, const Fuse::FuseStat& stat, const char* data, size_t length);
+
+    void invalidate(const std::string& path);
+
+    inline uint64_t hits() const
+    {
+        return hitCount.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t misses() const
+    {
+        return missCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct block_entry {
+        std::string path;
+        int64_t index;
+        int64_t fileSize;
+        int32_t mtime;
+        uint32_t length;
+        uint32_t slot;
+    };
+
+    typedef std::list<block_entry>::iterator entry_ref;
+
+    bool read_slot(uint32_t slot, char* buf, size_t length);
+    bool write_slot(uint32_t slot, const char* data, size_t length);
+    void invalidate_locked(const std::string& path);
+    void drop_locked(entry_ref entry);
+    void free_slot_locked(uint32_t slot);
+    void unpin_locked(uint32_t slot);
+    void load_index();
+    void save_index();
+
+    std::string dir;
+    uint32_t blockSize;
+    uint32_t slotCount;
+    int slabFd;
+
+    boost::mutex lock;
+    // Most recently used first
+    std::list<block_entry> lru;
+    std::unordered_map<std::string, std::unordered_map<int64_t, entry_ref>> files;
+    std::vector<uint32_t> freeSlots;
+    // Reads copying out of each slot, a dropped slot is freed by the last one
+    std::vector<uint32_t> pins;
+    std::vector<bool> dropped;
+    // Bumped by every invalidation, see put
+    uint64_t invalidations = 0;
+
+    std::atomic<uint64_t> hitCount;
+    std::atomic<uint64_t> missCount;
+};
@@ -1,651 +1,1478 @@
-/*
- ***************************************************************************** 
- * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
- *
- * Copyright (c) 2022 Yogender Solanki
- *
- * This program is free software: you can redistribute it and/or modify it
- * under the terms of the GNU Lesser General Public License as published by the
- * Free Software Foundation, either version 3 of the License, or (at your
- * option) any later version.
- *
- * This program is distributed in the hope that it will be useful, but WITHOUT
- * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
- * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
- * for more details.
- *
- * You should have received a copy of the GNU Lesser General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- *****************************************************************************
- */
-#include <FuseService.h>
-
-#include <Logger.h>
-#include <fuse_native.h>
-#include <thrift_client.h>
-#include <thrift_fuse.h>
-
-#include <chrono>
-
-using namespace std::chrono;
-using namespace Fuse;
-
-struct scope_exit {
-    scope_exit(std::function<void(void)> f)
-        : f_(f)
-    {
-    }
-    ~scope_exit(void) { f_(); }
-
-private:
-    std::function<void(void)> f_;
-};
-#define WARNING_CHANNEL_THRESHOLD 100
-
-#define THRIFT_OP(func, ...)                                                               \
-    try {                                                                                  \
-        auto start = high_resolution_clock::now();                                         \
-        auto client = thrift_fuse::get_tfuse_from_context()->get_tclient();                \
-        auto duration = duration_cast<milliseconds>(high_resolution_clock::now() - start); \
-        if (duration.count() > WARNING_CHANNEL_THRESHOLD) {                                \
-            LOG_WARNING                                                                    \
-                << "High latency to get client "                                           \
-                << duration.count() << " ms";                                              \
-        }                                                                                  \
-        scope_exit relaseChannel([client](void) {                                          \
-            thrift_fuse::get_tfuse_from_context()->release_tclient(client);                \
-        });                                                                                \
-        LOG_DEBUG << "Calling host " << " => [" << client->get_client_id() << "]"; \
-        client->GetStub()->func(__VA_ARGS__);                                              \
-    } catch (std::exception & ex) {                                                        \
-        resp.status = StatusCode::FUSE_ERRECANCELED;                                       \
-        LOG_ERROR << " Operation failed due to exception " << ex.what();   \
-        thrift_client::HandleException(ex);                                                \
-    }
-
-int fuse_native::getattr(const char* path, fuse_stat* stbuf, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << " Path " << path;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(getattr, resp, std::string(path), handle, context);
-
-    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS && resp.__isset.stats) {
-        thrift_fuse::t2fFileStat(resp.stats, stbuf);
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::readlink(const char* path, char* buf, size_t size)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(readlink, resp, path, size, context);
-    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS) {
-        strncpy(buf, resp.linkPath.c_str(), size);
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::mknod(const char* path, fuse_mode_t mode, fuse_dev_t dev)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(mknod, resp, path, mode, dev, context);
-
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::mkdir(const char* path, fuse_mode_t mode)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(mkdir, resp, path, mode, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::unlink(const char* path)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(unlink, resp, path, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::rmdir(const char* path)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(rmdir, resp, path, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::symlink(const char* dstpath, const char* srcpath)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(symlink, resp, dstpath, srcpath, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << srcpath << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::rename(const char* oldpath, const char* newpath, unsigned int flags)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(rename, resp, oldpath, newpath, flags, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << oldpath << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::link(const char* srcpath, const char* dstpath)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(link, resp, srcpath, dstpath, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << srcpath << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::chown(const char* path,
-    fuse_uid_t uid,
-    fuse_gid_t gid,
-    fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(chown, resp, path, uid, gid, handle, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::chmod(const char* path, fuse_mode_t mode, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(chmod, resp, path, mode, handle, context);
-    if (resp.status == StatusCode::FUSE_SUCCESS) {
-        thrift_fuse::t2fHandle(resp.info, fi);
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::truncate(const char* path, fuse_off_t size, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(truncate, resp, path, size, handle, context);
-    if (resp.status == StatusCode::FUSE_SUCCESS) {
-        thrift_fuse::t2fHandle(resp.info, fi);
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::open(const char* path, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(open, resp, path, context);
-    if (resp.status == StatusCode::FUSE_SUCCESS) {
-        thrift_fuse::t2fHandle(resp.info, fi);
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::read(const char* path,
-    char* buf,
-    size_t size,
-    fuse_off_t off,
-    fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(read, resp, path, size, off, handle, context);
-    if (resp.status == StatusCode::FUSE_SUCCESS) {
-        if (resp.__isset.data) { 
-            memcpy(buf, resp.data.c_str(), resp.data.size());
-        } else {
-            return 0;
-        }
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-        return resp.status;
-    }
-    return resp.data.size();
-}
-
-int fuse_native::write(const char* path,
-    const char* buf,
-    size_t size,
-    fuse_off_t off,
-    fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-  //  LOG_INFO << "Write  " << path << " Offset " << off << " Size " << size;
-    
-    THRIFT_OP(write, resp, path, std::string(buf, size), off, size, handle, context);
-    
-    if (resp.status == StatusCode::FUSE_SUCCESS) {        
-    //   LOG_INFO << "Written  " << path << " Offset " << off << " Size " << size;
-       return static_cast<int>(resp.dataWritten);
-    } else {
-        LOG_ERROR << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.dataWritten;
-}
-
-int fuse_native::statfs(const char* path, fuse_statvfs* stbuf)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(statfs, resp, path, context);
-    if (resp.status == StatusCode::FUSE_SUCCESS) {
-        thrift_fuse::t2fStatFS(resp.statfs, stbuf);
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::flush(const char* path, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(flush, resp, path, handle, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::release(const char* path, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(release, resp, path == nullptr ? "" : std::string(path), handle, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::create(const char* path, fuse_mode_t mode, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(create, resp, path, mode, context);
-
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-
-
-int fuse_native::setxattr(const char* path,
-    const char* name0,
-    const char* value,
-    size_t size,
-    int flags)
-{
-
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(setxattr, resp, path, name0, value, size, flags, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::getxattr(const char* path,
-    const char* name0,
-    char* value,
-    size_t size)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(getxattr, resp, path, name0, context);
-    if (resp.status == StatusCode::FUSE_SUCCESS) {
-        strncpy(value, resp.atrributeValue.c_str(), size);
-        if (resp.atrributeValue.size() > size) {
-            return StatusCode::FUSE_ERRORENOMEM;
-        }
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-
-
-
-int fuse_native::opendir(const char* path, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(opendir, resp, path, context);
-    if (resp.status == StatusCode::FUSE_SUCCESS) {
-        thrift_fuse::t2fHandle(resp.info, fi);
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::readdir(const char* path,
-    void* buf,
-    fuse_fill_dir_t filler,
-    fuse_off_t off,
-    fuse_file_info* fi,
-    fuse_readdir_flags flag)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(readdir, resp, path, off, handle, context);
-    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS) {
-        for (auto entry : resp.dirEntry) {
-            fuse_stat statBuf;
-            thrift_fuse::t2fFileStat(entry.stats, &statBuf);
-            if (filler(buf, entry.name.c_str(), &statBuf, 0, FUSE_FILL_DIR_PLUS) != 0) {
-                break;
-            }
-        }
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::releasedir(const char* path, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(releasedir, resp, path, handle, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::utimens(const char* path,
-    const fuse_timespec tmsp[2],
-    fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseTimeSpec timeSpec;
-    timeSpec.accessTime = tmsp[0].tv_sec;
-    timeSpec.modificationTime = tmsp[0].tv_sec;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(utimens, resp, path, timeSpec, handle, context);
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::fsync(const char* path, int datasync, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(fsync, resp, path, datasync, handle, context);
-    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS) {
-        thrift_fuse::t2fHandle(handle, fi);
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::fsyncdir(const char* path, int datasync, fuse_file_info* fi)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseHandleInfo handle;
-    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(fsyncdir, resp, path, datasync, handle, context);
-    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS) {
-        thrift_fuse::t2fHandle(handle, fi);
-    } else {
-        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
-    }
-    return resp.status;
-}
-
-int fuse_native::access(const char* path, int flag)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    FileSystemResponse resp;
-
-    FuseContext context;
-    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
-
-    THRIFT_OP(access, resp, path, static_cast<FuseAccessMode::type>(flag), context);
-
-    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {        
-        LOG_DEBUG << "Failed "
-                  << " Path " << path << "Error " << resp.status;
-    }
-    return 0;
-}
-
-// Todo:: need to be implemented
-int fuse_native::removexattr(const char* path, const char* name0)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    return StatusCode::FUSE_ERROREPERM;
-}
-
-int fuse_native::listxattr(const char* path, char* namebuf, size_t size)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    // TODO:: fix it.
-    return StatusCode::FUSE_ERROREPERM;
-}
-
-int fuse_native::lock(const char* path, fuse_file_info* fi, int cmd, fuse_flock* flock)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    return 0;
-}
-
-int fuse_native::bmap(const char* path, size_t blocksize, uint64_t* idx)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    return 0;
-}
-
-
-
-void fuse_native::destroy(void* fuse)
-{
-    LOG_DEBUG << "Called " << __FUNCTION__;
-    auto fs = static_cast<thrift_fuse*>(fuse);
-
-    delete static_cast<thrift_fuse*>(fuse);
-}
-
-void* fuse_native::init(fuse_conn_info* conn, fuse_config* conf)
-{        
-    conn->want |= (conn->capable & FUSE_CAP_READDIRPLUS);
-    return thrift_fuse::get_tfuse_from_context();
-}
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <FuseService.h>
+
+#include <Logger.h>
+#include <fuse_native.h>
+#include <path_util.h>
+#include <thrift_client.h>
+#include <thrift_fuse.h>
+#include <thrift_op.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+
+#ifndef O_ACCMODE
+#define O_ACCMODE (O_RDONLY | O_WRONLY | O_RDWR)
+#endif
+
+using namespace std::chrono;
+using namespace Fuse;
+
+static inline attr_cache* context_attr_cache()
+{
+    return thrift_fuse::get_tfuse_from_context()->get_attr_cache();
+}
+
+static inline op_stats* context_op_stats()
+{
+    return thrift_fuse::get_tfuse_from_context()->get_op_stats();
+}
+
+static inline neg_cache* context_neg_cache()
+{
+    return thrift_fuse::get_tfuse_from_context()->get_neg_cache();
+}
+
+// Write out buffered data of path before something needs to observe it
+static inline void flush_write_back(const char* path)
+{
+    auto writeBack = thrift_fuse::get_tfuse_from_context()->get_write_back();
+    if (writeBack != nullptr && path != nullptr) {
+        writeBack->flush_path(path);
+    }
+}
+
+// O_SYNC, O_DSYNC and O_DIRECT writers expect the data on the backend once
+// write returns, so their writes skip the write-back buffer
+static inline bool writes_through(const fuse_file_info* fi)
+{
+    int flags = 0;
+#ifdef O_SYNC
+    flags |= O_SYNC;
+#endif
+#ifdef O_DSYNC
+    flags |= O_DSYNC;
+#endif
+#ifdef O_DIRECT
+    flags |= O_DIRECT;
+#endif
+    return fi->direct_io || (fi->flags & flags) != 0;
+}
+
+// Data of path changed, drop what was prefetched, inlined or cached for it
+static inline void invalidate_file_data(const char* path)
+{
+    auto fs = thrift_fuse::get_tfuse_from_context();
+    if (fs->get_read_ahead() != nullptr) {
+        fs->get_read_ahead()->invalidate(path);
+    }
+    if (fs->get_inline_table() != nullptr) {
+        fs->get_inline_table()->invalidate(path);
+    }
+    if (fs->get_page_cache() != nullptr) {
+        fs->get_page_cache()->invalidate(path);
+    }
+    if (fs->get_disk_cache() != nullptr) {
+        fs->get_disk_cache()->invalidate(path);
+    }
+}
+
+// Keep the content an open or create reply carried for the new handle, or
+// the content held already when the reply says it is still current
+static inline void keep_inline_data(const char* path, fuse_file_info* fi, FileSystemResponse& resp)
+{
+    auto inlineTable = thrift_fuse::get_tfuse_from_context()->get_inline_table();
+    if (inlineTable == nullptr) {
+        return;
+    }
+    int64_t version = resp.__isset.version ? resp.version : INLINE_NO_VERSION;
+    if (resp.__isset.data && resp.__isset.stats && resp.stats.__isset.size) {
+        inlineTable->put(fi->fh, path, resp.data, resp.stats.size, version);
+    } else {
+        inlineTable->reuse(fi->fh, path, version);
+    }
+}
+
+// False only when the attribute cache knows path is no directory
+static inline bool may_be_directory(const char* path)
+{
+    FuseStat stats;
+    return !context_attr_cache()->peek(path, stats) || (stats.mode & S_IFMT) == S_IFDIR;
+}
+
+static inline bool is_stats_file(const char* path)
+{
+    return path != nullptr && strcmp(path, OP_STATS_FILE) == 0;
+}
+
+// Attributes of the virtual stats directory and file, false for other paths
+static bool stats_attr(const char* path, fuse_stat* stbuf)
+{
+    bool isDir = strcmp(path, OP_STATS_DIR) == 0;
+    if (!isDir && !is_stats_file(path)) {
+        return false;
+    }
+    memset(stbuf, 0, sizeof(*stbuf));
+    if (isDir) {
+        stbuf->st_mode = S_IFDIR | 0555;
+        stbuf->st_nlink = 2;
+    } else {
+        stbuf->st_mode = S_IFREG | 0444;
+        stbuf->st_nlink = 1;
+        stbuf->st_size = context_op_stats()->render().size();
+    }
+    stbuf->st_uid = fuse_get_context()->uid;
+    stbuf->st_gid = fuse_get_context()->gid;
+    stbuf->st_mtim.tv_sec = duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+    stbuf->st_ctim = stbuf->st_mtim;
+    stbuf->st_atim = stbuf->st_mtim;
+    return true;
+}
+
+int fuse_native::getattr(const char* path, fuse_stat* stbuf, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::GETATTR);
+    LOG_DEBUG << "Called " << " Path " << path;
+    FileSystemResponse resp;
+
+    if (stats_attr(path, stbuf)) {
+        return StatusCode::FUSE_SUCCESS;
+    }
+
+    flush_write_back(path);
+
+    // Served from the cache without touching the client pool
+    auto cache = context_attr_cache();
+    FuseStat cached;
+    if (cache->get(path, cached)) {
+        thrift_fuse::t2fFileStat(cached, stbuf);
+        return StatusCode::FUSE_SUCCESS;
+    }
+    auto negCache = context_neg_cache();
+    if (negCache->contains(path)) {
+        return StatusCode::FUSE_ERRORENOENT;
+    }
+    uint64_t cacheToken = cache->fill_token(path);
+    uint64_t negToken = negCache->fill_token(path);
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    BatchRequest request;
+    request.op = BatchOp::GETATTR;
+    request.path = path;
+    request.__set_handleInfo(handle);
+    request.__set_context(context);
+    auto fs = thrift_fuse::get_tfuse_from_context();
+    fs->get_batcher()->run(fs->route(path), request, resp);
+
+    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS && resp.__isset.stats) {
+        cache->put(path, resp.stats, cacheToken);
+        thrift_fuse::t2fFileStat(resp.stats, stbuf);
+    } else {
+        if (resp.status == StatusCode::FUSE_ERRORENOENT) {
+            negCache->put(path, negToken);
+        }
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::readlink(const char* path, char* buf, size_t size)
+{
+    op_timer timer(context_op_stats(), FuseOp::READLINK);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_READ_OP(readlink, resp, path, size, context);
+    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS) {
+        strncpy(buf, resp.linkPath.c_str(), size);
+    } else {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::mknod(const char* path, fuse_mode_t mode, fuse_dev_t dev)
+{
+    op_timer timer(context_op_stats(), FuseOp::MKNOD);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_OP(mknod, resp, path, mode, dev, context);
+    context_neg_cache()->invalidate(path);
+    context_attr_cache()->invalidate(path);
+    context_attr_cache()->invalidate(parent_path(path));
+
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::mkdir(const char* path, fuse_mode_t mode)
+{
+    op_timer timer(context_op_stats(), FuseOp::MKDIR);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    uint64_t cacheToken = context_attr_cache()->fill_token(path);
+    THRIFT_OP(mkdir, resp, path, mode, context);
+    context_neg_cache()->invalidate(path);
+    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS && resp.__isset.stats) {
+        context_attr_cache()->put(path, resp.stats, cacheToken);
+    } else {
+        context_attr_cache()->invalidate(path);
+    }
+    context_attr_cache()->invalidate(parent_path(path));
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::unlink(const char* path)
+{
+    op_timer timer(context_op_stats(), FuseOp::UNLINK);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    flush_write_back(path);
+    BatchRequest request;
+    request.op = BatchOp::UNLINK;
+    request.path = path;
+    request.__set_context(context);
+    auto fs = thrift_fuse::get_tfuse_from_context();
+    fs->get_batcher()->run(fs->route(path), request, resp);
+    context_attr_cache()->invalidate(path);
+    context_attr_cache()->invalidate(parent_path(path));
+    invalidate_file_data(path);
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::rmdir(const char* path)
+{
+    op_timer timer(context_op_stats(), FuseOp::RMDIR);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    BatchRequest request;
+    request.op = BatchOp::RMDIR;
+    request.path = path;
+    request.__set_context(context);
+    auto fs = thrift_fuse::get_tfuse_from_context();
+    fs->get_batcher()->run(fs->route(path), request, resp);
+    // Only an empty directory is removed, nothing below it is cached
+    context_attr_cache()->invalidate(path);
+    context_attr_cache()->invalidate(parent_path(path));
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::symlink(const char* dstpath, const char* srcpath)
+{
+    op_timer timer(context_op_stats(), FuseOp::SYMLINK);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    // The link is created at srcpath, route by that rather than by its target
+    THRIFT_PATH_CALL(thrift_fuse::get_tfuse_from_context(), srcpath, client->GetStub()->symlink(resp, dstpath, srcpath, context));
+    // Names below a link to a directory resolve now
+    context_neg_cache()->invalidate_tree(srcpath);
+    context_attr_cache()->invalidate(srcpath);
+    context_attr_cache()->invalidate(parent_path(srcpath));
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << srcpath << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::rename(const char* oldpath, const char* newpath, unsigned int flags)
+{
+    op_timer timer(context_op_stats(), FuseOp::RENAME);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    auto fs = thrift_fuse::get_tfuse_from_context();
+    if (fs->route(oldpath) != fs->route(newpath)) {
+        // Different backends, let the caller fall back to copy and delete
+        return Fuse::StatusCode::FUSE_ERROREXDEV;
+    }
+
+    // Entries below a path only need the full scan when it is a directory.
+    // A directory renamed over newpath is empty, it only has children
+    // afterwards when the two are exchanged.
+    bool oldTree = may_be_directory(oldpath);
+    bool newTree = (flags & RENAME_EXCHANGE) != 0 && may_be_directory(newpath);
+
+    flush_write_back(oldpath);
+    THRIFT_OP(rename, resp, oldpath, newpath, flags, context);
+    invalidate_file_data(oldpath);
+    invalidate_file_data(newpath);
+    context_neg_cache()->invalidate_tree(newpath);
+    if (oldTree) {
+        context_attr_cache()->invalidate_tree(oldpath);
+    } else {
+        context_attr_cache()->invalidate(oldpath);
+    }
+    if (newTree) {
+        context_attr_cache()->invalidate_tree(newpath);
+    } else {
+        context_attr_cache()->invalidate(newpath);
+    }
+    context_attr_cache()->invalidate(parent_path(oldpath));
+    context_attr_cache()->invalidate(parent_path(newpath));
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << oldpath << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::link(const char* srcpath, const char* dstpath)
+{
+    op_timer timer(context_op_stats(), FuseOp::LINK);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    auto fs = thrift_fuse::get_tfuse_from_context();
+    if (fs->route(srcpath) != fs->route(dstpath)) {
+        return Fuse::StatusCode::FUSE_ERROREXDEV;
+    }
+
+    THRIFT_OP(link, resp, srcpath, dstpath, context);
+    context_neg_cache()->invalidate(dstpath);
+    // nlink of the source changes as well
+    context_attr_cache()->invalidate(srcpath);
+    context_attr_cache()->invalidate(dstpath);
+    context_attr_cache()->invalidate(parent_path(dstpath));
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << srcpath << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::chown(const char* path,
+    fuse_uid_t uid,
+    fuse_gid_t gid,
+    fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::CHOWN);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_OP(chown, resp, path, uid, gid, handle, context);
+    context_attr_cache()->invalidate(path);
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::chmod(const char* path, fuse_mode_t mode, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::CHMOD);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_OP(chmod, resp, path, mode, handle, context);
+    context_attr_cache()->invalidate(path);
+    if (resp.status == StatusCode::FUSE_SUCCESS) {
+        thrift_fuse::t2fHandle(resp.info, fi);
+    } else {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::truncate(const char* path, fuse_off_t size, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::TRUNCATE);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    flush_write_back(path);
+    THRIFT_OP(truncate, resp, path, size, handle, context);
+    context_attr_cache()->invalidate(path);
+    invalidate_file_data(path);
+    if (resp.status == StatusCode::FUSE_SUCCESS) {
+        thrift_fuse::t2fHandle(resp.info, fi);
+    } else {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::open(const char* path, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::OPEN);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    // Each open of the stats file reads its own snapshot, without page cache
+    if (is_stats_file(path)) {
+        if ((fi->flags & O_ACCMODE) != O_RDONLY) {
+            return StatusCode::FUSE_ERROREACCES;
+        }
+        fi->fh = context_op_stats()->open_snapshot();
+        fi->direct_io = 1;
+        return StatusCode::FUSE_SUCCESS;
+    }
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    auto inlineTable = thrift_fuse::get_tfuse_from_context()->get_inline_table();
+    int32_t inlineLimit = inlineTable != nullptr ? static_cast<int32_t>(inlineTable->limit()) : 0;
+    int64_t knownVersion = inlineLimit > 0 ? inlineTable->known_version(path) : INLINE_NO_VERSION;
+    THRIFT_OP(open, resp, path, context, inlineLimit, knownVersion);
+    if (resp.status == StatusCode::FUSE_SUCCESS) {
+        thrift_fuse::t2fHandle(resp.info, fi);
+        keep_inline_data(path, fi, resp);
+    } else {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+/*
+ * Read RPC on a client that was taken from the pool up front, used by
+ * read-ahead windows running on the worker pool.
+ */
+static read_chunk_ptr fetch_read_chunk(client_pool* pool,
+    ThriftClientPtr client,
+    const std::string& path,
+    int64_t off,
+    uint32_t size,
+    FuseHandleInfo handle,
+    FuseContext context)
+{
+    auto chunk = std::make_shared<read_chunk>();
+    scope_exit relaseChannel([client, pool](void) {
+        pool->release(client);
+    });
+    try {
+        FileSystemResponse resp;
+        auto start = std::chrono::steady_clock::now();
+        client->GetStub()->read(resp, path, size, off, handle, context);
+        pool->record_latency(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        chunk->status = resp.status;
+        chunk->data.swap(resp.data);
+        pool->record_read(chunk->data.size());
+    } catch (std::exception& ex) {
+        if (thrift_client::breaks_connection(ex)) {
+            client->mark_broken();
+        }
+        pool->record_failure();
+        chunk->status = StatusCode::FUSE_ERRECANCELED;
+        LOG_ERROR << " Read-ahead failed due to exception " << ex.what();
+        thrift_client::HandleException(ex);
+    }
+    return chunk;
+}
+
+/*
+ * Put read-ahead windows in flight, but only on clients that are idle so
+ * foreground requests never queue behind a prefetch.
+ */
+static void issue_read_ahead(thrift_fuse* fs,
+    read_stream_ptr stream,
+    const std::string& path,
+    FuseHandleInfo handle,
+    FuseContext context)
+{
+    int64_t off;
+    uint32_t size;
+    size_t shard = fs->route(path);
+    while (stream->plan(off, size)) {
+        FuseHandleInfo windowHandle = handle;
+        auto pool = fs->get_read_pool(shard, windowHandle);
+        ThriftClientPtr client;
+        if (!pool->try_acquire(client)) {
+            return;
+        }
+
+        auto promise = std::make_shared<std::promise<read_chunk_ptr>>();
+        if (!stream->add_window(off, size, promise->get_future().share())) {
+            pool->release(client);
+            return;
+        }
+        fs->get_workers()->submit([pool, client, path, off, size, windowHandle, context, promise]() {
+            promise->set_value(fetch_read_chunk(pool, client, path, off, size, windowHandle, context));
+        });
+    }
+}
+
+/*
+ * Attributes of path to validate cached content against, from the attribute
+ * cache when it has them.
+ */
+static bool current_stat(thrift_fuse* fs, const char* path, const FuseHandleInfo& handle, const FuseContext& context, FuseStat& stat)
+{
+    auto cache = fs->get_attr_cache();
+    if (cache->get(path, stat)) {
+        return true;
+    }
+
+    uint64_t cacheToken = cache->fill_token(path);
+    FileSystemResponse resp;
+    BatchRequest request;
+    request.op = BatchOp::GETATTR;
+    request.path = path;
+    request.__set_handleInfo(handle);
+    request.__set_context(context);
+    fs->get_batcher()->run(fs->route(path), request, resp);
+    if (resp.status != StatusCode::FUSE_SUCCESS || !resp.__isset.stats) {
+        return false;
+    }
+    cache->put(path, resp.stats, cacheToken);
+    stat = resp.stats;
+    return true;
+}
+
+/*
+ * Block of path from the memory tier, else from the disk tier which then
+ * also fills the memory tier. Null when neither holds it.
+ */
+static cached_page_ptr lookup_cached_block(thrift_fuse* fs, const char* path, int64_t index, const FuseStat& stat)
+{
+    auto pageCache = fs->get_page_cache();
+    if (pageCache != nullptr) {
+        auto page = pageCache->get(path, index, stat);
+        if (page != nullptr) {
+            return page;
+        }
+    }
+
+    auto diskCache = fs->get_disk_cache();
+    if (diskCache == nullptr) {
+        return nullptr;
+    }
+    auto page = std::make_shared<cached_page>();
+    page->fileSize = stat.size;
+    page->mtime = stat.modificationTime;
+    page->data.resize(fs->get_cache_block_size());
+    size_t length = 0;
+    if (!diskCache->get(path, index, stat, &page->data[0], length)) {
+        return nullptr;
+    }
+    page->data.resize(length);
+    if (pageCache != nullptr) {
+        pageCache->put(path, index, page);
+    }
+    return page;
+}
+
+/*
+ * Copy the blocks covering [off, off + size) from the cache tiers into buf
+ * up to the first block neither tier holds. Returns the bytes copied, eof is
+ * set when the file ends inside them.
+ */
+static size_t serve_cached_blocks(thrift_fuse* fs,
+    const char* path,
+    char* buf,
+    size_t size,
+    int64_t off,
+    const FuseStat& stat,
+    bool& eof)
+{
+    size_t blockSize = fs->get_cache_block_size();
+    size_t done = 0;
+    eof = false;
+    while (done < size) {
+        int64_t pos = off + static_cast<int64_t>(done);
+        int64_t index = pos / blockSize;
+        auto page = lookup_cached_block(fs, path, index, stat);
+        if (page == nullptr) {
+            break;
+        }
+
+        size_t inBlock = static_cast<size_t>(pos - index * blockSize);
+        if (page->data.size() <= inBlock) {
+            eof = true;
+            break;
+        }
+        size_t count = std::min(size - done, page->data.size() - inBlock);
+        memcpy(buf + done, page->data.data() + inBlock, count);
+        done += count;
+        if (page->data.size() < blockSize && inBlock + count == page->data.size()) {
+            eof = true;
+            break;
+        }
+    }
+    return done;
+}
+
+/*
+ * Keep the blocks of data, fetched from block first on, in every cache
+ * tier. A block that was not fetched whole is only kept when the file ends
+ * in it.
+ */
+static void keep_cached_blocks(thrift_fuse* fs,
+    const char* path,
+    int64_t first,
+    const char* data,
+    size_t length,
+    bool eof,
+    const FuseStat& stat)
+{
+    auto pageCache = fs->get_page_cache();
+    auto diskCache = fs->get_disk_cache();
+    size_t blockSize = fs->get_cache_block_size();
+    for (size_t start = 0; start < length; start += blockSize) {
+        size_t count = std::min(blockSize, length - start);
+        if (count < blockSize && !eof) {
+            break;
+        }
+        int64_t index = first + static_cast<int64_t>(start / blockSize);
+        if (diskCache != nullptr) {
+            diskCache->put(path, index, stat, data + start, count);
+        }
+        if (pageCache != nullptr) {
+            auto page = std::make_shared<cached_page>();
+            page->fileSize = stat.size;
+            page->mtime = stat.modificationTime;
+            page->data.assign(data + start, count);
+            pageCache->put(path, index, page);
+        }
+    }
+}
+
+/*
+ * Fill buf with [off, off + size) of path, from the read-ahead windows of
+ * stream first and with one read decoded straight into buf for the rest.
+ * Returns the bytes read, eof is set on a short read and status when the
+ * host failed it.
+ */
+static size_t fetch_range(thrift_fuse* fs,
+    const read_stream_ptr& stream,
+    const char* path,
+    char* buf,
+    size_t size,
+    int64_t off,
+    const FuseHandleInfo& handle,
+    const FuseContext& context,
+    bool& eof,
+    int& status)
+{
+    size_t done = 0;
+    eof = false;
+    if (stream != nullptr) {
+        done = stream->serve(off, buf, size, eof);
+    }
+    if (done == size || eof) {
+        return done;
+    }
+
+    FileSystemResponse resp;
+    size_t bytesRead = 0;
+    FuseHandleInfo readHandle = handle;
+    auto pool = fs->get_read_pool(fs->route(path), readHandle);
+    THRIFT_POOL_CALL(pool,
+        client->read_into(resp, path, static_cast<int32_t>(size - done), off + done, readHandle, context, buf + done, bytesRead));
+    if (resp.status != StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+        status = resp.status;
+        return done;
+    }
+    pool->record_read(bytesRead);
+    done += bytesRead;
+    eof = done < size;
+    return done;
+}
+
+int fuse_native::read(const char* path,
+    char* buf,
+    size_t size,
+    fuse_off_t off,
+    fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::READ);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    auto fs = thrift_fuse::get_tfuse_from_context();
+
+    if (is_stats_file(path) && fi != nullptr) {
+        return static_cast<int>(fs->get_op_stats()->read_snapshot(fi->fh, off, buf, size));
+    }
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    flush_write_back(path);
+
+    // Small files are served from what open returned
+    size_t inlineRead = 0;
+    if (fi != nullptr && fs->get_inline_table() != nullptr
+        && fs->get_inline_table()->serve(fi->fh, path, off, buf, size, inlineRead)) {
+        timer.moved(inlineRead);
+        return static_cast<int>(inlineRead);
+    }
+
+    read_stream_ptr stream;
+    if (fi != nullptr && fs->get_read_ahead() != nullptr && fs->get_workers()->enabled()) {
+        stream = fs->get_read_ahead()->get(fi->fh, path);
+    }
+
+    // Content caches validate their blocks against the current attributes,
+    // without them the read goes to the host uncached
+    FuseStat stat;
+    bool cached = (fs->get_page_cache() != nullptr || fs->get_disk_cache() != nullptr)
+        && current_stat(fs, path, handle, context, stat);
+
+    size_t done = 0;
+    bool eof = false;
+    if (cached) {
+        done = serve_cached_blocks(fs, path, buf, size, off, stat, eof);
+    }
+
+    bool missed = done < size && !eof;
+    int status = StatusCode::FUSE_SUCCESS;
+    if (missed && cached) {
+        // Whole blocks from the first missing one on, so the tiers can keep them
+        size_t blockSize = fs->get_cache_block_size();
+        int64_t pos = off + static_cast<int64_t>(done);
+        int64_t first = pos / blockSize;
+        int64_t last = (off + static_cast<int64_t>(size) - 1) / blockSize;
+        size_t spanSize = static_cast<size_t>(last - first + 1) * blockSize;
+        std::unique_ptr<char[]> span(new char[spanSize]);
+        bool spanEof = false;
+        size_t fetched = fetch_range(fs, stream, path, span.get(), spanSize, first * blockSize, handle, context, spanEof, status);
+        keep_cached_blocks(fs, path, first, span.get(), fetched, spanEof, stat);
+
+        size_t skip = static_cast<size_t>(pos - first * blockSize);
+        size_t count = fetched > skip ? std::min(size - done, fetched - skip) : 0;
+        memcpy(buf + done, span.get() + skip, count);
+        done += count;
+        eof = status == StatusCode::FUSE_SUCCESS && done < size;
+    } else if (missed) {
+        done += fetch_range(fs, stream, path, buf + done, size - done, off + done, handle, context, eof, status);
+    }
+    if (done == 0 && status != StatusCode::FUSE_SUCCESS) {
+        return status;
+    }
+
+    if (stream != nullptr) {
+        stream->record(off, done, eof);
+        // Reads the caches answered need nothing from the host ahead of them
+        if (missed) {
+            issue_read_ahead(fs, stream, path, handle, context);
+        }
+    }
+    timer.moved(done);
+    return static_cast<int>(done);
+}
+
+/*
+ * Send a write whose payload is scattered over segments, without gathering
+ * it into one buffer first.
+ */
+static int write_segments(const char* path,
+    const write_segment* segments,
+    size_t count,
+    fuse_off_t off,
+    fuse_file_info* fi,
+    op_timer& timer)
+{
+    FileSystemResponse resp;
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    auto fs = thrift_fuse::get_tfuse_from_context();
+    auto pool = fs->get_client_pool(fs->route(path));
+    THRIFT_POOL_CALL(pool, client->write_from(resp, path, segments, count, off, handle, context));
+    context_attr_cache()->invalidate(path);
+    invalidate_file_data(path);
+
+    if (resp.status == StatusCode::FUSE_SUCCESS) {
+        pool->record_written(resp.dataWritten);
+        timer.moved(resp.dataWritten);
+        return static_cast<int>(resp.dataWritten);
+    } else {
+        LOG_ERROR << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+/*
+ * Buffer a write for write-back or send it right away. Either way the
+ * segments are copied once, into the extents or onto the wire.
+ */
+static int write_data(const char* path,
+    const write_segment* segments,
+    size_t count,
+    fuse_off_t off,
+    fuse_file_info* fi,
+    op_timer& timer)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++) {
+        size += segments[i].size;
+    }
+
+    auto writeBack = thrift_fuse::get_tfuse_from_context()->get_write_back();
+    if (writeBack != nullptr && fi != nullptr && writes_through(fi)) {
+        // Buffered data of the range must not land on top of this write later
+        writeBack->flush_range(path, off, size);
+    } else if (writeBack != nullptr && fi != nullptr) {
+        FuseHandleInfo handle;
+        thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+        FuseContext context;
+        thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+        writeBack->write(fi->fh, path, segments, count, off, handle, context);
+        context_attr_cache()->invalidate(path);
+        invalidate_file_data(path);
+        timer.moved(size);
+        return static_cast<int>(size);
+    }
+
+    return write_segments(path, segments, count, off, fi, timer);
+}
+
+int fuse_native::write(const char* path,
+    const char* buf,
+    size_t size,
+    fuse_off_t off,
+    fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::WRITE);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+  //  LOG_INFO << "Write  " << path << " Offset " << off << " Size " << size;
+
+    write_segment segment = { buf, size };
+    return write_data(path, &segment, 1, off, fi, timer);
+}
+
+int fuse_native::write_buf(const char* path,
+    fuse_bufvec* buf,
+    fuse_off_t off,
+    fuse_file_info* fi)
+{
+    LOG_DEBUG << "Called " << __FUNCTION__;
+
+    bool inMemory = true;
+    for (size_t i = buf->idx; i < buf->count; i++) {
+        if (buf->buf[i].flags & FUSE_BUF_IS_FD) {
+            inMemory = false;
+        }
+    }
+
+    // fd backed buffers have to be read in first
+    if (!inMemory) {
+        size_t size = fuse_buf_size(buf);
+        std::vector<char> flat(size);
+        fuse_bufvec dst;
+        memset(&dst, 0, sizeof(dst));
+        dst.count = 1;
+        dst.buf[0].size = size;
+        dst.buf[0].mem = flat.data();
+        dst.buf[0].fd = -1;
+        ssize_t copied = fuse_buf_copy(&dst, buf, static_cast<fuse_buf_copy_flags>(0));
+        if (copied < 0) {
+            return static_cast<int>(copied);
+        }
+        return write(path, flat.data(), static_cast<size_t>(copied), off, fi);
+    }
+
+    // Timed here, the flat path is timed by write
+    op_timer timer(context_op_stats(), FuseOp::WRITE);
+    std::vector<write_segment> segments;
+    segments.reserve(buf->count - buf->idx);
+    for (size_t i = buf->idx; i < buf->count; i++) {
+        size_t skip = i == buf->idx ? buf->off : 0;
+        if (buf->buf[i].size > skip) {
+            segments.push_back({ static_cast<const char*>(buf->buf[i].mem) + skip, buf->buf[i].size - skip });
+        }
+    }
+    return write_data(path, segments.data(), segments.size(), off, fi, timer);
+}
+
+int fuse_native::statfs(const char* path, fuse_statvfs* stbuf)
+{
+    op_timer timer(context_op_stats(), FuseOp::STATFS);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_OP(statfs, resp, path, context);
+    if (resp.status == StatusCode::FUSE_SUCCESS) {
+        thrift_fuse::t2fStatFS(resp.statfs, stbuf);
+    } else {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::flush(const char* path, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::FLUSH);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    auto writeBack = thrift_fuse::get_tfuse_from_context()->get_write_back();
+    if (writeBack != nullptr && fi != nullptr) {
+        int error = writeBack->flush(fi->fh, path);
+        if (error != StatusCode::FUSE_SUCCESS) {
+            return error;
+        }
+    }
+
+    THRIFT_OP(flush, resp, path, handle, context);
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::release(const char* path, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::RELEASE);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    if (is_stats_file(path) && fi != nullptr) {
+        context_op_stats()->release_snapshot(fi->fh);
+        return StatusCode::FUSE_SUCCESS;
+    }
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    auto fs = thrift_fuse::get_tfuse_from_context();
+    if (fi != nullptr && fs->get_read_ahead() != nullptr) {
+        fs->get_read_ahead()->remove(fi->fh);
+    }
+    if (fi != nullptr && fs->get_inline_table() != nullptr) {
+        fs->get_inline_table()->remove(fi->fh);
+    }
+
+    // A read-only handle has nothing left to report, its release is not waited for
+    std::string releasePath = path == nullptr ? "" : path;
+    if (fi != nullptr && (fi->flags & O_ACCMODE) == O_RDONLY
+        && fs->get_workers()->submit([fs, releasePath, handle, context]() {
+               FileSystemResponse resp;
+               THRIFT_FS_OP(fs, release, resp, releasePath, handle, context);
+               if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+                   LOG_DEBUG << "Failed " << " Path " << releasePath << "Error " << resp.status;
+               }
+           })) {
+        return StatusCode::FUSE_SUCCESS;
+    }
+
+    // Deferred write errors surface here even though the handle goes away
+    int writeError = StatusCode::FUSE_SUCCESS;
+    auto writeBack = fs->get_write_back();
+    if (writeBack != nullptr && fi != nullptr) {
+        writeError = writeBack->release(fi->fh, releasePath);
+    }
+
+    THRIFT_OP(release, resp, releasePath, handle, context);
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return writeError != StatusCode::FUSE_SUCCESS ? writeError : resp.status;
+}
+
+int fuse_native::create(const char* path, fuse_mode_t mode, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::CREATE);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    uint64_t cacheToken = context_attr_cache()->fill_token(path);
+    auto inlineTable = thrift_fuse::get_tfuse_from_context()->get_inline_table();
+    int32_t inlineLimit = inlineTable != nullptr ? static_cast<int32_t>(inlineTable->limit()) : 0;
+    THRIFT_OP(create, resp, path, mode, context, inlineLimit);
+    context_neg_cache()->invalidate(path);
+    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS && resp.__isset.info) {
+        thrift_fuse::t2fHandle(resp.info, fi);
+        keep_inline_data(path, fi, resp);
+    }
+    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS && resp.__isset.stats) {
+        context_attr_cache()->put(path, resp.stats, cacheToken);
+    } else {
+        context_attr_cache()->invalidate(path);
+    }
+    context_attr_cache()->invalidate(parent_path(path));
+
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+
+
+int fuse_native::setxattr(const char* path,
+    const char* name0,
+    const char* value,
+    size_t size,
+    int flags)
+{
+    op_timer timer(context_op_stats(), FuseOp::SETXATTR);
+
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_OP(setxattr, resp, path, name0, value, size, flags, context);
+    context_attr_cache()->invalidate(path);
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::getxattr(const char* path,
+    const char* name0,
+    char* value,
+    size_t size)
+{
+    op_timer timer(context_op_stats(), FuseOp::GETXATTR);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_READ_OP(getxattr, resp, path, name0, context);
+    if (resp.status == StatusCode::FUSE_SUCCESS) {
+        strncpy(value, resp.atrributeValue.c_str(), size);
+        if (resp.atrributeValue.size() > size) {
+            return StatusCode::FUSE_ERRORENOMEM;
+        }
+    } else {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+
+
+
+int fuse_native::opendir(const char* path, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::OPENDIR);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_OP(opendir, resp, path, context);
+    if (resp.status == StatusCode::FUSE_SUCCESS) {
+        thrift_fuse::t2fHandle(resp.info, fi);
+    } else {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+/*
+ * Fetch one page of a listing and seed the caches from it. Runs on FUSE
+ * threads as well as on the worker pool, so everything comes in explicitly.
+ */
+static dir_page_ptr fetch_dir_page(thrift_fuse* fs,
+    const std::string& path,
+    int64_t offset,
+    FuseHandleInfo handle,
+    FuseContext context)
+{
+    auto page = std::make_shared<dir_page>();
+    page->offset = offset;
+
+    auto cache = fs->get_attr_cache();
+    auto negCache = fs->get_neg_cache();
+    auto cacheSnapshot = cache->fill_snapshot();
+
+    // A listing spread over all shards walks them in turn, the shard being
+    // read is kept in the top bits of the offsets
+    auto router = fs->get_router();
+    bool merged = router->merges_listing(path);
+    size_t shard = merged ? shard_router::listing_shard(offset) : fs->route(path);
+    int64_t shardOffset = merged ? shard_router::listing_offset(offset) : offset;
+    if (merged && shard != 0) {
+        // The open handle belongs to shard 0
+        handle.__set_fh(-1);
+    }
+
+    FileSystemResponse resp;
+    THRIFT_POOL_CALL(fs->get_read_pool(shard, handle),
+        client->GetStub()->readdir(resp, path, shardOffset, handle, context, fs->get_readdir_page_size()));
+    page->status = resp.status;
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+        return page;
+    }
+
+    if (merged) {
+        std::vector<FuseDirEntry> entries;
+        for (auto& entry : resp.dirEntry) {
+            if (shard != 0 && (entry.name == "." || entry.name == "..")) {
+                continue;
+            }
+            if (entry.__isset.offset) {
+                entry.offset = shard_router::listing_cookie(shard, entry.offset);
+            }
+            entries.push_back(std::move(entry));
+        }
+        resp.dirEntry.swap(entries);
+        if (resp.__isset.nextOffset) {
+            resp.nextOffset = shard_router::listing_cookie(shard, resp.nextOffset);
+        } else if (shard + 1 < router->count()) {
+            resp.__set_nextOffset(shard_router::listing_cookie(shard + 1, 0));
+        }
+    }
+
+    // Seed the caches so the getattr calls that follow ls -l or find stay local
+    for (auto& entry : resp.dirEntry) {
+        if (entry.name == "." || entry.name == "..") {
+            continue;
+        }
+        auto entryPath = join_path(path, entry.name);
+        negCache->forget(entryPath);
+        if (entry.__isset.stats && entry.stats.__isset.mode) {
+            cache->put(entryPath, entry.stats, cacheSnapshot);
+        }
+    }
+    page->entries.swap(resp.dirEntry);
+    page->more = resp.__isset.nextOffset;
+    page->nextOffset = resp.nextOffset;
+    return page;
+}
+
+int fuse_native::readdir(const char* path,
+    void* buf,
+    fuse_fill_dir_t filler,
+    fuse_off_t off,
+    fuse_file_info* fi,
+    fuse_readdir_flags flag)
+{
+    op_timer timer(context_op_stats(), FuseOp::READDIR);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    auto fs = thrift_fuse::get_tfuse_from_context();
+    std::string dirPath(path);
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    dir_stream_ptr stream;
+    if (fi != nullptr) {
+        stream = fs->get_dir_streams()->get(fi->fh, dirPath);
+    }
+
+    int64_t cookie = off;
+    while (true) {
+        size_t start = 0;
+        dir_page_ptr page;
+        // Offset 0 is a fresh listing (rewinddir), never served from an old page
+        if (stream != nullptr && cookie != 0) {
+            page = stream->lookup(cookie, start);
+        }
+        if (page == nullptr) {
+            page = fetch_dir_page(fs, dirPath, cookie, handle, context);
+            if (stream != nullptr) {
+                stream->set_current(page);
+            }
+        }
+        if (page->status != Fuse::StatusCode::FUSE_SUCCESS) {
+            return page->status;
+        }
+
+        // Keep the host busy with the next page while this one is copied out
+        if (page->more && stream != nullptr && fs->readdir_prefetch()) {
+            int64_t next = page->nextOffset;
+            stream->prefetch(next, [fs, dirPath, next, handle, context]() {
+                return fetch_dir_page(fs, dirPath, next, handle, context);
+            },
+                *fs->get_workers());
+        }
+
+        for (size_t i = start; i < page->entries.size(); i++) {
+            auto& entry = page->entries[i];
+            fuse_stat statBuf;
+            memset(&statBuf, 0, sizeof(statBuf));
+            thrift_fuse::t2fFileStat(entry.stats, &statBuf);
+            // Only a complete stat may prime the kernel entry and attribute caches
+            bool plus = (flag & FUSE_READDIR_PLUS) && entry.__isset.stats && entry.stats.__isset.mode;
+            fuse_off_t entryOffset = entry.__isset.offset ? entry.offset : 0;
+            if (filler(buf, entry.name.c_str(), &statBuf, entryOffset, plus ? FUSE_FILL_DIR_PLUS : static_cast<fuse_fill_dir_flags>(0)) != 0) {
+                return Fuse::StatusCode::FUSE_SUCCESS;
+            }
+        }
+
+        if (!page->more || page->nextOffset == cookie) {
+            return Fuse::StatusCode::FUSE_SUCCESS;
+        }
+        cookie = page->nextOffset;
+    }
+}
+
+int fuse_native::releasedir(const char* path, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::RELEASEDIR);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    if (fi != nullptr) {
+        thrift_fuse::get_tfuse_from_context()->get_dir_streams()->remove(fi->fh);
+    }
+
+    THRIFT_OP(releasedir, resp, path, handle, context);
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::utimens(const char* path,
+    const fuse_timespec tmsp[2],
+    fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::UTIMENS);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseTimeSpec timeSpec;
+    timeSpec.accessTime = tmsp[0].tv_sec;
+    timeSpec.modificationTime = tmsp[0].tv_sec;
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_OP(utimens, resp, path, timeSpec, handle, context);
+    context_attr_cache()->invalidate(path);
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::fsync(const char* path, int datasync, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::FSYNC);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    auto writeBack = thrift_fuse::get_tfuse_from_context()->get_write_back();
+    if (writeBack != nullptr && fi != nullptr) {
+        int error = writeBack->flush(fi->fh, path);
+        if (error != StatusCode::FUSE_SUCCESS) {
+            return error;
+        }
+    }
+
+    THRIFT_OP(fsync, resp, path, datasync, handle, context);
+    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS) {
+        thrift_fuse::t2fHandle(handle, fi);
+    } else {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::fsyncdir(const char* path, int datasync, fuse_file_info* fi)
+{
+    op_timer timer(context_op_stats(), FuseOp::FSYNCDIR);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseHandleInfo handle;
+    thrift_fuse::fuse2thriftHandleInfo(fi, handle);
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_OP(fsyncdir, resp, path, datasync, handle, context);
+    if (resp.status == Fuse::StatusCode::FUSE_SUCCESS) {
+        thrift_fuse::t2fHandle(handle, fi);
+    } else {
+        LOG_DEBUG << "Failed " << " Path " << path << "Error " << resp.status;
+    }
+    return resp.status;
+}
+
+int fuse_native::access(const char* path, int flag)
+{
+    op_timer timer(context_op_stats(), FuseOp::ACCESS);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    FileSystemResponse resp;
+
+    FuseContext context;
+    thrift_fuse::fuse2thriftContext(fuse_get_context(), context);
+
+    THRIFT_OP(access, resp, path, static_cast<FuseAccessMode::type>(flag), context);
+
+    if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {        
+        LOG_DEBUG << "Failed "
+                  << " Path " << path << "Error " << resp.status;
+    }
+    return 0;
+}
+
+// Todo:: need to be implemented
+int fuse_native::removexattr(const char* path, const char* name0)
+{
+    op_timer timer(context_op_stats(), FuseOp::REMOVEXATTR);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    return StatusCode::FUSE_ERROREPERM;
+}
+
+int fuse_native::listxattr(const char* path, char* namebuf, size_t size)
+{
+    op_timer timer(context_op_stats(), FuseOp::LISTXATTR);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    // TODO:: fix it.
+    return StatusCode::FUSE_ERROREPERM;
+}
+
+int fuse_native::lock(const char* path, fuse_file_info* fi, int cmd, fuse_flock* flock)
+{
+    op_timer timer(context_op_stats(), FuseOp::LOCK);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    return 0;
+}
+
+int fuse_native::bmap(const char* path, size_t blocksize, uint64_t* idx)
+{
+    op_timer timer(context_op_stats(), FuseOp::BMAP);
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    return 0;
+}
+
+
+
+void fuse_native::destroy(void* fuse)
+{
+    LOG_DEBUG << "Called " << __FUNCTION__;
+    auto fs = static_cast<thrift_fuse*>(fuse);
+
+    delete static_cast<thrift_fuse*>(fuse);
+}
+
+void* fuse_native::init(fuse_conn_info* conn, fuse_config* conf)
+{        
+    conn->want |= (conn->capable & FUSE_CAP_READDIRPLUS);
+    auto fs = thrift_fuse::get_tfuse_from_context();
+    fs->set_kernel_timeouts(conf);
+    fs->start();
+    return fs;
+}
@@ -0,0 +1,216 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <algorithm>
+#include <cstring>
+
+#include <inline_data.h>
+
+inline_table::inline_table(uint32_t maxFileBytes, size_t capacityBytes)
+    : maxFile(maxFileBytes)
+    , capacity(capacityBytes)
+    , hitCount(0)
+    , missCount(0)
+{
+}
+
+void inline_table::put(uint64_t fh, const std::string& path, std::string& data, int64_t fileSize, int64_t version)
+{
+    auto content = std::make_shared<inline_content>();
+    content->path = path;
+    content->data.swap(data);
+    content->fileSize = fileSize;
+    content->version = version;
+
+    boost::mutex::scoped_lock guard(lock);
+    auto it = contents.find(fh);
+    if (it != contents.end()) {
+        erase_locked(it);
+    }
+    // What was released before is older than this
+    unretain_locked(path);
+    if (!make_room_locked(content->data.size())) {
+        return;
+    }
+    add_locked(fh, std::move(content));
+}
+
+bool inline_table::serve(uint64_t fh, const std::string& path, int64_t off, char* buf, size_t size, size_t& bytesRead)
+{
+    inline_content_ptr content;
+    {
+        boost::mutex::scoped_lock guard(lock);
+        auto it = contents.find(fh);
+        if (it == contents.end() || it->second->path != path) {
+            missCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        content = it->second;
+    }
+
+    int64_t held = static_cast<int64_t>(content->data.size());
+    bool whole = held == content->fileSize;
+    if (off < 0 || (!whole && off + static_cast<int64_t>(size) > held)) {
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bytesRead = off < held ? std::min(size, static_cast<size_t>(held - off)) : 0;
+    if (bytesRead > 0) {
+        memcpy(buf, content->data.data() + off, bytesRead);
+    }
+    hitCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+int64_t inline_table::known_version(const std::string& path)
+{
+    boost::mutex::scoped_lock guard(lock);
+    auto kept = retained.find(path);
+    if (kept != retained.end()) {
+        return (*kept->second)->version;
+    }
+    // Another handle of the path may still be open
+    auto handles = handlesOf.find(path);
+    if (handles != handlesOf.end()) {
+        for (uint64_t fh : handles->second) {
+            int64_t version = contents.at(fh)->version;
+            if (version != INLINE_NO_VERSION) {
+                return version;
+            }
+        }
+    }
+    return INLINE_NO_VERSION;
+}
+
+bool inline_table::reuse(uint64_t fh, const std::string& path, int64_t version)
+{
+    if (version == INLINE_NO_VERSION) {
+        return false;
+    }
+    boost::mutex::scoped_lock guard(lock);
+    inline_content_ptr content;
+    auto kept = retained.find(path);
+    if (kept != retained.end() && (*kept->second)->version == version) {
+        content = *kept->second;
+        unretain_locked(path);
+    } else {
+        auto handles = handlesOf.find(path);
+        if (handles == handlesOf.end()) {
+            return false;
+        }
+        for (uint64_t other : handles->second) {
+            if (other != fh && contents.at(other)->version == version) {
+                content = contents.at(other);
+                break;
+            }
+        }
+        if (!content) {
+            return false;
+        }
+    }
+    auto it = contents.find(fh);
+    if (it != contents.end()) {
+        erase_locked(it);
+    }
+    if (!make_room_locked(content->data.size())) {
+        return false;
+    }
+    add_locked(fh, std::move(content));
+    return true;
+}
+
+void inline_table::remove(uint64_t fh)
+{
+    boost::mutex::scoped_lock guard(lock);
+    auto it = contents.find(fh);
+    if (it == contents.end()) {
+        return;
+    }
+    inline_content_ptr content = it->second;
+    erase_locked(it);
+    // Without a version the next open could not tell whether it is current
+    if (content->version == INLINE_NO_VERSION) {
+        return;
+    }
+    unretain_locked(content->path);
+    if (!make_room_locked(content->data.size())) {
+        return;
+    }
+    bytes += content->data.size();
+    retainOrder.push_front(content);
+    retained.emplace(content->path, retainOrder.begin());
+}
+
+void inline_table::invalidate(const std::string& path)
+{
+    boost::mutex::scoped_lock guard(lock);
+    unretain_locked(path);
+    auto handles = handlesOf.find(path);
+    if (handles == handlesOf.end()) {
+        return;
+    }
+    // All handles of the path go, no need to erase_locked them one by one
+    std::unordered_set<uint64_t> fhs;
+    fhs.swap(handles->second);
+    handlesOf.erase(handles);
+    for (uint64_t fh : fhs) {
+        auto it = contents.find(fh);
+        bytes -= it->second->data.size();
+        contents.erase(it);
+    }
+}
+
+void inline_table::erase_locked(std::unordered_map<uint64_t, inline_content_ptr>::iterator it)
+{
+    auto handles = handlesOf.find(it->second->path);
+    handles->second.erase(it->first);
+    if (handles->second.empty()) {
+        handlesOf.erase(handles);
+    }
+    bytes -= it->second->data.size();
+    contents.erase(it);
+}
+
+void inline_table::unretain_locked(const std::string& path)
+{
+    auto kept = retained.find(path);
+    if (kept != retained.end()) {
+        bytes -= (*kept->second)->data.size();
+        retainOrder.erase(kept->second);
+        retained.erase(kept);
+    }
+}
+
+bool inline_table::make_room_locked(size_t size)
+{
+    while (bytes + size > capacity && !retainOrder.empty()) {
+        inline_content_ptr oldest = retainOrder.back();
+        unretain_locked(oldest->path);
+    }
+    return bytes + size <= capacity;
+}
+
+void inline_table::add_locked(uint64_t fh, inline_content_ptr content)
+{
+    bytes += content->data.size();
+    handlesOf[content->path].insert(fh);
+    contents.emplace(fh, std::move(content));
+}
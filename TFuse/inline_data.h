@@ -0,0 +1,130 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <boost/thread/mutex.hpp>
+
+// Bytes of a file open asks the host to return with the handle
+#define INLINE_DEFAULT_MAX_FILE (64 * 1024)
+// Bytes held for all open handles and released files together
+#define INLINE_DEFAULT_CAPACITY (64 * 1024 * 1024)
+// knownVersion of an open when nothing is held for the path
+#define INLINE_NO_VERSION (-1)
+
+/*
+ * File content that came back with open.
+ */
+struct inline_content {
+    std::string path;
+    std::string data;
+    // Size of the whole file at open, data is all of it when the two match
+    int64_t fileSize;
+    // Content version of the backend, INLINE_NO_VERSION when it sent none
+    int64_t version;
+};
+
+typedef std::shared_ptr<const inline_content> inline_content_ptr;
+
+/*
+ * Open file handles mapped to the content their open returned.
+ *
+ * Reads that fall inside it, or past the end of a file that was inlined
+ * whole, are served without a read RPC. Like the kernel page cache it gives
+ * close-to-open consistency: changes made through this mount drop the
+ * content of the path, changes made elsewhere show at the next open.
+ *
+ * Content of a released handle stays behind for its path, least recently
+ * released first out when the capacity runs short. The next open sends its
+ * version and the backend leaves the data out while it is still current.
+ */
+class inline_table {
+private:
+    boost::mutex lock;
+    std::unordered_map<uint64_t, inline_content_ptr> contents;
+    // Handles in contents by path, so invalidate finds them without a scan
+    std::unordered_map<std::string, std::unordered_set<uint64_t>> handlesOf;
+    // Content of released handles by path, most recently released first
+    std::list<inline_content_ptr> retainOrder;
+    std::unordered_map<std::string, std::list<inline_content_ptr>::iterator> retained;
+    uint32_t maxFile;
+    size_t capacity;
+    // Held by contents and retained, content shared by both counts twice
+    size_t bytes = 0;
+    std::atomic<uint64_t> hitCount;
+    std::atomic<uint64_t> missCount;
+
+    void erase_locked(std::unordered_map<uint64_t, inline_content_ptr>::iterator it);
+    void unretain_locked(const std::string& path);
+    // Evicts released content until size more bytes fit, false when they do not
+    bool make_room_locked(size_t size);
+    void add_locked(uint64_t fh, inline_content_ptr content);
+
+public:
+    inline_table(uint32_t maxFileBytes, size_t capacityBytes);
+
+    // inlineLimit to send with open and create, 0 when disabled
+    inline uint32_t limit() const
+    {
+        return maxFile;
+    }
+
+    inline uint64_t hits() const
+    {
+        return hitCount.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t misses() const
+    {
+        return missCount.load(std::memory_order_relaxed);
+    }
+
+    // Takes data, ignored when it would exceed the capacity
+    void put(uint64_t fh, const std::string& path, std::string& data, int64_t fileSize, int64_t version);
+
+    /*
+     * Copy [off, off + size) of the handle's content into buf. Returns false
+     * when the content does not answer the read, otherwise bytesRead is what
+     * a read RPC would have returned.
+     */
+    bool serve(uint64_t fh, const std::string& path, int64_t off, char* buf, size_t size, size_t& bytesRead);
+
+    // knownVersion to send with an open of path
+    int64_t known_version(const std::string& path);
+
+    /*
+     * The open of fh returned version without data, hand it the content held
+     * for path. False when that is gone or of another version.
+     */
+    bool reuse(uint64_t fh, const std::string& path, int64_t version);
+
+    // Handle released, its content stays for the next open of the path
+    void remove(uint64_t fh);
+    // Data of path changed, drop what its handles and released ones hold
+    void invalidate(const std::string& path);
+};
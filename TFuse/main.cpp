@@ -1,100 +1,136 @@
-/*
- ***************************************************************************** 
- * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
- *
- * Copyright (c) 2022 Yogender Solanki
- *
- * This program is free software: you can redistribute it and/or modify it
- * under the terms of the GNU Lesser General Public License as published by the
- * Free Software Foundation, either version 3 of the License, or (at your
- * option) any later version.
- *
- * This program is distributed in the hope that it will be useful, but WITHOUT
- * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
- * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
- * for more details.
- *
- * You should have received a copy of the GNU Lesser General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- *****************************************************************************
- */
-
-// ThriftFuse.cpp : This file contains the 'main' function. Program execution
-// begins and ends there.
-//
-
-#include <iostream>
-#include <memory>
-
-#include <logger.h>
-#include <thrift_fuse.h>
-
-#include <thrift_client.h>
-
-#include <boost/property_tree/ini_parser.hpp>
-#include <boost/property_tree/ptree.hpp>
-
-using namespace std;
-
-int main(int argc, char* argv[])
-{
-    init_logging();
-
-    boost::property_tree::ptree pt;
-    boost::property_tree::ini_parser::read_ini("config.ini", pt);
-    blocking_queue<ThriftClientPtr>* clientQueue;
-
-    try {
-        auto thriftConfig = pt.get_child("THRIFT");
-
-        if (thriftConfig.find("TRANSPORT") == thriftConfig.not_found()) {
-            std::cerr << "TRANSPORT not persent in config file." << endl;
-            return -1;
-        }
-
-        if (thriftConfig.find("TARGET") == thriftConfig.not_found()) {
-            std::cerr << "TARGET not persent in config file." << endl;
-            return -1;
-        }
-
-        TransportType type = thrift_client::TransportTypeFromString(thriftConfig.get<std::string>("TRANSPORT"));
-        MessageWrap wrap = thrift_client::WrapTypeFromString(thriftConfig.get<std::string>("WRAPPER", "BUFFERED"));
-        SerializationProtocol protocol = thrift_client::ProtocolTypeFromString(thriftConfig.get<std::string>("PROTOCOL", "BINARY"));
-
-        string targetPath = thriftConfig.get<std::string>("TARGET");
-        string servicePath;
-        if (wrap == MessageWrap::HTTP) {
-            if (thriftConfig.find("SERVICEPATH") == thriftConfig.not_found()) {
-                LOG_FATAL << "Service option not defined in conifg file";
-                std::cerr << "Service location is required for HTTP endpoint, use SERVICEPATH  in THRIFT Section" << std::endl;
-                return -1;
-            } else {
-                servicePath = thriftConfig.get<std::string>("SERVICEPATH");
-            }
-        }
-        clientQueue = new blocking_queue<ThriftClientPtr>(8);
-        for (int i = 0; i < 8; i++) {
-            auto client = make_shared<thrift_client>(targetPath, servicePath, type, wrap, protocol,i);
-            try {
-                client->connect();
-            } catch (const std::exception& e) {
-                LOG_ERROR << "Could not connect client " << e.what();
-                return -1;
-            }
-            clientQueue->push(client);
-        }
-
-    } catch (const std::invalid_argument& ex) {
-        LOG_ERROR << "Error in arguments " << ex.what();
-        return -1;
-    } catch (const exception& ex) {
-        LOG_ERROR << "Unknown error while initializing client :" << ex.what();
-        return -1;
-    }
-
-    auto* fs = new thrift_fuse(clientQueue);
-    LOG_INFO << "File System retrun " << fs->thrift_fuse_main(argc, argv);
-    int x;
-    std::cin >> x;
-    return 0;
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+
+// ThriftFuse.cpp : This file contains the 'main' function. Program execution
+// begins and ends there.
+//
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <logger.h>
+#include <thrift_fuse.h>
+
+#include <client_pool.h>
+#include <replica_set.h>
+#include <shard_router.h>
+#include <thrift_client.h>
+
+#include <boost/property_tree/ini_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    // fuse_main may fork, the log thread is started in thrift_fuse::start
+    init_logging(false);
+
+    boost::property_tree::ptree pt;
+    boost::property_tree::ini_parser::read_ini("config.ini", pt);
+    vector<replica_set> shards;
+
+    try {
+        auto thriftConfig = pt.get_child("THRIFT");
+
+        if (thriftConfig.find("TRANSPORT") == thriftConfig.not_found()) {
+            std::cerr << "TRANSPORT not persent in config file." << endl;
+            return -1;
+        }
+
+        if (thriftConfig.find("TARGET") == thriftConfig.not_found()) {
+            std::cerr << "TARGET not persent in config file." << endl;
+            return -1;
+        }
+
+        TransportType type = thrift_client::TransportTypeFromString(thriftConfig.get<std::string>("TRANSPORT"));
+        MessageWrap wrap = thrift_client::WrapTypeFromString(thriftConfig.get<std::string>("WRAPPER", "BUFFERED"));
+        SerializationProtocol protocol = thrift_client::ProtocolTypeFromString(thriftConfig.get<std::string>("PROTOCOL", "BINARY"));
+
+        string servicePath;
+        if (wrap == MessageWrap::HTTP) {
+            if (thriftConfig.find("SERVICEPATH") == thriftConfig.not_found()) {
+                LOG_FATAL << "Service option not defined in conifg file";
+                std::cerr << "Service location is required for HTTP endpoint, use SERVICEPATH  in THRIFT Section" << std::endl;
+                return -1;
+            } else {
+                servicePath = thriftConfig.get<std::string>("SERVICEPATH");
+            }
+        }
+        bool pipelined = thriftConfig.get<bool>("PIPELINED", false);
+
+        client_pool_config poolConfig;
+        poolConfig.minClients = thriftConfig.get<size_t>("MIN_CONNECTIONS", CLIENT_POOL_DEFAULT_MIN);
+        poolConfig.maxClients = thriftConfig.get<size_t>("MAX_CONNECTIONS", CLIENT_POOL_DEFAULT_MAX);
+        poolConfig.maxInflight = pipelined ? thriftConfig.get<size_t>("MAX_INFLIGHT", DEFAULT_MAX_INFLIGHT) : 1;
+        poolConfig.growWaitMs = thriftConfig.get<uint32_t>("POOL_GROW_WAIT_MS", CLIENT_POOL_DEFAULT_GROW_WAIT_MS);
+        poolConfig.idleMs = thriftConfig.get<uint32_t>("POOL_IDLE_MS", CLIENT_POOL_DEFAULT_IDLE_MS);
+        poolConfig.pingMs = thriftConfig.get<uint32_t>("PING_INTERVAL_MS", CLIENT_POOL_DEFAULT_PING_MS);
+
+        // One pool per backend, all with the same transport settings
+        auto startPool = [&](const string& targetPath) {
+            auto factory = [=](int id) {
+                auto client = make_shared<thrift_client>(targetPath, servicePath, type, wrap, protocol, id, pipelined);
+                try {
+                    client->connect();
+                } catch (const std::exception& e) {
+                    LOG_ERROR << "Could not connect client to " << targetPath << " " << e.what();
+                    throw;
+                }
+                return client;
+            };
+
+            auto targetConfig = poolConfig;
+            targetConfig.target = targetPath;
+            auto pool = new client_pool(factory, targetConfig);
+            pool->start();
+            return pool;
+        };
+
+        bool readFromPrimary = pt.get<bool>("REPLICAS.READ_FROM_PRIMARY", true);
+        auto targets = shard_router::targets_from_config(pt);
+        for (size_t shard = 0; shard < targets.size(); shard++) {
+            auto primary = startPool(targets[shard]);
+            vector<client_pool*> replicas;
+            for (auto& replicaTarget : replica_set::targets_from_config(pt, shard)) {
+                replicas.push_back(startPool(replicaTarget));
+            }
+            if (!replicas.empty()) {
+                LOG_INFO << "Shard " << shard << " reads from " << replicas.size() << " replicas";
+            }
+            shards.emplace_back(primary, replicas, readFromPrimary);
+        }
+
+    } catch (const std::invalid_argument& ex) {
+        LOG_ERROR << "Error in arguments " << ex.what();
+        return -1;
+    } catch (const exception& ex) {
+        LOG_ERROR << "Unknown error while initializing client :" << ex.what();
+        return -1;
+    }
+
+    auto* fs = new thrift_fuse(shards, pt);
+    LOG_INFO << "File System retrun " << fs->thrift_fuse_main(argc, argv);
+    int x;
+    std::cin >> x;
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,317 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+// Include thirft_fuse first to avoid refdefination error
+#include <thrift_fuse.h>
+
+#include <cstdio>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <Logger.h>
+#include <metrics_exporter.h>
+#include <op_stats.h>
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+typedef boost::asio::local::stream_protocol metrics_protocol;
+
+struct metrics_exporter::server {
+    boost::asio::io_context io;
+    metrics_protocol::acceptor acceptor { io };
+};
+
+// One scrape: read the request head, answer, close
+struct metrics_session : std::enable_shared_from_this<metrics_session> {
+    metrics_session(boost::asio::io_context& io, metrics_exporter* exporter)
+        : socket(io)
+        , request(METRICS_MAX_REQUEST)
+        , exporter(exporter)
+    {
+    }
+
+    void start()
+    {
+        auto self = shared_from_this();
+        boost::asio::async_read_until(socket, request, "\r\n\r\n",
+            [self](const boost::system::error_code& ec, size_t) {
+                if (!ec) {
+                    self->reply();
+                }
+            });
+    }
+
+    void reply()
+    {
+        auto body = exporter->render();
+        response = "HTTP/1.0 200 OK\r\n"
+                   "Content-Type: text/plain; version=0.0.4\r\n"
+                   "Content-Length: "
+            + std::to_string(body.size()) + "\r\n"
+                                            "Connection: close\r\n\r\n"
+            + body;
+        auto self = shared_from_this();
+        boost::asio::async_write(socket, boost::asio::buffer(response),
+            [self](const boost::system::error_code&, size_t) {
+                boost::system::error_code ignored;
+                self->socket.shutdown(metrics_protocol::socket::shutdown_both, ignored);
+            });
+    }
+
+    metrics_protocol::socket socket;
+    boost::asio::streambuf request;
+    std::string response;
+    metrics_exporter* exporter;
+};
+
+static void accept_next(boost::asio::io_context& io, metrics_protocol::acceptor& acceptor, metrics_exporter* exporter)
+{
+    auto session = std::make_shared<metrics_session>(io, exporter);
+    acceptor.async_accept(session->socket, [&io, &acceptor, exporter, session](const boost::system::error_code& ec) {
+        if (ec == boost::asio::error::operation_aborted) {
+            return;
+        }
+        if (!ec) {
+            session->start();
+        }
+        accept_next(io, acceptor, exporter);
+    });
+}
+#else
+struct metrics_exporter::server {
+};
+#endif
+
+metrics_exporter::metrics_exporter(thrift_fuse* fileSystem, const std::string& path)
+    : fs(fileSystem)
+    , socketPath(path)
+    , impl(new server())
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    // A socket left behind by an earlier mount would make bind fail
+    std::remove(socketPath.c_str());
+    impl->acceptor.open(metrics_protocol());
+    impl->acceptor.bind(metrics_protocol::endpoint(socketPath));
+    impl->acceptor.listen();
+    accept_next(impl->io, impl->acceptor, this);
+    thread.reset(new boost::thread(&metrics_exporter::run, this));
+    LOG_INFO << "Serving metrics on " << socketPath;
+#else
+    LOG_WARNING << "UNIX sockets are not available, metrics are not exported";
+#endif
+}
+
+metrics_exporter::~metrics_exporter()
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    impl->io.stop();
+    if (thread) {
+        thread->join();
+    }
+    std::remove(socketPath.c_str());
+#endif
+}
+
+void metrics_exporter::run()
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    try {
+        impl->io.run();
+    } catch (std::exception& ex) {
+        LOG_ERROR << "Metrics exporter stopped " << ex.what();
+    }
+#endif
+}
+
+static std::string escape_label(const std::string& value)
+{
+    std::string out;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+static void write_header(std::ostringstream& out, const char* name, const char* type, const char* help)
+{
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+// Cumulative buckets at every power of two up to the largest value seen
+static void write_histogram(std::ostringstream& out, const char* name, const std::string& labels, const latency_histogram& histogram)
+{
+    uint64_t cumulative = 0;
+    uint64_t largest = histogram.max();
+    for (size_t idx = 0; idx < OP_HISTOGRAM_BUCKETS; idx++) {
+        cumulative += histogram.bucket_count(idx);
+        size_t sub = (size_t(1) << OP_HISTOGRAM_SUB_BITS) - 1;
+        if ((idx & sub) != sub) {
+            continue;
+        }
+        uint64_t bound = latency_histogram::bucket_upper(idx);
+        out << name << "_bucket{" << labels << ",le=\"" << bound << "\"} " << cumulative << "\n";
+        if (bound >= largest) {
+            break;
+        }
+    }
+    out << name << "_bucket{" << labels << ",le=\"+Inf\"} " << histogram.count() << "\n";
+    out << name << "_sum{" << labels << "} " << histogram.sum() << "\n";
+    out << name << "_count{" << labels << "} " << histogram.count() << "\n";
+}
+
+// The power of two buckets of a pool, the last one only counts towards +Inf
+static void write_histogram(std::ostringstream& out, const char* name, const std::string& labels, const wait_histogram& histogram)
+{
+    uint64_t cumulative = 0;
+    uint64_t largest = histogram.max();
+    for (size_t idx = 0; idx + 1 < CLIENT_POOL_WAIT_BUCKETS; idx++) {
+        cumulative += histogram.bucket_count(idx);
+        uint64_t bound = wait_histogram::bucket_upper(idx);
+        out << name << "_bucket{" << labels << ",le=\"" << bound << "\"} " << cumulative << "\n";
+        if (bound >= largest) {
+            break;
+        }
+    }
+    out << name << "_bucket{" << labels << ",le=\"+Inf\"} " << histogram.count() << "\n";
+    out << name << "_sum{" << labels << "} " << histogram.sum() << "\n";
+    out << name << "_count{" << labels << "} " << histogram.count() << "\n";
+}
+
+std::string metrics_exporter::render()
+{
+    std::ostringstream out;
+    auto stats = fs->get_op_stats();
+    const size_t opCount = static_cast<size_t>(FuseOp::COUNT);
+
+    write_header(out, "tfuse_op_calls_total", "counter", "FUSE callbacks completed");
+    for (size_t idx = 0; idx < opCount; idx++) {
+        auto op = static_cast<FuseOp>(idx);
+        out << "tfuse_op_calls_total{op=\"" << op_stats::name(op) << "\"} " << stats->of(op).latency.count() << "\n";
+    }
+    write_header(out, "tfuse_op_in_flight", "gauge", "FUSE callbacks running");
+    for (size_t idx = 0; idx < opCount; idx++) {
+        auto op = static_cast<FuseOp>(idx);
+        out << "tfuse_op_in_flight{op=\"" << op_stats::name(op) << "\"} " << stats->of(op).active.load(std::memory_order_relaxed) << "\n";
+    }
+    write_header(out, "tfuse_op_rpc_failures_total", "counter", "RPCs of a callback that threw");
+    for (size_t idx = 0; idx < opCount; idx++) {
+        auto op = static_cast<FuseOp>(idx);
+        out << "tfuse_op_rpc_failures_total{op=\"" << op_stats::name(op) << "\"} " << stats->of(op).failures.load(std::memory_order_relaxed) << "\n";
+    }
+    write_header(out, "tfuse_op_bytes_total", "counter", "Payload read or written by callbacks");
+    for (size_t idx = 0; idx < opCount; idx++) {
+        auto op = static_cast<FuseOp>(idx);
+        out << "tfuse_op_bytes_total{op=\"" << op_stats::name(op) << "\"} " << stats->of(op).bytes.sum() << "\n";
+    }
+
+    struct {
+        const char* name;
+        const char* help;
+        const latency_histogram op_counters::*member;
+    } histograms[] = {
+        { "tfuse_op_latency_microseconds", "Time from entering to leaving a callback", &op_counters::latency },
+        { "tfuse_op_wait_microseconds", "Time a callback waited for pool clients", &op_counters::wait },
+        { "tfuse_op_rpc_microseconds", "Time a callback spent in RPCs", &op_counters::rpc },
+    };
+    for (auto& histogram : histograms) {
+        write_header(out, histogram.name, "histogram", histogram.help);
+        for (size_t idx = 0; idx < opCount; idx++) {
+            auto op = static_cast<FuseOp>(idx);
+            auto& counters = stats->of(op);
+            if ((counters.*histogram.member).count() == 0) {
+                continue;
+            }
+            write_histogram(out, histogram.name, std::string("op=\"") + op_stats::name(op) + "\"", counters.*histogram.member);
+        }
+    }
+
+    // Every pool of every shard with its labels, each family is written as one group
+    std::vector<std::pair<client_pool*, std::string>> pools;
+    for (size_t shard = 0; shard < fs->get_router()->count(); shard++) {
+        auto& replicas = fs->get_replicas(shard);
+        for (auto pool : replicas.pools()) {
+            pools.emplace_back(pool, "target=\"" + escape_label(pool->target()) + "\",shard=\"" + std::to_string(shard)
+                    + "\",role=\"" + (replicas.is_primary(pool) ? "primary" : "replica") + "\"");
+        }
+    }
+    write_header(out, "tfuse_pool_clients", "gauge", "Connections of a backend pool");
+    for (auto& pool : pools) {
+        out << "tfuse_pool_clients{" << pool.second << "} " << pool.first->size() << "\n";
+    }
+    write_header(out, "tfuse_pool_in_use", "gauge", "Clients of a backend pool handed out");
+    for (auto& pool : pools) {
+        out << "tfuse_pool_in_use{" << pool.second << "} " << pool.first->outstanding() << "\n";
+    }
+    write_header(out, "tfuse_pool_call_latency_microseconds", "gauge", "Moving average of call latency");
+    for (auto& pool : pools) {
+        out << "tfuse_pool_call_latency_microseconds{" << pool.second << "} " << pool.first->latency() << "\n";
+    }
+    write_header(out, "tfuse_pool_wait_microseconds", "histogram", "Time callers waited for a client");
+    for (auto& pool : pools) {
+        write_histogram(out, "tfuse_pool_wait_microseconds", pool.second, pool.first->waits());
+    }
+    write_header(out, "tfuse_backend_read_bytes_total", "counter", "File data read from a backend");
+    for (auto& pool : pools) {
+        out << "tfuse_backend_read_bytes_total{" << pool.second << "} " << pool.first->bytes_read() << "\n";
+    }
+    write_header(out, "tfuse_backend_written_bytes_total", "counter", "File data written to a backend");
+    for (auto& pool : pools) {
+        out << "tfuse_backend_written_bytes_total{" << pool.second << "} " << pool.first->bytes_written() << "\n";
+    }
+
+    std::vector<std::tuple<const char*, uint64_t, uint64_t>> caches;
+    caches.emplace_back("attr", fs->get_attr_cache()->hits(), fs->get_attr_cache()->misses());
+    caches.emplace_back("negative", fs->get_neg_cache()->hits(), fs->get_neg_cache()->misses());
+    if (fs->get_page_cache() != nullptr) {
+        caches.emplace_back("page", fs->get_page_cache()->hits(), fs->get_page_cache()->misses());
+    }
+    if (fs->get_disk_cache() != nullptr) {
+        caches.emplace_back("disk", fs->get_disk_cache()->hits(), fs->get_disk_cache()->misses());
+    }
+    if (fs->get_inline_table() != nullptr) {
+        caches.emplace_back("inline", fs->get_inline_table()->hits(), fs->get_inline_table()->misses());
+    }
+    write_header(out, "tfuse_cache_hits_total", "counter", "Lookups a client side cache answered");
+    for (auto& cache : caches) {
+        out << "tfuse_cache_hits_total{cache=\"" << std::get<0>(cache) << "\"} " << std::get<1>(cache) << "\n";
+    }
+    write_header(out, "tfuse_cache_misses_total", "counter", "Lookups a client side cache could not answer");
+    for (auto& cache : caches) {
+        out << "tfuse_cache_misses_total{cache=\"" << std::get<0>(cache) << "\"} " << std::get<2>(cache) << "\n";
+    }
+    write_header(out, "tfuse_cache_hit_ratio", "gauge", "Hits over all lookups since mount");
+    for (auto& cache : caches) {
+        uint64_t lookups = std::get<1>(cache) + std::get<2>(cache);
+        out << "tfuse_cache_hit_ratio{cache=\"" << std::get<0>(cache) << "\"} "
+            << (lookups == 0 ? 0.0 : static_cast<double>(std::get<1>(cache)) / lookups) << "\n";
+    }
+    return out.str();
+}
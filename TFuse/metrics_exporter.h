@@ -0,0 +1,59 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <boost/thread/thread.hpp>
+
+class thrift_fuse;
+
+// Largest scrape request that is read before answering
+#define METRICS_MAX_REQUEST 8192
+
+/*
+ * Prometheus text exposition of a mount, answered over HTTP on a local UNIX
+ * socket ([METRICS] SOCKET) so it can be scraped without opening a port,
+ * e.g. curl --unix-socket <path> http://localhost/metrics.
+ *
+ * Everything runs on the exporter's own thread. It only reads the relaxed
+ * atomic counters the FUSE callbacks and pools already keep, serving a scrape
+ * adds nothing to their path.
+ */
+class metrics_exporter {
+public:
+    metrics_exporter(thrift_fuse* fs, const std::string& socketPath);
+    ~metrics_exporter();
+
+    // Whole exposition in text format 0.0.4
+    std::string render();
+
+private:
+    struct server;
+
+    void run();
+
+    thrift_fuse* fs;
+    std::string socketPath;
+    std::unique_ptr<server> impl;
+    std::unique_ptr<boost::thread> thread;
+};
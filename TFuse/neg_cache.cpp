@@ -0,0 +1,198 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <neg_cache.h>
+#include <path_util.h>
+
+neg_cache::neg_cache(size_t capacity, uint32_t ttlMs, size_t shardCount)
+    : _enabled(capacity > 0 && ttlMs > 0)
+    , ttl(ttlMs)
+    , hitCount(0)
+    , missCount(0)
+{
+    if (shardCount == 0) {
+        shardCount = 1;
+    }
+    if (capacity < shardCount) {
+        shardCount = capacity > 0 ? capacity : 1;
+    }
+    shardCapacity = capacity / shardCount;
+    for (size_t i = 0; i < shardCount; i++) {
+        shards.emplace_back(new shard());
+    }
+}
+
+size_t neg_cache::shard_index(const std::string& parent) const
+{
+    return std::hash<std::string>()(parent) % shards.size();
+}
+
+bool neg_cache::contains(const std::string& path)
+{
+    if (!_enabled) {
+        return false;
+    }
+
+    auto parent = parent_path(path);
+    shard& s = *shards[shard_index(parent)];
+    boost::mutex::scoped_lock lock(s.lock);
+    auto dir = s.parents.find(parent);
+    if (dir != s.parents.end()) {
+        auto it = dir->second.find(base_name(path));
+        if (it != dir->second.end()) {
+            if (clock::now() < it->second) {
+                hitCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            dir->second.erase(it);
+            s.count--;
+            if (dir->second.empty()) {
+                s.parents.erase(dir);
+            }
+        }
+    }
+    missCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+uint64_t neg_cache::fill_token(const std::string& path)
+{
+    if (!_enabled) {
+        return 0;
+    }
+    shard& s = *shards[shard_index(parent_path(path))];
+    boost::mutex::scoped_lock lock(s.lock);
+    return s.epoch;
+}
+
+void neg_cache::put(const std::string& path, uint64_t token)
+{
+    if (!_enabled) {
+        return;
+    }
+
+    auto parent = parent_path(path);
+    shard& s = *shards[shard_index(parent)];
+    boost::mutex::scoped_lock lock(s.lock);
+    if (s.epoch != token) {
+        return;
+    }
+    if (s.count >= shardCapacity) {
+        purge_expired_locked(s);
+        if (s.count >= shardCapacity) {
+            return;
+        }
+    }
+
+    auto result = s.parents[parent].emplace(base_name(path), clock::now() + ttl);
+    if (result.second) {
+        s.count++;
+    } else {
+        result.first->second = clock::now() + ttl;
+    }
+}
+
+void neg_cache::purge_expired_locked(shard& s)
+{
+    auto now = clock::now();
+    for (auto dir = s.parents.begin(); dir != s.parents.end();) {
+        for (auto it = dir->second.begin(); it != dir->second.end();) {
+            if (now >= it->second) {
+                it = dir->second.erase(it);
+                s.count--;
+            } else {
+                ++it;
+            }
+        }
+        if (dir->second.empty()) {
+            dir = s.parents.erase(dir);
+        } else {
+            ++dir;
+        }
+    }
+}
+
+void neg_cache::invalidate(const std::string& path)
+{
+    if (!_enabled) {
+        return;
+    }
+
+    auto parent = parent_path(path);
+    shard& s = *shards[shard_index(parent)];
+    boost::mutex::scoped_lock lock(s.lock);
+    s.epoch++;
+    auto dir = s.parents.find(parent);
+    if (dir != s.parents.end()) {
+        s.count -= dir->second.erase(base_name(path));
+        if (dir->second.empty()) {
+            s.parents.erase(dir);
+        }
+    }
+}
+
+void neg_cache::forget(const std::string& path)
+{
+    if (!_enabled) {
+        return;
+    }
+
+    auto parent = parent_path(path);
+    shard& s = *shards[shard_index(parent)];
+    boost::mutex::scoped_lock lock(s.lock);
+    auto dir = s.parents.find(parent);
+    if (dir != s.parents.end()) {
+        s.count -= dir->second.erase(base_name(path));
+        if (dir->second.empty()) {
+            s.parents.erase(dir);
+        }
+    }
+}
+
+void neg_cache::invalidate_tree(const std::string& path)
+{
+    if (!_enabled) {
+        return;
+    }
+
+    invalidate(path);
+    for (auto& s : shards) {
+        boost::mutex::scoped_lock lock(s->lock);
+        s->epoch++;
+        for (auto dir = s->parents.begin(); dir != s->parents.end();) {
+            if (is_path_under(dir->first, path)) {
+                s->count -= dir->second.size();
+                dir = s->parents.erase(dir);
+            } else {
+                ++dir;
+            }
+        }
+    }
+}
+
+void neg_cache::clear()
+{
+    for (auto& s : shards) {
+        boost::mutex::scoped_lock lock(s->lock);
+        s->epoch++;
+        s->count = 0;
+        s->parents.clear();
+    }
+}
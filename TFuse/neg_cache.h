@@ -0,0 +1,100 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#define NEG_CACHE_DEFAULT_TTL_MS 1000
+#define NEG_CACHE_DEFAULT_CAPACITY 16384
+#define NEG_CACHE_DEFAULT_SHARDS 16
+
+/*
+ * Negative dentry cache, remembers names the host reported as ENOENT.
+ *
+ * Entries are grouped by parent directory and sharded on the parent path so
+ * that creating something in a directory only has to look at one shard. Like
+ * attr_cache every shard keeps an epoch so a lookup that raced with a create
+ * does not record a stale miss.
+ *
+ * Once a shard is full expired entries are purged and new misses are not
+ * recorded until room frees up. A ttlMs or capacity of 0 disables the cache.
+ */
+class neg_cache {
+public:
+    neg_cache(size_t capacity, uint32_t ttlMs, size_t shardCount);
+
+    inline bool enabled() const
+    {
+        return _enabled;
+    }
+
+    // True if path is known not to exist
+    bool contains(const std::string& path);
+    uint64_t fill_token(const std::string& path);
+    void put(const std::string& path, uint64_t token);
+
+    // Something named path may exist now
+    void invalidate(const std::string& path);
+    // Drop a single entry without disturbing lookups in flight, for names seen to exist
+    void forget(const std::string& path);
+    // Names anywhere below path may exist now, used by rename and symlink
+    void invalidate_tree(const std::string& path);
+    void clear();
+
+    inline uint64_t hits() const
+    {
+        return hitCount.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t misses() const
+    {
+        return missCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    typedef std::chrono::steady_clock clock;
+    typedef std::unordered_map<std::string, clock::time_point> name_map;
+
+    struct shard {
+        boost::mutex lock;
+        uint64_t epoch = 0;
+        size_t count = 0;
+        std::unordered_map<std::string, name_map> parents;
+    };
+
+    size_t shard_index(const std::string& parent) const;
+    void purge_expired_locked(shard& s);
+
+    bool _enabled;
+    size_t shardCapacity;
+    std::chrono::milliseconds ttl;
+    std::vector<std::unique_ptr<shard>> shards;
+
+    std::atomic<uint64_t> hitCount;
+    std::atomic<uint64_t> missCount;
+};
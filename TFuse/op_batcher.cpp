@@ -0,0 +1,196 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+// Include thirft_fuse first to avoid refdefination error
+#include <thrift_fuse.h>
+
+#include <chrono>
+#include <thread>
+
+#include <Logger.h>
+#include <op_batcher.h>
+#include <thrift_op.h>
+
+using namespace Fuse;
+
+op_batcher::op_batcher(thrift_fuse* fuse, size_t shards, const op_batch_config& conf)
+    : fs(fuse)
+    , config(conf)
+    , queueCount(shards * OP_BATCH_KINDS)
+    , supported(true)
+    , batchCount(0)
+    , batchedOps(0)
+{
+    config.maxSize = std::max<size_t>(config.maxSize, 1);
+    queues.reset(new op_queue[queueCount]);
+}
+
+void op_batcher::run(size_t shard, const BatchRequest& request, FileSystemResponse& resp)
+{
+    if (config.maxSize == 1) {
+        send_single(shard, request, resp);
+        return;
+    }
+
+    auto& queue = queues[shard * OP_BATCH_KINDS + (static_cast<int>(request.op) - 1)];
+    pending_op self;
+    self.request = &request;
+    self.response = &resp;
+
+    boost::mutex::scoped_lock guard(queue.lock);
+    queue.pending.push_back(&self);
+    while (!self.done) {
+        if (!self.taken && !queue.collecting) {
+            collect(queue, guard, shard);
+        } else {
+            queue.changed.wait(guard);
+        }
+    }
+}
+
+/*
+ * Take the queued operations and send them, the caller's own may not be
+ * among them if the queue held more than one batch. Called and returns with
+ * guard held.
+ */
+void op_batcher::collect(op_queue& queue, boost::mutex::scoped_lock& guard, size_t shard)
+{
+    queue.collecting = true;
+    if (queue.inflight > 0 && config.windowUs > 0) {
+        // Spin rather than sleep, a sleep lasts a scheduler tick which is
+        // far longer than the window
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(config.windowUs);
+        while (queue.pending.size() < config.maxSize && std::chrono::steady_clock::now() < deadline) {
+            guard.unlock();
+            std::this_thread::yield();
+            guard.lock();
+        }
+    }
+
+    size_t count = std::min(queue.pending.size(), config.maxSize);
+    std::vector<pending_op*> ops(queue.pending.begin(), queue.pending.begin() + count);
+    queue.pending.erase(queue.pending.begin(), queue.pending.begin() + count);
+    for (auto op : ops) {
+        op->taken = true;
+    }
+    queue.collecting = false;
+    queue.inflight++;
+    // Whoever is left may start on the next batch
+    queue.changed.notify_all();
+
+    guard.unlock();
+    send(shard, ops);
+    guard.lock();
+
+    queue.inflight--;
+    for (auto op : ops) {
+        op->done = true;
+    }
+    queue.changed.notify_all();
+}
+
+void op_batcher::send(size_t shard, std::vector<pending_op*>& ops)
+{
+    if (ops.size() > 1 && supported.load(std::memory_order_relaxed) && send_batch(shard, ops)) {
+        return;
+    }
+    for (auto op : ops) {
+        send_single(shard, *op->request, *op->response);
+    }
+}
+
+// Batch RPC that reports a host without the batch method instead of failing
+static void call_batch(const ThriftClientPtr& client,
+    const BatchRequestList& requests,
+    ResponseList& responses,
+    bool& unknown)
+{
+    try {
+        client->GetStub()->batch(responses, requests);
+    } catch (apache::thrift::TApplicationException& ex) {
+        if (ex.getType() != apache::thrift::TApplicationException::UNKNOWN_METHOD) {
+            throw;
+        }
+        unknown = true;
+    }
+}
+
+bool op_batcher::send_batch(size_t shard, std::vector<pending_op*>& ops)
+{
+    // Every op of a batch has the same kind, so they share the pool
+    auto& replicas = fs->get_replicas(shard);
+    auto kind = ops.front()->request->op;
+    auto pool = kind == BatchOp::GETATTR ? replicas.pick_reader() : replicas.primary();
+
+    BatchRequestList requests;
+    requests.reserve(ops.size());
+    for (auto op : ops) {
+        requests.push_back(*op->request);
+        if (!replicas.is_primary(pool) && requests.back().__isset.handleInfo) {
+            requests.back().handleInfo.__set_fh(-1);
+        }
+    }
+
+    FileSystemResponse resp;
+    resp.status = StatusCode::FUSE_SUCCESS;
+    ResponseList responses;
+    bool unknown = false;
+    THRIFT_POOL_CALL(pool, call_batch(client, requests, responses, unknown));
+    if (unknown) {
+        if (supported.exchange(false)) {
+            LOG_WARNING << "Host does not support batch calls, sending them one by one";
+        }
+        return false;
+    }
+
+    for (size_t idx = 0; idx < ops.size(); idx++) {
+        if (resp.status != StatusCode::FUSE_SUCCESS) {
+            ops[idx]->response->status = resp.status;
+        } else if (idx < responses.size()) {
+            *ops[idx]->response = std::move(responses[idx]);
+        } else {
+            LOG_ERROR << "Batch reply holds " << responses.size() << " of " << ops.size() << " responses";
+            ops[idx]->response->status = StatusCode::FUSE_ERROREIO;
+        }
+    }
+    batchCount.fetch_add(1, std::memory_order_relaxed);
+    batchedOps.fetch_add(ops.size(), std::memory_order_relaxed);
+    return true;
+}
+
+void op_batcher::send_single(size_t shard, const BatchRequest& request, FileSystemResponse& resp)
+{
+    switch (request.op) {
+    case BatchOp::GETATTR: {
+        auto handle = request.handleInfo;
+        THRIFT_POOL_CALL(fs->get_read_pool(shard, handle), client->GetStub()->getattr(resp, request.path, handle, request.context));
+        break;
+    }
+    case BatchOp::UNLINK:
+        THRIFT_CLIENT_CALL(fs, shard, client->GetStub()->unlink(resp, request.path, request.context));
+        break;
+    case BatchOp::RMDIR:
+        THRIFT_CLIENT_CALL(fs, shard, client->GetStub()->rmdir(resp, request.path, request.context));
+        break;
+    default:
+        resp.status = StatusCode::FUSE_ERROREINVAL;
+        break;
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <FuseService.h>
+
+// How long a call waits for others to join its batch, in microseconds
+#define OP_BATCH_DEFAULT_WINDOW_US 20
+#define OP_BATCH_DEFAULT_MAX_SIZE 64
+// Kinds of operation that are batched, Fuse::BatchOp values 1..this
+#define OP_BATCH_KINDS 3
+
+class thrift_fuse;
+class client_pool;
+
+struct op_batch_config {
+    uint32_t windowUs = OP_BATCH_DEFAULT_WINDOW_US;
+    // Operations per batch RPC, 1 sends every operation on its own
+    size_t maxSize = OP_BATCH_DEFAULT_MAX_SIZE;
+};
+
+/*
+ * Gathers concurrent operations of one kind on one shard into batch RPCs.
+ *
+ * Callers queue their request and the first one without a batch to wait
+ * for collects the queue and sends it, everybody else sleeps until their
+ * response is filled in. A caller that finds no batch of its kind in flight
+ * sends right away, so a lone call costs no extra latency. While one is in
+ * flight calls are evidently arriving concurrently and the collector waits
+ * up to windowUs for more of them before it sends.
+ *
+ * A batch of one, and every call once the host turned out not to know the
+ * batch method, goes out as the plain single call.
+ */
+class op_batcher {
+public:
+    op_batcher(thrift_fuse* fs, size_t shards, const op_batch_config& conf);
+
+    // Fill resp for request as the single call would, request.op decides the call
+    void run(size_t shard, const Fuse::BatchRequest& request, Fuse::FileSystemResponse& resp);
+
+    inline uint64_t batches() const
+    {
+        return batchCount.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t batched() const
+    {
+        return batchedOps.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct pending_op {
+        const Fuse::BatchRequest* request;
+        Fuse::FileSystemResponse* response;
+        bool taken = false;
+        bool done = false;
+    };
+
+    struct op_queue {
+        boost::mutex lock;
+        boost::condition_variable changed;
+        std::vector<pending_op*> pending;
+        // A caller is collecting a batch
+        bool collecting = false;
+        // Batches sent and not answered yet
+        size_t inflight = 0;
+    };
+
+    void collect(op_queue& queue, boost::mutex::scoped_lock& guard, size_t shard);
+    void send(size_t shard, std::vector<pending_op*>& ops);
+    bool send_batch(size_t shard, std::vector<pending_op*>& ops);
+    void send_single(size_t shard, const Fuse::BatchRequest& request, Fuse::FileSystemResponse& resp);
+
+    thrift_fuse* fs;
+    op_batch_config config;
+    std::unique_ptr<op_queue[]> queues;
+    size_t queueCount;
+    std::atomic<bool> supported;
+    std::atomic<uint64_t> batchCount;
+    std::atomic<uint64_t> batchedOps;
+};
@@ -0,0 +1,253 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <op_stats.h>
+
+static const char* const OpNames[] = {
+    "getattr",
+    "readlink",
+    "mknod",
+    "mkdir",
+    "unlink",
+    "rmdir",
+    "symlink",
+    "rename",
+    "link",
+    "chmod",
+    "chown",
+    "truncate",
+    "open",
+    "read",
+    "write",
+    "statfs",
+    "flush",
+    "release",
+    "fsync",
+    "setxattr",
+    "getxattr",
+    "listxattr",
+    "removexattr",
+    "opendir",
+    "readdir",
+    "releasedir",
+    "fsyncdir",
+    "access",
+    "create",
+    "lock",
+    "utimens",
+    "bmap",
+};
+static_assert(sizeof(OpNames) / sizeof(OpNames[0]) == static_cast<size_t>(FuseOp::COUNT),
+    "Every FuseOp needs a name");
+
+// Innermost timer alive on this thread
+static thread_local op_timer* currentTimer = nullptr;
+
+latency_histogram::latency_histogram()
+    : total(0)
+    , sumValue(0)
+    , maxValue(0)
+{
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t latency_histogram::bucket_of(uint64_t value)
+{
+    const uint64_t subCount = uint64_t(1) << OP_HISTOGRAM_SUB_BITS;
+    value = std::min(value, (uint64_t(1) << OP_HISTOGRAM_MAX_BITS) - 1);
+    if (value < subCount) {
+        return static_cast<size_t>(value);
+    }
+    size_t msb = OP_HISTOGRAM_SUB_BITS;
+    while ((value >> (msb + 1)) != 0) {
+        msb++;
+    }
+    size_t shift = msb - OP_HISTOGRAM_SUB_BITS;
+    return ((shift + 1) << OP_HISTOGRAM_SUB_BITS) + static_cast<size_t>((value >> shift) & (subCount - 1));
+}
+
+uint64_t latency_histogram::bucket_upper(size_t idx)
+{
+    const uint64_t subCount = uint64_t(1) << OP_HISTOGRAM_SUB_BITS;
+    if (idx < subCount) {
+        return idx;
+    }
+    size_t shift = (idx >> OP_HISTOGRAM_SUB_BITS) - 1;
+    uint64_t lower = (subCount + (idx & (subCount - 1))) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+void latency_histogram::record(uint64_t value)
+{
+    buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sumValue.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t seen = maxValue.load(std::memory_order_relaxed);
+    while (value > seen && !maxValue.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t latency_histogram::percentile(double p) const
+{
+    uint64_t samples = count();
+    if (samples == 0) {
+        return 0;
+    }
+    auto target = static_cast<uint64_t>(std::ceil(samples * p / 100.0));
+    target = std::max<uint64_t>(target, 1);
+
+    uint64_t seen = 0;
+    for (size_t idx = 0; idx < OP_HISTOGRAM_BUCKETS; idx++) {
+        seen += buckets[idx].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(bucket_upper(idx), max());
+        }
+    }
+    return max();
+}
+
+op_stats::op_stats()
+{
+}
+
+const char* op_stats::name(FuseOp op)
+{
+    return OpNames[static_cast<size_t>(op)];
+}
+
+std::string op_stats::render() const
+{
+    std::string out;
+    char line[256];
+    snprintf(line, sizeof(line), "%-12s %10s %10s %8s %14s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n",
+        "op", "calls", "backend", "rpcfail", "bytes",
+        "p50", "p99", "p999", "max",
+        "wait50", "wait99", "wait999",
+        "rpc50", "rpc99", "rpc999");
+    out += line;
+
+    for (size_t idx = 0; idx < static_cast<size_t>(FuseOp::COUNT); idx++) {
+        auto& op = counters[idx];
+        if (op.latency.count() == 0) {
+            continue;
+        }
+        snprintf(line, sizeof(line),
+            "%-12s %10llu %10llu %8llu %14llu %8llu %8llu %8llu %8llu %8llu %8llu %8llu %8llu %8llu %8llu\n",
+            OpNames[idx],
+            static_cast<unsigned long long>(op.latency.count()),
+            static_cast<unsigned long long>(op.rpc.count()),
+            static_cast<unsigned long long>(op.failures.load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(op.bytes.sum()),
+            static_cast<unsigned long long>(op.latency.percentile(50)),
+            static_cast<unsigned long long>(op.latency.percentile(99)),
+            static_cast<unsigned long long>(op.latency.percentile(99.9)),
+            static_cast<unsigned long long>(op.latency.max()),
+            static_cast<unsigned long long>(op.wait.percentile(50)),
+            static_cast<unsigned long long>(op.wait.percentile(99)),
+            static_cast<unsigned long long>(op.wait.percentile(99.9)),
+            static_cast<unsigned long long>(op.rpc.percentile(50)),
+            static_cast<unsigned long long>(op.rpc.percentile(99)),
+            static_cast<unsigned long long>(op.rpc.percentile(99.9)));
+        out += line;
+    }
+    return out;
+}
+
+uint64_t op_stats::open_snapshot()
+{
+    auto text = render();
+    boost::mutex::scoped_lock guard(lock);
+    uint64_t id = nextSnapshot++;
+    snapshots[id] = std::move(text);
+    return id;
+}
+
+size_t op_stats::read_snapshot(uint64_t id, int64_t off, char* buf, size_t size)
+{
+    boost::mutex::scoped_lock guard(lock);
+    auto it = snapshots.find(id);
+    if (it == snapshots.end() || off < 0 || static_cast<uint64_t>(off) >= it->second.size()) {
+        return 0;
+    }
+    size_t count = std::min(size, it->second.size() - static_cast<size_t>(off));
+    memcpy(buf, it->second.data() + off, count);
+    return count;
+}
+
+void op_stats::release_snapshot(uint64_t id)
+{
+    boost::mutex::scoped_lock guard(lock);
+    snapshots.erase(id);
+}
+
+op_timer::op_timer(op_stats* stats, FuseOp op)
+    : counters(&stats->of(op))
+    , start(std::chrono::steady_clock::now())
+    , outer(currentTimer)
+{
+    counters->active.fetch_add(1, std::memory_order_relaxed);
+    currentTimer = this;
+}
+
+op_timer::~op_timer()
+{
+    currentTimer = outer;
+    counters->active.fetch_sub(1, std::memory_order_relaxed);
+    counters->latency.record(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start)
+                                 .count());
+    if (rpcs > 0) {
+        counters->wait.record(waitUs);
+        counters->rpc.record(rpcUs);
+    }
+    if (bytes > 0) {
+        counters->bytes.record(bytes);
+    }
+}
+
+void op_timer::note_wait(uint64_t us)
+{
+    if (currentTimer != nullptr) {
+        currentTimer->waitUs += us;
+    }
+}
+
+void op_timer::note_rpc(uint64_t us)
+{
+    if (currentTimer != nullptr) {
+        currentTimer->rpcUs += us;
+        currentTimer->rpcs++;
+    }
+}
+
+void op_timer::note_failure()
+{
+    if (currentTimer != nullptr) {
+        currentTimer->counters->failures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,204 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <boost/thread/mutex.hpp>
+
+// Sub-buckets per power of two, values land within 1/8 of their bucket
+#define OP_HISTOGRAM_SUB_BITS 3
+// Values are clamped below 2^this (about 12 days in us, 1 TiB in bytes)
+#define OP_HISTOGRAM_MAX_BITS 40
+#define OP_HISTOGRAM_BUCKETS ((OP_HISTOGRAM_MAX_BITS - OP_HISTOGRAM_SUB_BITS + 1) << OP_HISTOGRAM_SUB_BITS)
+
+// Virtual directory and file served by the client itself
+#define OP_STATS_DIR "/.tfuse"
+#define OP_STATS_FILE "/.tfuse/stats"
+
+enum class FuseOp : size_t {
+    GETATTR,
+    READLINK,
+    MKNOD,
+    MKDIR,
+    UNLINK,
+    RMDIR,
+    SYMLINK,
+    RENAME,
+    LINK,
+    CHMOD,
+    CHOWN,
+    TRUNCATE,
+    OPEN,
+    READ,
+    WRITE,
+    STATFS,
+    FLUSH,
+    RELEASE,
+    FSYNC,
+    SETXATTR,
+    GETXATTR,
+    LISTXATTR,
+    REMOVEXATTR,
+    OPENDIR,
+    READDIR,
+    RELEASEDIR,
+    FSYNCDIR,
+    ACCESS,
+    CREATE,
+    LOCK,
+    UTIMENS,
+    BMAP,
+    COUNT
+};
+
+/*
+ * Log-linear histogram in the spirit of HdrHistogram. Values below
+ * 2^OP_HISTOGRAM_SUB_BITS get a bucket each, above that every power of two is
+ * split into 2^OP_HISTOGRAM_SUB_BITS buckets. Recording is a few relaxed
+ * atomic increments, readers see a slightly torn but never invalid picture.
+ */
+class latency_histogram {
+public:
+    latency_histogram();
+
+    void record(uint64_t value);
+    // Upper bound of the bucket holding the p-th percentile (0 < p <= 100)
+    uint64_t percentile(double p) const;
+
+    inline uint64_t count() const
+    {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t sum() const
+    {
+        return sumValue.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t max() const
+    {
+        return maxValue.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t bucket_count(size_t idx) const
+    {
+        return buckets[idx].load(std::memory_order_relaxed);
+    }
+
+    static size_t bucket_of(uint64_t value);
+    static uint64_t bucket_upper(size_t idx);
+
+private:
+    std::atomic<uint64_t> buckets[OP_HISTOGRAM_BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sumValue;
+    std::atomic<uint64_t> maxValue;
+};
+
+struct op_counters {
+    // Whole callback, from entry to return
+    latency_histogram latency;
+    // Time spent waiting for pool clients and inside RPCs, per call that made any
+    latency_histogram wait;
+    latency_histogram rpc;
+    // Payload of reads and writes
+    latency_histogram bytes;
+    // RPCs that threw instead of returning a status
+    std::atomic<uint64_t> failures { 0 };
+    // Callbacks running right now
+    std::atomic<int64_t> active { 0 };
+};
+
+/*
+ * Per operation counters of a mount plus the snapshots handed out through
+ * OP_STATS_FILE. Each snapshot is rendered once at open so a reader sees a
+ * consistent table however it splits its reads.
+ */
+class op_stats {
+public:
+    op_stats();
+
+    inline op_counters& of(FuseOp op)
+    {
+        return counters[static_cast<size_t>(op)];
+    }
+
+    inline const op_counters& of(FuseOp op) const
+    {
+        return counters[static_cast<size_t>(op)];
+    }
+
+    static const char* name(FuseOp op);
+
+    // Table of every operation called so far, percentiles in microseconds.
+    // backend counts the calls that made at least one RPC themselves.
+    std::string render() const;
+
+    uint64_t open_snapshot();
+    // Bytes copied, 0 past the end or for an unknown snapshot
+    size_t read_snapshot(uint64_t id, int64_t off, char* buf, size_t size);
+    void release_snapshot(uint64_t id);
+
+private:
+    op_counters counters[static_cast<size_t>(FuseOp::COUNT)];
+
+    boost::mutex lock;
+    std::unordered_map<uint64_t, std::string> snapshots;
+    uint64_t nextSnapshot = 1;
+};
+
+/*
+ * Times one FUSE callback into its op_counters. THRIFT_POOL_CALL reports the
+ * client wait and RPC time of every call the thread makes while the timer is
+ * alive, calls made on other threads (read-ahead, batches led by another
+ * caller) count only towards the latency of the callback.
+ */
+class op_timer {
+public:
+    op_timer(op_stats* stats, FuseOp op);
+    ~op_timer();
+
+    inline void moved(size_t size)
+    {
+        bytes += size;
+    }
+
+    static void note_wait(uint64_t us);
+    static void note_rpc(uint64_t us);
+    static void note_failure();
+
+private:
+    op_timer(const op_timer&) = delete;
+    op_timer& operator=(const op_timer&) = delete;
+
+    op_counters* counters;
+    std::chrono::steady_clock::time_point start;
+    uint64_t waitUs = 0;
+    uint64_t rpcUs = 0;
+    uint64_t rpcs = 0;
+    uint64_t bytes = 0;
+    op_timer* outer;
+};
@@ -0,0 +1,251 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <algorithm>
+
+#include <page_cache.h>
+
+page_cache::page_cache(size_t capacityBytes, size_t blockSize, size_t count)
+    : shardCount(std::min<size_t>(std::max<size_t>(count, 1), PAGE_CACHE_MAX_SHARDS))
+    , hitCount(0)
+    , missCount(0)
+{
+    shardCapacity = std::max<size_t>(capacityBytes / std::max<size_t>(blockSize, 1) / shardCount, 1);
+    shards.reset(new arc_shard[shardCount]);
+}
+
+page_cache::arc_shard& page_cache::shard_of(const page_key& key)
+{
+    return shards[page_key_hash()(key) % shardCount];
+}
+
+uint64_t page_cache::shard_bit(const arc_shard& shard) const
+{
+    return 1ull << (&shard - shards.get());
+}
+
+std::list<page_cache::page_key>& page_cache::list_of(arc_shard& shard, arc_list list)
+{
+    switch (list) {
+    case arc_list::T1:
+        return shard.t1;
+    case arc_list::T2:
+        return shard.t2;
+    case arc_list::B1:
+        return shard.b1;
+    default:
+        return shard.b2;
+    }
+}
+
+cached_page_ptr page_cache::get(const std::string& path, int64_t index, const Fuse::FuseStat& stat)
+{
+    page_key key { path, index };
+    auto& shard = shard_of(key);
+    boost::mutex::scoped_lock guard(shard.lock);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end() || it->second.page == nullptr) {
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto page = it->second.page;
+    if (page->fileSize != stat.size || page->mtime != stat.modificationTime) {
+        erase_locked(shard, key);
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // Seen again, T2 holds it from now on
+    move_locked(shard, it->second, arc_list::T2);
+    hitCount.fetch_add(1, std::memory_order_relaxed);
+    return page;
+}
+
+void page_cache::put(const std::string& path, int64_t index, cached_page_ptr page)
+{
+    page_key key { path, index };
+    auto& shard = shard_of(key);
+    boost::mutex::scoped_lock guard(shard.lock);
+    auto it = shard.entries.find(key);
+
+    if (it != shard.entries.end() && it->second.page != nullptr) {
+        // Another reader fetched it at the same time
+        it->second.page = page;
+        move_locked(shard, it->second, arc_list::T2);
+        return;
+    }
+
+    if (it != shard.entries.end()) {
+        // A ghost hit, had the list it was evicted from been larger this
+        // would have been a hit. Grow that list's share and bring it back
+        // as a frequently used page.
+        size_t b1 = shard.b1.size();
+        size_t b2 = shard.b2.size();
+        bool ghostOfT2 = it->second.list == arc_list::B2;
+        if (ghostOfT2) {
+            size_t delta = std::max<size_t>(b2 > 0 ? b1 / b2 : 1, 1);
+            shard.target = shard.target > delta ? shard.target - delta : 0;
+        } else {
+            size_t delta = std::max<size_t>(b1 > 0 ? b2 / b1 : 1, 1);
+            shard.target = std::min(shard.target + delta, shardCapacity);
+        }
+        replace_locked(shard, ghostOfT2);
+        it->second.page = page;
+        move_locked(shard, it->second, arc_list::T2);
+        add_resident_locked(shard, path, index);
+        return;
+    }
+
+    size_t t1 = shard.t1.size();
+    size_t b1 = shard.b1.size();
+    size_t total = t1 + shard.t2.size() + b1 + shard.b2.size();
+    if (t1 + b1 >= shardCapacity) {
+        if (t1 < shardCapacity) {
+            drop_lru_locked(shard, arc_list::B1);
+            replace_locked(shard, false);
+        } else {
+            drop_lru_locked(shard, arc_list::T1);
+        }
+    } else if (total >= shardCapacity) {
+        if (total >= 2 * shardCapacity) {
+            drop_lru_locked(shard, arc_list::B2);
+        }
+        replace_locked(shard, false);
+    }
+
+    shard.t1.push_front(key);
+    shard.entries[key] = { arc_list::T1, shard.t1.begin(), page };
+    add_resident_locked(shard, path, index);
+}
+
+void page_cache::invalidate(const std::string& path)
+{
+    uint64_t mask;
+    {
+        boost::mutex::scoped_lock guard(indexLock);
+        auto held = shardsOf.find(path);
+        if (held == shardsOf.end()) {
+            return;
+        }
+        mask = held->second;
+    }
+    for (size_t i = 0; i < shardCount; i++) {
+        if ((mask & (1ull << i)) == 0) {
+            continue;
+        }
+        auto& shard = shards[i];
+        boost::mutex::scoped_lock guard(shard.lock);
+        auto file = shard.resident.find(path);
+        if (file == shard.resident.end()) {
+            continue;
+        }
+        auto indexes = file->second;
+        for (auto index : indexes) {
+            erase_locked(shard, { path, index });
+        }
+    }
+}
+
+void page_cache::move_locked(arc_shard& shard, arc_entry& entry, arc_list to)
+{
+    auto& from = list_of(shard, entry.list);
+    auto& dest = list_of(shard, to);
+    dest.splice(dest.begin(), from, entry.position);
+    entry.list = to;
+    entry.position = dest.begin();
+}
+
+/*
+ * Make room for one page: evict the LRU page of T1 when T1 is above its
+ * target, of T2 otherwise. Evicted keys are remembered as ghosts.
+ */
+void page_cache::replace_locked(arc_shard& shard, bool ghostOfT2)
+{
+    size_t t1 = shard.t1.size();
+    bool fromT1 = t1 > 0 && (t1 > shard.target || (ghostOfT2 && t1 == shard.target));
+    if (!fromT1 && shard.t2.empty()) {
+        fromT1 = t1 > 0;
+    }
+    if (!fromT1 && shard.t2.empty()) {
+        return;
+    }
+
+    auto& list = fromT1 ? shard.t1 : shard.t2;
+    auto key = list.back();
+    auto& entry = shard.entries[key];
+    remove_resident_locked(shard, key.path, key.index);
+    entry.page.reset();
+    move_locked(shard, entry, fromT1 ? arc_list::B1 : arc_list::B2);
+}
+
+void page_cache::drop_lru_locked(arc_shard& shard, arc_list list)
+{
+    auto& keys = list_of(shard, list);
+    if (!keys.empty()) {
+        auto key = keys.back();
+        erase_locked(shard, key);
+    }
+}
+
+void page_cache::erase_locked(arc_shard& shard, const page_key& key)
+{
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        return;
+    }
+    if (it->second.page != nullptr) {
+        remove_resident_locked(shard, key.path, key.index);
+    }
+    list_of(shard, it->second.list).erase(it->second.position);
+    shard.entries.erase(it);
+}
+
+void page_cache::add_resident_locked(arc_shard& shard, const std::string& path, int64_t index)
+{
+    auto& pages = shard.resident[path];
+    if (pages.empty()) {
+        boost::mutex::scoped_lock guard(indexLock);
+        shardsOf[path] |= shard_bit(shard);
+    }
+    pages.insert(index);
+}
+
+void page_cache::remove_resident_locked(arc_shard& shard, const std::string& path, int64_t index)
+{
+    auto file = shard.resident.find(path);
+    if (file == shard.resident.end()) {
+        return;
+    }
+    file->second.erase(index);
+    if (!file->second.empty()) {
+        return;
+    }
+    shard.resident.erase(file);
+    // Last page of the path in this shard
+    boost::mutex::scoped_lock guard(indexLock);
+    auto held = shardsOf.find(path);
+    if (held != shardsOf.end()) {
+        held->second &= ~shard_bit(shard);
+        if (held->second == 0) {
+            shardsOf.erase(held);
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <boost/thread/mutex.hpp>
+
+#include <FuseService.h>
+
+// Block size shared by the page and disk caches
+#define READ_CACHE_DEFAULT_BLOCK (256 * 1024)
+#define PAGE_CACHE_DEFAULT_CAPACITY_MB 256
+#define PAGE_CACHE_DEFAULT_SHARDS 16
+// One bit per shard in the index of the shards holding a path
+#define PAGE_CACHE_MAX_SHARDS 64
+
+/*
+ * One block of file content, with the attributes the file had when the
+ * block was fetched.
+ */
+struct cached_page {
+    std::string data;
+    int64_t fileSize;
+    int32_t mtime;
+};
+
+typedef std::shared_ptr<const cached_page> cached_page_ptr;
+
+/*
+ * In-memory file content cache with ARC eviction.
+ *
+ * Each shard splits its pages between a list of pages seen once (T1) and a
+ * list of pages seen again (T2), and remembers the keys it recently evicted
+ * from either (B1, B2). A miss that hits a remembered key moves the target
+ * size of T1 towards the list that would have kept it. A long sequential
+ * read only ever cycles through T1, the working set in T2 stays put.
+ *
+ * Pages are sharded by path and block, a single large file can fill the
+ * whole capacity and its readers spread over all the shard locks. A mask of
+ * the shards holding pages of each path lets dropping it, as every write
+ * does, lock only those. Every page counts as a whole block against the
+ * capacity, so the memory used never exceeds it. Pages are validated against the file's size
+ * and mtime like the disk cache, and changes made through this mount drop
+ * the pages of the path.
+ */
+class page_cache {
+public:
+    page_cache(size_t capacityBytes, size_t blockSize, size_t shardCount);
+
+    // Page index of path if cached and the file still matches stat, else null
+    cached_page_ptr get(const std::string& path, int64_t index, const Fuse::FuseStat& stat);
+    void put(const std::string& path, int64_t index, cached_page_ptr page);
+    void invalidate(const std::string& path);
+
+    inline uint64_t hits() const
+    {
+        return hitCount.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t misses() const
+    {
+        return missCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    enum class arc_list {
+        T1,
+        T2,
+        B1,
+        B2
+    };
+
+    struct page_key {
+        std::string path;
+        int64_t index;
+
+        bool operator==(const page_key& other) const
+        {
+            return index == other.index && path == other.path;
+        }
+    };
+
+    struct page_key_hash {
+        size_t operator()(const page_key& key) const
+        {
+            return std::hash<std::string>()(key.path) ^ (std::hash<int64_t>()(key.index) * 31);
+        }
+    };
+
+    struct arc_entry {
+        arc_list list;
+        std::list<page_key>::iterator position;
+        // Null while the key is a ghost in B1 or B2
+        cached_page_ptr page;
+    };
+
+    struct arc_shard {
+        boost::mutex lock;
+        // Most recently used at the front
+        std::list<page_key> t1, t2, b1, b2;
+        std::unordered_map<page_key, arc_entry, page_key_hash> entries;
+        // Resident page indexes of every path, for invalidation
+        std::unordered_map<std::string, std::unordered_set<int64_t>> resident;
+        // Target size of T1
+        size_t target = 0;
+    };
+
+    arc_shard& shard_of(const page_key& key);
+    uint64_t shard_bit(const arc_shard& shard) const;
+    // Keep resident and shardsOf in step, the shard lock held
+    void add_resident_locked(arc_shard& shard, const std::string& path, int64_t index);
+    void remove_resident_locked(arc_shard& shard, const std::string& path, int64_t index);
+    std::list<page_key>& list_of(arc_shard& shard, arc_list list);
+    void move_locked(arc_shard& shard, arc_entry& entry, arc_list to);
+    void replace_locked(arc_shard& shard, bool ghostOfT2);
+    void drop_lru_locked(arc_shard& shard, arc_list list);
+    void erase_locked(arc_shard& shard, const page_key& key);
+
+    size_t shardCapacity;
+    size_t shardCount;
+    std::unique_ptr<arc_shard[]> shards;
+
+    // Taken inside a shard lock, never the other way round
+    boost::mutex indexLock;
+    std::unordered_map<std::string, uint64_t> shardsOf;
+
+    std::atomic<uint64_t> hitCount;
+    std::atomic<uint64_t> missCount;
+};
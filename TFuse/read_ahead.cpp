@@ -0,0 +1,167 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <read_ahead.h>
+
+#include <algorithm>
+#include <cstring>
+
+size_t read_stream::serve(int64_t off, char* buf, size_t size, bool& eof)
+{
+    size_t done = 0;
+    eof = false;
+    while (done < size) {
+        int64_t pos = off + static_cast<int64_t>(done);
+        int64_t windowOffset = 0;
+        uint32_t windowLength = 0;
+        std::shared_future<read_chunk_ptr> data;
+        {
+            boost::mutex::scoped_lock guard(lock);
+            while (!windows.empty() && windows.front().offset + windows.front().size <= pos) {
+                windows.pop_front();
+            }
+            auto it = std::find_if(windows.begin(), windows.end(), [pos](const window& w) {
+                return w.offset <= pos && pos < w.offset + w.size;
+            });
+            if (it == windows.end()) {
+                break;
+            }
+            windowOffset = it->offset;
+            windowLength = it->size;
+            data = it->data;
+        }
+
+        read_chunk_ptr chunk = data.get();
+        if (chunk->status != 0) {
+            // Let the caller retry synchronously and report the error itself
+            reset();
+            break;
+        }
+
+        size_t idx = static_cast<size_t>(pos - windowOffset);
+        if (idx >= chunk->data.size()) {
+            eof = true;
+            break;
+        }
+        size_t count = std::min(size - done, chunk->data.size() - idx);
+        memcpy(buf + done, chunk->data.data() + idx, count);
+        done += count;
+
+        if (chunk->data.size() < windowLength && idx + count == chunk->data.size()) {
+            eof = true;
+            break;
+        }
+    }
+    return done;
+}
+
+void read_stream::record(int64_t off, size_t len, bool eof)
+{
+    boost::mutex::scoped_lock guard(lock);
+    if (off == lastEnd) {
+        sequential++;
+        if (sequential > config.trigger) {
+            windowSize = std::min(windowSize * 2, config.maxWindow);
+        }
+    } else if (lastEnd >= 0) {
+        reset_locked();
+    }
+    lastEnd = off + static_cast<int64_t>(len);
+    if (eof) {
+        eofOffset = lastEnd;
+    }
+}
+
+bool read_stream::plan(int64_t& off, uint32_t& size)
+{
+    boost::mutex::scoped_lock guard(lock);
+    if (sequential < config.trigger || lastEnd < 0) {
+        return false;
+    }
+
+    size_t ahead = 0;
+    for (auto& w : windows) {
+        if (w.offset + w.size > lastEnd) {
+            ahead++;
+        }
+    }
+    if (ahead >= config.windows) {
+        return false;
+    }
+
+    off = std::max(prefetchEnd, lastEnd);
+    if (eofOffset >= 0 && off >= eofOffset) {
+        return false;
+    }
+    size = windowSize;
+    return true;
+}
+
+bool read_stream::add_window(int64_t off, uint32_t size, std::shared_future<read_chunk_ptr> data)
+{
+    boost::mutex::scoped_lock guard(lock);
+    if (off < prefetchEnd) {
+        return false;
+    }
+    windows.push_back({ off, size, data });
+    prefetchEnd = off + size;
+    return true;
+}
+
+void read_stream::reset_locked()
+{
+    sequential = 0;
+    windowSize = config.minWindow;
+    prefetchEnd = 0;
+    eofOffset = -1;
+    windows.clear();
+}
+
+void read_stream::reset()
+{
+    boost::mutex::scoped_lock guard(lock);
+    reset_locked();
+}
+
+read_stream_ptr read_ahead_table::get(uint64_t fh, const std::string& path)
+{
+    boost::mutex::scoped_lock guard(lock);
+    auto& stream = streams[fh];
+    if (stream == nullptr || stream->get_path() != path) {
+        stream = std::make_shared<read_stream>(path, config);
+    }
+    return stream;
+}
+
+void read_ahead_table::remove(uint64_t fh)
+{
+    boost::mutex::scoped_lock guard(lock);
+    streams.erase(fh);
+}
+
+void read_ahead_table::invalidate(const std::string& path)
+{
+    boost::mutex::scoped_lock guard(lock);
+    for (auto& entry : streams) {
+        if (entry.second->get_path() == path) {
+            entry.second->reset();
+        }
+    }
+}
@@ -0,0 +1,144 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <boost/thread/mutex.hpp>
+
+#define READ_AHEAD_DEFAULT_WINDOWS 4
+#define READ_AHEAD_DEFAULT_MIN_WINDOW (128 * 1024)
+#define READ_AHEAD_DEFAULT_MAX_WINDOW (1024 * 1024)
+// Back to back reads needed before windows are issued
+#define READ_AHEAD_DEFAULT_TRIGGER 2
+
+struct read_ahead_config {
+    uint32_t windows = READ_AHEAD_DEFAULT_WINDOWS;
+    uint32_t minWindow = READ_AHEAD_DEFAULT_MIN_WINDOW;
+    uint32_t maxWindow = READ_AHEAD_DEFAULT_MAX_WINDOW;
+    uint32_t trigger = READ_AHEAD_DEFAULT_TRIGGER;
+};
+
+/*
+ * Result of one prefetched read RPC.
+ */
+struct read_chunk {
+    int status = 0;
+    std::string data;
+};
+
+typedef std::shared_ptr<read_chunk> read_chunk_ptr;
+
+/*
+ * Read-ahead state of one open file handle.
+ *
+ * Reads that continue exactly where the previous one ended count as
+ * sequential. After config.trigger of them up to config.windows windows are
+ * kept in flight past the last read, each window doubling in size up to
+ * maxWindow. A read anywhere else drops the windows and starts over from
+ * minWindow.
+ */
+class read_stream {
+private:
+    struct window {
+        int64_t offset;
+        uint32_t size;
+        std::shared_future<read_chunk_ptr> data;
+    };
+
+    boost::mutex lock;
+    const read_ahead_config& config;
+    std::string path;
+
+    int64_t lastEnd = -1;
+    uint32_t sequential = 0;
+    uint32_t windowSize;
+    // End of the furthest window issued so far
+    int64_t prefetchEnd = 0;
+    // Known end of file, -1 until a short read was seen
+    int64_t eofOffset = -1;
+    std::deque<window> windows;
+
+    void reset_locked();
+
+public:
+    read_stream(const std::string& filePath, const read_ahead_config& conf)
+        : config(conf)
+        , path(filePath)
+        , windowSize(conf.minWindow)
+    {
+    }
+
+    inline const std::string& get_path() const
+    {
+        return path;
+    }
+
+    /*
+     * Copy what the windows hold for [off, off + size) into buf, waiting for
+     * windows still in flight. Returns the number of bytes copied, stops at
+     * the first gap; eof is set when the file ends inside the served range.
+     */
+    size_t serve(int64_t off, char* buf, size_t size, bool& eof);
+
+    // Account a completed read of len bytes at off
+    void record(int64_t off, size_t len, bool eof);
+
+    // Next window worth fetching, false if nothing should be issued now
+    bool plan(int64_t& off, uint32_t& size);
+    // Register a window returned by plan, false if another reader got there first
+    bool add_window(int64_t off, uint32_t size, std::shared_future<read_chunk_ptr> data);
+
+    void reset();
+};
+
+typedef std::shared_ptr<read_stream> read_stream_ptr;
+
+/*
+ * Open file handles mapped to their read-ahead state.
+ */
+class read_ahead_table {
+private:
+    boost::mutex lock;
+    read_ahead_config config;
+    std::unordered_map<uint64_t, read_stream_ptr> streams;
+
+public:
+    read_ahead_table(const read_ahead_config& conf)
+        : config(conf)
+    {
+    }
+
+    inline bool enabled() const
+    {
+        return config.windows > 0 && config.minWindow > 0;
+    }
+
+    read_stream_ptr get(uint64_t fh, const std::string& path);
+    void remove(uint64_t fh);
+    // Data of path changed, drop everything prefetched for it
+    void invalidate(const std::string& path);
+};
@@ -0,0 +1,71 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <limits>
+
+#include <boost/algorithm/string.hpp>
+
+#include <replica_set.h>
+
+replica_set::replica_set(client_pool* primary, const std::vector<client_pool*>& replicas, bool readFromPrimary)
+    : primaryPool(primary)
+{
+    allPools.push_back(primary);
+    allPools.insert(allPools.end(), replicas.begin(), replicas.end());
+    if (readFromPrimary || replicas.empty()) {
+        readers.push_back(primary);
+    }
+    readers.insert(readers.end(), replicas.begin(), replicas.end());
+}
+
+std::vector<std::string> replica_set::targets_from_config(const boost::property_tree::ptree& config, size_t shard)
+{
+    std::vector<std::string> targets;
+    auto listed = config.get<std::string>("REPLICAS." + std::to_string(shard), "");
+    std::vector<std::string> split;
+    boost::split(split, listed, boost::is_any_of(","));
+    for (auto& target : split) {
+        boost::trim(target);
+        if (!target.empty()) {
+            targets.push_back(target);
+        }
+    }
+    return targets;
+}
+
+client_pool* replica_set::pick_reader() const
+{
+    if (readers.size() == 1) {
+        return readers.front();
+    }
+
+    // Expected wait if this call queued behind the ones already out, the +1s
+    // keep an idle or not yet measured reader from scoring zero
+    client_pool* best = readers.front();
+    uint64_t bestScore = std::numeric_limits<uint64_t>::max();
+    for (auto pool : readers) {
+        uint64_t score = (pool->latency() + 1) * (pool->outstanding() + 1);
+        if (score < bestScore) {
+            best = pool;
+            bestScore = score;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,72 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <client_pool.h>
+
+/*
+ * The backends holding one shard's data: a primary and any number of read
+ * replicas listed in [REPLICAS] under the shard's index.
+ *
+ * Everything that changes state goes to the primary. getattr, readdir, read,
+ * readlink and getxattr go to whichever reader promises the quickest answer,
+ * its moving average latency scaled by the callers it is already serving.
+ * The primary is a reader too unless READ_FROM_PRIMARY is false.
+ *
+ * Replicas know nothing of the handles the primary gave out, calls sent to
+ * them go by path. They are expected to hold the same tree and list
+ * directories in the same order, a replica that lags shows stale data.
+ */
+class replica_set {
+public:
+    replica_set(client_pool* primary, const std::vector<client_pool*>& replicas, bool readFromPrimary);
+
+    // Replica targets of a shard in config.ini, empty when it has none
+    static std::vector<std::string> targets_from_config(const boost::property_tree::ptree& config, size_t shard);
+
+    inline client_pool* primary() const
+    {
+        return primaryPool;
+    }
+
+    inline bool is_primary(const client_pool* pool) const
+    {
+        return pool == primaryPool;
+    }
+
+    client_pool* pick_reader() const;
+
+    // Primary first, then the replicas
+    inline const std::vector<client_pool*>& pools() const
+    {
+        return allPools;
+    }
+
+private:
+    client_pool* primaryPool;
+    std::vector<client_pool*> allPools;
+    std::vector<client_pool*> readers;
+};
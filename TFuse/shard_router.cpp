@@ -0,0 +1,144 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include <Logger.h>
+#include <path_util.h>
+#include <shard_router.h>
+
+shard_router::shard_router(const std::vector<std::string>& targets,
+    ShardMode shardMode,
+    const std::vector<std::pair<std::string, size_t>>& shardPrefixes)
+    : shardCount(targets.size())
+    , mode(shardMode)
+    , prefixes(shardPrefixes)
+{
+    // Ring points derive from the target name, not the index, so reordering
+    // TARGETS does not move anything
+    for (size_t shard = 0; shard < shardCount; shard++) {
+        for (int point = 0; point < SHARD_RING_POINTS; point++) {
+            ring.emplace_back(hash(targets[shard] + "#" + std::to_string(point)), shard);
+        }
+    }
+    std::sort(ring.begin(), ring.end());
+
+    for (auto& prefix : prefixes) {
+        while (prefix.first.size() > 1 && prefix.first.back() == '/') {
+            prefix.first.pop_back();
+        }
+        if (prefix.second >= shardCount) {
+            throw std::invalid_argument("Shard index out of range for prefix " + prefix.first);
+        }
+    }
+    std::sort(prefixes.begin(), prefixes.end(),
+        [](const std::pair<std::string, size_t>& a, const std::pair<std::string, size_t>& b) {
+            return a.first.size() > b.first.size();
+        });
+}
+
+std::vector<std::string> shard_router::targets_from_config(const boost::property_tree::ptree& config)
+{
+    std::vector<std::string> targets { config.get<std::string>("THRIFT.TARGET") };
+
+    auto extra = config.get<std::string>("SHARDS.TARGETS", "");
+    std::vector<std::string> split;
+    boost::split(split, extra, boost::is_any_of(","));
+    for (auto& target : split) {
+        boost::trim(target);
+        if (!target.empty()) {
+            targets.push_back(target);
+        }
+    }
+    return targets;
+}
+
+shard_router* shard_router::from_config(const boost::property_tree::ptree& config)
+{
+    auto targets = targets_from_config(config);
+
+    auto modeName = config.get<std::string>("SHARDS.MODE", SHARD_MODE_HASH);
+    ShardMode mode;
+    if (modeName == SHARD_MODE_HASH) {
+        mode = ShardMode::HASH;
+    } else if (modeName == SHARD_MODE_PREFIX) {
+        mode = ShardMode::PREFIX;
+    } else {
+        throw std::invalid_argument("Invalid shard mode " + modeName);
+    }
+
+    std::vector<std::pair<std::string, size_t>> prefixes;
+    for (auto& entry : config.get_child("SHARD_PREFIXES", boost::property_tree::ptree())) {
+        prefixes.emplace_back(entry.first, entry.second.get_value<size_t>());
+    }
+
+    if (targets.size() > 1) {
+        LOG_INFO << "Routing over " << targets.size() << " shards in " << modeName << " mode";
+    }
+    return new shard_router(targets, mode, prefixes);
+}
+
+size_t shard_router::route(const std::string& path) const
+{
+    if (shardCount == 1) {
+        return 0;
+    }
+
+    if (mode == ShardMode::PREFIX) {
+        for (auto& prefix : prefixes) {
+            if (is_path_under(path, prefix.first)) {
+                return prefix.second;
+            }
+        }
+        return 0;
+    }
+
+    // HASH, keyed by the top level entry the path lives under
+    size_t begin = path.find_first_not_of('/');
+    if (begin == std::string::npos) {
+        return 0;
+    }
+    size_t end = path.find('/', begin);
+    auto key = hash(path.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+
+    auto it = std::lower_bound(ring.begin(), ring.end(), std::make_pair(key, size_t(0)));
+    if (it == ring.end()) {
+        it = ring.begin();
+    }
+    return it->second;
+}
+
+// 64 bit FNV-1a with a final mix
+uint64_t shard_router::hash(const std::string& key)
+{
+    uint64_t value = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        value ^= c;
+        value *= 1099511628211ULL;
+    }
+    // Spread similar names over the whole ring
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    return value;
+}
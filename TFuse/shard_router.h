@@ -0,0 +1,103 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#define SHARD_MODE_HASH "HASH"
+#define SHARD_MODE_PREFIX "PREFIX"
+// Points every shard puts on the hash ring
+#define SHARD_RING_POINTS 64
+// Bits of a merged root listing cookie left for the offset within a shard
+#define SHARD_COOKIE_SHIFT 48
+
+enum class ShardMode {
+    HASH,
+    PREFIX
+};
+
+/*
+ * Maps paths onto the backends of a mount.
+ *
+ * Shard 0 is [THRIFT] TARGET, [SHARDS] TARGETS follow in order. In HASH mode
+ * every top level entry lives with everything below it on the shard its name
+ * hashes to on a consistent hash ring, so adding a target moves only about
+ * 1/n of them. Root itself belongs to shard 0 and its listing is stitched
+ * together from all shards. In PREFIX mode the subtrees listed in
+ * [SHARD_PREFIXES] go to their shard and all else to shard 0.
+ *
+ * Paths of different shards share no namespace, rename and link across them
+ * fail with EXDEV.
+ */
+class shard_router {
+public:
+    shard_router(const std::vector<std::string>& targets,
+        ShardMode mode,
+        const std::vector<std::pair<std::string, size_t>>& prefixes);
+
+    // Targets of all shards in config.ini, shard 0 first
+    static std::vector<std::string> targets_from_config(const boost::property_tree::ptree& config);
+    static shard_router* from_config(const boost::property_tree::ptree& config);
+
+    size_t route(const std::string& path) const;
+
+    inline size_t count() const
+    {
+        return shardCount;
+    }
+
+    // True when the listing of path spans all shards (root in HASH mode)
+    inline bool merges_listing(const std::string& path) const
+    {
+        return mode == ShardMode::HASH && shardCount > 1 && path == "/";
+    }
+
+    // Offsets of a merged listing carry the shard in their top bits
+    static inline int64_t listing_cookie(size_t shard, int64_t offset)
+    {
+        return (static_cast<int64_t>(shard) << SHARD_COOKIE_SHIFT) | offset;
+    }
+
+    static inline size_t listing_shard(int64_t cookie)
+    {
+        return static_cast<size_t>(cookie >> SHARD_COOKIE_SHIFT);
+    }
+
+    static inline int64_t listing_offset(int64_t cookie)
+    {
+        return cookie & ((int64_t(1) << SHARD_COOKIE_SHIFT) - 1);
+    }
+
+private:
+    static uint64_t hash(const std::string& key);
+
+    size_t shardCount;
+    ShardMode mode;
+    // Sorted ring points and the shard owning the arc up to each
+    std::vector<std::pair<uint64_t, size_t>> ring;
+    // Longest prefix first
+    std::vector<std::pair<std::string, size_t>> prefixes;
+};
@@ -0,0 +1,301 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Shared memory segment layout used by the SHARED_MEMORY transport.
+ *
+ * The backend creates a named segment (TARGET in config.ini) holding a fixed
+ * number of channels. Every channel carries two single-producer/single-consumer
+ * byte rings: requests flow client -> server and responses server -> client.
+ * A thrift_client claims one channel for its lifetime, so each ring only ever
+ * has one writer and one reader and needs no locks. The backend serves every
+ * channel from its own thread.
+ *
+ *  +----------------+----------------------+-------------+--------------+
+ *  | shm_segment    | shm_channel[0]       | req data[0] | resp data[0] | ...
+ *  +----------------+----------------------+-------------+--------------+
+ *
+ * Positions are free running 32 bit counters, the ring capacity must be a
+ * power of two. Waiting sides spin for a short window and then sleep on a
+ * futex word that the other side bumps when it publishes data or space.
+ *
+ * A claim stores the client's pid in owner, a channel whose owner died
+ * without releasing it is taken over by the next client. Every claim bumps
+ * generation and waits until the backend acknowledged it in
+ * served_generation: by then the backend dropped the request bytes and any
+ * half written response of the previous owner, and stopped writing for it.
+ * The new owner then skips what is left in the response ring.
+ */
+
+#define SHM_SEGMENT_MAGIC 0x54465348 // "TFSH"
+#define SHM_SEGMENT_VERSION 2
+#define SHM_CACHE_LINE 64
+
+// owner of an unclaimed channel
+#define SHM_CHANNEL_FREE 0
+
+struct alignas(SHM_CACHE_LINE) shm_ring_ctl {
+    // Producer side
+    alignas(SHM_CACHE_LINE) std::atomic<uint32_t> head;
+    std::atomic<uint32_t> space_seq;
+    std::atomic<uint32_t> space_waiters;
+
+    // Consumer side
+    alignas(SHM_CACHE_LINE) std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> data_seq;
+    std::atomic<uint32_t> data_waiters;
+};
+
+struct alignas(SHM_CACHE_LINE) shm_channel {
+    // Process id of the client holding the channel
+    std::atomic<uint32_t> owner;
+    // Bumped by the client on every claim
+    std::atomic<uint32_t> generation;
+    // Last generation the server synchronized to
+    std::atomic<uint32_t> served_generation;
+    shm_ring_ctl request;
+    shm_ring_ctl response;
+};
+
+struct alignas(SHM_CACHE_LINE) shm_segment {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t channel_count;
+    uint32_t ring_capacity;
+    std::atomic<uint32_t> server_ready;
+};
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+    "shared memory rings require address free atomics");
+
+namespace shm {
+
+inline size_t channel_stride(uint32_t ringCapacity)
+{
+    return sizeof(shm_channel) + 2 * static_cast<size_t>(ringCapacity);
+}
+
+inline size_t segment_size(uint32_t channelCount, uint32_t ringCapacity)
+{
+    return sizeof(shm_segment) + channelCount * channel_stride(ringCapacity);
+}
+
+inline shm_channel* get_channel(shm_segment* segment, uint32_t idx)
+{
+    auto base = reinterpret_cast<uint8_t*>(segment) + sizeof(shm_segment);
+    return reinterpret_cast<shm_channel*>(base + idx * channel_stride(segment->ring_capacity));
+}
+
+inline uint8_t* request_data(shm_channel* channel)
+{
+    return reinterpret_cast<uint8_t*>(channel) + sizeof(shm_channel);
+}
+
+inline uint8_t* response_data(shm_channel* channel, uint32_t ringCapacity)
+{
+    return request_data(channel) + ringCapacity;
+}
+
+inline uint32_t current_pid()
+{
+#if defined(_WIN32)
+    return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+/*
+ * Whether the process holding a channel still runs. A pid the OS handed to
+ * another process since keeps the channel taken, which costs a channel and
+ * not correctness.
+ */
+inline bool pid_alive(uint32_t pid)
+{
+#if defined(_WIN32)
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(pid));
+    if (process == nullptr) {
+        return GetLastError() == ERROR_ACCESS_DENIED;
+    }
+    bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return running;
+#else
+    return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+#endif
+}
+
+/*
+ * Sleep on a shared futex word until it differs from expected or the timeout
+ * expires. Only Linux futexes work across processes; other platforms fall
+ * back to a short sleep and let the caller re-check.
+ */
+inline void wait_word(std::atomic<uint32_t>* word, uint32_t expected, uint32_t timeoutMs)
+{
+#if defined(__linux__)
+    struct timespec ts;
+    ts.tv_sec = timeoutMs / 1000;
+    ts.tv_nsec = (timeoutMs % 1000) * 1000000L;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+#else
+    if (word->load(std::memory_order_acquire) == expected) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+#endif
+}
+
+inline void wake_word(std::atomic<uint32_t>* word)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+/*
+ * Publish the producer position and wake the consumer if it went to sleep.
+ */
+inline void publish(shm_ring_ctl* ring, uint32_t head)
+{
+    ring->head.store(head, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring->data_waiters.load(std::memory_order_relaxed) != 0) {
+        ring->data_seq.fetch_add(1, std::memory_order_release);
+        wake_word(&ring->data_seq);
+    }
+}
+
+/*
+ * Release consumed bytes back to the producer and wake it if it is blocked
+ * on a full ring.
+ */
+inline void consume(shm_ring_ctl* ring, uint32_t tail)
+{
+    ring->tail.store(tail, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring->space_waiters.load(std::memory_order_relaxed) != 0) {
+        ring->space_seq.fetch_add(1, std::memory_order_release);
+        wake_word(&ring->space_seq);
+    }
+}
+
+/*
+ * Block until ready() is true. Spins for spinUs before sleeping on the futex
+ * word, returns false once timeoutMs elapsed without progress.
+ */
+template <typename Ready>
+inline bool wait_until(Ready ready,
+    std::atomic<uint32_t>* seq,
+    std::atomic<uint32_t>* waiters,
+    uint32_t spinUs,
+    uint32_t timeoutMs)
+{
+    if (ready()) {
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto spinEnd = start + std::chrono::microseconds(spinUs);
+    while (std::chrono::steady_clock::now() < spinEnd) {
+        if (ready()) {
+            return true;
+        }
+    }
+
+    auto deadline = start + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        waiters->fetch_add(1, std::memory_order_seq_cst);
+        uint32_t observed = seq->load(std::memory_order_acquire);
+        if (ready()) {
+            waiters->fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (timeoutMs != 0 && now >= deadline) {
+            waiters->fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        uint32_t sleepMs = 100;
+        if (timeoutMs != 0) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1;
+            sleepMs = left < sleepMs ? static_cast<uint32_t>(left) : sleepMs;
+        }
+        wait_word(seq, observed, sleepMs);
+        waiters->fetch_sub(1, std::memory_order_relaxed);
+
+        if (ready()) {
+            return true;
+        }
+    }
+}
+
+/*
+ * Copy len bytes into / out of a ring at a free running position,
+ * handling the wrap around at the end of the data area.
+ */
+inline void copy_in(uint8_t* data, uint32_t capacity, uint32_t pos, const uint8_t* src, uint32_t len)
+{
+    uint32_t idx = pos & (capacity - 1);
+    uint32_t first = capacity - idx < len ? capacity - idx : len;
+    memcpy(data + idx, src, first);
+    if (first < len) {
+        memcpy(data, src + first, len - first);
+    }
+}
+
+inline void copy_out(const uint8_t* data, uint32_t capacity, uint32_t pos, uint8_t* dst, uint32_t len)
+{
+    uint32_t idx = pos & (capacity - 1);
+    uint32_t first = capacity - idx < len ? capacity - idx : len;
+    memcpy(dst, data + idx, first);
+    if (first < len) {
+        memcpy(dst + first, data, len - first);
+    }
+}
+
+} // namespace shm
@@ -0,0 +1,220 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <Logger.h>
+#include <shm_transport.h>
+
+using namespace apache::thrift::transport;
+namespace bip = boost::interprocess;
+
+shm_transport::shm_transport(const std::string& name, int preferred, uint32_t spin, uint32_t timeout)
+    : segmentName(name)
+    , preferredChannel(preferred)
+    , spinUs(spin)
+    , timeoutMs(timeout)
+{
+}
+
+shm_transport::~shm_transport()
+{
+    close();
+}
+
+bool shm_transport::isOpen() const
+{
+    return channel != nullptr;
+}
+
+bool shm_transport::peek()
+{
+    if (!isOpen()) {
+        return false;
+    }
+    return channel->response.head.load(std::memory_order_acquire) != channel->response.tail.load(std::memory_order_relaxed);
+}
+
+void shm_transport::open()
+{
+    if (isOpen()) {
+        return;
+    }
+
+    try {
+        shmObject.reset(new bip::shared_memory_object(bip::open_only, segmentName.c_str(), bip::read_write));
+        region.reset(new bip::mapped_region(*shmObject, bip::read_write));
+    } catch (const bip::interprocess_exception& ex) {
+        LOG_ERROR << "Unable to map shared memory segment " << segmentName << " " << ex.what();
+        throw TTransportException(TTransportException::NOT_OPEN, "Unable to open shared memory segment " + segmentName);
+    }
+
+    segment = static_cast<shm_segment*>(region->get_address());
+    if (region->get_size() < sizeof(shm_segment) || segment->magic != SHM_SEGMENT_MAGIC
+        || segment->version != SHM_SEGMENT_VERSION) {
+        close();
+        throw TTransportException(TTransportException::NOT_OPEN, "Invalid shared memory segment " + segmentName);
+    }
+
+    capacity = segment->ring_capacity;
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0
+        || region->get_size() < shm::segment_size(segment->channel_count, capacity)) {
+        close();
+        throw TTransportException(TTransportException::NOT_OPEN, "Corrupted shared memory segment " + segmentName);
+    }
+
+    if (segment->server_ready.load(std::memory_order_acquire) == 0) {
+        close();
+        throw TTransportException(TTransportException::NOT_OPEN, "Shared memory backend not ready " + segmentName);
+    }
+
+    claim_channel();
+}
+
+void shm_transport::claim_channel()
+{
+    uint32_t self = shm::current_pid();
+    uint32_t count = segment->channel_count;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t idx = (static_cast<uint32_t>(preferredChannel) + i) % count;
+        shm_channel* candidate = shm::get_channel(segment, idx);
+        uint32_t owner = candidate->owner.load(std::memory_order_acquire);
+        // Channels of this process belong to other live clients
+        if (owner != SHM_CHANNEL_FREE && (owner == self || shm::pid_alive(owner))) {
+            continue;
+        }
+        // Only one of the clients racing for a dead owner's channel wins
+        if (!candidate->owner.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+            continue;
+        }
+        if (owner != SHM_CHANNEL_FREE) {
+            LOG_WARNING << "Taking over shared memory channel " << idx << " of exited process " << owner;
+        }
+        channel = candidate;
+        requestData = shm::request_data(channel);
+        responseData = shm::response_data(channel, capacity);
+        synchronize();
+        LOG_INFO << "Claimed shared memory channel " << idx << " on " << segmentName;
+        return;
+    }
+
+    close();
+    throw TTransportException(TTransportException::NOT_OPEN, "No free shared memory channel on " + segmentName);
+}
+
+void shm_transport::synchronize()
+{
+    // Fences the backend off whatever it still does for the previous owner
+    uint32_t generation = channel->generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+    shm_ring_ctl* request = &channel->request;
+    request->data_seq.fetch_add(1, std::memory_order_release);
+    shm::wake_word(&request->data_seq);
+    shm_ring_ctl* response = &channel->response;
+    response->space_seq.fetch_add(1, std::memory_order_release);
+    shm::wake_word(&response->space_seq);
+
+    auto served = [this, generation]() {
+        return channel->served_generation.load(std::memory_order_acquire) == generation;
+    };
+    if (!shm::wait_until(served, &response->data_seq, &response->data_waiters, spinUs, timeoutMs)) {
+        close();
+        throw TTransportException(TTransportException::TIMED_OUT, "Shared memory backend did not take over channel on " + segmentName);
+    }
+
+    // The backend emptied the request ring, responses it published before
+    // the acknowledgement are the previous owner's
+    pendingHead = request->head.load(std::memory_order_acquire);
+    shm::consume(response, response->head.load(std::memory_order_acquire));
+}
+
+void shm_transport::close()
+{
+    if (channel != nullptr) {
+        uint32_t self = shm::current_pid();
+        channel->owner.compare_exchange_strong(self, SHM_CHANNEL_FREE, std::memory_order_acq_rel);
+        channel = nullptr;
+    }
+    segment = nullptr;
+    requestData = nullptr;
+    responseData = nullptr;
+    region.reset();
+    shmObject.reset();
+}
+
+uint32_t shm_transport::read(uint8_t* buf, uint32_t len)
+{
+    if (!isOpen()) {
+        throw TTransportException(TTransportException::NOT_OPEN, "Shared memory transport not open");
+    }
+
+    shm_ring_ctl* ring = &channel->response;
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    auto ready = [ring, tail]() {
+        return ring->head.load(std::memory_order_acquire) != tail;
+    };
+
+    if (!shm::wait_until(ready, &ring->data_seq, &ring->data_waiters, spinUs, timeoutMs)) {
+        throw TTransportException(TTransportException::TIMED_OUT, "Timed out waiting for shared memory response");
+    }
+
+    uint32_t available = ring->head.load(std::memory_order_acquire) - tail;
+    uint32_t count = available < len ? available : len;
+    shm::copy_out(responseData, capacity, tail, buf, count);
+    shm::consume(ring, tail + count);
+    return count;
+}
+
+void shm_transport::write(const uint8_t* buf, uint32_t len)
+{
+    if (!isOpen()) {
+        throw TTransportException(TTransportException::NOT_OPEN, "Shared memory transport not open");
+    }
+
+    shm_ring_ctl* ring = &channel->request;
+    while (len > 0) {
+        uint32_t used = pendingHead - ring->tail.load(std::memory_order_acquire);
+        if (used == capacity) {
+            // Ring is full of unpublished bytes, hand them over before waiting
+            shm::publish(ring, pendingHead);
+            uint32_t head = pendingHead;
+            uint32_t cap = capacity;
+            auto ready = [ring, head, cap]() {
+                return head - ring->tail.load(std::memory_order_acquire) < cap;
+            };
+            if (!shm::wait_until(ready, &ring->space_seq, &ring->space_waiters, spinUs, timeoutMs)) {
+                throw TTransportException(TTransportException::TIMED_OUT, "Timed out waiting for shared memory ring space");
+            }
+            continue;
+        }
+
+        uint32_t space = capacity - used;
+        uint32_t count = space < len ? space : len;
+        shm::copy_in(requestData, capacity, pendingHead, buf, count);
+        pendingHead += count;
+        buf += count;
+        len -= count;
+    }
+}
+
+void shm_transport::flush()
+{
+    if (!isOpen()) {
+        throw TTransportException(TTransportException::NOT_OPEN, "Shared memory transport not open");
+    }
+    shm::publish(&channel->request, pendingHead);
+}
@@ -0,0 +1,87 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <thrift/transport/TVirtualTransport.h>
+
+#include <shm_ring.h>
+
+// Busy poll window before a reader/writer goes to sleep on the futex
+#define SHM_DEFAULT_SPIN_US 50
+// Give up on a silent backend after this long
+#define SHM_DEFAULT_TIMEOUT_MS 30000
+
+/*
+ * Client side of the SHARED_MEMORY transport.
+ *
+ * Writes are staged straight into the request ring and only made visible to
+ * the backend on flush(), so a framed/buffered message is published with a
+ * single release store. Reads consume directly from the response ring.
+ */
+class shm_transport : public apache::thrift::transport::TVirtualTransport<shm_transport> {
+public:
+    shm_transport(const std::string& segmentName, int preferredChannel,
+        uint32_t spinUs = SHM_DEFAULT_SPIN_US,
+        uint32_t timeoutMs = SHM_DEFAULT_TIMEOUT_MS);
+    ~shm_transport() override;
+
+    bool isOpen() const override;
+    bool peek() override;
+    void open() override;
+    void close() override;
+
+    uint32_t read(uint8_t* buf, uint32_t len);
+    void write(const uint8_t* buf, uint32_t len);
+    void flush() override;
+
+    const std::string getOrigin() const override
+    {
+        return segmentName;
+    }
+
+private:
+    void claim_channel();
+    // Starts a new generation on the claimed channel and waits for the backend
+    void synchronize();
+
+    std::string segmentName;
+    int preferredChannel;
+    uint32_t spinUs;
+    uint32_t timeoutMs;
+
+    std::unique_ptr<boost::interprocess::shared_memory_object> shmObject;
+    std::unique_ptr<boost::interprocess::mapped_region> region;
+
+    shm_segment* segment = nullptr;
+    shm_channel* channel = nullptr;
+    uint32_t capacity = 0;
+    uint8_t* requestData = nullptr;
+    uint8_t* responseData = nullptr;
+
+    // Producer position not yet published to the backend
+    uint32_t pendingHead = 0;
+};
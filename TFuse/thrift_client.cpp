@@ -1,180 +1,572 @@
-/*
- ***************************************************************************** 
- * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
- *
- * Copyright (c) 2022 Yogender Solanki
- *
- * This program is free software: you can redistribute it and/or modify it
- * under the terms of the GNU Lesser General Public License as published by the
- * Free Software Foundation, either version 3 of the License, or (at your
- * option) any later version.
- *
- * This program is distributed in the hope that it will be useful, but WITHOUT
- * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
- * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
- * for more details.
- *
- * You should have received a copy of the GNU Lesser General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- *****************************************************************************
- */
-#include <boost/algorithm/string.hpp>
-#include <iterator>
-#include <stdexcept>
-#include <string>
-#include <vector>
-
-#include <logger.h>
-#include <thrift_client.h>
-
-using namespace std;
-
-thrift_client::thrift_client(const std::string& targetPath,
-    const std::string& serviceLoc,
-    TransportType type,
-    MessageWrap wrap,
-    SerializationProtocol protocol, int id)
-{
-  
-
-    lowLevelTransport = type;
-    transportWrapper = wrap;
-    encodingProtocol = protocol;
-
-    // Inititalize location
-    servicePath = serviceLoc;
-    target = targetPath;
-
-    // Parse the TCP IP target address
-    if (type == TransportType::TCP_IP) {
-        vector<string> splitStr;
-        boost::split(splitStr, target, boost::is_any_of(":"));
-        if (splitStr.size() != 2) {
-            LOG_ERROR << _clientId << " Invalid TCP/IP target path " << target;
-            throw new std::invalid_argument(
-                "Invalid TCP/IP target address use IP:PORT");
-        }
-        port = 0;
-        try {
-            port = stoi(splitStr[1]);
-        } catch (exception& ex) {
-            LOG_FATAL << "Unable to parse target TCP/IP " << target << ex.what();
-        }
-        host = splitStr[0];
-    }
-    _clientId = "channel[" + to_string(id) + "]";
-
-    LOG_INFO << " Initializing filesystem channel " << _clientId
-             << " Client Type [" << static_cast<int>(type) << "]"
-             << " Serialization [" << static_cast<int>(protocol) << "]"
-             << " Message Wrapping [" << static_cast<int>(wrap) << "]"
-             << " Target [" << targetPath << "]"
-             << " ServiceLocation " << servicePath;
-
-    init_low_level_transport();
-    init_transport_wrapper();
-    init_encoding_protocol();
-}
-
-thrift_client::~thrift_client()
-{
-    if (wrappedTransport->isOpen()) {
-        wrappedTransport->close();
-    }
-}
-
-void thrift_client::HandleException(std::exception& ex)
-{
-    LOG_ERROR << "IPC Exception " << ex.what();
-}
-
-void thrift_client::init_low_level_transport()
-{
-    switch (lowLevelTransport) {
-#ifdef _WIN32
-    case TransportType::NAMED_PIPE:
-        pipe.reset(new TPipe(target.c_str()));
-        break;
-#else
-    case TransportType::UNIX_SOCKET:
-        LOG_INFO << "Initialzing Unix Domain Socket transport " << target;
-        socket.reset(new TSocket(target.c_str()));
-        break;
-#endif
-    case TransportType::TCP_IP: {
-        socket.reset(new TSocket(host, port));
-        break;
-    case TransportType::SHARED_MEMORY:
-    default:
-        LOG_FATAL << _clientId << " Unsupported transport type" << target;
-        throw new std::invalid_argument("Unsupported/Unknown type of transport");
-        break;
-    }
-    }
-}
-
-void thrift_client::init_transport_wrapper()
-{
-    switch (transportWrapper) {
-    case MessageWrap::BUFFERED:
-        if (lowLevelTransport == TransportType::NAMED_PIPE) {
-            wrappedTransport.reset(new TBufferedTransport(pipe));
-        } else {
-            wrappedTransport.reset(new TBufferedTransport(socket));
-        }
-        break;
-    case MessageWrap::FRAMED:
-        if (lowLevelTransport == TransportType::NAMED_PIPE) {
-            wrappedTransport.reset(new TFramedTransport(pipe));
-        } else {
-            wrappedTransport.reset(new TFramedTransport(socket));
-        }
-        break;
-    case MessageWrap::HTTP:
-        if (lowLevelTransport == TransportType::NAMED_PIPE) {
-            throw new invalid_argument(
-                "HTTP Transport is not allowed over NAMED PIPE");
-        } else {
-            wrappedTransport.reset(new apache::thrift::transport::THttpClient(socket, host, servicePath));
-        }
-        break;
-    case MessageWrap::ZLIB:
-        if (lowLevelTransport == TransportType::NAMED_PIPE) {
-            throw new invalid_argument(
-                "HTTP Transport is not allowed over NAMED PIPE");
-        } else {
-            wrappedTransport.reset(new apache::thrift::transport::TZlibTransport(socket));
-        }
-        break;
-    default:
-        break;
-    }
-}
-
-void thrift_client::init_encoding_protocol()
-{
-    switch (encodingProtocol) {
-    case SerializationProtocol::BINARY:
-        protocol.reset(new TBinaryProtocol(wrappedTransport));
-        break;
-    case SerializationProtocol::COMPACT:
-        protocol.reset(new TCompactProtocol(wrappedTransport));
-        break;
-    case SerializationProtocol::JSON:
-        protocol.reset(new TJSONProtocol(wrappedTransport));
-        break;
-    case SerializationProtocol::MULTIPLEXED:
-    default:
-        LOG_ERROR << _clientId << "Unsupported/Invalid endcoding protocol" << endl;
-        throw new invalid_argument("Unsupported/Invalid endcoding protocol");
-        break;
-    }
-}
-
-void thrift_client::connect()
-{   
-    _stub =  make_shared<Fuse::FuseServiceClient>(protocol);
-
-    LOG_INFO << _clientId << " Opening transport channel " << target;
-    wrappedTransport->open();
-}
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <boost/algorithm/string.hpp>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <logger.h>
+#include <shm_transport.h>
+#include <thrift_client.h>
+
+using namespace std;
+
+thrift_client::thrift_client(const std::string& targetPath,
+    const std::string& serviceLoc,
+    TransportType type,
+    MessageWrap wrap,
+    SerializationProtocol protocol, int id,
+    bool pipelined)
+{
+  
+
+    lowLevelTransport = type;
+    transportWrapper = wrap;
+    encodingProtocol = protocol;
+
+    // Inititalize location
+    servicePath = serviceLoc;
+    target = targetPath;
+
+    // Parse the TCP IP target address
+    if (type == TransportType::TCP_IP) {
+        vector<string> splitStr;
+        boost::split(splitStr, target, boost::is_any_of(":"));
+        if (splitStr.size() != 2) {
+            LOG_ERROR << _clientId << " Invalid TCP/IP target path " << target;
+            throw new std::invalid_argument(
+                "Invalid TCP/IP target address use IP:PORT");
+        }
+        port = 0;
+        try {
+            port = stoi(splitStr[1]);
+        } catch (exception& ex) {
+            LOG_FATAL << "Unable to parse target TCP/IP " << target << ex.what();
+        }
+        host = splitStr[0];
+    }
+    _id = id;
+    _clientId = "channel[" + to_string(id) + "]";
+    _pipelined = pipelined;
+
+    // HTTP is strictly one request per response, nothing to pipeline
+    if (pipelined && wrap == MessageWrap::HTTP) {
+        LOG_ERROR << _clientId << " Pipelining is not supported over HTTP";
+        throw std::invalid_argument("Pipelining is not supported over HTTP");
+    }
+
+    LOG_INFO << " Initializing filesystem channel " << _clientId
+             << " Client Type [" << static_cast<int>(type) << "]"
+             << " Serialization [" << static_cast<int>(protocol) << "]"
+             << " Message Wrapping [" << static_cast<int>(wrap) << "]"
+             << " Pipelined [" << pipelined << "]"
+             << " Target [" << targetPath << "]"
+             << " ServiceLocation " << servicePath;
+
+    init_low_level_transport();
+    init_transport_wrapper();
+    init_encoding_protocol();
+}
+
+thrift_client::~thrift_client()
+{
+    if (wrappedTransport->isOpen()) {
+        wrappedTransport->close();
+    }
+}
+
+void thrift_client::HandleException(std::exception& ex)
+{
+    LOG_ERROR << "IPC Exception " << ex.what();
+}
+
+bool thrift_client::breaks_connection(const std::exception& ex)
+{
+    return dynamic_cast<const TTransportException*>(&ex) != nullptr
+        || dynamic_cast<const TProtocolException*>(&ex) != nullptr;
+}
+
+void thrift_client::ping()
+{
+    _stub->ping();
+}
+
+void thrift_client::init_low_level_transport()
+{
+    switch (lowLevelTransport) {
+#ifdef _WIN32
+    case TransportType::NAMED_PIPE:
+        pipe.reset(new TPipe(target.c_str()));
+        transport = pipe;
+        break;
+#else
+    case TransportType::UNIX_SOCKET:
+        LOG_INFO << "Initialzing Unix Domain Socket transport " << target;
+        socket.reset(new TSocket(target.c_str()));
+        transport = socket;
+        break;
+#endif
+    case TransportType::TCP_IP:
+        socket.reset(new TSocket(host, port));
+        transport = socket;
+        break;
+    case TransportType::SHARED_MEMORY:
+        LOG_INFO << "Initialzing shared memory transport " << target;
+        transport.reset(new shm_transport(target, _id));
+        break;
+    default:
+        LOG_FATAL << _clientId << " Unsupported transport type" << target;
+        throw new std::invalid_argument("Unsupported/Unknown type of transport");
+        break;
+    }
+}
+
+void thrift_client::init_transport_wrapper()
+{
+    switch (transportWrapper) {
+    case MessageWrap::BUFFERED:
+        wrappedTransport.reset(new TBufferedTransport(transport));
+        break;
+    case MessageWrap::FRAMED:
+        wrappedTransport.reset(new TFramedTransport(transport));
+        break;
+    case MessageWrap::HTTP:
+        if (lowLevelTransport == TransportType::NAMED_PIPE || lowLevelTransport == TransportType::SHARED_MEMORY) {
+            throw new invalid_argument(
+                "HTTP Transport is only allowed over sockets");
+        } else {
+            wrappedTransport.reset(new apache::thrift::transport::THttpClient(socket, host, servicePath));
+        }
+        break;
+    case MessageWrap::ZLIB:
+        if (lowLevelTransport == TransportType::NAMED_PIPE) {
+            throw new invalid_argument(
+                "HTTP Transport is not allowed over NAMED PIPE");
+        } else {
+            wrappedTransport.reset(new apache::thrift::transport::TZlibTransport(transport));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void thrift_client::init_encoding_protocol()
+{
+    switch (encodingProtocol) {
+    case SerializationProtocol::BINARY:
+        inProtocol.reset(new TBinaryProtocol(wrappedTransport));
+        outProtocol.reset(new TBinaryProtocol(wrappedTransport));
+        break;
+    case SerializationProtocol::COMPACT:
+        inProtocol.reset(new TCompactProtocol(wrappedTransport));
+        outProtocol.reset(new TCompactProtocol(wrappedTransport));
+        break;
+    case SerializationProtocol::JSON:
+        inProtocol.reset(new TJSONProtocol(wrappedTransport));
+        outProtocol.reset(new TJSONProtocol(wrappedTransport));
+        break;
+    case SerializationProtocol::MULTIPLEXED:
+    default:
+        LOG_ERROR << _clientId << "Unsupported/Invalid endcoding protocol" << endl;
+        throw new invalid_argument("Unsupported/Invalid endcoding protocol");
+        break;
+    }
+}
+
+void thrift_client::read_into(Fuse::FileSystemResponse& resp,
+    const std::string& path,
+    int32_t size,
+    int64_t offset,
+    const Fuse::FuseHandleInfo& handle,
+    const Fuse::FuseContext& context,
+    char* buf,
+    size_t& bytesRead)
+{
+    bytesRead = 0;
+    if (encodingProtocol != SerializationProtocol::BINARY && encodingProtocol != SerializationProtocol::COMPACT) {
+        _stub->read(resp, path, size, offset, handle, context);
+        if (resp.status == Fuse::StatusCode::FUSE_SUCCESS && resp.__isset.data) {
+            bytesRead = resp.data.size() < static_cast<size_t>(size) ? resp.data.size() : static_cast<size_t>(size);
+            memcpy(buf, resp.data.data(), bytesRead);
+        }
+        return;
+    }
+
+    Fuse::FuseService_read_pargs args;
+    args.path = &path;
+    args.size = &size;
+    args.offset = &offset;
+    args.handleInfo = &handle;
+    args.context = &context;
+
+    int32_t seqid = send_call("read", [this, &args]() { args.write(outProtocol.get()); });
+    recv_reply("read", seqid, [this, &resp, buf, size, &bytesRead]() {
+        read_result_into(resp, buf, static_cast<size_t>(size), bytesRead);
+    });
+}
+
+/*
+ * Reads a FuseService_read_result like the generated code does, except that
+ * field 5 of the FileSystemResponse (data) is read from the transport into
+ * buf, see read_payload.
+ */
+void thrift_client::read_result_into(Fuse::FileSystemResponse& resp, char* buf, size_t capacity, size_t& bytesRead)
+{
+    using apache::thrift::TApplicationException;
+
+    std::string name;
+    TType ftype;
+    int16_t fid;
+    bool hasSuccess = false;
+    bool hasStatus = false;
+
+    // FuseService_read_result
+    inProtocol->readStructBegin(name);
+    while (true) {
+        inProtocol->readFieldBegin(name, ftype, fid);
+        if (ftype == T_STOP) {
+            break;
+        }
+        if (fid != 0 || ftype != T_STRUCT) {
+            inProtocol->skip(ftype);
+            inProtocol->readFieldEnd();
+            continue;
+        }
+
+        // FileSystemResponse, only status and data matter to a read
+        hasSuccess = true;
+        inProtocol->readStructBegin(name);
+        while (true) {
+            inProtocol->readFieldBegin(name, ftype, fid);
+            if (ftype == T_STOP) {
+                break;
+            }
+            if (fid == 1 && ftype == T_I32) {
+                int32_t status;
+                inProtocol->readI32(status);
+                resp.status = static_cast<Fuse::StatusCode::type>(status);
+                hasStatus = true;
+            } else if (fid == 5 && ftype == T_STRING) {
+                uint32_t length = read_binary_length();
+                uint32_t take = length < capacity ? length : static_cast<uint32_t>(capacity);
+                read_payload(reinterpret_cast<uint8_t*>(buf), take);
+                // A host that sent more than was asked for, drop the excess
+                uint8_t scratch[512];
+                for (uint32_t left = length - take; left > 0;) {
+                    uint32_t chunk = left < sizeof(scratch) ? left : sizeof(scratch);
+                    read_payload(scratch, chunk);
+                    left -= chunk;
+                }
+                bytesRead = take;
+                resp.__isset.data = true;
+            } else {
+                inProtocol->skip(ftype);
+            }
+            inProtocol->readFieldEnd();
+        }
+        inProtocol->readStructEnd();
+        inProtocol->readFieldEnd();
+    }
+    inProtocol->readStructEnd();
+
+    if (!hasSuccess) {
+        throw TApplicationException(TApplicationException::MISSING_RESULT, "read failed: unknown result");
+    }
+    if (!hasStatus) {
+        throw TProtocolException(TProtocolException::INVALID_DATA, "read reply without status");
+    }
+}
+
+/*
+ * TBufferedTransport refills its own buffer and copies out of it, so with the
+ * buffered wrap only what it already holds is taken from there and the rest
+ * is read from the low level transport into buf, leaving just the copy out of
+ * the socket. A framed transport has the whole frame in its buffer already
+ * and the payload is copied once out of it.
+ */
+void thrift_client::read_payload(uint8_t* buf, uint32_t length)
+{
+    if (transportWrapper != MessageWrap::BUFFERED) {
+        wrappedTransport->readAll(buf, length);
+        return;
+    }
+    // Asking for nothing returns what is buffered without reading more
+    uint32_t held = 0;
+    const uint8_t* data = wrappedTransport->borrow(nullptr, &held);
+    uint32_t take = held < length ? held : length;
+    if (take > 0) {
+        memcpy(buf, data, take);
+        wrappedTransport->consume(take);
+    }
+    if (take < length) {
+        transport->readAll(buf + take, length - take);
+    }
+}
+
+/*
+ * Length prefix of a binary field: a plain i32 for the binary protocol and an
+ * unsigned varint (not zigzag, so not readI32) for the compact protocol.
+ */
+uint32_t thrift_client::read_binary_length()
+{
+    if (encodingProtocol == SerializationProtocol::BINARY) {
+        int32_t length;
+        inProtocol->readI32(length);
+        if (length < 0) {
+            throw TProtocolException(TProtocolException::NEGATIVE_SIZE);
+        }
+        return static_cast<uint32_t>(length);
+    }
+
+    uint32_t length = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte;
+        wrappedTransport->readAll(&byte, 1);
+        length |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            if (length > static_cast<uint32_t>(INT32_MAX)) {
+                throw TProtocolException(TProtocolException::NEGATIVE_SIZE);
+            }
+            return length;
+        }
+    }
+    throw TProtocolException(TProtocolException::INVALID_DATA, "Variable-length int over 5 bytes");
+}
+
+void thrift_client::write_from(Fuse::FileSystemResponse& resp,
+    const std::string& path,
+    const write_segment* segments,
+    size_t count,
+    int64_t offset,
+    const Fuse::FuseHandleInfo& handle,
+    const Fuse::FuseContext& context)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += segments[i].size;
+    }
+
+    if (encodingProtocol != SerializationProtocol::BINARY && encodingProtocol != SerializationProtocol::COMPACT) {
+        std::string data;
+        data.reserve(total);
+        for (size_t i = 0; i < count; i++) {
+            data.append(segments[i].data, segments[i].size);
+        }
+        _stub->write(resp, path, data, offset, static_cast<int32_t>(total), handle, context);
+        return;
+    }
+
+    // Same message the generated FuseServiceClient::send_write produces
+    int32_t seqid = send_call("write", [&]() {
+        outProtocol->writeStructBegin("FuseService_write_pargs");
+
+        outProtocol->writeFieldBegin("path", T_STRING, 1);
+        outProtocol->writeString(path);
+        outProtocol->writeFieldEnd();
+
+        outProtocol->writeFieldBegin("buffer", T_STRING, 2);
+        write_binary_length(static_cast<uint32_t>(total));
+        for (size_t i = 0; i < count; i++) {
+            wrappedTransport->write(reinterpret_cast<const uint8_t*>(segments[i].data), static_cast<uint32_t>(segments[i].size));
+        }
+        outProtocol->writeFieldEnd();
+
+        outProtocol->writeFieldBegin("offset", T_I64, 3);
+        outProtocol->writeI64(offset);
+        outProtocol->writeFieldEnd();
+
+        outProtocol->writeFieldBegin("size", T_I32, 4);
+        outProtocol->writeI32(static_cast<int32_t>(total));
+        outProtocol->writeFieldEnd();
+
+        outProtocol->writeFieldBegin("handleInfo", T_STRUCT, 5);
+        handle.write(outProtocol.get());
+        outProtocol->writeFieldEnd();
+
+        outProtocol->writeFieldBegin("context", T_STRUCT, 6);
+        context.write(outProtocol.get());
+        outProtocol->writeFieldEnd();
+
+        outProtocol->writeFieldStop();
+        outProtocol->writeStructEnd();
+    });
+
+    recv_reply("write", seqid, [this, &resp]() {
+        Fuse::FuseService_write_presult result;
+        result.success = &resp;
+        result.read(inProtocol.get());
+        if (!result.__isset.success) {
+            throw apache::thrift::TApplicationException(apache::thrift::TApplicationException::MISSING_RESULT, "write failed: unknown result");
+        }
+    });
+}
+
+void thrift_client::write_binary_length(uint32_t length)
+{
+    if (encodingProtocol == SerializationProtocol::BINARY) {
+        outProtocol->writeI32(static_cast<int32_t>(length));
+        return;
+    }
+
+    uint8_t varint[5];
+    uint32_t used = 0;
+    while (length >= 0x80) {
+        varint[used++] = static_cast<uint8_t>(length | 0x80);
+        length >>= 7;
+    }
+    varint[used++] = static_cast<uint8_t>(length);
+    wrappedTransport->write(varint, used);
+}
+
+/*
+ * Message framing for the direct read/write paths. A plain channel is owned by
+ * one caller at a time so seqid 0 and the next reply on the wire are its own,
+ * a pipelined channel hands both to the concurrent stub.
+ */
+int32_t thrift_client::send_call(const char* name, const std::function<void()>& writeArgs)
+{
+    if (_pipelinedStub) {
+        return _pipelinedStub->send_call(name, writeArgs);
+    }
+
+    outProtocol->writeMessageBegin(name, T_CALL, 0);
+    writeArgs();
+    outProtocol->writeMessageEnd();
+    wrappedTransport->writeEnd();
+    wrappedTransport->flush();
+    return 0;
+}
+
+/*
+ * Consumes a reply that is not a result for name, fills error and returns
+ * true. Returns false with the message still open when it is the result.
+ */
+static bool unexpected_reply(TProtocol* prot, const char* name,
+    const std::string& fname,
+    TMessageType mtype,
+    apache::thrift::TApplicationException& error)
+{
+    using apache::thrift::TApplicationException;
+
+    if (mtype == T_EXCEPTION) {
+        error.read(prot);
+    } else if (mtype != T_REPLY || fname != name) {
+        prot->skip(T_STRUCT);
+        error = TApplicationException(mtype != T_REPLY ? TApplicationException::INVALID_MESSAGE_TYPE : TApplicationException::WRONG_METHOD_NAME,
+            "Unexpected reply " + fname);
+    } else {
+        return false;
+    }
+    prot->readMessageEnd();
+    prot->getTransport()->readEnd();
+    return true;
+}
+
+void thrift_client::recv_reply(const char* name, int32_t seqid, const std::function<void()>& readResult)
+{
+    if (_pipelinedStub) {
+        _pipelinedStub->recv_reply(name, seqid, readResult);
+        return;
+    }
+
+    std::string fname;
+    TMessageType mtype;
+    int32_t rseqid = 0;
+    apache::thrift::TApplicationException error;
+    inProtocol->readMessageBegin(fname, mtype, rseqid);
+    if (unexpected_reply(inProtocol.get(), name, fname, mtype, error)) {
+        throw error;
+    }
+    readResult();
+    inProtocol->readMessageEnd();
+    wrappedTransport->readEnd();
+}
+
+pipelined_stub::pipelined_stub(std::shared_ptr<TProtocol> iprot, std::shared_ptr<TProtocol> oprot)
+    : Fuse::FuseServiceConcurrentClient(iprot, oprot, std::make_shared<apache::thrift::async::TConcurrentClientSyncInfo>())
+{
+}
+
+int32_t pipelined_stub::send_call(const char* name, const std::function<void()>& writeArgs)
+{
+    int32_t seqid = sync_->generateSeqId();
+    apache::thrift::async::TConcurrentSendSentry sentry(sync_.get());
+
+    oprot_->writeMessageBegin(name, T_CALL, seqid);
+    writeArgs();
+    oprot_->writeMessageEnd();
+    oprot_->getTransport()->writeEnd();
+    oprot_->getTransport()->flush();
+
+    sentry.commit();
+    return seqid;
+}
+
+/*
+ * Same loop the generated concurrent recv_* functions run: whoever holds the
+ * read side takes the next reply off the wire, keeps it when the seqid is its
+ * own and otherwise parks it for its owner and waits for its turn. Leaving
+ * without commit() marks the connection bad for every waiter.
+ */
+void pipelined_stub::recv_reply(const char* name, int32_t seqid, const std::function<void()>& readResult)
+{
+    std::string fname;
+    TMessageType mtype;
+    int32_t rseqid = 0;
+    apache::thrift::async::TConcurrentRecvSentry sentry(sync_.get(), seqid);
+
+    while (true) {
+        if (!sync_->getPending(fname, mtype, rseqid)) {
+            iprot_->readMessageBegin(fname, mtype, rseqid);
+        }
+        if (rseqid == seqid) {
+            apache::thrift::TApplicationException error;
+            if (unexpected_reply(iprot_, name, fname, mtype, error)) {
+                sentry.commit();
+                throw error;
+            }
+            readResult();
+            iprot_->readMessageEnd();
+            iprot_->getTransport()->readEnd();
+            sentry.commit();
+            return;
+        }
+        sync_->updatePending(fname, mtype, rseqid);
+        sync_->waitForWork(seqid);
+    }
+}
+
+void thrift_client::connect()
+{   
+    if (_pipelined) {
+        _pipelinedStub = make_shared<pipelined_stub>(inProtocol, outProtocol);
+        _stub = _pipelinedStub;
+    } else {
+        _stub = make_shared<Fuse::FuseServiceClient>(inProtocol, outProtocol);
+    }
+
+    LOG_INFO << _clientId << " Opening transport channel " << target;
+    wrappedTransport->open();
+}
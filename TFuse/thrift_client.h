@@ -1,167 +1,282 @@
-/*
- ***************************************************************************** 
- * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
- *
- * Copyright (c) 2022 Yogender Solanki
- *
- * This program is free software: you can redistribute it and/or modify it
- * under the terms of the GNU Lesser General Public License as published by the
- * Free Software Foundation, either version 3 of the License, or (at your
- * option) any later version.
- *
- * This program is distributed in the hope that it will be useful, but WITHOUT
- * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
- * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
- * for more details.
- *
- * You should have received a copy of the GNU Lesser General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- *****************************************************************************
- */
-#pragma once
-#include <FuseService.h>
-
-#include <thrift/protocol/TBinaryProtocol.h>
-#include <thrift/protocol/TCompactProtocol.h>
-#include <thrift/protocol/TJSONProtocol.h>
-#include <thrift/transport/TBufferTransports.h>
-#include <thrift/transport/THttpClient.h>
-#include <thrift/transport/TPipe.h>
-#include <thrift/transport/TSocket.h>
-#include <thrift/transport/TTransport.h>
-#include <thrift/transport/TZlibTransport.h>
-
-using namespace apache::thrift::transport;
-using namespace apache::thrift::protocol;
-using namespace std;
-
-#define TRANSPORT_PIPE "PIPE"
-#define TRANSPORT_MEM "SHARED_MEMORY"
-#define TRANSPORT_UNIX "UNIX_SOCKET"
-#define TRANSPORT_TCP "TCP_IP"
-
-#define WRAP_BUFFERED "BUFFERED"
-#define WRAP_FRAMED "FRAMED"
-#define WRAP_HTTP "HTTP"
-#define WRAP_ZLIB "ZLIB"
-
-#define PROTO_BINARY "BINARY"
-#define PROTO_COMPACT "COMPACT"
-#define PROTO_JSON "JSON"
-#define PROTO_MULTIPLXED "MULTIPLEXED"
-
-enum class TransportType {
-    NAMED_PIPE,
-    UNIX_SOCKET,
-    TCP_IP,
-    SHARED_MEMORY,
-    // TLS //TODO
-};
-
-enum class MessageWrap {
-    BUFFERED,
-    FRAMED,
-    HTTP,
-    ZLIB
-};
-
-enum class SerializationProtocol {
-    BINARY,
-    COMPACT,
-    JSON,
-    MULTIPLEXED
-};
-
-class thrift_client {
-public:
-    thrift_client(const std::string& target, const std::string& servicePath,
-        TransportType type,
-        MessageWrap wrap,
-        SerializationProtocol protocol, int id);
-    ~thrift_client();
-
-    static void HandleException(std::exception& ex);
-
-    static inline TransportType TransportTypeFromString(const string& str)
-    {
-        if (str == TRANSPORT_PIPE) {
-            return TransportType::NAMED_PIPE;
-        } else if (str == TRANSPORT_MEM) {
-            return TransportType::SHARED_MEMORY;
-        } else if (str == TRANSPORT_TCP) {
-            return TransportType::TCP_IP;
-        } else if (str == TRANSPORT_UNIX) {
-            return TransportType::UNIX_SOCKET;
-        } else {
-            throw invalid_argument("Invalid transport type " + str);
-        }
-    }
-
-    static inline MessageWrap WrapTypeFromString(const string& str)
-    {
-        if (str == WRAP_BUFFERED) {
-            return MessageWrap::BUFFERED;
-        } else if (str == WRAP_FRAMED) {
-            return MessageWrap::FRAMED;
-        } else if (str == WRAP_HTTP) {
-            return MessageWrap::HTTP;
-        } else if (str == WRAP_ZLIB) {
-            return MessageWrap::ZLIB;
-        } else {
-            throw invalid_argument("Invalid message wrap " + str);
-        }
-    }
-
-    /*
-    * Function to covert string def of Protocol String to Enum
-    */
-    static SerializationProtocol ProtocolTypeFromString(const string& str)
-    {
-        if (str == PROTO_BINARY) {
-            return SerializationProtocol::BINARY;
-        } else if (str == PROTO_COMPACT) {
-            return SerializationProtocol::COMPACT;
-        } else if (str == PROTO_JSON) {
-            return SerializationProtocol::JSON;
-        } else {
-            throw invalid_argument("Invalid message protocol " + str);
-        }
-    }
-
-    inline std::shared_ptr<Fuse::FuseServiceClient> GetStub()
-    {
-        return _stub;
-    }
-
-    void connect();
-
-    inline const std::string& get_client_id() {
-        return _clientId;
-    }
-
-private:
-    // Thrift options
-    std::string target;
-    std::string host;
-    int port;
-    std::string servicePath;
-    TransportType lowLevelTransport;
-    MessageWrap transportWrapper;
-    SerializationProtocol encodingProtocol;
-
-    // Thrift init function
-    void init_low_level_transport();
-    void init_transport_wrapper();
-    void init_encoding_protocol();
-
-    // Thrift requried fields
-    std::shared_ptr<TSocket> socket;
-    std::shared_ptr<TPipe> pipe;
-    std::shared_ptr<TTransport> wrappedTransport;
-    std::shared_ptr<TProtocol> protocol;
-    string _clientId;
-    // Client stub
-    std::shared_ptr<Fuse::FuseServiceClient> _stub;
-};
-
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+#include <FuseService.h>
+
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+
+#include <thrift/async/TConcurrentClientSyncInfo.h>
+#include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/protocol/TCompactProtocol.h>
+#include <thrift/protocol/TJSONProtocol.h>
+#include <thrift/transport/TBufferTransports.h>
+#include <thrift/transport/THttpClient.h>
+#include <thrift/transport/TPipe.h>
+#include <thrift/transport/TSocket.h>
+#include <thrift/transport/TTransport.h>
+#include <thrift/transport/TZlibTransport.h>
+
+using namespace apache::thrift::transport;
+using namespace apache::thrift::protocol;
+using namespace std;
+
+#define TRANSPORT_PIPE "PIPE"
+#define TRANSPORT_MEM "SHARED_MEMORY"
+#define TRANSPORT_UNIX "UNIX_SOCKET"
+#define TRANSPORT_TCP "TCP_IP"
+
+#define WRAP_BUFFERED "BUFFERED"
+#define WRAP_FRAMED "FRAMED"
+#define WRAP_HTTP "HTTP"
+#define WRAP_ZLIB "ZLIB"
+
+#define PROTO_BINARY "BINARY"
+#define PROTO_COMPACT "COMPACT"
+#define PROTO_JSON "JSON"
+#define PROTO_MULTIPLXED "MULTIPLEXED"
+
+// Calls a pipelined channel keeps in flight when config.ini does not say
+#define DEFAULT_MAX_INFLIGHT 32
+
+enum class TransportType {
+    NAMED_PIPE,
+    UNIX_SOCKET,
+    TCP_IP,
+    SHARED_MEMORY,
+    // TLS //TODO
+};
+
+enum class MessageWrap {
+    BUFFERED,
+    FRAMED,
+    HTTP,
+    ZLIB
+};
+
+enum class SerializationProtocol {
+    BINARY,
+    COMPACT,
+    JSON,
+    MULTIPLEXED
+};
+
+// One piece of a scattered write payload
+struct write_segment {
+    const char* data;
+    size_t size;
+};
+
+/*
+ * Generated concurrent client plus seqid aware send/recv for the hand written
+ * read/write messages, so those can share a pipelined connection with the
+ * generated calls. Replies are matched to callers by seqid, whichever thread
+ * reads a reply meant for another caller parks it for that caller.
+ */
+class pipelined_stub : public Fuse::FuseServiceConcurrentClient {
+public:
+    pipelined_stub(std::shared_ptr<TProtocol> iprot, std::shared_ptr<TProtocol> oprot);
+
+    int32_t send_call(const char* name, const std::function<void()>& writeArgs);
+    void recv_reply(const char* name, int32_t seqid, const std::function<void()>& readResult);
+};
+
+class thrift_client {
+public:
+    thrift_client(const std::string& target, const std::string& servicePath,
+        TransportType type,
+        MessageWrap wrap,
+        SerializationProtocol protocol, int id,
+        bool pipelined = false);
+    ~thrift_client();
+
+    static void HandleException(std::exception& ex);
+
+    /*
+    * True for failures that leave the connection unusable (transport errors,
+    * undecodable replies), as opposed to errors the host reported cleanly.
+    */
+    static bool breaks_connection(const std::exception& ex);
+
+    static inline TransportType TransportTypeFromString(const string& str)
+    {
+        if (str == TRANSPORT_PIPE) {
+            return TransportType::NAMED_PIPE;
+        } else if (str == TRANSPORT_MEM) {
+            return TransportType::SHARED_MEMORY;
+        } else if (str == TRANSPORT_TCP) {
+            return TransportType::TCP_IP;
+        } else if (str == TRANSPORT_UNIX) {
+            return TransportType::UNIX_SOCKET;
+        } else {
+            throw invalid_argument("Invalid transport type " + str);
+        }
+    }
+
+    static inline MessageWrap WrapTypeFromString(const string& str)
+    {
+        if (str == WRAP_BUFFERED) {
+            return MessageWrap::BUFFERED;
+        } else if (str == WRAP_FRAMED) {
+            return MessageWrap::FRAMED;
+        } else if (str == WRAP_HTTP) {
+            return MessageWrap::HTTP;
+        } else if (str == WRAP_ZLIB) {
+            return MessageWrap::ZLIB;
+        } else {
+            throw invalid_argument("Invalid message wrap " + str);
+        }
+    }
+
+    /*
+    * Function to covert string def of Protocol String to Enum
+    */
+    static SerializationProtocol ProtocolTypeFromString(const string& str)
+    {
+        if (str == PROTO_BINARY) {
+            return SerializationProtocol::BINARY;
+        } else if (str == PROTO_COMPACT) {
+            return SerializationProtocol::COMPACT;
+        } else if (str == PROTO_JSON) {
+            return SerializationProtocol::JSON;
+        } else {
+            throw invalid_argument("Invalid message protocol " + str);
+        }
+    }
+
+    inline std::shared_ptr<Fuse::FuseServiceIf> GetStub()
+    {
+        return _stub;
+    }
+
+    /*
+    * A pipelined channel is safe to call from several threads at once, each
+    * call is tagged with its own seqid and may be in flight with the others.
+    */
+    inline bool is_pipelined()
+    {
+        return _pipelined;
+    }
+
+    void connect();
+
+    /*
+    * read RPC that decodes FileSystemResponse.data straight into buf instead
+    * of a std::string, bytesRead receives the payload size. Protocols without
+    * a direct path (JSON) fall back to the generated stub plus a copy.
+    */
+    void read_into(Fuse::FileSystemResponse& resp,
+        const std::string& path,
+        int32_t size,
+        int64_t offset,
+        const Fuse::FuseHandleInfo& handle,
+        const Fuse::FuseContext& context,
+        char* buf,
+        size_t& bytesRead);
+
+    /*
+    * write RPC whose payload is serialized from the segments in place, no
+    * std::string is built for it. Protocols without a direct path (JSON)
+    * gather the segments into one string first.
+    */
+    void write_from(Fuse::FileSystemResponse& resp,
+        const std::string& path,
+        const write_segment* segments,
+        size_t count,
+        int64_t offset,
+        const Fuse::FuseHandleInfo& handle,
+        const Fuse::FuseContext& context);
+
+    inline const std::string& get_client_id() {
+        return _clientId;
+    }
+
+    // Cheap round trip to the host, throws when it does not answer
+    void ping();
+
+    // Set once a call failed on the connection, the pool replaces the client
+    inline void mark_broken()
+    {
+        _broken.store(true, std::memory_order_release);
+    }
+
+    inline bool is_broken() const
+    {
+        return _broken.load(std::memory_order_acquire);
+    }
+
+    // Steady clock ticks of the last call or ping, kept by the pool
+    inline void mark_used(int64_t ticks)
+    {
+        _lastUsed.store(ticks, std::memory_order_relaxed);
+    }
+
+    inline int64_t last_used() const
+    {
+        return _lastUsed.load(std::memory_order_relaxed);
+    }
+
+private:
+    // Thrift options
+    std::string target;
+    std::string host;
+    int port;
+    std::string servicePath;
+    TransportType lowLevelTransport;
+    MessageWrap transportWrapper;
+    SerializationProtocol encodingProtocol;
+
+    // Thrift init function
+    void init_low_level_transport();
+    void init_transport_wrapper();
+    void init_encoding_protocol();
+
+    // Message framing shared by the direct paths, seqid aware when pipelined
+    int32_t send_call(const char* name, const std::function<void()>& writeArgs);
+    void recv_reply(const char* name, int32_t seqid, const std::function<void()>& readResult);
+
+    // Direct decoding helpers for read_into
+    void read_result_into(Fuse::FileSystemResponse& resp, char* buf, size_t capacity, size_t& bytesRead);
+    uint32_t read_binary_length();
+    void read_payload(uint8_t* buf, uint32_t length);
+    void write_binary_length(uint32_t length);
+
+    // Thrift requried fields
+    std::shared_ptr<TSocket> socket;
+    std::shared_ptr<TPipe> pipe;
+    std::shared_ptr<TTransport> transport;
+    std::shared_ptr<TTransport> wrappedTransport;
+    // Separate instances for each direction, compact and JSON keep per
+    // message state that a reply read while another caller sends would corrupt
+    std::shared_ptr<TProtocol> inProtocol;
+    std::shared_ptr<TProtocol> outProtocol;
+    int _id;
+    string _clientId;
+    bool _pipelined;
+    std::atomic<bool> _broken { false };
+    std::atomic<int64_t> _lastUsed { 0 };
+    // Client stub
+    std::shared_ptr<Fuse::FuseServiceIf> _stub;
+    std::shared_ptr<pipelined_stub> _pipelinedStub;
+};
+
 typedef shared_ptr<thrift_client> ThriftClientPtr;
\ No newline at end of file
@@ -1,89 +1,255 @@
-/*
- ***************************************************************************** 
- * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
- *
- * Copyright (c) 2022 Yogender Solanki
- *
- * This program is free software: you can redistribute it and/or modify it
- * under the terms of the GNU Lesser General Public License as published by the
- * Free Software Foundation, either version 3 of the License, or (at your
- * option) any later version.
- *
- * This program is distributed in the hope that it will be useful, but WITHOUT
- * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
- * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
- * for more details.
- *
- * You should have received a copy of the GNU Lesser General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- *****************************************************************************
- */
-
-// Include thirft_fuse first to avoid refdefination error
-#include <thrift_fuse.h>
-
-#include <fuse_native.h>
-#include <logger.h>
-
-
-using namespace Fuse;
-
-thrift_fuse::thrift_fuse(blocking_queue<ThriftClientPtr>* clients)
-{
-    _clientQueue = clients;
-    ops = {
-        fuse_native::getattr,
-        fuse_native::readlink,
-        fuse_native::mknod,
-        fuse_native::mkdir,
-        fuse_native::unlink,
-        fuse_native::rmdir,
-        fuse_native::symlink,
-        fuse_native::rename,
-        fuse_native::link,
-        fuse_native::chmod,
-        fuse_native::chown,
-        fuse_native::truncate,
-        fuse_native::open,
-        fuse_native::read,
-        fuse_native::write,
-        fuse_native::statfs,
-        fuse_native::flush,
-        fuse_native::release,
-        fuse_native::fsync, // fsync
-        fuse_native::setxattr,
-        fuse_native::getxattr,
-        fuse_native::listxattr,
-        fuse_native::removexattr,
-        fuse_native::opendir,
-        fuse_native::readdir,
-        fuse_native::releasedir,
-        fuse_native::fsyncdir, // fsyncdir
-        fuse_native::init,
-        fuse_native::destroy, // destroy
-        fuse_native::access, // access
-        fuse_native::create, // create
-        fuse_native::lock, // lock
-        fuse_native::utimens,
-        fuse_native::bmap, // bmap
-#if 0
-			fuse_native::ioctl,
-#endif
-    };
-}
-
-fuse_operations*
-thrift_fuse::get_operations()
-{
-    return &ops;
-}
-
-bool thrift_fuse::ping_host()
-{
-    return false;
-}
-
-int thrift_fuse::thrift_fuse_main(int argc, char* argv[])
-{
-    return fuse_main(argc, argv, get_operations(), this);
-}
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+
+// Include thirft_fuse first to avoid refdefination error
+#include <thrift_fuse.h>
+
+#include <fuse_native.h>
+#include <logger.h>
+
+
+using namespace Fuse;
+
+thrift_fuse::thrift_fuse(const std::vector<replica_set>& shards, const boost::property_tree::ptree& config)
+{
+    _shards = shards;
+    _router.reset(shard_router::from_config(config));
+    if (_router->count() != _shards.size()) {
+        throw std::invalid_argument("Shard count does not match the replica sets");
+    }
+
+    auto cacheConfig = config.get_child("CACHE", boost::property_tree::ptree());
+    _attrCache.reset(new attr_cache(cacheConfig.get<size_t>("ATTR_CAPACITY", ATTR_CACHE_DEFAULT_CAPACITY),
+        cacheConfig.get<uint32_t>("ATTR_TTL_MS", ATTR_CACHE_DEFAULT_TTL_MS),
+        cacheConfig.get<size_t>("ATTR_SHARDS", ATTR_CACHE_DEFAULT_SHARDS)));
+    LOG_INFO << "Attribute cache " << (_attrCache->enabled() ? "enabled" : "disabled");
+
+    _negCache.reset(new neg_cache(cacheConfig.get<size_t>("NEGATIVE_CAPACITY", NEG_CACHE_DEFAULT_CAPACITY),
+        cacheConfig.get<uint32_t>("NEGATIVE_TTL_MS", NEG_CACHE_DEFAULT_TTL_MS),
+        cacheConfig.get<size_t>("NEGATIVE_SHARDS", NEG_CACHE_DEFAULT_SHARDS)));
+    LOG_INFO << "Negative lookup cache " << (_negCache->enabled() ? "enabled" : "disabled");
+
+    // The kernel caches default to the lifetimes of the matching client caches
+    auto attrTtl = cacheConfig.get<uint32_t>("ATTR_TTL_MS", ATTR_CACHE_DEFAULT_TTL_MS);
+    auto negativeTtl = cacheConfig.get<uint32_t>("NEGATIVE_TTL_MS", NEG_CACHE_DEFAULT_TTL_MS);
+    _entryTimeout = cacheConfig.get<uint32_t>("KERNEL_ENTRY_TIMEOUT_MS", attrTtl) / 1000.0;
+    _attrTimeout = cacheConfig.get<uint32_t>("KERNEL_ATTR_TIMEOUT_MS", attrTtl) / 1000.0;
+    _negativeTimeout = cacheConfig.get<uint32_t>("KERNEL_NEGATIVE_TIMEOUT_MS", negativeTtl) / 1000.0;
+
+    auto readdirConfig = config.get_child("READDIR", boost::property_tree::ptree());
+    _readdirPageSize = readdirConfig.get<int32_t>("PAGE_SIZE", READDIR_DEFAULT_PAGE_SIZE);
+    _readdirPrefetch = readdirConfig.get<bool>("PREFETCH", true);
+
+    auto readAheadConfig = config.get_child("READAHEAD", boost::property_tree::ptree());
+    read_ahead_config readAhead;
+    readAhead.windows = readAheadConfig.get<uint32_t>("WINDOWS", READ_AHEAD_DEFAULT_WINDOWS);
+    readAhead.minWindow = readAheadConfig.get<uint32_t>("MIN_WINDOW_KB", READ_AHEAD_DEFAULT_MIN_WINDOW / 1024) * 1024;
+    readAhead.maxWindow = readAheadConfig.get<uint32_t>("MAX_WINDOW_KB", READ_AHEAD_DEFAULT_MAX_WINDOW / 1024) * 1024;
+    readAhead.trigger = readAheadConfig.get<uint32_t>("TRIGGER", READ_AHEAD_DEFAULT_TRIGGER);
+    if (readAhead.maxWindow < readAhead.minWindow) {
+        readAhead.maxWindow = readAhead.minWindow;
+    }
+    _readAhead.reset(new read_ahead_table(readAhead));
+    if (!_readAhead->enabled()) {
+        _readAhead.reset();
+    }
+    LOG_INFO << "Read-ahead " << (_readAhead ? "enabled" : "disabled");
+
+    auto readCacheConfig = config.get_child("READ_CACHE", boost::property_tree::ptree());
+    _cacheBlockSize = readCacheConfig.get<uint32_t>("BLOCK_KB", READ_CACHE_DEFAULT_BLOCK / 1024) * 1024;
+    auto pageCacheBytes = readCacheConfig.get<size_t>("MEMORY_MB", PAGE_CACHE_DEFAULT_CAPACITY_MB) * 1024 * 1024;
+    if (pageCacheBytes > 0 && _cacheBlockSize > 0) {
+        _pageCache.reset(new page_cache(pageCacheBytes, _cacheBlockSize,
+            readCacheConfig.get<size_t>("MEMORY_SHARDS", PAGE_CACHE_DEFAULT_SHARDS)));
+    }
+    LOG_INFO << "Page cache " << (_pageCache ? "enabled" : "disabled");
+
+    auto diskCacheDir = readCacheConfig.get<std::string>("DISK_DIR", "");
+    if (!diskCacheDir.empty() && _cacheBlockSize > 0) {
+        _diskCache.reset(new disk_cache(diskCacheDir,
+            readCacheConfig.get<uint64_t>("DISK_MB", DISK_CACHE_DEFAULT_CAPACITY_MB) * 1024 * 1024,
+            _cacheBlockSize));
+    }
+    LOG_INFO << "Disk cache " << (_diskCache ? "enabled" : "disabled");
+
+    auto inlineConfig = config.get_child("INLINE", boost::property_tree::ptree());
+    auto inlineMax = inlineConfig.get<uint32_t>("MAX_FILE_KB", INLINE_DEFAULT_MAX_FILE / 1024) * 1024;
+    if (inlineMax > 0) {
+        _inline.reset(new inline_table(inlineMax,
+            inlineConfig.get<size_t>("CAPACITY_MB", INLINE_DEFAULT_CAPACITY / (1024 * 1024)) * 1024 * 1024));
+    }
+    LOG_INFO << "Small-file inlining " << (_inline ? "enabled" : "disabled");
+
+    _workers.reset(new worker_pool(config.get<size_t>("THRIFT.WORKER_THREADS", WORKER_POOL_DEFAULT_THREADS)));
+
+    auto writeBackConfig = config.get_child("WRITEBACK", boost::property_tree::ptree());
+    write_back_config writeBack;
+    writeBack.maxBytes = writeBackConfig.get<size_t>("MAX_BUFFER_KB", WRITE_BACK_DEFAULT_MAX_BYTES / 1024) * 1024;
+    writeBack.maxAgeMs = writeBackConfig.get<uint32_t>("MAX_AGE_MS", WRITE_BACK_DEFAULT_MAX_AGE_MS);
+    if (writeBack.maxBytes > 0) {
+        _writeBack.reset(new write_back_table(this, writeBack));
+    }
+    LOG_INFO << "Write-back " << (_writeBack ? "enabled" : "disabled");
+
+    auto batchConfig = config.get_child("BATCH", boost::property_tree::ptree());
+    op_batch_config batch;
+    batch.windowUs = batchConfig.get<uint32_t>("WINDOW_US", OP_BATCH_DEFAULT_WINDOW_US);
+    batch.maxSize = batchConfig.get<size_t>("MAX_SIZE", OP_BATCH_DEFAULT_MAX_SIZE);
+    _batcher.reset(new op_batcher(this, _shards.size(), batch));
+    LOG_INFO << "Operation batching " << (batch.maxSize > 1 ? "enabled" : "disabled");
+
+    ops = {
+        fuse_native::getattr,
+        fuse_native::readlink,
+        fuse_native::mknod,
+        fuse_native::mkdir,
+        fuse_native::unlink,
+        fuse_native::rmdir,
+        fuse_native::symlink,
+        fuse_native::rename,
+        fuse_native::link,
+        fuse_native::chmod,
+        fuse_native::chown,
+        fuse_native::truncate,
+        fuse_native::open,
+        fuse_native::read,
+        fuse_native::write,
+        fuse_native::statfs,
+        fuse_native::flush,
+        fuse_native::release,
+        fuse_native::fsync, // fsync
+        fuse_native::setxattr,
+        fuse_native::getxattr,
+        fuse_native::listxattr,
+        fuse_native::removexattr,
+        fuse_native::opendir,
+        fuse_native::readdir,
+        fuse_native::releasedir,
+        fuse_native::fsyncdir, // fsyncdir
+        fuse_native::init,
+        fuse_native::destroy, // destroy
+        fuse_native::access, // access
+        fuse_native::create, // create
+        fuse_native::lock, // lock
+        fuse_native::utimens,
+        fuse_native::bmap, // bmap
+#if 0
+			fuse_native::ioctl,
+#endif
+    };
+    ops.write_buf = fuse_native::write_buf;
+
+    _metricsSocket = config.get<std::string>("METRICS.SOCKET", "");
+}
+
+thrift_fuse::~thrift_fuse()
+{
+    // Scrapes read everything below, stop serving them first
+    _metrics.reset();
+    if (_writeBack) {
+        _writeBack->shutdown();
+    }
+    LOG_INFO << "Operation latency (us)\n" << _opStats.render();
+    LOG_INFO << "Attribute cache hits " << _attrCache->hits() << " misses " << _attrCache->misses();
+    LOG_INFO << "Negative lookup cache hits " << _negCache->hits() << " misses " << _negCache->misses();
+    if (_inline) {
+        LOG_INFO << "Reads served from inlined data " << _inline->hits();
+    }
+    if (_pageCache) {
+        LOG_INFO << "Page cache hits " << _pageCache->hits() << " misses " << _pageCache->misses();
+    }
+    if (_diskCache) {
+        LOG_INFO << "Disk cache hits " << _diskCache->hits() << " misses " << _diskCache->misses();
+    }
+    LOG_INFO << "Batched " << _batcher->batched() << " operations into " << _batcher->batches() << " calls";
+    for (auto& shard : _shards) {
+        for (auto pool : shard.pools()) {
+            pool->log_stats();
+        }
+    }
+}
+
+/*
+ * Without -f fuse_main forks into the background after the constructor ran,
+ * only the thread calling fork carries on in the child. Everything that runs
+ * a thread of its own is started here, from init in the process that serves
+ * the mount.
+ */
+void thrift_fuse::start()
+{
+    start_logging();
+    _workers->start();
+    if (_writeBack) {
+        _writeBack->start();
+    }
+    for (auto& shard : _shards) {
+        for (auto pool : shard.pools()) {
+            pool->start_maintainer();
+        }
+    }
+    if (!_metricsSocket.empty()) {
+        try {
+            _metrics.reset(new metrics_exporter(this, _metricsSocket));
+        } catch (std::exception& ex) {
+            LOG_ERROR << "Could not serve metrics on " << _metricsSocket << " " << ex.what();
+        }
+    }
+}
+
+fuse_operations*
+thrift_fuse::get_operations()
+{
+    return &ops;
+}
+
+bool thrift_fuse::ping_host()
+{
+    bool alive = true;
+    for (size_t shard = 0; shard < _shards.size(); shard++) {
+        for (auto pool : _shards[shard].pools()) {
+            ThriftClientPtr client;
+            try {
+                client = pool->acquire();
+            } catch (std::exception& ex) {
+                LOG_ERROR << "No channel to ping shard " << shard << " " << ex.what();
+                alive = false;
+                continue;
+            }
+
+            try {
+                client->ping();
+            } catch (std::exception& ex) {
+                if (thrift_client::breaks_connection(ex)) {
+                    client->mark_broken();
+                }
+                LOG_ERROR << "Host ping failed on " << client->get_client_id() << " " << ex.what();
+                alive = false;
+            }
+            pool->release(client);
+        }
+    }
+    return alive;
+}
+
+int thrift_fuse::thrift_fuse_main(int argc, char* argv[])
+{
+    return fuse_main(argc, argv, get_operations(), this);
+}
@@ -1,164 +1,327 @@
-/*
- ***************************************************************************** 
- * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
- *
- * Copyright (c) 2022 Yogender Solanki
- *
- * This program is free software: you can redistribute it and/or modify it
- * under the terms of the GNU Lesser General Public License as published by the
- * Free Software Foundation, either version 3 of the License, or (at your
- * option) any later version.
- *
- * This program is distributed in the hope that it will be useful, but WITHOUT
- * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
- * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
- * for more details.
- *
- * You should have received a copy of the GNU Lesser General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- *****************************************************************************
- */
-#pragma once
-#define _WINSOCKAPI_
-#include <fuse3/fuse.h>
-
-#include <FuseService.h>
-
-#include <memory>
-
-#include <blocking_queue.h>
-#include <thrift_client.h>
-
-using namespace apache::thrift::transport;
-using namespace apache::thrift::protocol;
-
-class thrift_fuse {
-private: // private fields
-    fuse_operations ops;
-    blocking_queue<ThriftClientPtr>* _clientQueue;
-
-public: // public field
-private: // private function
-public: // non static function
-    thrift_fuse(blocking_queue<ThriftClientPtr>* clients);
-    fuse_operations* get_operations();
-    bool ping_host();
-    int thrift_fuse_main(int argc, char* argv[]);
-
-    inline ThriftClientPtr get_tclient()
-    {
-        ThriftClientPtr conn;
-        _clientQueue->pop(conn);
-        return conn;
-    }
-
-    inline void release_tclient(ThriftClientPtr client)
-    {
-        _clientQueue->push(client);
-    }
-
-public: // misc private function
-    static inline thrift_fuse* get_tfuse_from_context()
-    {
-        return static_cast<thrift_fuse*>(fuse_get_context()->private_data);
-    }
-    static inline void fuse2thriftHandleInfo(fuse_file_info* fi,
-        Fuse::FuseHandleInfo& handleInfo)
-    {
-        if (fi == nullptr) {
-            handleInfo.__set_fh(-1);
-            return;
-        }
-        handleInfo.__set_direct_io(fi->direct_io);
-        handleInfo.__set_keep_cache(fi->keep_cache);
-        handleInfo.__set_fh(fi->fh);
-        handleInfo.__set_flags(fi->flags);
-        handleInfo.__set_flush(fi->flush);
-        handleInfo.__set_lock_owner(fi->lock_owner);
-        handleInfo.__set_nonSeekable(fi->nonseekable);
-        handleInfo.__set_poll_events(fi->poll_events);
-    }
-
-    static inline void t2fHandle(Fuse::FuseHandleInfo handleInfo, fuse_file_info* fi)
-    {
-        if (handleInfo.__isset.direct_io)
-            fi->direct_io = handleInfo.direct_io;
-        if (handleInfo.__isset.keep_cache)
-            fi->keep_cache = handleInfo.keep_cache;
-        if (handleInfo.__isset.fh)
-            fi->fh = handleInfo.fh;
-        if (handleInfo.__isset.flags)
-            fi->flags = handleInfo.flags;
-        if (handleInfo.__isset.flush)
-            fi->flush = handleInfo.flush;
-        if (handleInfo.__isset.lock_owner)
-            fi->lock_owner = handleInfo.lock_owner;
-        if (handleInfo.__isset.nonSeekable)
-            fi->nonseekable = handleInfo.nonSeekable;
-        if (handleInfo.__isset.poll_events)
-            fi->poll_events = handleInfo.poll_events;
-    }
-
-    static inline void t2fStatFS(Fuse::FuseStatFS statFs, fuse_statvfs* stBuf)
-    {
-        if (statFs.__isset.bavail)
-            stBuf->f_bavail = statFs.bavail;
-        if (statFs.__isset.bfree)
-            stBuf->f_bfree = statFs.bfree;
-        if (statFs.__isset.blocks)
-            stBuf->f_blocks = statFs.blocks;
-        if (statFs.__isset.bSize)
-            stBuf->f_bsize = statFs.bSize;
-        if (statFs.__isset.bavail)
-            stBuf->f_favail = statFs.favail;
-        if (statFs.__isset.files)
-            stBuf->f_files = statFs.files;
-        if (statFs.__isset.flags)
-            stBuf->f_flag = statFs.flags;
-        if (statFs.__isset.free)
-            stBuf->f_ffree = statFs.free;
-        if (statFs.__isset.frSize)
-            stBuf->f_frsize = statFs.frSize;
-        if (statFs.__isset.fsid)
-            stBuf->f_fsid = statFs.fsid;
-        if (statFs.__isset.namemax)
-            stBuf->f_namemax = statFs.namemax;
-    }
-
-    static inline void t2fFileStat(Fuse::FuseStat& stats, fuse_stat* st)
-    {
-        if (stats.__isset.accessTime)
-            st->st_atim = { stats.accessTime };
-        if (stats.__isset.blksize)
-            st->st_blksize = stats.blksize;
-        if (stats.__isset.blocks)
-            st->st_blocks = stats.blocks;
-        if (stats.__isset.changeTime)
-            st->st_ctim = { stats.changeTime };
-        if (stats.__isset.dev)
-            st->st_dev = stats.dev;
-        if (stats.__isset.gid)
-            st->st_gid = stats.gid;
-        if (stats.__isset.ino)
-            st->st_ino = stats.ino;
-        if (stats.__isset.mode)
-            st->st_mode = stats.mode;
-        if (stats.__isset.modificationTime)
-            st->st_mtim = { stats.modificationTime };
-        if (stats.__isset.nlink)
-            st->st_nlink = stats.nlink;
-        if (stats.__isset.rdev)
-            st->st_rdev = stats.rdev;
-        if (stats.__isset.size)
-            st->st_size = stats.size;
-        if (stats.__isset.uid)
-            st->st_uid = stats.uid;
-    }
-    static inline void fuse2thriftContext(fuse_context* fuse_context, Fuse::FuseContext& context)
-    {
-        context.__set_gid(fuse_context->gid);
-        context.__set_uid(fuse_context->uid);
-        context.__set_pid(fuse_context->pid);
-        context.__set_umask(fuse_context->umask);
-    }
-};
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+#define _WINSOCKAPI_
+#include <fuse3/fuse.h>
+
+#include <FuseService.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <attr_cache.h>
+#include <client_pool.h>
+#include <dir_stream.h>
+#include <disk_cache.h>
+#include <inline_data.h>
+#include <metrics_exporter.h>
+#include <neg_cache.h>
+#include <page_cache.h>
+#include <op_batcher.h>
+#include <op_stats.h>
+#include <read_ahead.h>
+#include <replica_set.h>
+#include <shard_router.h>
+#include <thrift_client.h>
+#include <worker_pool.h>
+#include <write_back.h>
+
+using namespace apache::thrift::transport;
+using namespace apache::thrift::protocol;
+
+class thrift_fuse {
+private: // private fields
+    fuse_operations ops;
+    // Backends of every shard, indexed like the router's shards
+    std::vector<replica_set> _shards;
+    std::unique_ptr<shard_router> _router;
+    std::unique_ptr<attr_cache> _attrCache;
+    std::unique_ptr<neg_cache> _negCache;
+    dir_stream_table _dirStreams;
+    std::unique_ptr<read_ahead_table> _readAhead;
+    std::unique_ptr<inline_table> _inline;
+    std::unique_ptr<page_cache> _pageCache;
+    std::unique_ptr<disk_cache> _diskCache;
+    // Block size of both content caches
+    uint32_t _cacheBlockSize;
+    std::unique_ptr<write_back_table> _writeBack;
+    std::unique_ptr<op_batcher> _batcher;
+    op_stats _opStats;
+    std::string _metricsSocket;
+    std::unique_ptr<metrics_exporter> _metrics;
+    // Kernel side cache lifetimes in seconds, handed to fuse in init
+    double _entryTimeout;
+    double _attrTimeout;
+    double _negativeTimeout;
+    int32_t _readdirPageSize;
+    bool _readdirPrefetch;
+    // Last so queued jobs are drained before anything they use goes away
+    std::unique_ptr<worker_pool> _workers;
+
+public: // public field
+private: // private function
+public: // non static function
+    thrift_fuse(const std::vector<replica_set>& shards, const boost::property_tree::ptree& config);
+    ~thrift_fuse();
+    // Start the background threads, called once the mount is being served
+    void start();
+    fuse_operations* get_operations();
+    bool ping_host();
+    int thrift_fuse_main(int argc, char* argv[]);
+
+    // Shard owning path, pick the client from that shard's primary pool
+    inline size_t route(const std::string& path) const
+    {
+        return _router->route(path);
+    }
+
+    inline shard_router* get_router()
+    {
+        return _router.get();
+    }
+
+    inline ThriftClientPtr get_tclient(size_t shard = 0)
+    {
+        return _shards[shard].primary()->acquire();
+    }
+
+    inline void release_tclient(ThriftClientPtr client, size_t shard = 0)
+    {
+        _shards[shard].primary()->release(client);
+    }
+
+    inline client_pool* get_client_pool(size_t shard = 0)
+    {
+        return _shards[shard].primary();
+    }
+
+    inline const replica_set& get_replicas(size_t shard)
+    {
+        return _shards[shard];
+    }
+
+    // Pool for a read-only call on path that carries no handle
+    inline client_pool* get_read_pool(const std::string& path)
+    {
+        return _shards[route(path)].pick_reader();
+    }
+
+    // Pool for a read-only call of shard that carries a handle. Handles come
+    // from the primary, on a replica the call goes by path instead.
+    inline client_pool* get_read_pool(size_t shard, Fuse::FuseHandleInfo& handle)
+    {
+        auto pool = _shards[shard].pick_reader();
+        if (!_shards[shard].is_primary(pool)) {
+            handle.__set_fh(-1);
+        }
+        return pool;
+    }
+
+    inline attr_cache* get_attr_cache()
+    {
+        return _attrCache.get();
+    }
+
+    inline neg_cache* get_neg_cache()
+    {
+        return _negCache.get();
+    }
+
+    inline void set_kernel_timeouts(fuse_config* conf) const
+    {
+        conf->entry_timeout = _entryTimeout;
+        conf->attr_timeout = _attrTimeout;
+        conf->negative_timeout = _negativeTimeout;
+    }
+
+    inline dir_stream_table* get_dir_streams()
+    {
+        return &_dirStreams;
+    }
+
+    // Null when read-ahead is disabled
+    inline read_ahead_table* get_read_ahead()
+    {
+        return _readAhead.get();
+    }
+
+    // Null when the in-memory content cache is disabled
+    inline page_cache* get_page_cache()
+    {
+        return _pageCache.get();
+    }
+
+    inline uint32_t get_cache_block_size() const
+    {
+        return _cacheBlockSize;
+    }
+
+    // Null when no disk cache directory is configured
+    inline disk_cache* get_disk_cache()
+    {
+        return _diskCache.get();
+    }
+
+    // Null when small-file inlining is disabled
+    inline inline_table* get_inline_table()
+    {
+        return _inline.get();
+    }
+
+    // Null when write-back is disabled
+    inline write_back_table* get_write_back()
+    {
+        return _writeBack.get();
+    }
+
+    inline op_batcher* get_batcher()
+    {
+        return _batcher.get();
+    }
+
+    inline op_stats* get_op_stats()
+    {
+        return &_opStats;
+    }
+
+    inline int32_t get_readdir_page_size() const
+    {
+        return _readdirPageSize;
+    }
+
+    inline bool readdir_prefetch() const
+    {
+        return _readdirPrefetch && _workers->enabled();
+    }
+
+    inline worker_pool* get_workers()
+    {
+        return _workers.get();
+    }
+
+public: // misc private function
+    static inline thrift_fuse* get_tfuse_from_context()
+    {
+        return static_cast<thrift_fuse*>(fuse_get_context()->private_data);
+    }
+    static inline void fuse2thriftHandleInfo(fuse_file_info* fi,
+        Fuse::FuseHandleInfo& handleInfo)
+    {
+        if (fi == nullptr) {
+            handleInfo.__set_fh(-1);
+            return;
+        }
+        handleInfo.__set_direct_io(fi->direct_io);
+        handleInfo.__set_keep_cache(fi->keep_cache);
+        handleInfo.__set_fh(fi->fh);
+        handleInfo.__set_flags(fi->flags);
+        handleInfo.__set_flush(fi->flush);
+        handleInfo.__set_lock_owner(fi->lock_owner);
+        handleInfo.__set_nonSeekable(fi->nonseekable);
+        handleInfo.__set_poll_events(fi->poll_events);
+    }
+
+    static inline void t2fHandle(Fuse::FuseHandleInfo handleInfo, fuse_file_info* fi)
+    {
+        if (handleInfo.__isset.direct_io)
+            fi->direct_io = handleInfo.direct_io;
+        if (handleInfo.__isset.keep_cache)
+            fi->keep_cache = handleInfo.keep_cache;
+        if (handleInfo.__isset.fh)
+            fi->fh = handleInfo.fh;
+        if (handleInfo.__isset.flags)
+            fi->flags = handleInfo.flags;
+        if (handleInfo.__isset.flush)
+            fi->flush = handleInfo.flush;
+        if (handleInfo.__isset.lock_owner)
+            fi->lock_owner = handleInfo.lock_owner;
+        if (handleInfo.__isset.nonSeekable)
+            fi->nonseekable = handleInfo.nonSeekable;
+        if (handleInfo.__isset.poll_events)
+            fi->poll_events = handleInfo.poll_events;
+    }
+
+    static inline void t2fStatFS(Fuse::FuseStatFS statFs, fuse_statvfs* stBuf)
+    {
+        if (statFs.__isset.bavail)
+            stBuf->f_bavail = statFs.bavail;
+        if (statFs.__isset.bfree)
+            stBuf->f_bfree = statFs.bfree;
+        if (statFs.__isset.blocks)
+            stBuf->f_blocks = statFs.blocks;
+        if (statFs.__isset.bSize)
+            stBuf->f_bsize = statFs.bSize;
+        if (statFs.__isset.bavail)
+            stBuf->f_favail = statFs.favail;
+        if (statFs.__isset.files)
+            stBuf->f_files = statFs.files;
+        if (statFs.__isset.flags)
+            stBuf->f_flag = statFs.flags;
+        if (statFs.__isset.free)
+            stBuf->f_ffree = statFs.free;
+        if (statFs.__isset.frSize)
+            stBuf->f_frsize = statFs.frSize;
+        if (statFs.__isset.fsid)
+            stBuf->f_fsid = statFs.fsid;
+        if (statFs.__isset.namemax)
+            stBuf->f_namemax = statFs.namemax;
+    }
+
+    static inline void t2fFileStat(Fuse::FuseStat& stats, fuse_stat* st)
+    {
+        if (stats.__isset.accessTime)
+            st->st_atim = { stats.accessTime };
+        if (stats.__isset.blksize)
+            st->st_blksize = stats.blksize;
+        if (stats.__isset.blocks)
+            st->st_blocks = stats.blocks;
+        if (stats.__isset.changeTime)
+            st->st_ctim = { stats.changeTime };
+        if (stats.__isset.dev)
+            st->st_dev = stats.dev;
+        if (stats.__isset.gid)
+            st->st_gid = stats.gid;
+        if (stats.__isset.ino)
+            st->st_ino = stats.ino;
+        if (stats.__isset.mode)
+            st->st_mode = stats.mode;
+        if (stats.__isset.modificationTime)
+            st->st_mtim = { stats.modificationTime };
+        if (stats.__isset.nlink)
+            st->st_nlink = stats.nlink;
+        if (stats.__isset.rdev)
+            st->st_rdev = stats.rdev;
+        if (stats.__isset.size)
+            st->st_size = stats.size;
+        if (stats.__isset.uid)
+            st->st_uid = stats.uid;
+    }
+    static inline void fuse2thriftContext(fuse_context* fuse_context, Fuse::FuseContext& context)
+    {
+        context.__set_gid(fuse_context->gid);
+        context.__set_uid(fuse_context->uid);
+        context.__set_pid(fuse_context->pid);
+        context.__set_umask(fuse_context->umask);
+    }
+};
@@ -0,0 +1,102 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+#include <Logger.h>
+#include <op_stats.h>
+#include <thrift_client.h>
+
+/*
+ * Helpers shared by everything that issues RPCs through the client queue.
+ * Users include thrift_fuse.h first.
+ */
+
+struct scope_exit {
+    scope_exit(std::function<void(void)> f)
+        : f_(f)
+    {
+    }
+    ~scope_exit(void) { f_(); }
+
+private:
+    std::function<void(void)> f_;
+};
+
+// Run call with a client of pool bound to `client`, timing it for replica
+// selection and for the op_timer of the calling callback
+#define THRIFT_POOL_CALL(pool, call)                                                       \
+    {                                                                                      \
+        client_pool* clientPool = (pool);                                                  \
+        try {                                                                              \
+            auto waitStart = std::chrono::steady_clock::now();                             \
+            auto client = clientPool->acquire();                                           \
+            scope_exit relaseChannel([client, clientPool](void) {                          \
+                clientPool->release(client);                                               \
+            });                                                                            \
+            LOG_DEBUG << "Calling host " << " => [" << client->get_client_id() << "]";     \
+            auto callStart = std::chrono::steady_clock::now();                             \
+            op_timer::note_wait(std::chrono::duration_cast<std::chrono::microseconds>(     \
+                callStart - waitStart).count());                                           \
+            try {                                                                          \
+                call;                                                                      \
+            } catch (std::exception & callEx) {                                            \
+                if (thrift_client::breaks_connection(callEx)) {                            \
+                    client->mark_broken();                                                 \
+                }                                                                          \
+                throw;                                                                     \
+            }                                                                              \
+            auto callUs = std::chrono::duration_cast<std::chrono::microseconds>(           \
+                std::chrono::steady_clock::now() - callStart).count();                     \
+            clientPool->record_latency(callUs);                                            \
+            op_timer::note_rpc(callUs);                                                    \
+        } catch (std::exception & ex) {                                                    \
+            clientPool->record_failure();                                                  \
+            op_timer::note_failure();                                                      \
+            resp.status = Fuse::StatusCode::FUSE_ERRECANCELED;                             \
+            LOG_ERROR << " Operation failed due to exception " << ex.what();               \
+            thrift_client::HandleException(ex);                                            \
+        }                                                                                  \
+    }
+
+// THRIFT_POOL_CALL on the primary of shard, against an explicit thrift_fuse
+#define THRIFT_CLIENT_CALL(fs, shard, call) \
+    THRIFT_POOL_CALL((fs)->get_client_pool(shard), call)
+
+// THRIFT_CLIENT_CALL on the shard that owns path
+#define THRIFT_PATH_CALL(fs, path, call) \
+    THRIFT_CLIENT_CALL(fs, (fs)->route(path), call)
+
+// THRIFT_OP against an explicit thrift_fuse, for threads without a fuse context.
+// Routed by the first argument after the response, which is the path.
+#define THRIFT_FS_OP(fs, func, response, path, ...) \
+    THRIFT_PATH_CALL(fs, path, client->GetStub()->func(response, path, __VA_ARGS__))
+
+#define THRIFT_OP(func, ...) \
+    THRIFT_FS_OP(thrift_fuse::get_tfuse_from_context(), func, __VA_ARGS__)
+
+// THRIFT_OP for read-only calls without a handle, served by the quickest
+// reader of the shard instead of its primary
+#define THRIFT_READ_OP(func, response, path, ...)                                  \
+    THRIFT_POOL_CALL(thrift_fuse::get_tfuse_from_context()->get_read_pool(path),   \
+        client->GetStub()->func(response, path, __VA_ARGS__))
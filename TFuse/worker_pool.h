@@ -0,0 +1,88 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+
+#include <blocking_queue.h>
+
+#define WORKER_POOL_DEFAULT_THREADS 4
+
+/*
+ * Fixed set of background threads draining a queue of jobs.
+ *
+ * Used for work the FUSE threads hand off and do not wait for right away
+ * (prefetching). Jobs run without a fuse context, so they must not call
+ * fuse_get_context() or thrift_fuse::get_tfuse_from_context().
+ *
+ * The threads are spawned by start, jobs submitted before wait for them.
+ */
+class worker_pool {
+private:
+    blocking_queue<std::function<void(void)>> jobs;
+    size_t threadCount;
+    std::vector<std::unique_ptr<boost::thread>> threads;
+
+public:
+    worker_pool(size_t count)
+        : threadCount(count)
+    {
+    }
+
+    ~worker_pool()
+    {
+        jobs.close();
+        for (auto& thread : threads) {
+            thread->join();
+        }
+    }
+
+    void start()
+    {
+        for (size_t i = threads.size(); i < threadCount; i++) {
+            threads.emplace_back(new boost::thread([this]() {
+                std::function<void(void)> job;
+                while (jobs.pop(job)) {
+                    job();
+                }
+            }));
+        }
+    }
+
+    inline bool enabled() const
+    {
+        return threadCount > 0;
+    }
+
+    // Returns false when there are no threads to run the job
+    inline bool submit(std::function<void(void)> job)
+    {
+        if (threadCount == 0) {
+            return false;
+        }
+        jobs.push(job);
+        return true;
+    }
+};
@@ -0,0 +1,332 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+// Include thirft_fuse first to avoid refdefination error
+#include <thrift_fuse.h>
+
+#include <Logger.h>
+#include <thrift_op.h>
+#include <write_back.h>
+
+using namespace Fuse;
+
+void write_buffer::merge(int64_t off, const write_segment* segments, size_t count)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++) {
+        size += segments[i].size;
+    }
+    int64_t start = off;
+    int64_t end = off + static_cast<int64_t>(size);
+
+    // First extent that could touch [start, end)
+    auto first = extents.upper_bound(start);
+    if (first != extents.begin()) {
+        auto prev = std::prev(first);
+        if (prev->first + static_cast<int64_t>(prev->second.size()) >= start) {
+            first = prev;
+        }
+    }
+    auto last = first;
+    while (last != extents.end() && last->first <= end) {
+        ++last;
+    }
+
+    if (first == last) {
+        std::string data;
+        data.reserve(size);
+        for (size_t i = 0; i < count; i++) {
+            data.append(segments[i].data, segments[i].size);
+        }
+        extents.emplace(start, std::move(data));
+        bytes += size;
+        return;
+    }
+
+    int64_t mergedStart = std::min(start, first->first);
+    auto tail = std::prev(last);
+    int64_t mergedEnd = std::max(end, tail->first + static_cast<int64_t>(tail->second.size()));
+
+    std::string merged(static_cast<size_t>(mergedEnd - mergedStart), '\0');
+    for (auto it = first; it != last; ++it) {
+        merged.replace(static_cast<size_t>(it->first - mergedStart), it->second.size(), it->second);
+        bytes -= it->second.size();
+    }
+    size_t pos = static_cast<size_t>(start - mergedStart);
+    for (size_t i = 0; i < count; i++) {
+        merged.replace(pos, segments[i].size, segments[i].data, segments[i].size);
+        pos += segments[i].size;
+    }
+    bytes += merged.size();
+
+    extents.erase(first, last);
+    extents.emplace(mergedStart, std::move(merged));
+}
+
+bool write_buffer::overlaps(int64_t off, size_t size) const
+{
+    // Last extent starting before the end of the range
+    auto it = extents.lower_bound(off + static_cast<int64_t>(size));
+    if (it == extents.begin()) {
+        return false;
+    }
+    --it;
+    return it->first + static_cast<int64_t>(it->second.size()) > off;
+}
+
+write_back_table::write_back_table(thrift_fuse* owner, const write_back_config& conf)
+    : fs(owner)
+    , config(conf)
+    , dirtyCount(0)
+{
+}
+
+write_back_table::~write_back_table()
+{
+    shutdown();
+}
+
+void write_back_table::start()
+{
+    boost::mutex::scoped_lock guard(lock);
+    if (enabled() && config.maxAgeMs > 0 && flusher == nullptr && !stopping) {
+        flusher.reset(new boost::thread([this]() { flusher_loop(); }));
+    }
+}
+
+write_buffer_ptr write_back_table::find(uint64_t fh, const std::string& path, bool create)
+{
+    boost::mutex::scoped_lock guard(lock);
+    auto it = buffers.find(buffer_key(fh, path));
+    if (it != buffers.end()) {
+        return it->second;
+    }
+    if (!create) {
+        return nullptr;
+    }
+    auto buffer = std::make_shared<write_buffer>();
+    buffer->path = path;
+    buffers.emplace(buffer_key(fh, path), buffer);
+    return buffer;
+}
+
+void write_back_table::write(uint64_t fh,
+    const std::string& path,
+    const write_segment* segments,
+    size_t count,
+    int64_t off,
+    const FuseHandleInfo& handle,
+    const FuseContext& context)
+{
+    auto buffer = find(fh, path, true);
+    bool queue = false;
+    bool mustWait = false;
+    {
+        boost::mutex::scoped_lock guard(buffer->lock);
+        if (buffer->extents.empty()) {
+            buffer->firstDirty = write_buffer::clock::now();
+            dirtyCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        buffer->handle = handle;
+        buffer->context = context;
+        buffer->merge(off, segments, count);
+
+        if (buffer->bytes >= 2 * config.maxBytes) {
+            mustWait = true;
+        } else if (buffer->bytes >= config.maxBytes && !buffer->flushQueued) {
+            buffer->flushQueued = true;
+            queue = true;
+        }
+    }
+
+    if (mustWait) {
+        flush_buffer(buffer);
+    } else if (queue) {
+        if (!fs->get_workers()->submit([this, buffer]() { flush_buffer(buffer); })) {
+            flush_buffer(buffer);
+        }
+    }
+}
+
+int write_back_table::flush_buffer(write_buffer_ptr buffer)
+{
+    boost::mutex::scoped_lock flushGuard(buffer->flushLock);
+
+    std::map<int64_t, std::string> extents;
+    std::string path;
+    FuseHandleInfo handle;
+    FuseContext context;
+    {
+        boost::mutex::scoped_lock guard(buffer->lock);
+        buffer->flushQueued = false;
+        if (buffer->extents.empty()) {
+            return buffer->deferredError;
+        }
+        extents.swap(buffer->extents);
+        buffer->bytes = 0;
+        path = buffer->path;
+        handle = buffer->handle;
+        context = buffer->context;
+        dirtyCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    int error = 0;
+    for (auto& extent : extents) {
+        FileSystemResponse resp;
+        THRIFT_FS_OP(fs, write, resp, path, extent.second, extent.first, static_cast<int32_t>(extent.second.size()), handle, context);
+        if (resp.status != StatusCode::FUSE_SUCCESS) {
+            LOG_ERROR << "Write-back failed " << " Path " << path << " Offset " << extent.first << " Error " << resp.status;
+            error = resp.status;
+            break;
+        }
+        if (resp.dataWritten != static_cast<int64_t>(extent.second.size())) {
+            LOG_ERROR << "Short write-back " << " Path " << path << " Offset " << extent.first;
+            error = StatusCode::FUSE_ERROREIO;
+            break;
+        }
+        fs->get_client_pool(fs->route(path))->record_written(resp.dataWritten);
+    }
+
+    boost::mutex::scoped_lock guard(buffer->lock);
+    if (error != 0 && buffer->deferredError == 0) {
+        buffer->deferredError = error;
+    }
+    return buffer->deferredError;
+}
+
+int write_back_table::flush(uint64_t fh, const std::string& path)
+{
+    auto buffer = find(fh, path, false);
+    if (buffer == nullptr) {
+        return StatusCode::FUSE_SUCCESS;
+    }
+    flush_buffer(buffer);
+
+    boost::mutex::scoped_lock guard(buffer->lock);
+    int error = buffer->deferredError;
+    buffer->deferredError = 0;
+    return error;
+}
+
+int write_back_table::release(uint64_t fh, const std::string& path)
+{
+    int error = flush(fh, path);
+    boost::mutex::scoped_lock guard(lock);
+    buffers.erase(buffer_key(fh, path));
+    return error;
+}
+
+void write_back_table::flush_path(const std::string& path)
+{
+    if (dirtyCount.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    std::vector<write_buffer_ptr> matches;
+    {
+        boost::mutex::scoped_lock guard(lock);
+        for (auto& entry : buffers) {
+            if (entry.first.second == path) {
+                matches.push_back(entry.second);
+            }
+        }
+    }
+    for (auto& buffer : matches) {
+        flush_buffer(buffer);
+    }
+}
+
+void write_back_table::flush_range(const std::string& path, int64_t off, size_t size)
+{
+    if (dirtyCount.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    std::vector<write_buffer_ptr> matches;
+    {
+        boost::mutex::scoped_lock guard(lock);
+        for (auto& entry : buffers) {
+            if (entry.first.second == path) {
+                matches.push_back(entry.second);
+            }
+        }
+    }
+    for (auto& buffer : matches) {
+        bool overlapping;
+        {
+            boost::mutex::scoped_lock guard(buffer->lock);
+            overlapping = buffer->overlaps(off, size);
+        }
+        if (overlapping) {
+            flush_buffer(buffer);
+        }
+    }
+}
+
+void write_back_table::flusher_loop()
+{
+    auto period = boost::chrono::milliseconds(std::max<uint32_t>(config.maxAgeMs / 2, 10));
+    boost::mutex::scoped_lock guard(lock);
+    while (!stopping) {
+        wakeup.wait_for(guard, period);
+        if (stopping || dirtyCount.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+
+        auto deadline = write_buffer::clock::now() - std::chrono::milliseconds(config.maxAgeMs);
+        std::vector<write_buffer_ptr> aged;
+        for (auto& entry : buffers) {
+            boost::mutex::scoped_lock bufferGuard(entry.second->lock);
+            if (!entry.second->extents.empty() && entry.second->firstDirty <= deadline) {
+                aged.push_back(entry.second);
+            }
+        }
+
+        guard.unlock();
+        for (auto& buffer : aged) {
+            flush_buffer(buffer);
+        }
+        guard.lock();
+    }
+}
+
+void write_back_table::shutdown()
+{
+    {
+        boost::mutex::scoped_lock guard(lock);
+        stopping = true;
+        wakeup.notify_all();
+    }
+    if (flusher != nullptr) {
+        flusher->join();
+        flusher.reset();
+    }
+
+    std::vector<write_buffer_ptr> remaining;
+    {
+        boost::mutex::scoped_lock guard(lock);
+        for (auto& entry : buffers) {
+            remaining.push_back(entry.second);
+        }
+    }
+    for (auto& buffer : remaining) {
+        flush_buffer(buffer);
+    }
+}
@@ -0,0 +1,142 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <FuseService.h>
+
+#define WRITE_BACK_DEFAULT_MAX_BYTES (4 * 1024 * 1024)
+#define WRITE_BACK_DEFAULT_MAX_AGE_MS 1000
+
+class thrift_fuse;
+struct write_segment;
+
+struct write_back_config {
+    size_t maxBytes = WRITE_BACK_DEFAULT_MAX_BYTES;
+    uint32_t maxAgeMs = WRITE_BACK_DEFAULT_MAX_AGE_MS;
+};
+
+/*
+ * Dirty data of one open file handle.
+ *
+ * Writes are merged into non overlapping extents keyed by offset, a later
+ * write wins where it overlaps an earlier one and touching extents are joined,
+ * so a stream of small appends leaves the handle as one large write.
+ */
+class write_buffer {
+private:
+    friend class write_back_table;
+    typedef std::chrono::steady_clock clock;
+
+    boost::mutex lock;
+    // Held for the whole of a flush so flushes of a handle never reorder
+    boost::mutex flushLock;
+
+    std::string path;
+    Fuse::FuseHandleInfo handle;
+    Fuse::FuseContext context;
+
+    std::map<int64_t, std::string> extents;
+    size_t bytes = 0;
+    clock::time_point firstDirty;
+    bool flushQueued = false;
+    // First error of a background flush, reported on the next flush/fsync/release
+    int deferredError = 0;
+
+    void merge(int64_t off, const write_segment* segments, size_t count);
+    bool overlaps(int64_t off, size_t size) const;
+};
+
+typedef std::shared_ptr<write_buffer> write_buffer_ptr;
+
+/*
+ * Write-back buffers of all open handles.
+ *
+ * A handle is flushed in the background once it holds maxBytes or its oldest
+ * dirty byte is maxAgeMs old, and synchronously on flush, fsync and release
+ * or before anything that has to observe the data (read, getattr, truncate,
+ * rename, unlink of the same path). A writer that gets twice maxBytes ahead of
+ * the flushes waits for one. Writes that must reach the backend before they
+ * return bypass the table, flush_range first writes out what they overlap.
+ */
+class write_back_table {
+private:
+    typedef std::pair<uint64_t, std::string> buffer_key;
+
+    thrift_fuse* fs;
+    write_back_config config;
+
+    boost::mutex lock;
+    std::map<buffer_key, write_buffer_ptr> buffers;
+    // Buffers holding data, lets the read paths skip the scan when all is clean
+    std::atomic<size_t> dirtyCount;
+
+    boost::condition_variable wakeup;
+    bool stopping = false;
+    std::unique_ptr<boost::thread> flusher;
+
+    write_buffer_ptr find(uint64_t fh, const std::string& path, bool create);
+    int flush_buffer(write_buffer_ptr buffer);
+    void flusher_loop();
+
+public:
+    write_back_table(thrift_fuse* owner, const write_back_config& conf);
+    ~write_back_table();
+
+    // Start the background flusher of data older than maxAgeMs
+    void start();
+
+    inline bool enabled() const
+    {
+        return config.maxBytes > 0;
+    }
+
+    // The payload may be scattered over segments, it is copied straight into the extents
+    void write(uint64_t fh,
+        const std::string& path,
+        const write_segment* segments,
+        size_t count,
+        int64_t off,
+        const Fuse::FuseHandleInfo& handle,
+        const Fuse::FuseContext& context);
+
+    // Flush the handle and return the pending error, if any
+    int flush(uint64_t fh, const std::string& path);
+    int release(uint64_t fh, const std::string& path);
+    void flush_path(const std::string& path);
+    // Flush the buffers of path holding data in [off, off + size)
+    void flush_range(const std::string& path, int64_t off, size_t size);
+
+    // Stop the background flusher and write out everything still buffered
+    void shutdown();
+};
@@ -0,0 +1,183 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A run is repeated with more iterations until it takes at least this long
+#define BENCH_DEFAULT_MIN_TIME 0.5
+#define BENCH_MAX_ITERATIONS 1000000000ULL
+
+/*
+ * Minimal harness in the style of Google Benchmark, so the JSON it writes can
+ * be compared with the same tooling (compare.py) without the dependency.
+ *
+ *   static void bm_thing(bench_state& state)
+ *   {
+ *       setup();
+ *       while (state.keep_running()) {
+ *           thing();
+ *       }
+ *       state.set_items_processed(state.iterations());
+ *   }
+ *   BENCHMARK(bm_thing)->arg(64)->arg(4096)->threads(1)->threads(8);
+ *
+ * Only the loop is timed. With threads(n) the function runs on n threads at
+ * once, each for the same number of iterations, and the run takes from the
+ * first loop starting to the last one ending. Its CPU time is what the
+ * threads used inside their loops, added up.
+ */
+
+// CPU time the calling thread has used so far
+double thread_cpu_seconds();
+
+class bench_state {
+public:
+    bench_state(uint64_t iterations, int64_t arg, int threadIndex, int threadCount);
+
+    inline bool keep_running()
+    {
+        if (done == 0) {
+            cpuStart = thread_cpu_seconds();
+            start = std::chrono::steady_clock::now();
+        }
+        if (done < maxIterations) {
+            done++;
+            return true;
+        }
+        end = std::chrono::steady_clock::now();
+        cpuEnd = thread_cpu_seconds();
+        return false;
+    }
+
+    inline uint64_t iterations() const
+    {
+        return maxIterations;
+    }
+
+    inline int64_t range() const
+    {
+        return argument;
+    }
+
+    inline int thread_index() const
+    {
+        return threadIndex;
+    }
+
+    inline int threads() const
+    {
+        return threadCount;
+    }
+
+    inline void set_bytes_processed(uint64_t bytes)
+    {
+        bytesProcessed = bytes;
+    }
+
+    inline void set_items_processed(uint64_t items)
+    {
+        itemsProcessed = items;
+    }
+
+    inline void skip_with_error(const std::string& message)
+    {
+        error = message;
+        maxIterations = done;
+    }
+
+private:
+    friend class bench_runner;
+
+    uint64_t maxIterations;
+    uint64_t done = 0;
+    int64_t argument;
+    int threadIndex;
+    int threadCount;
+    uint64_t bytesProcessed = 0;
+    uint64_t itemsProcessed = 0;
+    std::string error;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+    double cpuStart = 0;
+    double cpuEnd = 0;
+};
+
+typedef std::function<void(bench_state&)> bench_fn;
+
+struct bench_case {
+    std::string name;
+    bench_fn fn;
+    std::vector<int64_t> args;
+    std::vector<int> threadCounts;
+
+    inline bench_case* arg(int64_t value)
+    {
+        args.push_back(value);
+        return this;
+    }
+
+    inline bench_case* threads(int count)
+    {
+        threadCounts.push_back(count);
+        return this;
+    }
+};
+
+// One reported row, also produced by the workload driver (workload.h)
+struct bench_result {
+    std::string name;
+    uint64_t iterations;
+    int threads;
+    double seconds;
+    // Of all threads together
+    double cpuSeconds;
+    uint64_t bytes;
+    uint64_t items;
+    std::string error;
+    // Extra fields written as Google Benchmark user counters
+    std::vector<std::pair<std::string, double>> counters;
+};
+
+// Cases live for the whole process, registered from static initializers
+bench_case* bench_register(const std::string& name, bench_fn fn);
+
+// Address of the last value passed to bench_keep
+extern const void* volatile bench_sink;
+
+// Keep the compiler from dropping the computation of value
+template <typename T>
+inline void bench_keep(const T& value)
+{
+    bench_sink = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+#define BENCH_CONCAT_INNER(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_INNER(a, b)
+#define BENCHMARK(fn) \
+    static bench_case* BENCH_CONCAT(bench_case_, __LINE__) = bench_register(#fn, fn)
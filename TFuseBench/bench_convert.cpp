@@ -0,0 +1,74 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+// Include thirft_fuse first to avoid refdefination error
+#include <thrift_fuse.h>
+
+#include <cstring>
+
+#include <bench.h>
+#include <bench_fixtures.h>
+
+// Reply attributes into the stat buffer of a getattr callback
+static void bm_t2f_file_stat(bench_state& state)
+{
+    auto stat = bench_file_stat();
+    fuse_stat stbuf;
+    memset(&stbuf, 0, sizeof(stbuf));
+    while (state.keep_running()) {
+        thrift_fuse::t2fFileStat(stat, &stbuf);
+        bench_keep(stbuf);
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(bm_t2f_file_stat);
+
+// File info of a callback into the handle sent with every handle based RPC
+static void bm_fuse2thrift_handle_info(bench_state& state)
+{
+    fuse_file_info fi;
+    memset(&fi, 0, sizeof(fi));
+    fi.fh = 42;
+    fi.flags = 2;
+    fi.keep_cache = 1;
+    Fuse::FuseHandleInfo handle;
+    while (state.keep_running()) {
+        thrift_fuse::fuse2thriftHandleInfo(&fi, handle);
+        bench_keep(handle);
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(bm_fuse2thrift_handle_info);
+
+static void bm_fuse2thrift_context(bench_state& state)
+{
+    fuse_context fuseContext;
+    memset(&fuseContext, 0, sizeof(fuseContext));
+    fuseContext.uid = 1000;
+    fuseContext.gid = 1000;
+    fuseContext.pid = 1;
+    Fuse::FuseContext context;
+    while (state.keep_running()) {
+        thrift_fuse::fuse2thriftContext(&fuseContext, context);
+        bench_keep(context);
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(bm_fuse2thrift_context);
@@ -0,0 +1,53 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <FuseService.h>
+
+// Attributes as a backend fills them for a regular file
+inline Fuse::FuseStat bench_file_stat()
+{
+    Fuse::FuseStat stat;
+    stat.__set_dev(1);
+    stat.__set_ino(4242);
+    stat.__set_mode(0100644);
+    stat.__set_nlink(1);
+    stat.__set_uid(1000);
+    stat.__set_gid(1000);
+    stat.__set_rdev(0);
+    stat.__set_size(1 << 20);
+    stat.__set_blksize(4096);
+    stat.__set_blocks(256);
+    stat.__set_accessTime(1650000000);
+    stat.__set_modificationTime(1650000000);
+    stat.__set_changeTime(1650000000);
+    return stat;
+}
+
+inline Fuse::FuseContext bench_context()
+{
+    Fuse::FuseContext context;
+    context.__set_uid(1000);
+    context.__set_gid(1000);
+    context.__set_pid(1);
+    context.__set_umask(022);
+    return context;
+}
@@ -0,0 +1,345 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <Logger.h>
+#include <bench.h>
+#include <workload.h>
+
+const void* volatile bench_sink = nullptr;
+
+double thread_cpu_seconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+    // 100 ns units
+    auto ticks = [](const FILETIME& time) {
+        return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return (ticks(kernel) + ticks(user)) / 1e7;
+#else
+    struct timespec now;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) {
+        return 0;
+    }
+    return now.tv_sec + now.tv_nsec / 1e9;
+#endif
+}
+
+bench_state::bench_state(uint64_t iterations, int64_t arg, int index, int count)
+    : maxIterations(iterations)
+    , argument(arg)
+    , threadIndex(index)
+    , threadCount(count)
+{
+}
+
+static std::vector<std::unique_ptr<bench_case>>& registry()
+{
+    static std::vector<std::unique_ptr<bench_case>> cases;
+    return cases;
+}
+
+bench_case* bench_register(const std::string& name, bench_fn fn)
+{
+    registry().emplace_back(new bench_case { name, fn, {}, {} });
+    return registry().back().get();
+}
+
+class bench_runner {
+public:
+    explicit bench_runner(double minTime)
+        : minTime(minTime)
+    {
+    }
+
+    // Grow the iteration count until a run is long enough to trust
+    bench_result measure(const std::string& name, const bench_fn& fn, int64_t arg, int threads)
+    {
+        uint64_t iterations = 1;
+        while (true) {
+            auto result = run_once(fn, arg, threads, iterations);
+            result.name = name;
+            if (!result.error.empty() || result.seconds >= minTime || iterations >= BENCH_MAX_ITERATIONS) {
+                return result;
+            }
+            double multiplier = result.seconds <= 0 ? 10.0 : std::min(10.0, minTime * 1.4 / result.seconds);
+            iterations = std::min<uint64_t>(BENCH_MAX_ITERATIONS,
+                std::max<uint64_t>(iterations + 1, static_cast<uint64_t>(iterations * multiplier)));
+        }
+    }
+
+private:
+    bench_result run_once(const bench_fn& fn, int64_t arg, int threads, uint64_t iterations)
+    {
+        std::vector<bench_state> states;
+        for (int i = 0; i < threads; i++) {
+            states.emplace_back(iterations, arg, i, threads);
+        }
+
+        boost::barrier ready(threads);
+        auto body = [&](int index) {
+            ready.wait();
+            fn(states[index]);
+        };
+        std::vector<std::unique_ptr<boost::thread>> workers;
+        for (int i = 1; i < threads; i++) {
+            workers.emplace_back(new boost::thread(body, i));
+        }
+        body(0);
+        for (auto& worker : workers) {
+            worker->join();
+        }
+
+        bench_result result { "", iterations, threads, 0, 0, 0, 0, "", {} };
+        auto first = states[0].start;
+        auto last = states[0].end;
+        for (auto& state : states) {
+            first = std::min(first, state.start);
+            last = std::max(last, state.end);
+            result.cpuSeconds += state.cpuEnd - state.cpuStart;
+            result.bytes += state.bytesProcessed;
+            result.items += state.itemsProcessed;
+            if (!state.error.empty()) {
+                result.error = state.error;
+            }
+        }
+        result.seconds = std::chrono::duration<double>(last - first).count();
+        return result;
+    }
+
+    double minTime;
+};
+
+static std::string json_string(const std::string& value)
+{
+    std::string out = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+static std::string to_json(const std::vector<bench_result>& results, const char* executable)
+{
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::ostringstream out;
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": " << json_string(date) << ",\n"
+        << "    \"executable\": " << json_string(executable) << ",\n"
+        << "    \"num_cpus\": " << boost::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\"\n"
+#else
+        << "    \"library_build_type\": \"debug\"\n"
+#endif
+        << "  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        auto& result = results[i];
+        double perIteration = result.iterations == 0 ? 0 : result.seconds * 1e9 / result.iterations;
+        double cpuPerIteration = result.iterations == 0 ? 0 : result.cpuSeconds * 1e9 / result.iterations;
+        out << (i == 0 ? "\n" : ",\n") << "    {\n"
+            << "      \"name\": " << json_string(result.name) << ",\n"
+            << "      \"run_name\": " << json_string(result.name) << ",\n"
+            << "      \"run_type\": \"iteration\",\n"
+            << "      \"threads\": " << result.threads << ",\n"
+            << "      \"iterations\": " << result.iterations << ",\n"
+            << "      \"real_time\": " << perIteration << ",\n"
+            << "      \"cpu_time\": " << cpuPerIteration << ",\n"
+            << "      \"time_unit\": \"ns\"";
+        if (result.bytes > 0) {
+            out << ",\n      \"bytes_per_second\": " << result.bytes / result.seconds;
+        }
+        if (result.items > 0) {
+            out << ",\n      \"items_per_second\": " << result.items / result.seconds;
+        }
+        for (auto& counter : result.counters) {
+            out << ",\n      " << json_string(counter.first) << ": " << counter.second;
+        }
+        if (!result.error.empty()) {
+            out << ",\n      \"error_occurred\": true,\n      \"error_message\": " << json_string(result.error);
+        }
+        out << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
+
+static void print_row(const bench_result& result)
+{
+    if (!result.error.empty()) {
+        printf("%-60s ERROR: %s\n", result.name.c_str(), result.error.c_str());
+        return;
+    }
+    printf("%-60s %14.1f ns %14llu", result.name.c_str(), result.seconds * 1e9 / result.iterations,
+        static_cast<unsigned long long>(result.iterations));
+    if (result.bytes > 0) {
+        printf(" %10.1f MiB/s", result.bytes / result.seconds / (1024 * 1024));
+    }
+    if (result.items > 0) {
+        printf(" %12.0f items/s", result.items / result.seconds);
+    }
+    for (auto& counter : result.counters) {
+        printf(" %s=%g", counter.first.c_str(), counter.second);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+static bool option(const std::string& arg, const char* name, std::string& value)
+{
+    std::string prefix = std::string("--") + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    value = arg.substr(prefix.size());
+    return true;
+}
+
+/*
+ * Options follow Google Benchmark:
+ *   --benchmark_filter=<regex>   only cases whose name matches
+ *   --benchmark_min_time=<s>     shortest run that is reported
+ *   --benchmark_out=<file>       write the results as JSON to file
+ *   --benchmark_format=json      print JSON instead of the table
+ *   --benchmark_list_tests=true  print the case names and exit
+ *
+ * With --workload_dir=<mount> the registered cases are skipped and the end to
+ * end workload (workload.h) runs against that directory instead:
+ *   --workload_threads=<n> --workload_dirs=<n> --workload_files=<n>
+ *   --workload_file_size=<size> --workload_block_size=<size>
+ *   --workload_rand_block_size=<size> --workload_rand_ops=<n>
+ *   --workload_phases=<list>     subset of WORKLOAD_PHASES, in run order
+ *   --workload_fsync=true        fsync data files before closing them
+ *   --workload_direct=true       open data files with O_DIRECT
+ *   --workload_wait=<s>          wait for the mount to come up
+ *   --workload_stats=<file>      save the client op table after the run
+ */
+int main(int argc, char* argv[])
+{
+    init_logging();
+
+    std::string filter = ".";
+    std::string outFile;
+    std::string format = "console";
+    std::string listOnly;
+    double minTime = BENCH_DEFAULT_MIN_TIME;
+    workload_config workload;
+    for (int i = 1; i < argc; i++) {
+        std::string value;
+        if (option(argv[i], "benchmark_filter", value)) {
+            filter = value;
+        } else if (option(argv[i], "benchmark_min_time", value)) {
+            minTime = std::stod(value);
+        } else if (option(argv[i], "benchmark_out", value)) {
+            outFile = value;
+        } else if (option(argv[i], "benchmark_format", value)) {
+            format = value;
+        } else if (option(argv[i], "benchmark_list_tests", value)) {
+            listOnly = value;
+        } else if (workload_option(argv[i], workload)) {
+            continue;
+        } else {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::regex pattern(filter);
+    bench_runner runner(minTime);
+    std::vector<bench_result> results;
+    if (!workload.dir.empty()) {
+        results = run_workload(workload);
+        if (format != "json") {
+            for (auto& result : results) {
+                print_row(result);
+            }
+        }
+        registry().clear();
+    }
+    for (auto& bench : registry()) {
+        auto args = bench->args.empty() ? std::vector<int64_t> { 0 } : bench->args;
+        auto threadCounts = bench->threadCounts.empty() ? std::vector<int> { 1 } : bench->threadCounts;
+        for (auto arg : args) {
+            for (auto threads : threadCounts) {
+                std::string name = bench->name;
+                if (!bench->args.empty()) {
+                    name += "/" + std::to_string(arg);
+                }
+                if (!bench->threadCounts.empty()) {
+                    name += "/threads:" + std::to_string(threads);
+                }
+                if (!std::regex_search(name, pattern)) {
+                    continue;
+                }
+                if (listOnly == "true") {
+                    printf("%s\n", name.c_str());
+                    continue;
+                }
+                results.push_back(runner.measure(name, bench->fn, arg, threads));
+                if (format != "json") {
+                    print_row(results.back());
+                }
+            }
+        }
+    }
+
+    auto json = to_json(results, argv[0]);
+    if (format == "json") {
+        std::cout << json;
+    }
+    if (!outFile.empty()) {
+        std::ofstream out(outFile);
+        out << json;
+    }
+    return 0;
+}
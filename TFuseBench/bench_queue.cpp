@@ -0,0 +1,78 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <atomic>
+#include <functional>
+
+#include <bench.h>
+#include <blocking_queue.h>
+
+// Capacity of the bounded queue, small enough that producers block on it
+#define BENCH_QUEUE_LIMIT 64
+
+// Every thread pushes and then pops, so all of them fight for the one lock
+static void bm_queue_push_pop(bench_state& state)
+{
+    static blocking_queue<int> queue;
+    int value = 0;
+    while (state.keep_running()) {
+        queue.push(value);
+        queue.pop(value);
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(bm_queue_push_pop)->threads(1)->threads(2)->threads(4)->threads(8);
+
+/*
+ * Half of the threads produce and half consume through a bounded queue, like
+ * the worker pool does with FUSE callbacks on one side and workers on the
+ * other. Thread counts are even so every pushed item gets popped.
+ */
+static void bm_queue_bounded_handoff(bench_state& state)
+{
+    static blocking_queue<int> queue(BENCH_QUEUE_LIMIT);
+    bool producer = state.thread_index() % 2 == 0;
+    int value = 0;
+    while (state.keep_running()) {
+        if (producer) {
+            queue.push(value);
+        } else {
+            queue.pop(value);
+        }
+    }
+    state.set_items_processed(producer ? state.iterations() : 0);
+}
+BENCHMARK(bm_queue_bounded_handoff)->threads(2)->threads(4)->threads(8);
+
+// Job queue as the worker pool uses it, a std::function per item
+static void bm_queue_jobs(bench_state& state)
+{
+    static blocking_queue<std::function<void(void)>> queue;
+    // Shared, a thread may run the job another one pushed
+    static std::atomic<uint64_t> counter(0);
+    std::function<void(void)> job;
+    while (state.keep_running()) {
+        queue.push([]() { counter.fetch_add(1, std::memory_order_relaxed); });
+        queue.pop(job);
+        job();
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(bm_queue_jobs)->threads(1)->threads(4);
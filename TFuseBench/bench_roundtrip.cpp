@@ -0,0 +1,189 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+// Include thirft_fuse first to avoid refdefination error
+#include <thrift_fuse.h>
+
+#include <cstdlib>
+#include <memory>
+
+#include <boost/thread/thread.hpp>
+
+#include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/protocol/TCompactProtocol.h>
+#include <thrift/server/TThreadedServer.h>
+#include <thrift/transport/TBufferTransports.h>
+#include <thrift/transport/TServerSocket.h>
+
+#include <bench.h>
+#include <bench_fixtures.h>
+#include <client_pool.h>
+#include <mem_fs.h>
+#include <thrift_op.h>
+
+using namespace apache::thrift::server;
+
+// First loopback port, override with TFUSE_BENCH_PORT
+#define BENCH_LOOPBACK_PORT 19090
+
+// The native in-memory backend holding the one file the benchmarks stat
+static std::shared_ptr<mem_fs> loopback_backend()
+{
+    auto backend = std::make_shared<mem_fs>();
+    auto context = bench_context();
+    Fuse::FileSystemResponse created, resp;
+    backend->mkdir(resp, "/bench", 0755, context);
+    backend->create(created, "/bench/file", 0644, context, 0);
+    backend->release(resp, "/bench/file", created.info, context);
+    return backend;
+}
+
+/*
+ * Server on 127.0.0.1 plus a client pool to it, both with one wrap and
+ * protocol. The server thread stops when the process exits.
+ */
+class loopback {
+public:
+    loopback(int port, MessageWrap wrap, SerializationProtocol protocol)
+    {
+        std::shared_ptr<TTransportFactory> transports;
+        if (wrap == MessageWrap::FRAMED) {
+            transports = std::make_shared<TFramedTransportFactory>();
+        } else {
+            transports = std::make_shared<TBufferedTransportFactory>();
+        }
+        std::shared_ptr<TProtocolFactory> protocols;
+        if (protocol == SerializationProtocol::COMPACT) {
+            protocols = std::make_shared<TCompactProtocolFactory>();
+        } else {
+            protocols = std::make_shared<TBinaryProtocolFactory>();
+        }
+        server = std::make_shared<TThreadedServer>(
+            std::make_shared<Fuse::FuseServiceProcessor>(loopback_backend()),
+            std::make_shared<TServerSocket>("127.0.0.1", port),
+            transports,
+            protocols);
+        serverThread.reset(new boost::thread([this]() { server->serve(); }));
+
+        std::string target = "127.0.0.1:" + std::to_string(port);
+        client_pool_config config;
+        config.target = target;
+        config.pingMs = 0;
+        pool.reset(new client_pool([=](int id) {
+            auto client = std::make_shared<thrift_client>(target, "", TransportType::TCP_IP, wrap, protocol, id);
+            client->connect();
+            return client;
+        },
+            config));
+
+        // The server socket listens once serve() got going
+        for (int attempt = 0;; attempt++) {
+            try {
+                pool->start();
+                break;
+            } catch (std::exception&) {
+                if (attempt == 50) {
+                    throw;
+                }
+                boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+            }
+        }
+    }
+
+    ~loopback()
+    {
+        pool.reset();
+        server->stop();
+        serverThread->join();
+    }
+
+    inline client_pool* get_pool()
+    {
+        return pool.get();
+    }
+
+private:
+    std::shared_ptr<TThreadedServer> server;
+    std::unique_ptr<boost::thread> serverThread;
+    std::unique_ptr<client_pool> pool;
+};
+
+static int loopback_port(int offset)
+{
+    const char* port = std::getenv("TFUSE_BENCH_PORT");
+    return (port != nullptr ? std::atoi(port) : BENCH_LOOPBACK_PORT) + offset;
+}
+
+/*
+ * getattr through THRIFT_POOL_CALL, the path every FUSE callback takes to the
+ * backend: pool acquire, serialization, loopback TCP, server dispatch and back.
+ */
+static void bm_thrift_op_getattr(bench_state& state, loopback* server)
+{
+    Fuse::FuseHandleInfo handle;
+    handle.__set_fh(-1);
+    auto context = bench_context();
+    while (state.keep_running()) {
+        Fuse::FileSystemResponse resp;
+        THRIFT_POOL_CALL(server->get_pool(), client->GetStub()->getattr(resp, "/bench/file", handle, context));
+        if (resp.status != Fuse::StatusCode::FUSE_SUCCESS) {
+            state.skip_with_error("getattr failed with status " + std::to_string(resp.status));
+            break;
+        }
+    }
+    state.set_items_processed(state.iterations());
+}
+
+static bool register_roundtrip_benchmarks()
+{
+    struct {
+        const char* name;
+        MessageWrap wrap;
+        SerializationProtocol protocol;
+    } setups[] = {
+        { "BINARY/BUFFERED", MessageWrap::BUFFERED, SerializationProtocol::BINARY },
+        { "COMPACT/FRAMED", MessageWrap::FRAMED, SerializationProtocol::COMPACT },
+    };
+    int offset = 0;
+    for (auto& setup : setups) {
+        // Started on first use so filtered out cases open no sockets
+        auto server = std::make_shared<std::unique_ptr<loopback>>();
+        int port = loopback_port(offset++);
+        auto wrap = setup.wrap;
+        auto protocol = setup.protocol;
+        bench_register(std::string("bm_thrift_op_getattr/") + setup.name,
+            [server, port, wrap, protocol](bench_state& state) {
+                static boost::mutex startLock;
+                {
+                    boost::mutex::scoped_lock guard(startLock);
+                    if (!*server) {
+                        server->reset(new loopback(port, wrap, protocol));
+                    }
+                }
+                bm_thrift_op_getattr(state, server->get());
+            })
+            ->threads(1)
+            ->threads(4)
+            ->threads(16);
+    }
+    return true;
+}
+
+static bool roundtripRegistered = register_roundtrip_benchmarks();
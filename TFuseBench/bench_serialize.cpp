@@ -0,0 +1,124 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <memory>
+#include <string>
+
+#include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/protocol/TCompactProtocol.h>
+#include <thrift/protocol/TJSONProtocol.h>
+#include <thrift/transport/TBufferTransports.h>
+#include <thrift/transport/TZlibTransport.h>
+
+#include <bench.h>
+#include <bench_fixtures.h>
+#include <thrift_client.h>
+
+/*
+ * FileSystemResponse written and read back through the same protocol and
+ * message wrap stacks thrift_client builds on a connection, with an in-memory
+ * buffer standing in for the socket. Payload 0 is a getattr reply, the
+ * others are read replies of that many bytes.
+ */
+
+static std::shared_ptr<TTransport> wrap_transport(MessageWrap wrap, std::shared_ptr<TTransport> inner)
+{
+    switch (wrap) {
+    case MessageWrap::FRAMED:
+        return std::make_shared<TFramedTransport>(inner);
+    case MessageWrap::ZLIB:
+        return std::make_shared<TZlibTransport>(inner);
+    default:
+        return std::make_shared<TBufferedTransport>(inner);
+    }
+}
+
+static std::shared_ptr<TProtocol> make_protocol(SerializationProtocol protocol, std::shared_ptr<TTransport> transport)
+{
+    switch (protocol) {
+    case SerializationProtocol::COMPACT:
+        return std::make_shared<TCompactProtocol>(transport);
+    case SerializationProtocol::JSON:
+        return std::make_shared<TJSONProtocol>(transport);
+    default:
+        return std::make_shared<TBinaryProtocol>(transport);
+    }
+}
+
+static void bm_response_roundtrip(bench_state& state, SerializationProtocol protocol, MessageWrap wrap)
+{
+    auto buffer = std::make_shared<TMemoryBuffer>();
+    auto writer = make_protocol(protocol, wrap_transport(wrap, buffer));
+    auto reader = make_protocol(protocol, wrap_transport(wrap, buffer));
+
+    size_t payload = static_cast<size_t>(state.range());
+    Fuse::FileSystemResponse response;
+    response.status = Fuse::StatusCode::FUSE_SUCCESS;
+    response.__set_stats(bench_file_stat());
+    if (payload > 0) {
+        response.__set_data(std::string(payload, 'x'));
+    }
+
+    Fuse::FileSystemResponse decoded;
+    uint64_t wireBytes = 0;
+    while (state.keep_running()) {
+        response.write(writer.get());
+        writer->getTransport()->flush();
+        wireBytes += buffer->available_read();
+        decoded.read(reader.get());
+        buffer->resetBuffer();
+    }
+    bench_keep(decoded);
+    state.set_bytes_processed(payload > 0 ? state.iterations() * payload : wireBytes);
+}
+
+static bool register_serialize_benchmarks()
+{
+    struct {
+        const char* name;
+        SerializationProtocol protocol;
+    } protocols[] = {
+        { PROTO_BINARY, SerializationProtocol::BINARY },
+        { PROTO_COMPACT, SerializationProtocol::COMPACT },
+        { PROTO_JSON, SerializationProtocol::JSON },
+    };
+    struct {
+        const char* name;
+        MessageWrap wrap;
+    } wraps[] = {
+        { WRAP_BUFFERED, MessageWrap::BUFFERED },
+        { WRAP_FRAMED, MessageWrap::FRAMED },
+        { WRAP_ZLIB, MessageWrap::ZLIB },
+    };
+    for (auto& protocol : protocols) {
+        for (auto& wrap : wraps) {
+            auto proto = protocol.protocol;
+            auto wrapping = wrap.wrap;
+            bench_register(std::string("bm_response_roundtrip/") + protocol.name + "/" + wrap.name,
+                [proto, wrapping](bench_state& state) { bm_response_roundtrip(state, proto, wrapping); })
+                ->arg(0)
+                ->arg(4096)
+                ->arg(128 * 1024);
+        }
+    }
+    return true;
+}
+
+static bool serializeRegistered = register_serialize_benchmarks();
@@ -0,0 +1,73 @@
+#!/bin/sh
+
+# Mounts TFuse in front of a local backend as an ordinary user (fusermount3),
+# runs the end to end workload against it and unmounts again. Arguments are
+# passed on to TFuseBench, e.g.
+#
+#   ./run_workload.sh --workload_threads=8 --benchmark_out=after.json
+#
+# Needs Linux with /dev/fuse usable by the caller and the setuid fusermount3
+# of the fuse3 package (fusermount of fuse 2 works too), plus TFuse,
+# TFuseHost and TFuseBench built. No root is needed.
+#
+# TFUSE     TFuse binary
+# HOST      TFuseHost binary, the default backend
+# BENCH     TFuseBench binary
+# BACKEND   command starting the backend, it reads config.ini from its
+#           working directory like TFuse does. TFuseHost serving from memory
+#           when unset.
+# CONFIG    config.ini shared by both. When unset the shipped TFuse/config.ini
+#           is used with a UNIX socket in the work directory, FRAMED, the
+#           NONBLOCKING host server and the MEMORY backend.
+# MOUNT     mount point, a fresh temporary directory when unset
+
+SRC=$(cd "$(dirname "$0")/.." && pwd)
+TFUSE=$(realpath "${TFUSE:-./TFuse}")
+HOST=$(realpath "${HOST:-./TFuseHost}")
+BENCH=$(realpath "${BENCH:-./TFuseBench}")
+BACKEND=${BACKEND:-$HOST}
+
+WORKDIR=$(mktemp -d)
+MOUNT=${MOUNT:-$WORKDIR/mnt}
+mkdir -p "$MOUNT"
+SOCKET=
+if [ -n "$CONFIG" ]; then
+    cp "$CONFIG" "$WORKDIR/config.ini"
+else
+    # Keys that are unique in config.ini, the rest keeps its shipped value
+    SOCKET=$WORKDIR/tfuse.sock
+    sed -e "s|^TRANSPORT *=.*|TRANSPORT = UNIX_SOCKET|" \
+        -e "s|^WRAPPER *=.*|WRAPPER = FRAMED|" \
+        -e "s|^TARGET *=.*|TARGET = $SOCKET|" \
+        -e "s|^SERVER_TYPE *=.*|SERVER_TYPE = NONBLOCKING|" \
+        -e "s|^BACKEND *=.*|BACKEND = MEMORY|" \
+        "$SRC/TFuse/config.ini" > "$WORKDIR/config.ini"
+fi
+cd "$WORKDIR" || exit 1
+
+$BACKEND > backend.log 2>&1 &
+BACKEND_PID=$!
+# TFuse connects at mount time, so the backend has to listen first
+if [ -n "$SOCKET" ]; then
+    for i in $(seq 100); do
+        [ -S "$SOCKET" ] && break
+        sleep 0.1
+    done
+    if [ ! -S "$SOCKET" ]; then
+        echo "Backend did not create $SOCKET, see $WORKDIR/backend.log"
+        kill $BACKEND_PID 2> /dev/null
+        exit 1
+    fi
+fi
+"$TFUSE" -f "$MOUNT" > tfuse.log 2>&1 &
+TFUSE_PID=$!
+
+"$BENCH" --workload_dir="$MOUNT" --workload_wait=30 --workload_stats="$WORKDIR/stats.txt" "$@"
+STATUS=$?
+
+fusermount3 -u "$MOUNT" || fusermount -u "$MOUNT"
+wait $TFUSE_PID
+kill $BACKEND_PID
+wait $BACKEND_PID 2> /dev/null
+echo "Logs and the client op table are in $WORKDIR"
+exit $STATUS
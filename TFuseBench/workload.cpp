@@ -0,0 +1,686 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <boost/filesystem.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <Logger.h>
+#include <op_stats.h>
+#include <workload.h>
+
+namespace fs = boost::filesystem;
+
+// Buffers are aligned for O_DIRECT, which wants the logical block size or better
+#define WORKLOAD_BUFFER_ALIGN 4096
+#define WORKLOAD_MOUNT_POLL_MS 100
+
+#ifdef _WIN32
+static int file_open(const std::string& path, int flags)
+{
+    return _open(path.c_str(), flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+
+static int64_t file_pread(int fd, char* buf, size_t size, uint64_t offset)
+{
+    if (_lseeki64(fd, static_cast<int64_t>(offset), SEEK_SET) < 0) {
+        return -1;
+    }
+    return _read(fd, buf, static_cast<unsigned int>(size));
+}
+
+static int64_t file_pwrite(int fd, const char* buf, size_t size, uint64_t offset)
+{
+    if (_lseeki64(fd, static_cast<int64_t>(offset), SEEK_SET) < 0) {
+        return -1;
+    }
+    return _write(fd, buf, static_cast<unsigned int>(size));
+}
+
+static int file_sync(int fd)
+{
+    return _commit(fd);
+}
+
+static int file_close(int fd)
+{
+    return _close(fd);
+}
+#else
+static int file_open(const std::string& path, int flags)
+{
+    return open(path.c_str(), flags, 0644);
+}
+
+static int64_t file_pread(int fd, char* buf, size_t size, uint64_t offset)
+{
+    return pread(fd, buf, size, static_cast<off_t>(offset));
+}
+
+static int64_t file_pwrite(int fd, const char* buf, size_t size, uint64_t offset)
+{
+    return pwrite(fd, buf, size, static_cast<off_t>(offset));
+}
+
+static int file_sync(int fd)
+{
+    return fsync(fd);
+}
+
+static int file_close(int fd)
+{
+    return close(fd);
+}
+#endif
+
+static bool parse_size(const std::string& value, uint64_t& size)
+{
+    size_t end = 0;
+    try {
+        size = std::stoull(value, &end);
+    } catch (const std::exception&) {
+        return false;
+    }
+    std::string suffix = value.substr(end);
+    if (suffix == "K" || suffix == "k") {
+        size <<= 10;
+    } else if (suffix == "M" || suffix == "m") {
+        size <<= 20;
+    } else if (suffix == "G" || suffix == "g") {
+        size <<= 30;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    return true;
+}
+
+static std::vector<std::string> split_phases(const std::string& value)
+{
+    std::vector<std::string> phases;
+    std::stringstream in(value);
+    std::string phase;
+    while (std::getline(in, phase, ',')) {
+        if (!phase.empty()) {
+            phases.push_back(phase);
+        }
+    }
+    return phases;
+}
+
+bool workload_option(const std::string& arg, workload_config& config)
+{
+    const std::string prefix = "--workload_";
+    if (arg.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    auto eq = arg.find('=');
+    if (eq == std::string::npos) {
+        return false;
+    }
+    std::string name = arg.substr(prefix.size(), eq - prefix.size());
+    std::string value = arg.substr(eq + 1);
+    uint64_t size = 0;
+    try {
+        if (name == "dir") {
+            config.dir = value;
+        } else if (name == "threads") {
+            config.threads = std::stoi(value);
+        } else if (name == "dirs") {
+            config.dirs = std::stoi(value);
+        } else if (name == "files") {
+            config.files = std::stoi(value);
+        } else if (name == "file_size" && parse_size(value, size)) {
+            config.fileSize = size;
+        } else if (name == "block_size" && parse_size(value, size)) {
+            config.blockSize = static_cast<uint32_t>(size);
+        } else if (name == "rand_block_size" && parse_size(value, size)) {
+            config.randBlockSize = static_cast<uint32_t>(size);
+        } else if (name == "rand_ops" && parse_size(value, size)) {
+            config.randOps = size;
+        } else if (name == "phases") {
+            config.phases = split_phases(value);
+        } else if (name == "fsync") {
+            config.fsync = value == "true";
+        } else if (name == "direct") {
+            config.direct = value == "true";
+        } else if (name == "wait") {
+            config.wait = std::stod(value);
+        } else if (name == "stats") {
+            config.statsFile = value;
+        } else {
+            return false;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+// What all threads of one phase add up to
+struct phase_totals {
+    latency_histogram latency;
+    std::atomic<uint64_t> ops { 0 };
+    std::atomic<uint64_t> bytes { 0 };
+    std::atomic<uint64_t> entries { 0 };
+    std::atomic<uint64_t> errors { 0 };
+    // CPU time of all threads in the phase
+    std::atomic<uint64_t> cpuNanos { 0 };
+    boost::mutex errorLock;
+    std::string error;
+
+    void fail(const std::string& what)
+    {
+        errors++;
+        boost::lock_guard<boost::mutex> lock(errorLock);
+        if (error.empty()) {
+            error = what;
+        }
+    }
+};
+
+class aligned_buffer {
+public:
+    explicit aligned_buffer(size_t size)
+        : storage(size + WORKLOAD_BUFFER_ALIGN)
+    {
+        auto address = reinterpret_cast<uintptr_t>(storage.data());
+        data = storage.data() + (WORKLOAD_BUFFER_ALIGN - address % WORKLOAD_BUFFER_ALIGN) % WORKLOAD_BUFFER_ALIGN;
+        std::fill(data, data + size, static_cast<char>(0x5a));
+    }
+
+    char* data;
+
+private:
+    std::vector<char> storage;
+};
+
+class workload_runner {
+public:
+    explicit workload_runner(const workload_config& config)
+        : config(config)
+        , root(fs::path(config.dir) / WORKLOAD_ROOT)
+    {
+    }
+
+    std::vector<bench_result> run()
+    {
+        std::vector<bench_result> results;
+        if (!wait_for_mount()) {
+            results.push_back(failed("workload/mount", "no " OP_STATS_FILE " below " + config.dir));
+            return results;
+        }
+
+        boost::system::error_code ec;
+        fs::remove_all(root, ec);
+        for (int t = 0; t < config.threads; t++) {
+            for (int d = 0; d < config.dirs; d++) {
+                fs::create_directories(dir_path(t, d), ec);
+                if (ec) {
+                    results.push_back(failed("workload/setup", dir_path(t, d).string() + ": " + ec.message()));
+                    return results;
+                }
+            }
+        }
+
+        auto phases = config.phases.empty() ? split_phases(WORKLOAD_PHASES) : config.phases;
+        for (auto& phase : phases) {
+            results.push_back(run_phase(phase));
+            print_progress(results.back());
+        }
+
+        fs::remove_all(root, ec);
+        copy_stats();
+        return results;
+    }
+
+private:
+    typedef void (workload_runner::*phase_fn)(int thread, phase_totals& totals);
+
+    bench_result run_phase(const std::string& phase)
+    {
+        std::string name = "workload/" + phase + "/threads:" + std::to_string(config.threads);
+        phase_fn fn = nullptr;
+        if (phase == "create") {
+            fn = &workload_runner::create_files;
+        } else if (phase == "stat") {
+            fn = &workload_runner::stat_files;
+        } else if (phase == "readdir") {
+            fn = &workload_runner::read_dirs;
+        } else if (phase == "rename") {
+            fn = &workload_runner::rename_files;
+        } else if (phase == "unlink") {
+            fn = &workload_runner::unlink_files;
+        } else if (phase == "seqwrite") {
+            fn = &workload_runner::seq_write;
+        } else if (phase == "seqread") {
+            fn = &workload_runner::seq_read;
+        } else if (phase == "randwrite") {
+            fn = &workload_runner::rand_write;
+        } else if (phase == "randread") {
+            fn = &workload_runner::rand_read;
+#ifdef O_SYNC
+        } else if (phase == "syncwrite") {
+            fn = &workload_runner::sync_write;
+#endif
+        } else {
+            return failed(name, "unknown phase " + phase);
+        }
+
+        bool metadata = fn == &workload_runner::stat_files || fn == &workload_runner::read_dirs
+            || fn == &workload_runner::rename_files || fn == &workload_runner::unlink_files;
+        if (metadata && !prepare_files()) {
+            return failed(name, "could not create the files for " + phase);
+        }
+        bool reads = fn == &workload_runner::seq_read || fn == &workload_runner::rand_read
+            || fn == &workload_runner::rand_write;
+        if (reads && !prepare_data()) {
+            return failed(name, "could not fill the data files for " + phase);
+        }
+
+        std::unique_ptr<phase_totals> totals(new phase_totals());
+        uint64_t backendBefore = 0;
+        bool checkBackend = is_sync_write(fn) && backend_calls("write", backendBefore);
+        double seconds = run_threads(fn, *totals);
+        uint64_t backendAfter = 0;
+        if (checkBackend && backend_calls("write", backendAfter) && backendAfter - backendBefore < totals->ops) {
+            totals->fail(std::to_string(totals->ops.load() - (backendAfter - backendBefore)) + " O_SYNC writes returned before reaching the backend");
+        }
+        if (fn == &workload_runner::create_files) {
+            filesExist = true;
+        } else if (fn == &workload_runner::rename_files) {
+            renamed = true;
+        } else if (fn == &workload_runner::unlink_files) {
+            filesExist = false;
+            renamed = false;
+        } else if (fn == &workload_runner::seq_write || is_sync_write(fn)) {
+            dataReady = true;
+        }
+
+        bench_result result { name, totals->ops.load(), config.threads, seconds, totals->cpuNanos / 1e9, totals->bytes.load(),
+            totals->ops.load(), totals->error, {} };
+        auto& latency = totals->latency;
+        result.counters.emplace_back("p50_us", latency.percentile(50) / 1000.0);
+        result.counters.emplace_back("p90_us", latency.percentile(90) / 1000.0);
+        result.counters.emplace_back("p99_us", latency.percentile(99) / 1000.0);
+        result.counters.emplace_back("p999_us", latency.percentile(99.9) / 1000.0);
+        result.counters.emplace_back("max_us", latency.max() / 1000.0);
+        if (totals->entries > 0) {
+            result.counters.emplace_back("entries", static_cast<double>(totals->entries.load()));
+        }
+        if (totals->errors > 0) {
+            result.counters.emplace_back("errors", static_cast<double>(totals->errors.load()));
+        }
+        if (result.iterations == 0 && result.error.empty()) {
+            result.error = "no operations ran";
+        }
+        return result;
+    }
+
+    // Wall time from all threads being released to the last one finishing
+    double run_threads(phase_fn fn, phase_totals& totals)
+    {
+        boost::barrier ready(config.threads + 1);
+        std::vector<std::unique_ptr<boost::thread>> workers;
+        for (int t = 0; t < config.threads; t++) {
+            workers.emplace_back(new boost::thread([this, fn, t, &ready, &totals]() {
+                ready.wait();
+                double cpuStart = thread_cpu_seconds();
+                (this->*fn)(t, totals);
+                totals.cpuNanos += static_cast<uint64_t>((thread_cpu_seconds() - cpuStart) * 1e9);
+            }));
+        }
+        ready.wait();
+        auto start = std::chrono::steady_clock::now();
+        for (auto& worker : workers) {
+            worker->join();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template <typename Op>
+    inline bool timed(phase_totals& totals, Op op)
+    {
+        auto start = std::chrono::steady_clock::now();
+        bool ok = op();
+        totals.latency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+        if (ok) {
+            totals.ops++;
+        }
+        return ok;
+    }
+
+    void create_files(int thread, phase_totals& totals)
+    {
+        for (int d = 0; d < config.dirs; d++) {
+            for (int f = 0; f < config.files; f++) {
+                auto path = file_path(thread, d, f, false).string();
+                timed(totals, [&]() {
+                    int fd = file_open(path, O_CREAT | O_EXCL | O_WRONLY);
+                    if (fd < 0) {
+                        totals.fail(path + ": " + strerror(errno));
+                        return false;
+                    }
+                    file_close(fd);
+                    return true;
+                });
+            }
+        }
+    }
+
+    void stat_files(int thread, phase_totals& totals)
+    {
+        for (int d = 0; d < config.dirs; d++) {
+            for (int f = 0; f < config.files; f++) {
+                auto path = file_path(thread, d, f, renamed);
+                timed(totals, [&]() {
+                    boost::system::error_code ec;
+                    auto status = fs::status(path, ec);
+                    if (ec || status.type() != fs::regular_file) {
+                        totals.fail(path.string() + ": " + (ec ? ec.message() : "not a regular file"));
+                        return false;
+                    }
+                    return true;
+                });
+            }
+        }
+    }
+
+    void read_dirs(int thread, phase_totals& totals)
+    {
+        for (int d = 0; d < config.dirs; d++) {
+            auto path = dir_path(thread, d);
+            timed(totals, [&]() {
+                boost::system::error_code ec;
+                uint64_t count = 0;
+                for (fs::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+                    count++;
+                }
+                totals.entries += count;
+                if (ec || count != static_cast<uint64_t>(config.files)) {
+                    totals.fail(path.string() + ": " + (ec ? ec.message() : std::to_string(count) + " entries"));
+                    return false;
+                }
+                return true;
+            });
+        }
+    }
+
+    void rename_files(int thread, phase_totals& totals)
+    {
+        for (int d = 0; d < config.dirs; d++) {
+            for (int f = 0; f < config.files; f++) {
+                auto from = file_path(thread, d, f, renamed);
+                auto to = file_path(thread, d, f, !renamed);
+                timed(totals, [&]() {
+                    boost::system::error_code ec;
+                    fs::rename(from, to, ec);
+                    if (ec) {
+                        totals.fail(from.string() + ": " + ec.message());
+                        return false;
+                    }
+                    return true;
+                });
+            }
+        }
+    }
+
+    void unlink_files(int thread, phase_totals& totals)
+    {
+        for (int d = 0; d < config.dirs; d++) {
+            for (int f = 0; f < config.files; f++) {
+                auto path = file_path(thread, d, f, renamed);
+                timed(totals, [&]() {
+                    boost::system::error_code ec;
+                    if (!fs::remove(path, ec) || ec) {
+                        totals.fail(path.string() + ": " + (ec ? ec.message() : "missing"));
+                        return false;
+                    }
+                    return true;
+                });
+            }
+        }
+    }
+
+    void seq_write(int thread, phase_totals& totals)
+    {
+        transfer(thread, totals, true, false);
+    }
+
+    void seq_read(int thread, phase_totals& totals)
+    {
+        transfer(thread, totals, false, false);
+    }
+
+    void rand_write(int thread, phase_totals& totals)
+    {
+        transfer(thread, totals, true, true);
+    }
+
+    void rand_read(int thread, phase_totals& totals)
+    {
+        transfer(thread, totals, false, true);
+    }
+
+#ifdef O_SYNC
+    void sync_write(int thread, phase_totals& totals)
+    {
+        transfer(thread, totals, true, false, O_SYNC);
+    }
+#endif
+
+    inline bool is_sync_write(phase_fn fn) const
+    {
+#ifdef O_SYNC
+        return fn == &workload_runner::sync_write;
+#else
+        return false;
+#endif
+    }
+
+    void transfer(int thread, phase_totals& totals, bool write, bool random, int extraFlags = 0)
+    {
+        auto path = data_path(thread).string();
+        int flags = (write ? O_WRONLY | O_CREAT | (random ? 0 : O_TRUNC) : O_RDONLY) | extraFlags;
+#ifdef O_DIRECT
+        if (config.direct) {
+            flags |= O_DIRECT;
+        }
+#endif
+        int fd = file_open(path, flags);
+        if (fd < 0) {
+            totals.fail(path + ": " + strerror(errno));
+            return;
+        }
+
+        uint32_t block = random ? config.randBlockSize : config.blockSize;
+        aligned_buffer buffer(block);
+        uint64_t blocks = std::max<uint64_t>(1, config.fileSize / block);
+        uint64_t count = random ? config.randOps : blocks;
+        std::mt19937_64 rng(static_cast<uint64_t>(thread) + 1);
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t offset = (random ? rng() % blocks : i) * block;
+            bool ok = timed(totals, [&]() {
+                int64_t done = write ? file_pwrite(fd, buffer.data, block, offset) : file_pread(fd, buffer.data, block, offset);
+                if (done != static_cast<int64_t>(block)) {
+                    totals.fail(path + ": " + (done < 0 ? strerror(errno) : "short transfer at " + std::to_string(offset)));
+                    return false;
+                }
+                totals.bytes += block;
+                return true;
+            });
+            if (!ok) {
+                break;
+            }
+        }
+        if (write && config.fsync && file_sync(fd) != 0) {
+            totals.fail(path + ": fsync " + strerror(errno));
+        }
+        file_close(fd);
+    }
+
+    // Metadata phases run on their own, so make the files they expect untimed
+    bool prepare_files()
+    {
+        if (filesExist) {
+            return true;
+        }
+        std::unique_ptr<phase_totals> totals(new phase_totals());
+        run_threads(&workload_runner::create_files, *totals);
+        filesExist = totals->errors == 0;
+        renamed = false;
+        return filesExist;
+    }
+
+    bool prepare_data()
+    {
+        if (dataReady) {
+            return true;
+        }
+        std::unique_ptr<phase_totals> totals(new phase_totals());
+        run_threads(&workload_runner::seq_write, *totals);
+        dataReady = totals->errors == 0;
+        return dataReady;
+    }
+
+    bool wait_for_mount()
+    {
+        if (config.wait <= 0) {
+            return true;
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(config.wait);
+        auto stats = fs::path(config.dir + OP_STATS_FILE);
+        while (true) {
+            boost::system::error_code ec;
+            if (fs::exists(stats, ec)) {
+                return true;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            boost::this_thread::sleep_for(boost::chrono::milliseconds(WORKLOAD_MOUNT_POLL_MS));
+        }
+    }
+
+    // backend column of the row of op in OP_STATS_FILE, false without one
+    bool backend_calls(const std::string& op, uint64_t& calls)
+    {
+        std::ifstream in(config.dir + OP_STATS_FILE, std::ios::binary);
+        std::string line;
+        if (!in || !std::getline(in, line)) {
+            LOG_WARNING << "No " << OP_STATS_FILE << " below " << config.dir << ", not checking the backend calls";
+            return false;
+        }
+        auto header = split_words(line);
+        auto column = std::find(header.begin(), header.end(), "backend");
+        if (column == header.end()) {
+            return false;
+        }
+        size_t index = static_cast<size_t>(column - header.begin());
+        // Operations never called have no row
+        calls = 0;
+        while (std::getline(in, line)) {
+            auto fields = split_words(line);
+            if (fields.size() > index && fields[0] == op) {
+                calls = std::stoull(fields[index]);
+            }
+        }
+        return true;
+    }
+
+    static std::vector<std::string> split_words(const std::string& line)
+    {
+        std::vector<std::string> words;
+        std::istringstream in(line);
+        std::string word;
+        while (in >> word) {
+            words.push_back(word);
+        }
+        return words;
+    }
+
+    void copy_stats()
+    {
+        if (config.statsFile.empty()) {
+            return;
+        }
+        std::ifstream in(config.dir + OP_STATS_FILE, std::ios::binary);
+        if (!in) {
+            LOG_WARNING << "No " << OP_STATS_FILE << " below " << config.dir << ", is it a TFuse mount?";
+            return;
+        }
+        std::ofstream out(config.statsFile, std::ios::binary);
+        out << in.rdbuf();
+    }
+
+    void print_progress(const bench_result& result)
+    {
+        LOG_INFO << result.name << ": " << result.iterations << " ops in " << result.seconds << "s"
+                 << (result.error.empty() ? "" : ", first error: " + result.error);
+    }
+
+    bench_result failed(const std::string& name, const std::string& error)
+    {
+        return bench_result { name, 0, config.threads, 0, 0, 0, 0, error, {} };
+    }
+
+    fs::path dir_path(int thread, int dir) const
+    {
+        return root / ("t" + std::to_string(thread)) / ("d" + std::to_string(dir));
+    }
+
+    fs::path file_path(int thread, int dir, int file, bool renamed) const
+    {
+        return dir_path(thread, dir) / ((renamed ? "r" : "f") + std::to_string(file));
+    }
+
+    fs::path data_path(int thread) const
+    {
+        return root / ("t" + std::to_string(thread)) / "data";
+    }
+
+    const workload_config& config;
+    fs::path root;
+    bool filesExist = false;
+    bool renamed = false;
+    bool dataReady = false;
+};
+
+std::vector<bench_result> run_workload(const workload_config& config)
+{
+    return workload_runner(config).run();
+}
@@ -0,0 +1,73 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <bench.h>
+
+// Every phase in the order it runs, metadata first so the tree exists for stat/readdir
+#define WORKLOAD_PHASES "create,stat,readdir,rename,unlink,seqwrite,seqread,randwrite,randread,syncwrite"
+// Directory made under the target so a run never touches anything else
+#define WORKLOAD_ROOT "tfuse-workload"
+
+/*
+ * End to end workload against a mounted TFuse, in the spirit of mdtest for
+ * metadata and fio for data. Each thread works on its own subtree
+ *
+ *   <dir>/tfuse-workload/t<thread>/d<dir>/f<file>   metadata phases
+ *   <dir>/tfuse-workload/t<thread>/data             data phases
+ *
+ * so the numbers show the stack, not contention on one directory. Only the
+ * operations are timed, building and removing the tree is not.
+ *
+ * syncwrite writes the data files through O_SYNC handles and fails unless
+ * every write reached the backend before returning, as the backend column of
+ * OP_STATS_FILE tells.
+ */
+struct workload_config {
+    std::string dir;
+    int threads = 4;
+    // Directories per thread and files per directory
+    int dirs = 8;
+    int files = 64;
+    uint64_t fileSize = 64ULL << 20;
+    uint32_t blockSize = 128 << 10;
+    uint32_t randBlockSize = 4 << 10;
+    uint64_t randOps = 4096;
+    std::vector<std::string> phases;
+    // fsync each data file before closing it, timed as part of the phase
+    bool fsync = false;
+    // Bypass the kernel page cache so every read and write reaches TFuse (Linux)
+    bool direct = false;
+    // Seconds to wait for OP_STATS_FILE to show up below dir, 0 to not wait
+    double wait = 0;
+    // Copy of the client side op table after the run
+    std::string statsFile;
+};
+
+// Handle a --workload_* option, false when arg is not one
+bool workload_option(const std::string& arg, workload_config& config);
+
+// One result per phase, latency percentiles in us are added as counters
+std::vector<bench_result> run_workload(const workload_config& config);
@@ -0,0 +1,178 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+// Include FuseService first to avoid redefinition errors
+#include <host_server.h>
+
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include <thrift/concurrency/ThreadFactory.h>
+#include <thrift/concurrency/ThreadManager.h>
+#include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/protocol/TCompactProtocol.h>
+#include <thrift/protocol/TJSONProtocol.h>
+#include <thrift/server/TNonblockingServer.h>
+#include <thrift/server/TSimpleServer.h>
+#include <thrift/server/TThreadPoolServer.h>
+#include <thrift/transport/TBufferTransports.h>
+#include <thrift/transport/THttpServer.h>
+#include <thrift/transport/TNonblockingServerSocket.h>
+#include <thrift/transport/TServerSocket.h>
+#include <thrift/transport/TZlibTransport.h>
+#ifdef _WIN32
+#include <thrift/transport/TPipeServer.h>
+#endif
+
+#include <Logger.h>
+
+using namespace apache::thrift::concurrency;
+using namespace apache::thrift::server;
+
+static void split_tcp_target(const std::string& target, std::string& host, int& port)
+{
+    std::vector<std::string> parts;
+    boost::split(parts, target, boost::is_any_of(":"));
+    if (parts.size() != 2) {
+        throw std::invalid_argument("Invalid TCP/IP target address use IP:PORT");
+    }
+    host = parts[0];
+    port = std::stoi(parts[1]);
+}
+
+static std::shared_ptr<TProtocolFactory> protocol_factory(SerializationProtocol protocol)
+{
+    switch (protocol) {
+    case SerializationProtocol::BINARY:
+        return std::make_shared<TBinaryProtocolFactory>();
+    case SerializationProtocol::COMPACT:
+        return std::make_shared<TCompactProtocolFactory>();
+    case SerializationProtocol::JSON:
+        return std::make_shared<TJSONProtocolFactory>();
+    default:
+        throw std::invalid_argument("Unsupported/Invalid endcoding protocol");
+    }
+}
+
+static std::shared_ptr<TTransportFactory> transport_factory(MessageWrap wrap)
+{
+    switch (wrap) {
+    case MessageWrap::BUFFERED:
+        return std::make_shared<TBufferedTransportFactory>();
+    case MessageWrap::FRAMED:
+        return std::make_shared<TFramedTransportFactory>();
+    case MessageWrap::HTTP:
+        return std::make_shared<THttpServerTransportFactory>();
+    case MessageWrap::ZLIB:
+        return std::make_shared<TZlibTransportFactory>();
+    default:
+        throw std::invalid_argument("Unsupported/Invalid message wrap");
+    }
+}
+
+static std::shared_ptr<TServerTransport> server_transport(const host_config& config)
+{
+    std::string host;
+    int port;
+    switch (config.transport) {
+    case TransportType::TCP_IP:
+        split_tcp_target(config.target, host, port);
+        return std::make_shared<TServerSocket>(host, port);
+#ifdef _WIN32
+    case TransportType::NAMED_PIPE:
+        return std::make_shared<TPipeServer>(config.target);
+#else
+    case TransportType::UNIX_SOCKET:
+        return std::make_shared<TServerSocket>(config.target);
+#endif
+    default:
+        throw std::invalid_argument("Unsupported transport for a blocking server");
+    }
+}
+
+static std::shared_ptr<TNonblockingServerTransport> nonblocking_transport(const host_config& config)
+{
+    std::string host;
+    int port;
+    switch (config.transport) {
+    case TransportType::TCP_IP:
+        split_tcp_target(config.target, host, port);
+        return std::make_shared<TNonblockingServerSocket>(host, port);
+    case TransportType::UNIX_SOCKET:
+        return std::make_shared<TNonblockingServerSocket>(config.target);
+    default:
+        throw std::invalid_argument(SERVER_NONBLOCKING " needs TCP_IP or UNIX_SOCKET transport");
+    }
+}
+
+static std::shared_ptr<ThreadManager> start_workers(int count)
+{
+    auto workers = ThreadManager::newSimpleThreadManager(static_cast<size_t>(count));
+    workers->threadFactory(std::make_shared<ThreadFactory>());
+    workers->start();
+    return workers;
+}
+
+host_server::host_server(std::shared_ptr<Fuse::FuseServiceIf> handler, const host_config& config)
+{
+    auto processor = std::make_shared<Fuse::FuseServiceProcessor>(handler);
+    auto protocols = protocol_factory(config.protocol);
+
+    LOG_INFO << "Serving " << config.target << " with a " << config.serverType << " server"
+             << " Transport [" << static_cast<int>(config.transport) << "]"
+             << " Serialization [" << static_cast<int>(config.protocol) << "]"
+             << " Message Wrapping [" << static_cast<int>(config.wrap) << "]";
+
+    if (config.transport == TransportType::SHARED_MEMORY) {
+        if (config.wrap == MessageWrap::HTTP) {
+            throw std::invalid_argument("HTTP wrapper needs a socket transport");
+        }
+        server = std::make_shared<shm_server>(processor, transport_factory(config.wrap), protocols,
+            config.target, config.shmChannels, config.shmRingKb * 1024);
+    } else if (config.serverType == SERVER_NONBLOCKING) {
+        // Frames are how the event loop knows a request is complete
+        if (config.wrap != MessageWrap::FRAMED) {
+            throw std::invalid_argument(SERVER_NONBLOCKING " needs the FRAMED wrapper");
+        }
+        auto nonblocking = std::make_shared<TNonblockingServer>(processor, protocols,
+            nonblocking_transport(config), start_workers(config.workerThreads));
+        nonblocking->setNumIOThreads(static_cast<size_t>(config.ioThreads));
+        server = nonblocking;
+    } else if (config.serverType == SERVER_THREAD_POOLED) {
+        server = std::make_shared<TThreadPoolServer>(processor, server_transport(config),
+            transport_factory(config.wrap), protocols, start_workers(config.workerThreads));
+    } else if (config.serverType == SERVER_SIMPLE) {
+        server = std::make_shared<TSimpleServer>(processor, server_transport(config),
+            transport_factory(config.wrap), protocols);
+    } else {
+        throw std::invalid_argument("Invalid server type " + config.serverType);
+    }
+}
+
+void host_server::serve()
+{
+    server->serve();
+}
+
+void host_server::stop()
+{
+    server->stop();
+}
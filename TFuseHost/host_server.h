@@ -0,0 +1,70 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+#include <FuseService.h>
+
+#include <memory>
+#include <string>
+
+#include <thrift/server/TServer.h>
+
+#include <shm_server.h>
+#include <thrift_client.h>
+
+// [HOST] SERVER_TYPE values
+#define SERVER_NONBLOCKING "NONBLOCKING"
+#define SERVER_THREAD_POOLED "THREAD_POOLED"
+#define SERVER_SIMPLE "SIMPLE"
+
+struct host_config {
+    TransportType transport = TransportType::TCP_IP;
+    MessageWrap wrap = MessageWrap::FRAMED;
+    SerializationProtocol protocol = SerializationProtocol::BINARY;
+    // IP:PORT, socket path or pipe name, as TARGET in [THRIFT]
+    std::string target;
+    std::string serverType = SERVER_NONBLOCKING;
+    // Event loops of the non-blocking server
+    int ioThreads = 4;
+    // Threads running handler calls, also the pool size of THREAD_POOLED
+    int workerThreads = 8;
+    uint32_t shmChannels = SHM_DEFAULT_CHANNELS;
+    uint32_t shmRingKb = SHM_DEFAULT_RING_KB;
+};
+
+/*
+ * Thrift server for a FuseService handler, built from the same settings the
+ * client reads so one config.ini serves both ends. NONBLOCKING is an event
+ * driven TNonblockingServer that hands calls to a worker pool, it needs the
+ * FRAMED wrapper over TCP_IP or UNIX_SOCKET. THREAD_POOLED and SIMPLE are the
+ * blocking servers and take every wrapper and transport but shared memory.
+ * SHARED_MEMORY is always served by shm_server, whatever the server type.
+ */
+class host_server {
+public:
+    host_server(std::shared_ptr<Fuse::FuseServiceIf> handler, const host_config& config);
+
+    // Blocks until stop is called from another thread
+    void serve();
+    void stop();
+
+private:
+    std::shared_ptr<apache::thrift::server::TServer> server;
+};
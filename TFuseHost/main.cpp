@@ -0,0 +1,106 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+
+// TFuseHost : native backend serving Fuse.thrift, configured by the same
+// config.ini as TFuse.
+//
+
+// Include FuseService first to avoid redefinition errors
+#include <host_server.h>
+
+#include <iostream>
+#include <memory>
+
+#include <Logger.h>
+#include <mem_fs.h>
+#include <passthrough_fs.h>
+
+#include <boost/property_tree/ini_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+// [HOST] BACKEND values
+#define BACKEND_MEMORY "MEMORY"
+#define BACKEND_PASSTHROUGH "PASSTHROUGH"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    init_logging();
+
+    boost::property_tree::ptree pt;
+    boost::property_tree::ini_parser::read_ini("config.ini", pt);
+
+    try {
+        auto thriftConfig = pt.get_child("THRIFT");
+        if (thriftConfig.find("TRANSPORT") == thriftConfig.not_found()) {
+            std::cerr << "TRANSPORT not persent in config file." << endl;
+            return -1;
+        }
+        if (thriftConfig.find("TARGET") == thriftConfig.not_found()) {
+            std::cerr << "TARGET not persent in config file." << endl;
+            return -1;
+        }
+
+        host_config config;
+        config.transport = thrift_client::TransportTypeFromString(thriftConfig.get<std::string>("TRANSPORT"));
+        config.wrap = thrift_client::WrapTypeFromString(thriftConfig.get<std::string>("WRAPPER", "BUFFERED"));
+        config.protocol = thrift_client::ProtocolTypeFromString(thriftConfig.get<std::string>("PROTOCOL", "BINARY"));
+        config.target = thriftConfig.get<std::string>("TARGET");
+        config.serverType = pt.get<std::string>("HOST.SERVER_TYPE", SERVER_NONBLOCKING);
+        config.ioThreads = pt.get<int>("HOST.MAX_IO_THREAD", config.ioThreads);
+        config.workerThreads = pt.get<int>("HOST.MAX_WORKER_THREAD", config.workerThreads);
+        config.shmChannels = pt.get<uint32_t>("HOST.SHM_CHANNELS", config.shmChannels);
+        config.shmRingKb = pt.get<uint32_t>("HOST.SHM_RING_KB", config.shmRingKb);
+
+        std::shared_ptr<Fuse::FuseServiceIf> backend;
+        auto backendType = pt.get<std::string>("HOST.BACKEND", BACKEND_MEMORY);
+        if (backendType == BACKEND_MEMORY) {
+            uint64_t capacity = pt.get<uint64_t>("HOST.MEMORY_MB", 0) * 1024 * 1024;
+            backend = std::make_shared<mem_fs>(capacity);
+        } else if (backendType == BACKEND_PASSTHROUGH) {
+#if defined(__linux__)
+            auto root = pt.get_optional<std::string>("HOST.PASSTHROUGH_ROOT");
+            if (!root || root->empty()) {
+                std::cerr << "PASSTHROUGH_ROOT not persent in config file." << endl;
+                return -1;
+            }
+            // Modes arrive with the client's umask applied already
+            umask(0);
+            backend = std::make_shared<passthrough_fs>(*root, pt.get<unsigned>("HOST.URING_ENTRIES", URING_DEFAULT_ENTRIES));
+#else
+            std::cerr << BACKEND_PASSTHROUGH " backend needs a Linux host." << endl;
+            return -1;
+#endif
+        } else {
+            std::cerr << "Unknown BACKEND " << backendType << " in HOST section." << endl;
+            return -1;
+        }
+
+        host_server server(backend, config);
+        server.serve();
+    } catch (std::exception& ex) {
+        LOG_FATAL << "Host failed " << ex.what();
+        std::cerr << ex.what() << endl;
+        return -1;
+    }
+    return 0;
+}
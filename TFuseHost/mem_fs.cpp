@@ -0,0 +1,1097 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+// Include FuseService first to avoid redefinition errors
+#include <mem_fs.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <ctime>
+
+#include <boost/thread/locks.hpp>
+
+using namespace Fuse;
+
+typedef boost::shared_lock<boost::shared_mutex> shared_guard;
+typedef boost::unique_lock<boost::shared_mutex> unique_guard;
+
+static inline int32_t now()
+{
+    return static_cast<int32_t>(std::time(nullptr));
+}
+
+static inline bool is_link(int32_t mode)
+{
+    return (mode & MEM_IFMT) == MEM_IFLNK;
+}
+
+static inline bool has_handle(const FuseHandleInfo& handle)
+{
+    return handle.__isset.fh && handle.fh > 0;
+}
+
+void mem_inode::clear()
+{
+    live = false;
+    parent = 0;
+    mode = nlink = uid = gid = rdev = 0;
+    atime = mtime = ctime = 0;
+    size = 0;
+    version = 0;
+    openCount = 0;
+    chunks.clear();
+    children.clear();
+    link.clear();
+    xattrs.clear();
+}
+
+uint64_t inode_arena::alloc()
+{
+    uint64_t ino;
+    if (!freeList.empty()) {
+        ino = freeList.back();
+        freeList.pop_back();
+    } else {
+        if (next % MEM_ARENA_SLAB == 0) {
+            slabs.emplace_back(new mem_inode[MEM_ARENA_SLAB]);
+        }
+        ino = ++next;
+    }
+    slot(ino)->live = true;
+    return ino;
+}
+
+void inode_arena::release(uint64_t ino)
+{
+    slot(ino)->clear();
+    freeList.push_back(ino);
+}
+
+mem_fs::mem_fs(uint64_t capacity)
+    : capacity(capacity)
+{
+    root = inodes.alloc();
+    auto node = inodes.get(root);
+    node->parent = root;
+    node->mode = MEM_IFDIR | 0777;
+    node->nlink = 2;
+    node->atime = node->mtime = node->ctime = now();
+}
+
+StatusCode::type mem_fs::resolve(const std::string& path, uint64_t& ino) const
+{
+    uint64_t current = root;
+    std::string name;
+    size_t pos = 0;
+    while (pos < path.size()) {
+        if (path[pos] == '/') {
+            pos++;
+            continue;
+        }
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        name.assign(path, pos, end - pos);
+        auto node = inodes.get(current);
+        if (!MEM_IS_DIR(node->mode)) {
+            return StatusCode::FUSE_ERRORENOTDIR;
+        }
+        auto child = node->children.find(name);
+        if (child == node->children.end()) {
+            return StatusCode::FUSE_ERRORENOENT;
+        }
+        current = child->second;
+        pos = end;
+    }
+    ino = current;
+    return StatusCode::FUSE_SUCCESS;
+}
+
+StatusCode::type mem_fs::resolve_parent(const std::string& path, uint64_t& parent, std::string& name) const
+{
+    size_t end = path.find_last_not_of('/');
+    if (end == std::string::npos) {
+        // The root has no parent to change
+        return StatusCode::FUSE_ERROREBUSY;
+    }
+    size_t slash = path.rfind('/', end);
+    size_t start = slash == std::string::npos ? 0 : slash + 1;
+    name.assign(path, start, end + 1 - start);
+    if (name.size() > MEM_NAME_MAX || name == "." || name == "..") {
+        return StatusCode::FUSE_ERROREINVAL;
+    }
+    auto status = resolve(path.substr(0, start), parent);
+    if (status != StatusCode::FUSE_SUCCESS) {
+        return status;
+    }
+    return MEM_IS_DIR(inodes.get(parent)->mode) ? StatusCode::FUSE_SUCCESS : StatusCode::FUSE_ERRORENOTDIR;
+}
+
+mem_inode* mem_fs::node_of(const std::string& path, const FuseHandleInfo& handle, uint64_t& ino, StatusCode::type& status)
+{
+    if (has_handle(handle)) {
+        boost::lock_guard<boost::mutex> guard(handleLock);
+        auto found = handles.find(handle.fh);
+        if (found != handles.end()) {
+            ino = found->second.ino;
+            status = StatusCode::FUSE_SUCCESS;
+            return inodes.get(ino);
+        }
+    }
+    status = resolve(path, ino);
+    return status == StatusCode::FUSE_SUCCESS ? inodes.get(ino) : nullptr;
+}
+
+StatusCode::type mem_fs::make_node(const std::string& path, int32_t mode, const FuseContext& context, uint64_t& ino)
+{
+    uint64_t parentIno;
+    std::string name;
+    auto status = resolve_parent(path, parentIno, name);
+    if (status != StatusCode::FUSE_SUCCESS) {
+        return status;
+    }
+    auto parent = inodes.get(parentIno);
+    if (parent->children.count(name) != 0) {
+        return StatusCode::FUSE_ERROREEXIST;
+    }
+
+    ino = inodes.alloc();
+    auto node = inodes.get(ino);
+    node->parent = parentIno;
+    node->mode = mode;
+    node->nlink = MEM_IS_DIR(mode) ? 2 : 1;
+    node->uid = context.__isset.uid ? context.uid : 0;
+    node->gid = context.__isset.gid ? context.gid : 0;
+    node->atime = node->mtime = node->ctime = now();
+    parent->children.emplace(name, ino);
+    if (MEM_IS_DIR(mode)) {
+        parent->nlink++;
+    }
+    parent->mtime = parent->ctime = node->ctime;
+    return StatusCode::FUSE_SUCCESS;
+}
+
+void mem_fs::drop_link(uint64_t ino)
+{
+    auto node = inodes.get(ino);
+    node->nlink = MEM_IS_DIR(node->mode) ? 0 : node->nlink - 1;
+    node->ctime = now();
+    free_if_unused(ino);
+}
+
+void mem_fs::free_if_unused(uint64_t ino)
+{
+    auto node = inodes.get(ino);
+    if (node != nullptr && node->nlink <= 0 && node->openCount == 0) {
+        release_chunks(*node, 0);
+        inodes.release(ino);
+    }
+}
+
+void mem_fs::fill_stat(uint64_t ino, const mem_inode& node, FuseStat& stat) const
+{
+    stat.__set_ino(static_cast<int64_t>(ino));
+    stat.__set_mode(node.mode);
+    stat.__set_nlink(node.nlink);
+    stat.__set_uid(node.uid);
+    stat.__set_gid(node.gid);
+    stat.__set_rdev(node.rdev);
+    int64_t size = MEM_IS_DIR(node.mode) ? MEM_BLOCK_SIZE : static_cast<int64_t>(node.size);
+    stat.__set_size(size);
+    stat.__set_blksize(MEM_BLOCK_SIZE);
+    stat.__set_blocks((size + 511) / 512);
+    stat.__set_accessTime(node.atime);
+    stat.__set_modificationTime(node.mtime);
+    stat.__set_changeTime(node.ctime);
+}
+
+int64_t mem_fs::open_handle(uint64_t ino, mem_inode* node)
+{
+    node->openCount++;
+    int64_t fh = ++nextHandle;
+    boost::lock_guard<boost::mutex> guard(handleLock);
+    handles.emplace(fh, mem_handle { ino, {}, false });
+    return fh;
+}
+
+void mem_fs::close_handle(const FuseHandleInfo& handle, FileSystemResponse& _return)
+{
+    uint64_t ino;
+    {
+        boost::lock_guard<boost::mutex> guard(handleLock);
+        auto found = has_handle(handle) ? handles.find(handle.fh) : handles.end();
+        if (found == handles.end()) {
+            _return.status = StatusCode::FUSE_ERROREBADF;
+            return;
+        }
+        ino = found->second.ino;
+        handles.erase(found);
+    }
+
+    bool unused;
+    {
+        shared_guard tree(treeLock);
+        auto node = inodes.get(ino);
+        unused = --node->openCount == 0 && node->nlink <= 0;
+    }
+    if (unused) {
+        // Last handle of an unlinked file
+        unique_guard tree(treeLock);
+        free_if_unused(ino);
+    }
+    _return.status = StatusCode::FUSE_SUCCESS;
+}
+
+void mem_fs::inline_data(uint64_t ino, mem_inode* node, int32_t inlineLimit, int64_t knownVersion, FileSystemResponse& _return)
+{
+    if (inlineLimit <= 0) {
+        return;
+    }
+    // Small files travel with the handle, the client skips the reads
+    shared_guard guard(node->lock);
+    if (knownVersion < 0 || knownVersion != node->version) {
+        std::string data;
+        read_data(*node, 0, static_cast<size_t>(inlineLimit), data);
+        _return.__set_data(data);
+    }
+    FuseStat stat;
+    fill_stat(ino, *node, stat);
+    _return.__set_stats(stat);
+    _return.__set_version(node->version);
+}
+
+void mem_fs::read_data(const mem_inode& node, uint64_t offset, size_t size, std::string& out) const
+{
+    if (offset >= node.size) {
+        out.clear();
+        return;
+    }
+    size_t length = static_cast<size_t>(std::min<uint64_t>(size, node.size - offset));
+    out.resize(length);
+    size_t done = 0;
+    while (done < length) {
+        uint64_t position = offset + done;
+        size_t idx = static_cast<size_t>(position / MEM_CHUNK_SIZE);
+        size_t within = static_cast<size_t>(position % MEM_CHUNK_SIZE);
+        size_t count = std::min<size_t>(length - done, MEM_CHUNK_SIZE - within);
+        if (idx < node.chunks.size() && node.chunks[idx]) {
+            memcpy(&out[done], node.chunks[idx].get() + within, count);
+        } else {
+            memset(&out[done], 0, count);
+        }
+        done += count;
+    }
+}
+
+StatusCode::type mem_fs::write_data(mem_inode& node, uint64_t offset, const char* data, size_t size)
+{
+    if (size == 0) {
+        return StatusCode::FUSE_SUCCESS;
+    }
+    size_t first = static_cast<size_t>(offset / MEM_CHUNK_SIZE);
+    size_t last = static_cast<size_t>((offset + size - 1) / MEM_CHUNK_SIZE);
+    uint64_t missing = 0;
+    for (size_t idx = first; idx <= last; idx++) {
+        if (idx >= node.chunks.size() || !node.chunks[idx]) {
+            missing += MEM_CHUNK_SIZE;
+        }
+    }
+    if (capacity != 0 && chunkBytes.fetch_add(missing) + missing > capacity) {
+        chunkBytes -= missing;
+        return StatusCode::FUSE_ERRORENOSPC;
+    } else if (capacity == 0) {
+        chunkBytes += missing;
+    }
+
+    if (node.chunks.size() <= last) {
+        node.chunks.resize(last + 1);
+    }
+    size_t done = 0;
+    while (done < size) {
+        uint64_t position = offset + done;
+        size_t idx = static_cast<size_t>(position / MEM_CHUNK_SIZE);
+        size_t within = static_cast<size_t>(position % MEM_CHUNK_SIZE);
+        size_t count = std::min<size_t>(size - done, MEM_CHUNK_SIZE - within);
+        if (!node.chunks[idx]) {
+            node.chunks[idx].reset(new char[MEM_CHUNK_SIZE]());
+        }
+        memcpy(node.chunks[idx].get() + within, data + done, count);
+        done += count;
+    }
+    node.size = std::max<uint64_t>(node.size, offset + size);
+    return StatusCode::FUSE_SUCCESS;
+}
+
+StatusCode::type mem_fs::resize(mem_inode& node, uint64_t size)
+{
+    if (size < node.size) {
+        size_t keep = static_cast<size_t>((size + MEM_CHUNK_SIZE - 1) / MEM_CHUNK_SIZE);
+        release_chunks(node, keep);
+        // Growing the file again has to read back zeros
+        size_t within = static_cast<size_t>(size % MEM_CHUNK_SIZE);
+        if (within != 0 && keep <= node.chunks.size() && node.chunks[keep - 1]) {
+            memset(node.chunks[keep - 1].get() + within, 0, MEM_CHUNK_SIZE - within);
+        }
+    }
+    node.size = size;
+    return StatusCode::FUSE_SUCCESS;
+}
+
+void mem_fs::release_chunks(mem_inode& node, size_t keep)
+{
+    for (size_t idx = keep; idx < node.chunks.size(); idx++) {
+        if (node.chunks[idx]) {
+            chunkBytes -= MEM_CHUNK_SIZE;
+        }
+    }
+    if (keep < node.chunks.size()) {
+        node.chunks.resize(keep);
+    }
+}
+
+void mem_fs::getattr(FileSystemResponse& _return, const std::string& path, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    auto node = node_of(path, handleInfo, ino, _return.status);
+    if (node == nullptr) {
+        return;
+    }
+    shared_guard guard(node->lock);
+    FuseStat stat;
+    fill_stat(ino, *node, stat);
+    _return.__set_stats(stat);
+}
+
+void mem_fs::readlink(FileSystemResponse& _return, const std::string& path, const int32_t maxSize, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = resolve(path, ino);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto node = inodes.get(ino);
+    shared_guard guard(node->lock);
+    if (!is_link(node->mode)) {
+        _return.status = StatusCode::FUSE_ERROREINVAL;
+        return;
+    }
+    _return.__set_linkPath(node->link);
+}
+
+void mem_fs::mkdir(FileSystemResponse& _return, const std::string& path, const int32_t mode, const FuseContext& context)
+{
+    unique_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = make_node(path, MEM_IFDIR | (mode & 07777), context, ino);
+}
+
+void mem_fs::unlink(FileSystemResponse& _return, const std::string& path, const FuseContext& context)
+{
+    unique_guard tree(treeLock);
+    uint64_t parentIno;
+    std::string name;
+    _return.status = resolve_parent(path, parentIno, name);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto parent = inodes.get(parentIno);
+    auto child = parent->children.find(name);
+    if (child == parent->children.end()) {
+        _return.status = StatusCode::FUSE_ERRORENOENT;
+        return;
+    }
+    uint64_t ino = child->second;
+    if (MEM_IS_DIR(inodes.get(ino)->mode)) {
+        _return.status = StatusCode::FUSE_ERROREISDIR;
+        return;
+    }
+    parent->children.erase(child);
+    parent->mtime = parent->ctime = now();
+    drop_link(ino);
+}
+
+void mem_fs::rmdir(FileSystemResponse& _return, const std::string& path, const FuseContext& context)
+{
+    unique_guard tree(treeLock);
+    uint64_t parentIno;
+    std::string name;
+    _return.status = resolve_parent(path, parentIno, name);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto parent = inodes.get(parentIno);
+    auto child = parent->children.find(name);
+    if (child == parent->children.end()) {
+        _return.status = StatusCode::FUSE_ERRORENOENT;
+        return;
+    }
+    uint64_t ino = child->second;
+    auto node = inodes.get(ino);
+    if (!MEM_IS_DIR(node->mode)) {
+        _return.status = StatusCode::FUSE_ERRORENOTDIR;
+        return;
+    }
+    if (!node->children.empty()) {
+        _return.status = StatusCode::FUSE_ENOTEMPTY;
+        return;
+    }
+    parent->children.erase(child);
+    parent->nlink--;
+    parent->mtime = parent->ctime = now();
+    drop_link(ino);
+}
+
+void mem_fs::symlink(FileSystemResponse& _return, const std::string& destination, const std::string& source, const FuseContext& context)
+{
+    // The link is created at source and points to destination
+    unique_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = make_node(source, MEM_IFLNK | 0777, context, ino);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        auto node = inodes.get(ino);
+        node->link = destination;
+        node->size = destination.size();
+    }
+}
+
+void mem_fs::rename(FileSystemResponse& _return, const std::string& source, const std::string& destination, const int64_t flags, const FuseContext& context)
+{
+    if ((flags & ~(MEM_RENAME_NOREPLACE | MEM_RENAME_EXCHANGE)) != 0
+        || (flags & (MEM_RENAME_NOREPLACE | MEM_RENAME_EXCHANGE)) == (MEM_RENAME_NOREPLACE | MEM_RENAME_EXCHANGE)) {
+        _return.status = StatusCode::FUSE_ERROREINVAL;
+        return;
+    }
+
+    unique_guard tree(treeLock);
+    uint64_t srcParentIno, dstParentIno;
+    std::string srcName, dstName;
+    _return.status = resolve_parent(source, srcParentIno, srcName);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = resolve_parent(destination, dstParentIno, dstName);
+    }
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto srcParent = inodes.get(srcParentIno);
+    auto dstParent = inodes.get(dstParentIno);
+    auto srcEntry = srcParent->children.find(srcName);
+    if (srcEntry == srcParent->children.end()) {
+        _return.status = StatusCode::FUSE_ERRORENOENT;
+        return;
+    }
+    uint64_t src = srcEntry->second;
+    auto srcNode = inodes.get(src);
+    auto dstEntry = dstParent->children.find(dstName);
+    uint64_t dst = dstEntry != dstParent->children.end() ? dstEntry->second : 0;
+    auto dstNode = dst != 0 ? inodes.get(dst) : nullptr;
+
+    // A directory cannot move below itself
+    auto inside = [this](uint64_t dir, uint64_t ino) {
+        for (uint64_t current = ino;; current = inodes.get(current)->parent) {
+            if (current == dir) {
+                return true;
+            }
+            if (current == root) {
+                return false;
+            }
+        }
+    };
+    if ((MEM_IS_DIR(srcNode->mode) && inside(src, dstParentIno))
+        || (dstNode != nullptr && MEM_IS_DIR(dstNode->mode) && (flags & MEM_RENAME_EXCHANGE) && inside(dst, srcParentIno))) {
+        _return.status = StatusCode::FUSE_ERROREINVAL;
+        return;
+    }
+
+    int32_t time = now();
+    if (flags & MEM_RENAME_EXCHANGE) {
+        if (dstNode == nullptr) {
+            _return.status = StatusCode::FUSE_ERRORENOENT;
+            return;
+        }
+        srcEntry->second = dst;
+        dstEntry->second = src;
+        if (MEM_IS_DIR(srcNode->mode) != MEM_IS_DIR(dstNode->mode)) {
+            int32_t moved = MEM_IS_DIR(srcNode->mode) ? 1 : -1;
+            srcParent->nlink -= moved;
+            dstParent->nlink += moved;
+        }
+        srcNode->parent = dstParentIno;
+        dstNode->parent = srcParentIno;
+        srcNode->ctime = dstNode->ctime = time;
+        srcParent->mtime = srcParent->ctime = dstParent->mtime = dstParent->ctime = time;
+        return;
+    }
+
+    if (dstNode != nullptr) {
+        if (dst == src) {
+            return;
+        }
+        if (flags & MEM_RENAME_NOREPLACE) {
+            _return.status = StatusCode::FUSE_ERROREEXIST;
+            return;
+        }
+        if (MEM_IS_DIR(srcNode->mode) && !MEM_IS_DIR(dstNode->mode)) {
+            _return.status = StatusCode::FUSE_ERRORENOTDIR;
+            return;
+        }
+        if (!MEM_IS_DIR(srcNode->mode) && MEM_IS_DIR(dstNode->mode)) {
+            _return.status = StatusCode::FUSE_ERROREISDIR;
+            return;
+        }
+        if (MEM_IS_DIR(dstNode->mode)) {
+            if (!dstNode->children.empty()) {
+                _return.status = StatusCode::FUSE_ENOTEMPTY;
+                return;
+            }
+            dstParent->nlink--;
+        }
+        dstParent->children.erase(dstEntry);
+        drop_link(dst);
+    }
+
+    srcParent->children.erase(srcEntry);
+    dstParent->children[dstName] = src;
+    if (MEM_IS_DIR(srcNode->mode)) {
+        srcParent->nlink--;
+        dstParent->nlink++;
+    }
+    srcNode->parent = dstParentIno;
+    srcNode->ctime = time;
+    srcParent->mtime = srcParent->ctime = dstParent->mtime = dstParent->ctime = time;
+}
+
+void mem_fs::link(FileSystemResponse& _return, const std::string& to, const std::string& destination, const FuseContext& context)
+{
+    unique_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = resolve(to, ino);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto node = inodes.get(ino);
+    if (MEM_IS_DIR(node->mode)) {
+        _return.status = StatusCode::FUSE_ERROREPERM;
+        return;
+    }
+    uint64_t parentIno;
+    std::string name;
+    _return.status = resolve_parent(destination, parentIno, name);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto parent = inodes.get(parentIno);
+    if (!parent->children.emplace(name, ino).second) {
+        _return.status = StatusCode::FUSE_ERROREEXIST;
+        return;
+    }
+    node->nlink++;
+    node->ctime = parent->mtime = parent->ctime = now();
+}
+
+void mem_fs::chmod(FileSystemResponse& _return, const std::string& path, const int32_t mode, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    auto node = node_of(path, handleInfo, ino, _return.status);
+    if (node == nullptr) {
+        return;
+    }
+    unique_guard guard(node->lock);
+    node->mode = (node->mode & MEM_IFMT) | (mode & 07777);
+    node->ctime = now();
+}
+
+void mem_fs::chown(FileSystemResponse& _return, const std::string& path, const int32_t uid, const int32_t gid, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    auto node = node_of(path, handleInfo, ino, _return.status);
+    if (node == nullptr) {
+        return;
+    }
+    unique_guard guard(node->lock);
+    if (uid != -1) {
+        node->uid = uid;
+    }
+    if (gid != -1) {
+        node->gid = gid;
+    }
+    node->ctime = now();
+}
+
+void mem_fs::truncate(FileSystemResponse& _return, const std::string& path, const int64_t offset, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    auto node = node_of(path, handleInfo, ino, _return.status);
+    if (node == nullptr) {
+        return;
+    }
+    if (MEM_IS_DIR(node->mode)) {
+        _return.status = StatusCode::FUSE_ERROREISDIR;
+        return;
+    }
+    if (offset < 0) {
+        _return.status = StatusCode::FUSE_ERROREINVAL;
+        return;
+    }
+    unique_guard guard(node->lock);
+    _return.status = resize(*node, static_cast<uint64_t>(offset));
+    node->version = ++versionClock;
+    node->mtime = node->ctime = now();
+}
+
+void mem_fs::open(FileSystemResponse& _return, const std::string& path, const FuseContext& context, const int32_t inlineLimit, const int64_t knownVersion)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = resolve(path, ino);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto node = inodes.get(ino);
+    if (MEM_IS_DIR(node->mode)) {
+        _return.status = StatusCode::FUSE_ERROREISDIR;
+        return;
+    }
+    FuseHandleInfo info;
+    info.__set_fh(open_handle(ino, node));
+    _return.__set_info(info);
+    inline_data(ino, node, inlineLimit, knownVersion, _return);
+}
+
+void mem_fs::read(FileSystemResponse& _return, const std::string& path, const int32_t size, const int64_t offset, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    auto node = node_of(path, handleInfo, ino, _return.status);
+    if (node == nullptr) {
+        return;
+    }
+    if (MEM_IS_DIR(node->mode)) {
+        _return.status = StatusCode::FUSE_ERROREISDIR;
+        return;
+    }
+    if (size < 0 || offset < 0) {
+        _return.status = StatusCode::FUSE_ERROREINVAL;
+        return;
+    }
+    shared_guard guard(node->lock);
+    _return.__isset.data = true;
+    read_data(*node, static_cast<uint64_t>(offset), static_cast<size_t>(size), _return.data);
+}
+
+void mem_fs::write(FileSystemResponse& _return, const std::string& path, const std::string& buffer, const int64_t offset, const int32_t size, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    auto node = node_of(path, handleInfo, ino, _return.status);
+    if (node == nullptr) {
+        return;
+    }
+    if (MEM_IS_DIR(node->mode)) {
+        _return.status = StatusCode::FUSE_ERROREISDIR;
+        return;
+    }
+    if (size < 0 || offset < 0) {
+        _return.status = StatusCode::FUSE_ERROREINVAL;
+        return;
+    }
+    size_t length = std::min<size_t>(static_cast<size_t>(size), buffer.size());
+    unique_guard guard(node->lock);
+    _return.status = write_data(*node, static_cast<uint64_t>(offset), buffer.data(), length);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        node->version = ++versionClock;
+        node->mtime = node->ctime = now();
+        _return.__set_dataWritten(static_cast<int64_t>(length));
+    }
+}
+
+void mem_fs::statfs(FileSystemResponse& _return, const std::string& path, const FuseContext& context)
+{
+    auto clamp = [](uint64_t value) { return static_cast<int32_t>(std::min<uint64_t>(value, INT32_MAX)); };
+    uint64_t used = chunkBytes;
+    uint64_t total = capacity != 0 ? capacity : std::max<uint64_t>(used, 1ULL << 40);
+    uint64_t inodeCount;
+    {
+        shared_guard tree(treeLock);
+        inodeCount = inodes.used();
+    }
+
+    FuseStatFS stat;
+    stat.__set_bSize(MEM_BLOCK_SIZE);
+    stat.__set_frSize(MEM_BLOCK_SIZE);
+    stat.__set_blocks(clamp(total / MEM_BLOCK_SIZE));
+    stat.__set_bfree(clamp((total - std::min(used, total)) / MEM_BLOCK_SIZE));
+    stat.__set_bavail(stat.bfree);
+    stat.__set_files(clamp(inodeCount + INT32_MAX / 2));
+    stat.__set_free(clamp(INT32_MAX / 2));
+    stat.__set_favail(stat.free);
+    stat.__set_fsid(0);
+    stat.__set_flags(static_cast<FuseFSFlags::type>(FuseFSFlags::FUSE_ST_NODEV | FuseFSFlags::FUSE_ST_VALID));
+    stat.__set_namemax(MEM_NAME_MAX);
+    _return.status = StatusCode::FUSE_SUCCESS;
+    _return.__set_statfs(stat);
+}
+
+void mem_fs::flush(FileSystemResponse& _return, const std::string& path, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    _return.status = StatusCode::FUSE_SUCCESS;
+}
+
+void mem_fs::release(FileSystemResponse& _return, const std::string& path, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    close_handle(handleInfo, _return);
+}
+
+void mem_fs::fsync(FileSystemResponse& _return, const std::string& path, const int64_t isdatasync, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    _return.status = StatusCode::FUSE_SUCCESS;
+}
+
+void mem_fs::setxattr(FileSystemResponse& _return, const std::string& path, const std::string& name, const std::string& val, const int16_t valsize, const int32_t flags, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = resolve(path, ino);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto node = inodes.get(ino);
+    unique_guard guard(node->lock);
+    auto found = node->xattrs.find(name);
+    if ((flags & MEM_XATTR_CREATE) && found != node->xattrs.end()) {
+        _return.status = StatusCode::FUSE_ERROREEXIST;
+    } else if ((flags & MEM_XATTR_REPLACE) && found == node->xattrs.end()) {
+        _return.status = MEM_STATUS_NOATTR;
+    } else {
+        node->xattrs[name] = val;
+        node->ctime = now();
+    }
+}
+
+void mem_fs::getxattr(FileSystemResponse& _return, const std::string& path, const std::string& name, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = resolve(path, ino);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto node = inodes.get(ino);
+    shared_guard guard(node->lock);
+    auto found = node->xattrs.find(name);
+    if (found == node->xattrs.end()) {
+        _return.status = MEM_STATUS_NOATTR;
+        return;
+    }
+    _return.__set_atrributeValue(found->second);
+}
+
+void mem_fs::listxattr(FileSystemResponse& _return, const std::string& path, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = resolve(path, ino);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto node = inodes.get(ino);
+    shared_guard guard(node->lock);
+    StringArray names;
+    for (auto& xattr : node->xattrs) {
+        names.push_back(xattr.first);
+    }
+    _return.__set_attributes(names);
+}
+
+void mem_fs::removexattr(FileSystemResponse& _return, const std::string& path, const std::string& attributeKey, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = resolve(path, ino);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto node = inodes.get(ino);
+    unique_guard guard(node->lock);
+    if (node->xattrs.erase(attributeKey) == 0) {
+        _return.status = MEM_STATUS_NOATTR;
+        return;
+    }
+    node->ctime = now();
+}
+
+void mem_fs::opendir(FileSystemResponse& _return, const std::string& path, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = resolve(path, ino);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    auto node = inodes.get(ino);
+    if (!MEM_IS_DIR(node->mode)) {
+        _return.status = StatusCode::FUSE_ERRORENOTDIR;
+        return;
+    }
+    FuseHandleInfo info;
+    info.__set_fh(open_handle(ino, node));
+    _return.__set_info(info);
+}
+
+void mem_fs::readdir(FileSystemResponse& _return, const std::string& path, const int64_t offset, const FuseHandleInfo& handleInfo, const FuseContext& context, const int32_t maxEntries)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    auto node = node_of(path, handleInfo, ino, _return.status);
+    if (node == nullptr) {
+        return;
+    }
+    if (!MEM_IS_DIR(node->mode)) {
+        _return.status = StatusCode::FUSE_ERRORENOTDIR;
+        return;
+    }
+
+    // Hand out one page, cookies are positions in the listing plus one
+    auto page = [&](const std::vector<FuseDirEntry>& listing) {
+        if (offset < 0 || offset > static_cast<int64_t>(listing.size())) {
+            _return.status = StatusCode::FUSE_ERROREINVAL;
+            return;
+        }
+        size_t count = listing.size() - static_cast<size_t>(offset);
+        if (maxEntries > 0 && count > static_cast<size_t>(maxEntries)) {
+            count = static_cast<size_t>(maxEntries);
+        }
+        _return.__set_dirEntry(DirEntryList(listing.begin() + offset, listing.begin() + offset + count));
+        if (offset + count < listing.size()) {
+            _return.__set_nextOffset(offset + static_cast<int64_t>(count));
+        }
+    };
+
+    auto clock = std::chrono::steady_clock::now();
+    auto ttl = std::chrono::milliseconds(MEM_LISTING_TTL_MS);
+    if (offset != 0) {
+        boost::lock_guard<boost::mutex> guard(handleLock);
+        if (has_handle(handleInfo)) {
+            auto found = handles.find(handleInfo.fh);
+            if (found != handles.end() && found->second.listed) {
+                page(found->second.listing);
+                return;
+            }
+        } else {
+            auto found = listings.find(path);
+            if (found != listings.end() && clock - found->second.taken < ttl) {
+                page(found->second.entries);
+                return;
+            }
+        }
+    }
+
+    std::vector<FuseDirEntry> listing;
+    listing.reserve(node->children.size());
+    for (auto& child : node->children) {
+        auto childNode = inodes.get(child.second);
+        FuseDirEntry entry;
+        entry.__set_name(child.first);
+        FuseStat stat;
+        {
+            shared_guard guard(childNode->lock);
+            fill_stat(child.second, *childNode, stat);
+        }
+        entry.__set_stats(stat);
+        entry.__set_offset(static_cast<int64_t>(listing.size()) + 1);
+        listing.push_back(entry);
+    }
+
+    if (has_handle(handleInfo)) {
+        boost::lock_guard<boost::mutex> guard(handleLock);
+        auto found = handles.find(handleInfo.fh);
+        if (found != handles.end()) {
+            found->second.listing = std::move(listing);
+            found->second.listed = true;
+            page(found->second.listing);
+            return;
+        }
+    } else {
+        boost::lock_guard<boost::mutex> guard(handleLock);
+        if (listings.size() >= MEM_LISTING_CACHE && listings.count(path) == 0) {
+            // Expired ones first, the oldest when none is
+            for (auto it = listings.begin(); it != listings.end();) {
+                it = clock - it->second.taken >= ttl ? listings.erase(it) : std::next(it);
+            }
+            if (listings.size() >= MEM_LISTING_CACHE) {
+                listings.erase(std::min_element(listings.begin(), listings.end(), [](const std::pair<const std::string, mem_listing>& a, const std::pair<const std::string, mem_listing>& b) {
+                    return a.second.taken < b.second.taken;
+                }));
+            }
+        }
+        auto& kept = listings[path];
+        kept.entries = std::move(listing);
+        kept.taken = clock;
+        page(kept.entries);
+        return;
+    }
+    page(listing);
+}
+
+void mem_fs::releasedir(FileSystemResponse& _return, const std::string& path, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    close_handle(handleInfo, _return);
+}
+
+void mem_fs::fsyncdir(FileSystemResponse& _return, const std::string& path, const int64_t isdatasync, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    _return.status = StatusCode::FUSE_SUCCESS;
+}
+
+void mem_fs::init(FileSystemResponse& _return, const FuseConnectionInfo& connn, const FuseConfig& config)
+{
+    _return.status = StatusCode::FUSE_SUCCESS;
+}
+
+void mem_fs::destroy(const int16_t fsPrivateId)
+{
+}
+
+void mem_fs::access(FileSystemResponse& _return, const std::string& path, const FuseAccessMode::type accessMask, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = resolve(path, ino);
+    if (_return.status != StatusCode::FUSE_SUCCESS || accessMask == 0) {
+        return;
+    }
+    auto node = inodes.get(ino);
+    shared_guard guard(node->lock);
+    int32_t uid = context.__isset.uid ? context.uid : 0;
+    int32_t gid = context.__isset.gid ? context.gid : 0;
+    int32_t allowed;
+    if (uid == 0) {
+        // root may do anything but execute what nobody may execute
+        allowed = MEM_ACCESS_R | MEM_ACCESS_W | ((node->mode & 0111) || MEM_IS_DIR(node->mode) ? MEM_ACCESS_X : 0);
+    } else if (uid == node->uid) {
+        allowed = (node->mode >> 6) & 7;
+    } else if (gid == node->gid) {
+        allowed = (node->mode >> 3) & 7;
+    } else {
+        allowed = node->mode & 7;
+    }
+    if ((accessMask & ~allowed) != 0) {
+        _return.status = StatusCode::FUSE_ERROREACCES;
+    }
+}
+
+void mem_fs::create(FileSystemResponse& _return, const std::string& path, const int32_t mode, const FuseContext& context, const int32_t inlineLimit)
+{
+    uint64_t ino;
+    mem_inode* node;
+    {
+        unique_guard tree(treeLock);
+        _return.status = make_node(path, MEM_IFREG | (mode & 07777), context, ino);
+        if (_return.status != StatusCode::FUSE_SUCCESS) {
+            return;
+        }
+        node = inodes.get(ino);
+        FuseHandleInfo info;
+        info.__set_fh(open_handle(ino, node));
+        _return.__set_info(info);
+        FuseStat stat;
+        fill_stat(ino, *node, stat);
+        _return.__set_stats(stat);
+    }
+    if (inlineLimit > 0) {
+        // Nothing to read yet, the version lets the client cache what it writes
+        _return.__set_data("");
+        _return.__set_version(0);
+    }
+}
+
+void mem_fs::lock(FileSystemResponse& _return, const std::string& path, const FuseHandleInfo& handleInfo, const int32_t cmd, const FuseFlock& flock, const FuseContext& context)
+{
+    // Locks are kept by the kernel of the mounting host
+    _return.status = StatusCode::FUSE_SUCCESS;
+}
+
+void mem_fs::utimens(FileSystemResponse& _return, const std::string& path, const FuseTimeSpec& timeSpec, const FuseHandleInfo& info, const FuseContext& context)
+{
+    shared_guard tree(treeLock);
+    uint64_t ino;
+    auto node = node_of(path, info, ino, _return.status);
+    if (node == nullptr) {
+        return;
+    }
+    unique_guard guard(node->lock);
+    int32_t time = now();
+    node->atime = timeSpec.__isset.accessTime ? timeSpec.accessTime : time;
+    node->mtime = timeSpec.__isset.modificationTime ? timeSpec.modificationTime : time;
+    node->ctime = time;
+}
+
+void mem_fs::bmap(FileSystemResponse& _return, const std::string& path, const int64_t blocksize, const int64_t blockIndex, const FuseContext& context)
+{
+    // Not backed by a block device
+    _return.status = StatusCode::FUSE_ERROREINVAL;
+}
+
+void mem_fs::mknod(FileSystemResponse& _return, const std::string& path, const int32_t mode, const int64_t deviceId, const FuseContext& context)
+{
+    int32_t type = mode & MEM_IFMT;
+    if (type == MEM_IFDIR) {
+        _return.status = StatusCode::FUSE_ERROREINVAL;
+        return;
+    }
+    unique_guard tree(treeLock);
+    uint64_t ino;
+    _return.status = make_node(path, (type == 0 ? MEM_IFREG : type) | (mode & 07777), context, ino);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        inodes.get(ino)->rdev = static_cast<int32_t>(deviceId);
+    }
+}
+
+void mem_fs::ping()
+{
+}
+
+void mem_fs::batch(ResponseList& _return, const BatchRequestList& requests)
+{
+    _return.resize(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+        auto& request = requests[i];
+        switch (request.op) {
+        case BatchOp::GETATTR:
+            getattr(_return[i], request.path, request.handleInfo, request.context);
+            break;
+        case BatchOp::UNLINK:
+            unlink(_return[i], request.path, request.context);
+            break;
+        case BatchOp::RMDIR:
+            rmdir(_return[i], request.path, request.context);
+            break;
+        default:
+            _return[i].status = StatusCode::FUSE_ERROREINVAL;
+            break;
+        }
+    }
+}
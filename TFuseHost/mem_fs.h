@@ -0,0 +1,229 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+#include <FuseService.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+// File contents live in chunks of this size, holes take no memory
+#define MEM_CHUNK_SIZE (64 * 1024)
+// Inodes are allocated this many at a time and never move afterwards
+#define MEM_ARENA_SLAB 4096
+// Block size reported by getattr and statfs
+#define MEM_BLOCK_SIZE 4096
+#define MEM_NAME_MAX 255
+// Listings of readdir calls without a handle are kept this long for the
+// pages after the first, up to MEM_LISTING_CACHE directories
+#define MEM_LISTING_TTL_MS 2000
+#define MEM_LISTING_CACHE 64
+
+// Mode bits as in FUSE_MODE_MASK_*, spelled out since Windows has no S_IFLNK
+#define MEM_IFMT 0170000
+#define MEM_IFDIR 0040000
+#define MEM_IFREG 0100000
+#define MEM_IFLNK 0120000
+#define MEM_IS_DIR(mode) (((mode)&MEM_IFMT) == MEM_IFDIR)
+// FuseAccessMode bits, unistd.h turns the R_OK style names into macros
+#define MEM_ACCESS_X 1
+#define MEM_ACCESS_W 2
+#define MEM_ACCESS_R 4
+
+// rename(2) flags, not defined on every platform
+#define MEM_RENAME_NOREPLACE 1
+#define MEM_RENAME_EXCHANGE 2
+// setxattr(2) flags
+#define MEM_XATTR_CREATE 1
+#define MEM_XATTR_REPLACE 2
+// ENODATA, missing attribute, has no StatusCode of its own
+#define MEM_STATUS_NOATTR static_cast<Fuse::StatusCode::type>(61)
+
+/*
+ * One file, directory or link. Tree shape (children, parent, nlink, live) is
+ * guarded by the tree lock of mem_fs, everything else by lock.
+ */
+struct mem_inode {
+    boost::shared_mutex lock;
+    bool live = false;
+    uint64_t parent = 0;
+    int32_t mode = 0;
+    int32_t nlink = 0;
+    int32_t uid = 0;
+    int32_t gid = 0;
+    int32_t rdev = 0;
+    int32_t atime = 0;
+    int32_t mtime = 0;
+    int32_t ctime = 0;
+    uint64_t size = 0;
+    // Content version handed out with inlined data, 0 while the file is
+    // empty from creation, a fresh tick of mem_fs::versionClock on every change
+    std::atomic<int64_t> version { 0 };
+    // Handles still open, an unlinked inode lives until the last is released
+    std::atomic<int32_t> openCount { 0 };
+    std::vector<std::unique_ptr<char[]>> chunks;
+    std::unordered_map<std::string, uint64_t> children;
+    std::string link;
+    std::map<std::string, std::string> xattrs;
+
+    void clear();
+};
+
+/*
+ * Inode table allocated in slabs of MEM_ARENA_SLAB, the inode number is the
+ * slot index plus one and freed slots are reused. Allocation and release need
+ * the tree lock exclusively, get works under the shared lock.
+ */
+class inode_arena {
+public:
+    uint64_t alloc();
+    void release(uint64_t ino);
+
+    // Null for numbers never handed out or already released
+    inline mem_inode* get(uint64_t ino) const
+    {
+        if (ino == 0 || ino > next) {
+            return nullptr;
+        }
+        auto node = slot(ino);
+        return node->live ? node : nullptr;
+    }
+
+    inline uint64_t used() const
+    {
+        return next - freeList.size();
+    }
+
+private:
+    inline mem_inode* slot(uint64_t ino) const
+    {
+        return &slabs[(ino - 1) / MEM_ARENA_SLAB][(ino - 1) % MEM_ARENA_SLAB];
+    }
+
+    std::vector<std::unique_ptr<mem_inode[]>> slabs;
+    std::vector<uint64_t> freeList;
+    uint64_t next = 0;
+};
+
+struct mem_handle {
+    uint64_t ino;
+    // Listing taken at readdir offset 0, later pages index into it
+    std::vector<Fuse::FuseDirEntry> listing;
+    bool listed;
+};
+
+struct mem_listing {
+    std::vector<Fuse::FuseDirEntry> entries;
+    std::chrono::steady_clock::time_point taken;
+};
+
+/*
+ * Whole filesystem in memory, the C++ counterpart of TFuseMem. Lookups,
+ * reads and writes share the tree lock and only serialize per inode, changes
+ * to the tree take it exclusively. capacity bounds the memory held by file
+ * contents, 0 leaves it unbounded.
+ */
+class mem_fs : public Fuse::FuseServiceIf {
+public:
+    explicit mem_fs(uint64_t capacity = 0);
+
+    void getattr(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void readlink(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t maxSize, const Fuse::FuseContext& context) override;
+    void mkdir(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t mode, const Fuse::FuseContext& context) override;
+    void unlink(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context) override;
+    void rmdir(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context) override;
+    void symlink(Fuse::FileSystemResponse& _return, const std::string& destination, const std::string& source, const Fuse::FuseContext& context) override;
+    void rename(Fuse::FileSystemResponse& _return, const std::string& source, const std::string& destination, const int64_t flags, const Fuse::FuseContext& context) override;
+    void link(Fuse::FileSystemResponse& _return, const std::string& to, const std::string& destination, const Fuse::FuseContext& context) override;
+    void chmod(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t mode, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void chown(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t uid, const int32_t gid, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void truncate(Fuse::FileSystemResponse& _return, const std::string& path, const int64_t offset, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void open(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context, const int32_t inlineLimit, const int64_t knownVersion) override;
+    void read(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t size, const int64_t offset, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void write(Fuse::FileSystemResponse& _return, const std::string& path, const std::string& buffer, const int64_t offset, const int32_t size, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void statfs(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context) override;
+    void flush(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void release(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void fsync(Fuse::FileSystemResponse& _return, const std::string& path, const int64_t isdatasync, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void setxattr(Fuse::FileSystemResponse& _return, const std::string& path, const std::string& name, const std::string& val, const int16_t valsize, const int32_t flags, const Fuse::FuseContext& context) override;
+    void getxattr(Fuse::FileSystemResponse& _return, const std::string& path, const std::string& name, const Fuse::FuseContext& context) override;
+    void listxattr(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context) override;
+    void removexattr(Fuse::FileSystemResponse& _return, const std::string& path, const std::string& attributeKey, const Fuse::FuseContext& context) override;
+    void opendir(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context) override;
+    void readdir(Fuse::FileSystemResponse& _return, const std::string& path, const int64_t offset, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context, const int32_t maxEntries) override;
+    void releasedir(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void fsyncdir(Fuse::FileSystemResponse& _return, const std::string& path, const int64_t isdatasync, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void init(Fuse::FileSystemResponse& _return, const Fuse::FuseConnectionInfo& connn, const Fuse::FuseConfig& config) override;
+    void destroy(const int16_t fsPrivateId) override;
+    void access(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseAccessMode::type accessMask, const Fuse::FuseContext& context) override;
+    void create(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t mode, const Fuse::FuseContext& context, const int32_t inlineLimit) override;
+    void lock(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseHandleInfo& handleInfo, const int32_t cmd, const Fuse::FuseFlock& flock, const Fuse::FuseContext& context) override;
+    void utimens(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseTimeSpec& timeSpec, const Fuse::FuseHandleInfo& info, const Fuse::FuseContext& context) override;
+    void bmap(Fuse::FileSystemResponse& _return, const std::string& path, const int64_t blocksize, const int64_t blockIndex, const Fuse::FuseContext& context) override;
+    void mknod(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t mode, const int64_t deviceId, const Fuse::FuseContext& context) override;
+    void ping() override;
+    void batch(Fuse::ResponseList& _return, const Fuse::BatchRequestList& requests) override;
+
+private:
+    // All of these expect the tree lock to be held
+    Fuse::StatusCode::type resolve(const std::string& path, uint64_t& ino) const;
+    Fuse::StatusCode::type resolve_parent(const std::string& path, uint64_t& parent, std::string& name) const;
+    // Inode of an open handle when there is one, of path otherwise
+    mem_inode* node_of(const std::string& path, const Fuse::FuseHandleInfo& handle, uint64_t& ino, Fuse::StatusCode::type& status);
+    Fuse::StatusCode::type make_node(const std::string& path, int32_t mode, const Fuse::FuseContext& context, uint64_t& ino);
+    void drop_link(uint64_t ino);
+    void free_if_unused(uint64_t ino);
+
+    void fill_stat(uint64_t ino, const mem_inode& node, Fuse::FuseStat& stat) const;
+    int64_t open_handle(uint64_t ino, mem_inode* node);
+    void close_handle(const Fuse::FuseHandleInfo& handle, Fuse::FileSystemResponse& _return);
+    void inline_data(uint64_t ino, mem_inode* node, int32_t inlineLimit, int64_t knownVersion, Fuse::FileSystemResponse& _return);
+
+    // Contents, with the inode lock held
+    void read_data(const mem_inode& node, uint64_t offset, size_t size, std::string& out) const;
+    Fuse::StatusCode::type write_data(mem_inode& node, uint64_t offset, const char* data, size_t size);
+    Fuse::StatusCode::type resize(mem_inode& node, uint64_t size);
+    void release_chunks(mem_inode& node, size_t keep);
+
+    mutable boost::shared_mutex treeLock;
+    inode_arena inodes;
+    uint64_t root;
+
+    boost::mutex handleLock;
+    std::unordered_map<int64_t, mem_handle> handles;
+    std::atomic<int64_t> nextHandle { 0 };
+    // By path, for readdir without a handle as sent to every shard
+    std::unordered_map<std::string, mem_listing> listings;
+
+    uint64_t capacity;
+    std::atomic<uint64_t> chunkBytes { 0 };
+    // Shared by all inodes, so a version names one content even after the
+    // path is recreated on a reused inode
+    std::atomic<int64_t> versionClock { 0 };
+};
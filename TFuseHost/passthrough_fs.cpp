@@ -0,0 +1,1012 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#if defined(__linux__)
+// Include FuseService first to avoid redefinition errors
+#include <FuseService.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <linux/openat2.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <sys/xattr.h>
+#include <unistd.h>
+
+#include <boost/thread/locks.hpp>
+
+#include <Logger.h>
+#include <passthrough_fs.h>
+
+using namespace Fuse;
+
+typedef boost::shared_lock<boost::shared_mutex> shared_guard;
+typedef boost::unique_lock<boost::shared_mutex> unique_guard;
+
+// StatusCode follows the Linux errno numbers
+static inline StatusCode::type status_of(int error)
+{
+    return static_cast<StatusCode::type>(error);
+}
+
+// Status of a libc call returning -1 and errno on failure
+static inline StatusCode::type call_status(long result)
+{
+    return result < 0 ? status_of(errno) : StatusCode::FUSE_SUCCESS;
+}
+
+// Status of a ring operation, -errno on failure
+static inline StatusCode::type ring_status(int result)
+{
+    return result < 0 ? status_of(-result) : StatusCode::FUSE_SUCCESS;
+}
+
+static inline bool has_handle(const FuseHandleInfo& handle)
+{
+    return handle.__isset.fh && handle.fh > 0;
+}
+
+static void fill_stat(const struct statx& stx, FuseStat& stat)
+{
+    stat.__set_dev(static_cast<int32_t>(makedev(stx.stx_dev_major, stx.stx_dev_minor)));
+    stat.__set_ino(static_cast<int64_t>(stx.stx_ino));
+    stat.__set_mode(stx.stx_mode);
+    stat.__set_nlink(static_cast<int32_t>(stx.stx_nlink));
+    stat.__set_uid(static_cast<int32_t>(stx.stx_uid));
+    stat.__set_gid(static_cast<int32_t>(stx.stx_gid));
+    stat.__set_rdev(static_cast<int32_t>(makedev(stx.stx_rdev_major, stx.stx_rdev_minor)));
+    stat.__set_size(static_cast<int64_t>(stx.stx_size));
+    stat.__set_blksize(static_cast<int32_t>(stx.stx_blksize));
+    stat.__set_blocks(static_cast<int64_t>(stx.stx_blocks));
+    stat.__set_accessTime(static_cast<int32_t>(stx.stx_atime.tv_sec));
+    stat.__set_modificationTime(static_cast<int32_t>(stx.stx_mtime.tv_sec));
+    stat.__set_changeTime(static_cast<int32_t>(stx.stx_ctime.tv_sec));
+}
+
+// Content version handed out with inlined data, moves with every write.
+// ctime since utimens can set mtime back, mixed with the inode for a file
+// recreated at the same path; never negative, -1 is no version for open.
+static inline int64_t content_version(const struct statx& stx)
+{
+    uint64_t ctime = static_cast<uint64_t>(stx.stx_ctime.tv_sec) * 1000000000 + stx.stx_ctime.tv_nsec;
+    return static_cast<int64_t>((ctime ^ (stx.stx_ino * 0x9E3779B97F4A7C15ull)) & INT64_MAX);
+}
+
+// Path of a descriptor for the calls that follow it to the inode
+static inline std::string proc_path(int fd)
+{
+    return "/proc/self/fd/" + std::to_string(fd);
+}
+
+pt_file::~pt_file()
+{
+    close(fd);
+}
+
+pt_node::~pt_node()
+{
+    if (owned) {
+        close(dirFd);
+    }
+}
+
+passthrough_fs::passthrough_fs(const std::string& root, unsigned uringEntries)
+    : asRoot(geteuid() == 0)
+    , ring(uringEntries)
+{
+    rootFd = ::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (rootFd < 0) {
+        throw std::runtime_error("Cannot open " + root + " " + strerror(errno));
+    }
+    // Nothing is resolved without it, io_uring needs the same 5.6 kernel
+    int probe = open_beneath(".", O_PATH | O_DIRECTORY);
+    if (probe < 0) {
+        int error = errno;
+        close(rootFd);
+        throw std::runtime_error(std::string("openat2 is not available ") + strerror(error));
+    }
+    close(probe);
+    LOG_INFO << "Serving " << root << (ring.active() ? " through io_uring" : " with plain system calls");
+}
+
+passthrough_fs::~passthrough_fs()
+{
+    close(rootFd);
+}
+
+StatusCode::type passthrough_fs::relative(const std::string& path, std::string& rel) const
+{
+    rel.clear();
+    size_t pos = 0;
+    while (pos < path.size()) {
+        if (path[pos] == '/') {
+            pos++;
+            continue;
+        }
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        size_t length = end - pos;
+        if (length == 2 && path.compare(pos, 2, "..") == 0) {
+            // Nothing above the root is served
+            return StatusCode::FUSE_ERROREACCES;
+        }
+        if (length != 1 || path[pos] != '.') {
+            if (!rel.empty()) {
+                rel += '/';
+            }
+            rel.append(path, pos, length);
+        }
+        pos = end;
+    }
+    if (rel.empty()) {
+        rel = ".";
+    }
+    return StatusCode::FUSE_SUCCESS;
+}
+
+int passthrough_fs::open_beneath(const std::string& rel, int flags, mode_t mode) const
+{
+    struct open_how how;
+    memset(&how, 0, sizeof(how));
+    how.flags = static_cast<uint64_t>(flags | O_CLOEXEC);
+    how.mode = (flags & O_CREAT) ? mode : 0;
+    how.resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS;
+    long fd;
+    do {
+        // EAGAIN when a rename raced with a ".." in the path
+        fd = syscall(SYS_openat2, rootFd, rel.c_str(), &how, sizeof(how));
+    } while (fd < 0 && errno == EAGAIN);
+    return static_cast<int>(fd);
+}
+
+StatusCode::type passthrough_fs::resolve(const std::string& path, pt_node& node) const
+{
+    std::string rel;
+    auto status = relative(path, rel);
+    if (status != StatusCode::FUSE_SUCCESS) {
+        return status;
+    }
+    size_t slash = rel.rfind('/');
+    if (slash == std::string::npos) {
+        node.dirFd = rootFd;
+        node.name = rel;
+        return StatusCode::FUSE_SUCCESS;
+    }
+    int fd = open_beneath(rel.substr(0, slash), O_PATH | O_DIRECTORY);
+    if (fd < 0) {
+        return status_of(errno);
+    }
+    node.dirFd = fd;
+    node.owned = true;
+    node.name = rel.substr(slash + 1);
+    return StatusCode::FUSE_SUCCESS;
+}
+
+StatusCode::type passthrough_fs::open_proc_path(const std::string& path, std::shared_ptr<pt_file>& node, std::string& procPath) const
+{
+    // f*xattr and fchmod refuse O_PATH descriptors, which are the only kind
+    // that opens any node without reading it. The /proc entry of the
+    // descriptor leads the path calls to that same inode.
+    std::string rel;
+    auto status = relative(path, rel);
+    if (status != StatusCode::FUSE_SUCCESS) {
+        return status;
+    }
+    int fd = open_beneath(rel, O_PATH | O_NOFOLLOW);
+    if (fd < 0) {
+        return status_of(errno);
+    }
+    node = std::make_shared<pt_file>(fd);
+    procPath = proc_path(fd);
+    return StatusCode::FUSE_SUCCESS;
+}
+
+std::shared_ptr<pt_file> passthrough_fs::find_handle(const FuseHandleInfo& handle)
+{
+    if (!has_handle(handle)) {
+        return nullptr;
+    }
+    shared_guard guard(handleLock);
+    auto found = handles.find(handle.fh);
+    return found != handles.end() ? found->second : nullptr;
+}
+
+std::shared_ptr<pt_file> passthrough_fs::file_of(const std::string& path, const FuseHandleInfo& handle, int flags, StatusCode::type& status)
+{
+    auto file = find_handle(handle);
+    if (file) {
+        status = StatusCode::FUSE_SUCCESS;
+        return file;
+    }
+    std::string rel;
+    status = relative(path, rel);
+    if (status != StatusCode::FUSE_SUCCESS) {
+        return nullptr;
+    }
+    int fd = open_beneath(rel, flags | O_NOFOLLOW);
+    if (fd < 0) {
+        status = status_of(errno);
+        return nullptr;
+    }
+    return std::make_shared<pt_file>(fd);
+}
+
+int64_t passthrough_fs::open_handle(const std::shared_ptr<pt_file>& file)
+{
+    int64_t fh = ++nextHandle;
+    unique_guard guard(handleLock);
+    handles.emplace(fh, file);
+    return fh;
+}
+
+void passthrough_fs::close_handle(const FuseHandleInfo& handle, FileSystemResponse& _return)
+{
+    std::shared_ptr<pt_file> file;
+    {
+        unique_guard guard(handleLock);
+        auto found = has_handle(handle) ? handles.find(handle.fh) : handles.end();
+        if (found == handles.end()) {
+            _return.status = StatusCode::FUSE_ERROREBADF;
+            return;
+        }
+        file = std::move(found->second);
+        handles.erase(found);
+    }
+    // Closed here unless a request still uses it
+    _return.status = StatusCode::FUSE_SUCCESS;
+}
+
+void passthrough_fs::give_to(int dirFd, const std::string& name, const FuseContext& context)
+{
+    if (!asRoot) {
+        return;
+    }
+    uid_t uid = context.__isset.uid ? static_cast<uid_t>(context.uid) : static_cast<uid_t>(-1);
+    gid_t gid = context.__isset.gid ? static_cast<gid_t>(context.gid) : static_cast<gid_t>(-1);
+    int flags = AT_SYMLINK_NOFOLLOW | (name.empty() ? AT_EMPTY_PATH : 0);
+    if (fchownat(dirFd, name.c_str(), uid, gid, flags) < 0) {
+        LOG_WARNING << "Cannot hand " << name << " to " << uid << ":" << gid << " " << strerror(errno);
+    }
+}
+
+StatusCode::type passthrough_fs::prepare_stat(const std::string& path, const FuseHandleInfo& handle, uring_op& op, struct statx& stx, pt_node& node, std::shared_ptr<pt_file>& file)
+{
+    op.kind = uring_kind::STATX;
+    op.stx = &stx;
+    op.flags = AT_SYMLINK_NOFOLLOW;
+    file = find_handle(handle);
+    if (file) {
+        op.fd = file->fd;
+        op.path = "";
+        op.flags |= AT_EMPTY_PATH;
+        return StatusCode::FUSE_SUCCESS;
+    }
+    auto status = resolve(path, node);
+    op.fd = node.dirFd;
+    op.path = node.name.c_str();
+    return status;
+}
+
+void passthrough_fs::stat_file(const pt_file& file, FileSystemResponse& _return)
+{
+    struct statx stx;
+    uring_op op;
+    op.kind = uring_kind::STATX;
+    op.fd = file.fd;
+    op.flags = AT_EMPTY_PATH;
+    op.stx = &stx;
+    _return.status = ring_status(ring.run(op));
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        FuseStat stat;
+        fill_stat(stx, stat);
+        _return.__set_stats(stat);
+    }
+}
+
+void passthrough_fs::inline_data(const pt_file& file, int32_t inlineLimit, int64_t knownVersion, FileSystemResponse& _return)
+{
+    // Attributes and the head of the file in one submission
+    struct statx stx;
+    std::string data(static_cast<size_t>(inlineLimit), '\0');
+    uring_op ops[2];
+    ops[0].kind = uring_kind::STATX;
+    ops[0].fd = file.fd;
+    ops[0].flags = AT_EMPTY_PATH;
+    ops[0].stx = &stx;
+    ops[1].kind = uring_kind::READ;
+    ops[1].fd = file.fd;
+    ops[1].buf = &data[0];
+    ops[1].len = data.size();
+    ring.run(ops, 2);
+    _return.status = ring_status(ops[0].result);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    FuseStat stat;
+    fill_stat(stx, stat);
+    _return.__set_stats(stat);
+
+    // Both ran at once, a write in between shows as a size the read disagrees with
+    if (ops[1].result >= 0 && static_cast<uint64_t>(ops[1].result) == std::min<uint64_t>(stx.stx_size, data.size())) {
+        int64_t version = content_version(stx);
+        // The client holds this content already, spare the wire
+        if (version != knownVersion) {
+            data.resize(static_cast<size_t>(ops[1].result));
+            _return.__set_data(data);
+        }
+        _return.__set_version(version);
+    }
+}
+
+StatusCode::type passthrough_fs::list(const pt_file& dir, std::vector<FuseDirEntry>& listing)
+{
+    // A descriptor of its own so the handle's position is left alone
+    int fd = openat(dir.fd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return status_of(errno);
+    }
+    DIR* stream = fdopendir(fd);
+    if (stream == nullptr) {
+        int error = errno;
+        close(fd);
+        return status_of(error);
+    }
+    std::vector<std::string> names;
+    errno = 0;
+    while (auto entry = ::readdir(stream)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+            names.emplace_back(entry->d_name);
+        }
+    }
+    int error = errno;
+    closedir(stream);
+    if (error != 0) {
+        return status_of(error);
+    }
+
+    // The whole directory is stat'ed with one submission
+    std::vector<struct statx> stats(names.size());
+    std::vector<uring_op> ops(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        ops[i].kind = uring_kind::STATX;
+        ops[i].fd = dir.fd;
+        ops[i].path = names[i].c_str();
+        ops[i].flags = AT_SYMLINK_NOFOLLOW;
+        ops[i].stx = &stats[i];
+    }
+    ring.run(ops.data(), ops.size());
+
+    listing.reserve(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        if (ops[i].result < 0) {
+            // Removed since the directory was read
+            continue;
+        }
+        FuseDirEntry entry;
+        entry.__set_name(names[i]);
+        FuseStat stat;
+        fill_stat(stats[i], stat);
+        entry.__set_stats(stat);
+        entry.__set_offset(static_cast<int64_t>(listing.size()) + 1);
+        listing.push_back(entry);
+    }
+    return StatusCode::FUSE_SUCCESS;
+}
+
+void passthrough_fs::getattr(FileSystemResponse& _return, const std::string& path, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    uring_op op;
+    struct statx stx;
+    pt_node node;
+    std::shared_ptr<pt_file> file;
+    _return.status = prepare_stat(path, handleInfo, op, stx, node, file);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    _return.status = ring_status(ring.run(op));
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        FuseStat stat;
+        fill_stat(stx, stat);
+        _return.__set_stats(stat);
+    }
+}
+
+void passthrough_fs::readlink(FileSystemResponse& _return, const std::string& path, const int32_t maxSize, const FuseContext& context)
+{
+    pt_node node;
+    _return.status = resolve(path, node);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    char target[PATH_MAX];
+    ssize_t length = readlinkat(node.dirFd, node.name.c_str(), target, sizeof(target));
+    _return.status = call_status(length);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.__set_linkPath(std::string(target, static_cast<size_t>(length)));
+    }
+}
+
+void passthrough_fs::mkdir(FileSystemResponse& _return, const std::string& path, const int32_t mode, const FuseContext& context)
+{
+    pt_node node;
+    _return.status = resolve(path, node);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    _return.status = call_status(mkdirat(node.dirFd, node.name.c_str(), static_cast<mode_t>(mode & 07777)));
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        give_to(node.dirFd, node.name, context);
+    }
+}
+
+void passthrough_fs::unlink(FileSystemResponse& _return, const std::string& path, const FuseContext& context)
+{
+    pt_node node;
+    _return.status = resolve(path, node);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = call_status(unlinkat(node.dirFd, node.name.c_str(), 0));
+    }
+}
+
+void passthrough_fs::rmdir(FileSystemResponse& _return, const std::string& path, const FuseContext& context)
+{
+    pt_node node;
+    _return.status = resolve(path, node);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = call_status(unlinkat(node.dirFd, node.name.c_str(), AT_REMOVEDIR));
+    }
+}
+
+void passthrough_fs::symlink(FileSystemResponse& _return, const std::string& destination, const std::string& source, const FuseContext& context)
+{
+    // The link is created at source and points to destination
+    pt_node node;
+    _return.status = resolve(source, node);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    _return.status = call_status(symlinkat(destination.c_str(), node.dirFd, node.name.c_str()));
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        give_to(node.dirFd, node.name, context);
+    }
+}
+
+void passthrough_fs::rename(FileSystemResponse& _return, const std::string& source, const std::string& destination, const int64_t flags, const FuseContext& context)
+{
+    pt_node from, to;
+    _return.status = resolve(source, from);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = resolve(destination, to);
+    }
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        // renameat2 takes the RENAME_NOREPLACE and RENAME_EXCHANGE the client forwards
+        _return.status = call_status(syscall(SYS_renameat2, from.dirFd, from.name.c_str(), to.dirFd, to.name.c_str(), static_cast<unsigned>(flags)));
+    }
+}
+
+void passthrough_fs::link(FileSystemResponse& _return, const std::string& to, const std::string& destination, const FuseContext& context)
+{
+    pt_node existing, created;
+    _return.status = resolve(to, existing);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = resolve(destination, created);
+    }
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = call_status(linkat(existing.dirFd, existing.name.c_str(), created.dirFd, created.name.c_str(), 0));
+    }
+}
+
+void passthrough_fs::chmod(FileSystemResponse& _return, const std::string& path, const int32_t mode, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    auto bits = static_cast<mode_t>(mode & 07777);
+    auto file = find_handle(handleInfo);
+    if (file) {
+        _return.status = call_status(fchmod(file->fd, bits));
+        return;
+    }
+    std::string procPath;
+    _return.status = open_proc_path(path, file, procPath);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = call_status(::chmod(procPath.c_str(), bits));
+    }
+}
+
+void passthrough_fs::chown(FileSystemResponse& _return, const std::string& path, const int32_t uid, const int32_t gid, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    auto file = find_handle(handleInfo);
+    if (file) {
+        _return.status = call_status(fchown(file->fd, static_cast<uid_t>(uid), static_cast<gid_t>(gid)));
+        return;
+    }
+    pt_node node;
+    _return.status = resolve(path, node);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = call_status(fchownat(node.dirFd, node.name.c_str(), static_cast<uid_t>(uid), static_cast<gid_t>(gid), AT_SYMLINK_NOFOLLOW));
+    }
+}
+
+void passthrough_fs::truncate(FileSystemResponse& _return, const std::string& path, const int64_t offset, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    if (offset < 0) {
+        _return.status = StatusCode::FUSE_ERROREINVAL;
+        return;
+    }
+    auto file = file_of(path, handleInfo, O_WRONLY, _return.status);
+    if (file) {
+        _return.status = call_status(ftruncate(file->fd, static_cast<off_t>(offset)));
+    }
+}
+
+void passthrough_fs::open(FileSystemResponse& _return, const std::string& path, const FuseContext& context, const int32_t inlineLimit, const int64_t knownVersion)
+{
+    std::string rel;
+    _return.status = relative(path, rel);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    // open carries no flags, take the widest access the file grants
+    int fd = -1;
+    for (int access : { O_RDWR, O_RDONLY, O_WRONLY }) {
+        fd = open_beneath(rel, access | O_NOFOLLOW);
+        if (fd >= 0 || (errno != EACCES && errno != EPERM && errno != EROFS && errno != ETXTBSY)) {
+            break;
+        }
+    }
+    if (fd < 0) {
+        _return.status = status_of(errno);
+        return;
+    }
+    auto file = std::make_shared<pt_file>(fd);
+    FuseHandleInfo info;
+    info.__set_fh(open_handle(file));
+    _return.__set_info(info);
+    if (inlineLimit > 0) {
+        inline_data(*file, inlineLimit, knownVersion, _return);
+    }
+}
+
+void passthrough_fs::read(FileSystemResponse& _return, const std::string& path, const int32_t size, const int64_t offset, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    if (size < 0 || offset < 0) {
+        _return.status = StatusCode::FUSE_ERROREINVAL;
+        return;
+    }
+    auto file = file_of(path, handleInfo, O_RDONLY, _return.status);
+    if (!file) {
+        return;
+    }
+    _return.data.resize(static_cast<size_t>(size));
+    uring_op op;
+    op.kind = uring_kind::READ;
+    op.fd = file->fd;
+    op.buf = &_return.data[0];
+    op.len = _return.data.size();
+    op.offset = static_cast<uint64_t>(offset);
+    int result = ring.run(op);
+    _return.status = ring_status(result);
+    _return.data.resize(result > 0 ? static_cast<size_t>(result) : 0);
+    _return.__isset.data = _return.status == StatusCode::FUSE_SUCCESS;
+}
+
+void passthrough_fs::write(FileSystemResponse& _return, const std::string& path, const std::string& buffer, const int64_t offset, const int32_t size, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    if (size < 0 || offset < 0) {
+        _return.status = StatusCode::FUSE_ERROREINVAL;
+        return;
+    }
+    auto file = file_of(path, handleInfo, O_WRONLY, _return.status);
+    if (!file) {
+        return;
+    }
+    uring_op op;
+    op.kind = uring_kind::WRITE;
+    op.fd = file->fd;
+    op.buf = const_cast<char*>(buffer.data());
+    op.len = std::min<size_t>(static_cast<size_t>(size), buffer.size());
+    op.offset = static_cast<uint64_t>(offset);
+    int result = ring.run(op);
+    _return.status = ring_status(result);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.__set_dataWritten(result);
+    }
+}
+
+void passthrough_fs::statfs(FileSystemResponse& _return, const std::string& path, const FuseContext& context)
+{
+    struct statvfs vfs;
+    _return.status = call_status(fstatvfs(rootFd, &vfs));
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    // Counts are 32 bit on the wire, big disks are reported in bigger fragments
+    uint64_t frSize = vfs.f_frsize != 0 ? vfs.f_frsize : vfs.f_bsize;
+    uint64_t blocks = vfs.f_blocks;
+    uint64_t bfree = vfs.f_bfree;
+    uint64_t bavail = vfs.f_bavail;
+    while (blocks > INT32_MAX && frSize < INT32_MAX / 2) {
+        frSize *= 2;
+        blocks /= 2;
+        bfree /= 2;
+        bavail /= 2;
+    }
+    auto clamp = [](uint64_t value) { return static_cast<int32_t>(std::min<uint64_t>(value, INT32_MAX)); };
+    unsigned long mountFlags = ST_RDONLY | ST_NOSUID | ST_NODEV | ST_NOEXEC | ST_SYNCHRONOUS | ST_MANDLOCK | ST_NOATIME | ST_NODIRATIME | ST_RELATIME;
+
+    FuseStatFS stat;
+    stat.__set_bSize(clamp(vfs.f_bsize));
+    stat.__set_frSize(clamp(frSize));
+    stat.__set_blocks(clamp(blocks));
+    stat.__set_bfree(clamp(bfree));
+    stat.__set_bavail(clamp(bavail));
+    stat.__set_files(clamp(vfs.f_files));
+    stat.__set_free(clamp(vfs.f_ffree));
+    stat.__set_favail(clamp(vfs.f_favail));
+    stat.__set_fsid(static_cast<int32_t>(vfs.f_fsid));
+    // ST_* and FUSE_ST_* share their values
+    stat.__set_flags(static_cast<FuseFSFlags::type>((vfs.f_flag & mountFlags) | FuseFSFlags::FUSE_ST_VALID));
+    stat.__set_namemax(clamp(vfs.f_namemax));
+    _return.__set_statfs(stat);
+}
+
+void passthrough_fs::flush(FileSystemResponse& _return, const std::string& path, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    // Writes went straight to the file, nothing is buffered here
+    _return.status = StatusCode::FUSE_SUCCESS;
+}
+
+void passthrough_fs::release(FileSystemResponse& _return, const std::string& path, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    close_handle(handleInfo, _return);
+}
+
+void passthrough_fs::fsync(FileSystemResponse& _return, const std::string& path, const int64_t isdatasync, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    auto file = file_of(path, handleInfo, O_RDONLY, _return.status);
+    if (!file) {
+        return;
+    }
+    uring_op op;
+    op.kind = uring_kind::FSYNC;
+    op.fd = file->fd;
+    op.flags = isdatasync ? IORING_FSYNC_DATASYNC : 0;
+    _return.status = ring_status(ring.run(op));
+}
+
+void passthrough_fs::setxattr(FileSystemResponse& _return, const std::string& path, const std::string& name, const std::string& val, const int16_t valsize, const int32_t flags, const FuseContext& context)
+{
+    std::shared_ptr<pt_file> node;
+    std::string full;
+    _return.status = open_proc_path(path, node, full);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    size_t length = valsize >= 0 ? std::min<size_t>(static_cast<size_t>(valsize), val.size()) : val.size();
+    _return.status = call_status(::setxattr(full.c_str(), name.c_str(), val.data(), length, flags));
+}
+
+void passthrough_fs::getxattr(FileSystemResponse& _return, const std::string& path, const std::string& name, const FuseContext& context)
+{
+    std::shared_ptr<pt_file> node;
+    std::string full;
+    _return.status = open_proc_path(path, node, full);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    std::string value;
+    ssize_t length;
+    do {
+        // Asks for the size first, ERANGE when the value grew in between
+        length = ::getxattr(full.c_str(), name.c_str(), nullptr, 0);
+        if (length > 0) {
+            value.resize(static_cast<size_t>(length));
+            length = ::getxattr(full.c_str(), name.c_str(), &value[0], value.size());
+        }
+    } while (length < 0 && errno == ERANGE);
+    _return.status = call_status(length);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        value.resize(static_cast<size_t>(length));
+        _return.__set_atrributeValue(value);
+    }
+}
+
+void passthrough_fs::listxattr(FileSystemResponse& _return, const std::string& path, const FuseContext& context)
+{
+    std::shared_ptr<pt_file> node;
+    std::string full;
+    _return.status = open_proc_path(path, node, full);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    std::string buffer;
+    ssize_t length;
+    do {
+        length = ::listxattr(full.c_str(), nullptr, 0);
+        if (length > 0) {
+            buffer.resize(static_cast<size_t>(length));
+            length = ::listxattr(full.c_str(), &buffer[0], buffer.size());
+        }
+    } while (length < 0 && errno == ERANGE);
+    _return.status = call_status(length);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    // Names come back NUL separated
+    StringArray names;
+    size_t pos = 0;
+    while (pos < static_cast<size_t>(length)) {
+        size_t end = buffer.find('\0', pos);
+        if (end == std::string::npos || end > static_cast<size_t>(length)) {
+            end = static_cast<size_t>(length);
+        }
+        if (end > pos) {
+            names.emplace_back(buffer, pos, end - pos);
+        }
+        pos = end + 1;
+    }
+    _return.__set_attributes(names);
+}
+
+void passthrough_fs::removexattr(FileSystemResponse& _return, const std::string& path, const std::string& attributeKey, const FuseContext& context)
+{
+    std::shared_ptr<pt_file> node;
+    std::string full;
+    _return.status = open_proc_path(path, node, full);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = call_status(::removexattr(full.c_str(), attributeKey.c_str()));
+    }
+}
+
+void passthrough_fs::opendir(FileSystemResponse& _return, const std::string& path, const FuseContext& context)
+{
+    std::string rel;
+    _return.status = relative(path, rel);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    int fd = open_beneath(rel, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+    if (fd < 0) {
+        _return.status = status_of(errno);
+        return;
+    }
+    FuseHandleInfo info;
+    info.__set_fh(open_handle(std::make_shared<pt_file>(fd)));
+    _return.__set_info(info);
+}
+
+void passthrough_fs::readdir(FileSystemResponse& _return, const std::string& path, const int64_t offset, const FuseHandleInfo& handleInfo, const FuseContext& context, const int32_t maxEntries)
+{
+    // Hand out one page, cookies are positions in the listing plus one
+    auto page = [&](const std::vector<FuseDirEntry>& listing) {
+        if (offset < 0 || offset > static_cast<int64_t>(listing.size())) {
+            _return.status = StatusCode::FUSE_ERROREINVAL;
+            return;
+        }
+        size_t count = listing.size() - static_cast<size_t>(offset);
+        if (maxEntries > 0 && count > static_cast<size_t>(maxEntries)) {
+            count = static_cast<size_t>(maxEntries);
+        }
+        _return.__set_dirEntry(DirEntryList(listing.begin() + offset, listing.begin() + offset + count));
+        if (offset + count < listing.size()) {
+            _return.__set_nextOffset(offset + static_cast<int64_t>(count));
+        }
+    };
+
+    auto dir = find_handle(handleInfo);
+    if (dir) {
+        boost::lock_guard<boost::mutex> guard(dir->listLock);
+        if (offset == 0 || !dir->listed) {
+            dir->listing.clear();
+            _return.status = list(*dir, dir->listing);
+            if (_return.status != StatusCode::FUSE_SUCCESS) {
+                return;
+            }
+            dir->listed = true;
+        }
+        page(dir->listing);
+        return;
+    }
+
+    dir = file_of(path, handleInfo, O_RDONLY | O_DIRECTORY, _return.status);
+    if (!dir) {
+        return;
+    }
+    std::vector<FuseDirEntry> listing;
+    _return.status = list(*dir, listing);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        page(listing);
+    }
+}
+
+void passthrough_fs::releasedir(FileSystemResponse& _return, const std::string& path, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    close_handle(handleInfo, _return);
+}
+
+void passthrough_fs::fsyncdir(FileSystemResponse& _return, const std::string& path, const int64_t isdatasync, const FuseHandleInfo& handleInfo, const FuseContext& context)
+{
+    auto dir = file_of(path, handleInfo, O_RDONLY | O_DIRECTORY, _return.status);
+    if (!dir) {
+        return;
+    }
+    uring_op op;
+    op.kind = uring_kind::FSYNC;
+    op.fd = dir->fd;
+    op.flags = isdatasync ? IORING_FSYNC_DATASYNC : 0;
+    _return.status = ring_status(ring.run(op));
+}
+
+void passthrough_fs::init(FileSystemResponse& _return, const FuseConnectionInfo& connn, const FuseConfig& config)
+{
+    _return.status = StatusCode::FUSE_SUCCESS;
+}
+
+void passthrough_fs::destroy(const int16_t fsPrivateId)
+{
+}
+
+void passthrough_fs::access(FileSystemResponse& _return, const std::string& path, const FuseAccessMode::type accessMask, const FuseContext& context)
+{
+    // Checked against the host process, whose rights bound everything served
+    pt_node node;
+    _return.status = resolve(path, node);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = call_status(faccessat(node.dirFd, node.name.c_str(), accessMask, AT_SYMLINK_NOFOLLOW));
+    }
+}
+
+void passthrough_fs::create(FileSystemResponse& _return, const std::string& path, const int32_t mode, const FuseContext& context, const int32_t inlineLimit)
+{
+    std::string rel;
+    _return.status = relative(path, rel);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    int fd = open_beneath(rel, O_CREAT | O_EXCL | O_RDWR | O_NOFOLLOW, static_cast<mode_t>(mode & 07777));
+    if (fd < 0) {
+        _return.status = status_of(errno);
+        return;
+    }
+    give_to(fd, "", context);
+    auto file = std::make_shared<pt_file>(fd);
+    FuseHandleInfo info;
+    info.__set_fh(open_handle(file));
+    _return.__set_info(info);
+    if (inlineLimit > 0) {
+        inline_data(*file, inlineLimit, -1, _return);
+    } else {
+        stat_file(*file, _return);
+    }
+}
+
+void passthrough_fs::lock(FileSystemResponse& _return, const std::string& path, const FuseHandleInfo& handleInfo, const int32_t cmd, const FuseFlock& flock, const FuseContext& context)
+{
+    // Locks are kept by the kernel of the mounting host
+    _return.status = StatusCode::FUSE_SUCCESS;
+}
+
+void passthrough_fs::utimens(FileSystemResponse& _return, const std::string& path, const FuseTimeSpec& timeSpec, const FuseHandleInfo& info, const FuseContext& context)
+{
+    struct timespec times[2];
+    times[0].tv_sec = timeSpec.accessTime;
+    times[0].tv_nsec = timeSpec.__isset.accessTime ? 0 : UTIME_NOW;
+    times[1].tv_sec = timeSpec.modificationTime;
+    times[1].tv_nsec = timeSpec.__isset.modificationTime ? 0 : UTIME_NOW;
+    auto file = find_handle(info);
+    if (file) {
+        _return.status = call_status(futimens(file->fd, times));
+        return;
+    }
+    pt_node node;
+    _return.status = resolve(path, node);
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        _return.status = call_status(utimensat(node.dirFd, node.name.c_str(), times, AT_SYMLINK_NOFOLLOW));
+    }
+}
+
+void passthrough_fs::bmap(FileSystemResponse& _return, const std::string& path, const int64_t blocksize, const int64_t blockIndex, const FuseContext& context)
+{
+    // Block numbers of the backing disk are not exported
+    _return.status = StatusCode::FUSE_ERROREINVAL;
+}
+
+void passthrough_fs::mknod(FileSystemResponse& _return, const std::string& path, const int32_t mode, const int64_t deviceId, const FuseContext& context)
+{
+    pt_node node;
+    _return.status = resolve(path, node);
+    if (_return.status != StatusCode::FUSE_SUCCESS) {
+        return;
+    }
+    _return.status = call_status(mknodat(node.dirFd, node.name.c_str(), static_cast<mode_t>(mode), static_cast<dev_t>(deviceId)));
+    if (_return.status == StatusCode::FUSE_SUCCESS) {
+        give_to(node.dirFd, node.name, context);
+    }
+}
+
+void passthrough_fs::ping()
+{
+}
+
+void passthrough_fs::batch(ResponseList& _return, const BatchRequestList& requests)
+{
+    size_t count = requests.size();
+    _return.resize(count);
+
+    // Runs of getattr share one submission, the rest runs in order around them
+    std::vector<uring_op> ops;
+    std::vector<size_t> slots;
+    std::vector<struct statx> stats(count);
+    std::vector<pt_node> nodes(count);
+    std::vector<std::shared_ptr<pt_file>> files(count);
+    ops.reserve(count);
+    slots.reserve(count);
+    auto flush_stats = [&]() {
+        ring.run(ops.data(), ops.size());
+        for (size_t i = 0; i < ops.size(); i++) {
+            auto& response = _return[slots[i]];
+            response.status = ring_status(ops[i].result);
+            if (response.status == StatusCode::FUSE_SUCCESS) {
+                FuseStat stat;
+                fill_stat(stats[slots[i]], stat);
+                response.__set_stats(stat);
+            }
+        }
+        ops.clear();
+        slots.clear();
+    };
+
+    for (size_t i = 0; i < count; i++) {
+        auto& request = requests[i];
+        if (request.op == BatchOp::GETATTR) {
+            uring_op op;
+            _return[i].status = prepare_stat(request.path, request.handleInfo, op, stats[i], nodes[i], files[i]);
+            if (_return[i].status == StatusCode::FUSE_SUCCESS) {
+                ops.push_back(op);
+                slots.push_back(i);
+            }
+            continue;
+        }
+        flush_stats();
+        switch (request.op) {
+        case BatchOp::UNLINK:
+            unlink(_return[i], request.path, request.context);
+            break;
+        case BatchOp::RMDIR:
+            rmdir(_return[i], request.path, request.context);
+            break;
+        default:
+            _return[i].status = StatusCode::FUSE_ERROREINVAL;
+            break;
+        }
+    }
+    flush_stats();
+}
+#endif
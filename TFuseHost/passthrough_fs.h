@@ -0,0 +1,159 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#if defined(__linux__)
+#include <FuseService.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <uring_queue.h>
+
+/*
+ * Descriptor behind a handle. Requests that are still using it keep it open
+ * after release, it is closed with the last reference.
+ */
+struct pt_file {
+    int fd;
+    // Directories: listing taken at readdir offset 0, later pages index into it
+    boost::mutex listLock;
+    std::vector<Fuse::FuseDirEntry> listing;
+    bool listed = false;
+
+    explicit pt_file(int fd)
+        : fd(fd)
+    {
+    }
+    ~pt_file();
+};
+
+/*
+ * A path resolved to the directory holding it and its last component, for
+ * the *at calls. The directory was opened beneath the root, so those calls
+ * only ever look up the last component themselves.
+ */
+struct pt_node {
+    int dirFd = -1;
+    // False when dirFd is the root's own descriptor
+    bool owned = false;
+    std::string name;
+
+    pt_node() = default;
+    pt_node(const pt_node&) = delete;
+    pt_node& operator=(const pt_node&) = delete;
+    ~pt_node();
+};
+
+/*
+ * Serves an existing local directory. Paths are resolved by openat2 with
+ * RESOLVE_BENEATH below a descriptor of the root, so neither ".." nor a
+ * symlink anywhere in the path leads outside of it, and /proc style links
+ * are not followed. The last component is never followed. open, create and
+ * opendir hand out a handle per descriptor, later calls carrying that fh
+ * reuse it instead of resolving the path again.
+ * Reads, writes, statx and fsync go through io_uring, readdir and batch
+ * submit the statx of all their entries at once.
+ *
+ * Permissions are those of the host process, when it runs as root new nodes
+ * are given to the uid and gid of the calling context.
+ */
+class passthrough_fs : public Fuse::FuseServiceIf {
+public:
+    passthrough_fs(const std::string& root, unsigned uringEntries = URING_DEFAULT_ENTRIES);
+    ~passthrough_fs();
+
+    void getattr(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void readlink(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t maxSize, const Fuse::FuseContext& context) override;
+    void mkdir(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t mode, const Fuse::FuseContext& context) override;
+    void unlink(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context) override;
+    void rmdir(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context) override;
+    void symlink(Fuse::FileSystemResponse& _return, const std::string& destination, const std::string& source, const Fuse::FuseContext& context) override;
+    void rename(Fuse::FileSystemResponse& _return, const std::string& source, const std::string& destination, const int64_t flags, const Fuse::FuseContext& context) override;
+    void link(Fuse::FileSystemResponse& _return, const std::string& to, const std::string& destination, const Fuse::FuseContext& context) override;
+    void chmod(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t mode, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void chown(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t uid, const int32_t gid, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void truncate(Fuse::FileSystemResponse& _return, const std::string& path, const int64_t offset, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void open(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context, const int32_t inlineLimit, const int64_t knownVersion) override;
+    void read(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t size, const int64_t offset, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void write(Fuse::FileSystemResponse& _return, const std::string& path, const std::string& buffer, const int64_t offset, const int32_t size, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void statfs(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context) override;
+    void flush(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void release(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void fsync(Fuse::FileSystemResponse& _return, const std::string& path, const int64_t isdatasync, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void setxattr(Fuse::FileSystemResponse& _return, const std::string& path, const std::string& name, const std::string& val, const int16_t valsize, const int32_t flags, const Fuse::FuseContext& context) override;
+    void getxattr(Fuse::FileSystemResponse& _return, const std::string& path, const std::string& name, const Fuse::FuseContext& context) override;
+    void listxattr(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context) override;
+    void removexattr(Fuse::FileSystemResponse& _return, const std::string& path, const std::string& attributeKey, const Fuse::FuseContext& context) override;
+    void opendir(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseContext& context) override;
+    void readdir(Fuse::FileSystemResponse& _return, const std::string& path, const int64_t offset, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context, const int32_t maxEntries) override;
+    void releasedir(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void fsyncdir(Fuse::FileSystemResponse& _return, const std::string& path, const int64_t isdatasync, const Fuse::FuseHandleInfo& handleInfo, const Fuse::FuseContext& context) override;
+    void init(Fuse::FileSystemResponse& _return, const Fuse::FuseConnectionInfo& connn, const Fuse::FuseConfig& config) override;
+    void destroy(const int16_t fsPrivateId) override;
+    void access(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseAccessMode::type accessMask, const Fuse::FuseContext& context) override;
+    void create(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t mode, const Fuse::FuseContext& context, const int32_t inlineLimit) override;
+    void lock(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseHandleInfo& handleInfo, const int32_t cmd, const Fuse::FuseFlock& flock, const Fuse::FuseContext& context) override;
+    void utimens(Fuse::FileSystemResponse& _return, const std::string& path, const Fuse::FuseTimeSpec& timeSpec, const Fuse::FuseHandleInfo& info, const Fuse::FuseContext& context) override;
+    void bmap(Fuse::FileSystemResponse& _return, const std::string& path, const int64_t blocksize, const int64_t blockIndex, const Fuse::FuseContext& context) override;
+    void mknod(Fuse::FileSystemResponse& _return, const std::string& path, const int32_t mode, const int64_t deviceId, const Fuse::FuseContext& context) override;
+    void ping() override;
+    void batch(Fuse::ResponseList& _return, const Fuse::BatchRequestList& requests) override;
+
+private:
+    // Path below the root, "." for the root itself
+    Fuse::StatusCode::type relative(const std::string& path, std::string& rel) const;
+    // Descriptor of path opened with flags, -1 and errno on failure
+    int open_beneath(const std::string& rel, int flags, mode_t mode = 0) const;
+    Fuse::StatusCode::type resolve(const std::string& path, pt_node& node) const;
+    // Descriptor of an open handle when there is one, path opened with flags otherwise
+    std::shared_ptr<pt_file> file_of(const std::string& path, const Fuse::FuseHandleInfo& handle, int flags, Fuse::StatusCode::type& status);
+    std::shared_ptr<pt_file> find_handle(const Fuse::FuseHandleInfo& handle);
+    int64_t open_handle(const std::shared_ptr<pt_file>& file);
+    void close_handle(const Fuse::FuseHandleInfo& handle, Fuse::FileSystemResponse& _return);
+    // O_PATH descriptor of path for the calls that cannot take one directly
+    Fuse::StatusCode::type open_proc_path(const std::string& path, std::shared_ptr<pt_file>& node, std::string& procPath) const;
+    // Owner of a new node when serving as root, name empty for dirFd itself
+    void give_to(int dirFd, const std::string& name, const Fuse::FuseContext& context);
+
+    // Fills op with the statx of a handle or path, file and node keep what it points to
+    Fuse::StatusCode::type prepare_stat(const std::string& path, const Fuse::FuseHandleInfo& handle, uring_op& op, struct statx& stx, pt_node& node, std::shared_ptr<pt_file>& file);
+    void stat_file(const pt_file& file, Fuse::FileSystemResponse& _return);
+    // Skips the data when its version is knownVersion, -1 never matches
+    void inline_data(const pt_file& file, int32_t inlineLimit, int64_t knownVersion, Fuse::FileSystemResponse& _return);
+    Fuse::StatusCode::type list(const pt_file& dir, std::vector<Fuse::FuseDirEntry>& listing);
+
+    int rootFd;
+    bool asRoot;
+    uring_queue ring;
+
+    boost::shared_mutex handleLock;
+    std::unordered_map<int64_t, std::shared_ptr<pt_file>> handles;
+    std::atomic<int64_t> nextHandle { 0 };
+};
+#endif
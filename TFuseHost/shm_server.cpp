@@ -0,0 +1,228 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#include <cstring>
+#include <stdexcept>
+
+#include <thrift/transport/TTransportException.h>
+
+#include <Logger.h>
+#include <shm_server.h>
+#include <shm_transport.h>
+
+using namespace apache::thrift;
+using namespace apache::thrift::protocol;
+using namespace apache::thrift::server;
+using namespace apache::thrift::transport;
+namespace bip = boost::interprocess;
+
+shm_channel_transport::shm_channel_transport(shm_channel* channel, uint32_t capacity, const std::atomic<bool>& stopping)
+    : channel(channel)
+    , capacity(capacity)
+    , requestData(shm::request_data(channel))
+    , responseData(shm::response_data(channel, capacity))
+    , stopping(stopping)
+{
+}
+
+bool shm_channel_transport::fenced() const
+{
+    return stopping.load(std::memory_order_relaxed) || channel->generation.load(std::memory_order_acquire) != served;
+}
+
+void shm_channel_transport::resync()
+{
+    served = channel->generation.load(std::memory_order_acquire);
+    // Whatever the previous owner published of a response stays for the new
+    // one to skip, it learns where that ends from the acknowledgement
+    shm::consume(&channel->request, channel->request.head.load(std::memory_order_acquire));
+    pendingHead = channel->response.head.load(std::memory_order_relaxed);
+    channel->served_generation.store(served, std::memory_order_release);
+    channel->response.data_seq.fetch_add(1, std::memory_order_release);
+    shm::wake_word(&channel->response.data_seq);
+}
+
+void shm_channel_transport::drain()
+{
+    uint8_t scratch[4096];
+    try {
+        for (;;) {
+            read(scratch, sizeof(scratch));
+        }
+    } catch (const TTransportException&) {
+    }
+}
+
+uint32_t shm_channel_transport::read(uint8_t* buf, uint32_t len)
+{
+    shm_ring_ctl* ring = &channel->request;
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    auto ready = [this, ring, tail]() {
+        return ring->head.load(std::memory_order_acquire) != tail || fenced();
+    };
+    // Channels wait for their client as long as it takes
+    shm::wait_until(ready, &ring->data_seq, &ring->data_waiters, SHM_DEFAULT_SPIN_US, 0);
+    if (fenced()) {
+        throw TTransportException(TTransportException::INTERRUPTED, "Shared memory channel claimed again");
+    }
+
+    uint32_t available = ring->head.load(std::memory_order_acquire) - tail;
+    uint32_t count = available < len ? available : len;
+    shm::copy_out(requestData, capacity, tail, buf, count);
+    shm::consume(ring, tail + count);
+    return count;
+}
+
+void shm_channel_transport::write(const uint8_t* buf, uint32_t len)
+{
+    shm_ring_ctl* ring = &channel->response;
+    while (len > 0) {
+        uint32_t used = pendingHead - ring->tail.load(std::memory_order_acquire);
+        if (used == capacity) {
+            flush();
+            uint32_t head = pendingHead;
+            uint32_t cap = capacity;
+            auto ready = [this, ring, head, cap]() {
+                return head - ring->tail.load(std::memory_order_acquire) < cap || fenced();
+            };
+            shm::wait_until(ready, &ring->space_seq, &ring->space_waiters, SHM_DEFAULT_SPIN_US, 0);
+            continue;
+        }
+
+        uint32_t space = capacity - used;
+        uint32_t count = space < len ? space : len;
+        shm::copy_in(responseData, capacity, pendingHead, buf, count);
+        pendingHead += count;
+        buf += count;
+        len -= count;
+    }
+}
+
+void shm_channel_transport::flush()
+{
+    // Nothing more reaches a client that gave the channel up
+    if (fenced()) {
+        throw TTransportException(TTransportException::INTERRUPTED, "Shared memory channel claimed again");
+    }
+    shm::publish(&channel->response, pendingHead);
+}
+
+shm_server::shm_server(const std::shared_ptr<TProcessor>& processor,
+    const std::shared_ptr<TTransportFactory>& transportFactory,
+    const std::shared_ptr<TProtocolFactory>& protocolFactory,
+    const std::string& name,
+    uint32_t channelCount,
+    uint32_t ringCapacity)
+    : TServer(processor)
+    , transportFactory(transportFactory)
+    , protocolFactory(protocolFactory)
+    , segmentName(name)
+{
+    if (channelCount == 0 || ringCapacity == 0 || (ringCapacity & (ringCapacity - 1)) != 0) {
+        throw std::invalid_argument("Shared memory needs channels and a power of two ring size");
+    }
+
+    // Clients still mapping a segment of an earlier run time out and reconnect
+    bip::shared_memory_object::remove(segmentName.c_str());
+    try {
+        shmObject.reset(new bip::shared_memory_object(bip::create_only, segmentName.c_str(), bip::read_write));
+        shmObject->truncate(static_cast<bip::offset_t>(shm::segment_size(channelCount, ringCapacity)));
+        region.reset(new bip::mapped_region(*shmObject, bip::read_write));
+    } catch (const bip::interprocess_exception& ex) {
+        throw std::runtime_error("Unable to create shared memory segment " + segmentName + " " + ex.what());
+    }
+
+    memset(region->get_address(), 0, region->get_size());
+    segment = static_cast<shm_segment*>(region->get_address());
+    segment->magic = SHM_SEGMENT_MAGIC;
+    segment->version = SHM_SEGMENT_VERSION;
+    segment->channel_count = channelCount;
+    segment->ring_capacity = ringCapacity;
+    LOG_INFO << "Shared memory segment " << segmentName << " with " << channelCount << " channels of " << ringCapacity << " bytes";
+}
+
+shm_server::~shm_server()
+{
+    stop();
+    for (auto& thread : threads) {
+        thread->join();
+    }
+    region.reset();
+    shmObject.reset();
+    bip::shared_memory_object::remove(segmentName.c_str());
+}
+
+void shm_server::serve()
+{
+    for (uint32_t i = 0; i < segment->channel_count; i++) {
+        threads.emplace_back(new boost::thread([this, i]() { run_channel(i); }));
+    }
+    segment->server_ready.store(1, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread->join();
+    }
+    threads.clear();
+}
+
+void shm_server::stop()
+{
+    if (stopping.exchange(true)) {
+        return;
+    }
+    segment->server_ready.store(0, std::memory_order_release);
+    for (uint32_t i = 0; i < segment->channel_count; i++) {
+        auto channel = shm::get_channel(segment, i);
+        channel->request.data_seq.fetch_add(1, std::memory_order_release);
+        shm::wake_word(&channel->request.data_seq);
+        channel->response.space_seq.fetch_add(1, std::memory_order_release);
+        shm::wake_word(&channel->response.space_seq);
+    }
+}
+
+void shm_server::run_channel(uint32_t index)
+{
+    auto channel = std::make_shared<shm_channel_transport>(shm::get_channel(segment, index), segment->ring_capacity, stopping);
+    std::shared_ptr<TTransport> transport;
+    std::shared_ptr<TProtocol> input;
+    std::shared_ptr<TProtocol> output;
+    std::shared_ptr<TProcessor> processor;
+    while (!stopping.load()) {
+        if (!transport || channel->fenced()) {
+            if (stopping.load()) {
+                break;
+            }
+            channel->resync();
+            // A new wrapper, the old one may buffer part of a stale message
+            transport = transportFactory->getTransport(channel);
+            input = protocolFactory->getProtocol(transport);
+            output = protocolFactory->getProtocol(transport);
+            processor = getProcessor(input, output, transport);
+        }
+        try {
+            processor->process(input, output, nullptr);
+        } catch (const TException& ex) {
+            // A fenced channel picks up the new generation on the next turn
+            if (!channel->fenced()) {
+                LOG_ERROR << "Shared memory channel " << index << " dropped until its client reconnects " << ex.what();
+                channel->drain();
+            }
+        }
+    }
+}
@@ -0,0 +1,113 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <thrift/protocol/TProtocol.h>
+#include <thrift/server/TServer.h>
+#include <thrift/transport/TVirtualTransport.h>
+
+#include <shm_ring.h>
+
+// [HOST] SHM_CHANNELS and SHM_RING_KB when not set, clients pick the channel
+// matching their id so it should not be below MAX_CONNECTIONS
+#define SHM_DEFAULT_CHANNELS 64
+#define SHM_DEFAULT_RING_KB 256
+
+/*
+ * Backend end of one channel. Reads and writes wait for data or space until
+ * the channel is fenced, that is a client claimed it again or the server is
+ * stopping, and then throw. resync drops the request bytes of the previous
+ * generation, stops adding to its response and acknowledges the new one.
+ */
+class shm_channel_transport : public apache::thrift::transport::TVirtualTransport<shm_channel_transport> {
+public:
+    shm_channel_transport(shm_channel* channel, uint32_t capacity, const std::atomic<bool>& stopping);
+
+    bool isOpen() const override
+    {
+        return true;
+    }
+
+    uint32_t read(uint8_t* buf, uint32_t len);
+    void write(const uint8_t* buf, uint32_t len);
+    void flush() override;
+
+    bool fenced() const;
+    void resync();
+    // Skips requests until the channel is fenced, for a stream that no longer parses
+    void drain();
+
+private:
+    shm_channel* channel;
+    uint32_t capacity;
+    uint8_t* requestData;
+    uint8_t* responseData;
+    const std::atomic<bool>& stopping;
+
+    // Generation being served
+    uint32_t served = 0;
+    // Producer position not yet published to the client
+    uint32_t pendingHead = 0;
+};
+
+/*
+ * Server of the SHARED_MEMORY transport. Creates the segment named by TARGET,
+ * replacing one left by an earlier run, and serves every channel from its own
+ * thread through the configured wrapper and protocol. HTTP needs a socket and
+ * is not available.
+ */
+class shm_server : public apache::thrift::server::TServer {
+public:
+    shm_server(const std::shared_ptr<apache::thrift::TProcessor>& processor,
+        const std::shared_ptr<apache::thrift::transport::TTransportFactory>& transportFactory,
+        const std::shared_ptr<apache::thrift::protocol::TProtocolFactory>& protocolFactory,
+        const std::string& segmentName,
+        uint32_t channelCount = SHM_DEFAULT_CHANNELS,
+        uint32_t ringCapacity = SHM_DEFAULT_RING_KB * 1024);
+    ~shm_server() override;
+
+    void serve() override;
+    void stop() override;
+
+private:
+    void run_channel(uint32_t index);
+
+    std::shared_ptr<apache::thrift::transport::TTransportFactory> transportFactory;
+    std::shared_ptr<apache::thrift::protocol::TProtocolFactory> protocolFactory;
+    std::string segmentName;
+
+    std::unique_ptr<boost::interprocess::shared_memory_object> shmObject;
+    std::unique_ptr<boost::interprocess::mapped_region> region;
+    shm_segment* segment = nullptr;
+
+    std::atomic<bool> stopping { false };
+    std::vector<std::unique_ptr<boost::thread>> threads;
+};
@@ -0,0 +1,333 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#if defined(__linux__)
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <Logger.h>
+#include <uring_queue.h>
+
+// user_data of the eventfd poll, operations carry their own address
+#define URING_WAKE_TAG 0
+
+static inline unsigned load_acquire(const unsigned* word)
+{
+    return __atomic_load_n(word, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(unsigned* word, unsigned value)
+{
+    __atomic_store_n(word, value, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+static inline T* at_offset(void* base, uint32_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+uring_queue::uring_queue(unsigned entries)
+{
+    if (entries == 0) {
+        LOG_INFO << "io_uring disabled, running system calls directly";
+        return;
+    }
+    if (!setup(entries)) {
+        LOG_WARNING << "io_uring not usable (" << strerror(errno) << "), running system calls directly";
+        teardown();
+        return;
+    }
+    LOG_INFO << "io_uring with " << sqEntries << " submission and " << cqEntries << " completion entries";
+    ringThread.reset(new boost::thread([this]() { loop(); }));
+}
+
+uring_queue::~uring_queue()
+{
+    if (ringThread) {
+        {
+            boost::lock_guard<boost::mutex> guard(queueLock);
+            stopping = true;
+        }
+        uint64_t one = 1;
+        (void)::write(wakeFd, &one, sizeof(one));
+        ringThread->join();
+    }
+    teardown();
+}
+
+bool uring_queue::setup(unsigned entries)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ringFd < 0) {
+        return false;
+    }
+    sqEntries = params.sq_entries;
+    cqEntries = params.cq_entries;
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+        sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+    }
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        return false;
+    }
+    if (single) {
+        cqRing = sqRing;
+    } else {
+        cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+            return false;
+        }
+    }
+    sqeMapSize = params.sq_entries * sizeof(io_uring_sqe);
+    sqeMap = mmap(nullptr, sqeMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqeMap == MAP_FAILED) {
+        sqeMap = nullptr;
+        return false;
+    }
+
+    sqHead = at_offset<unsigned>(sqRing, params.sq_off.head);
+    sqTail = at_offset<unsigned>(sqRing, params.sq_off.tail);
+    sqMask = at_offset<unsigned>(sqRing, params.sq_off.ring_mask);
+    sqArray = at_offset<unsigned>(sqRing, params.sq_off.array);
+    cqHead = at_offset<unsigned>(cqRing, params.cq_off.head);
+    cqTail = at_offset<unsigned>(cqRing, params.cq_off.tail);
+    cqMask = at_offset<unsigned>(cqRing, params.cq_off.ring_mask);
+    cqes = at_offset<void>(cqRing, params.cq_off.cqes);
+    sqes = sqeMap;
+
+    // READ, WRITE and STATX arrived in 5.6 together with the probe itself
+    const size_t probeOps = 256;
+    std::unique_ptr<char[]> probeBuffer(new char[sizeof(io_uring_probe) + probeOps * sizeof(io_uring_probe_op)]());
+    auto probe = reinterpret_cast<io_uring_probe*>(probeBuffer.get());
+    if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, probeOps) < 0) {
+        return false;
+    }
+    for (int op : { IORING_OP_READ, IORING_OP_WRITE, IORING_OP_STATX, IORING_OP_FSYNC, IORING_OP_POLL_ADD }) {
+        if (op >= probe->ops_len || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0) {
+            errno = ENOTSUP;
+            return false;
+        }
+    }
+
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    return wakeFd >= 0;
+}
+
+void uring_queue::teardown()
+{
+    if (sqeMap != nullptr) {
+        munmap(sqeMap, sqeMapSize);
+    }
+    if (cqRing != nullptr && cqRing != sqRing) {
+        munmap(cqRing, cqRingSize);
+    }
+    if (sqRing != nullptr) {
+        munmap(sqRing, sqRingSize);
+    }
+    sqeMap = cqRing = sqRing = nullptr;
+    if (wakeFd >= 0) {
+        close(wakeFd);
+        wakeFd = -1;
+    }
+    if (ringFd >= 0) {
+        close(ringFd);
+        ringFd = -1;
+    }
+}
+
+void uring_queue::run(uring_op* ops, size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    if (!active()) {
+        for (size_t i = 0; i < count; i++) {
+            execute(&ops[i]);
+        }
+        return;
+    }
+
+    uring_batch batch;
+    batch.pending = count;
+    {
+        boost::lock_guard<boost::mutex> guard(queueLock);
+        for (size_t i = 0; i < count; i++) {
+            ops[i].batch = &batch;
+            waiting.push_back(&ops[i]);
+        }
+    }
+    uint64_t one = 1;
+    (void)::write(wakeFd, &one, sizeof(one));
+
+    boost::unique_lock<boost::mutex> guard(batch.lock);
+    while (batch.pending != 0) {
+        batch.done.wait(guard);
+    }
+}
+
+void uring_queue::prepare(uring_op* op)
+{
+    unsigned tail = *sqTail;
+    unsigned index = tail & *sqMask;
+    auto sqe = static_cast<io_uring_sqe*>(sqes) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    if (op == nullptr) {
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = wakeFd;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = URING_WAKE_TAG;
+    } else {
+        sqe->fd = op->fd;
+        switch (op->kind) {
+        case uring_kind::READ:
+        case uring_kind::WRITE:
+            sqe->opcode = op->kind == uring_kind::READ ? IORING_OP_READ : IORING_OP_WRITE;
+            sqe->addr = reinterpret_cast<uint64_t>(op->buf);
+            sqe->len = static_cast<uint32_t>(op->len);
+            sqe->off = op->offset;
+            break;
+        case uring_kind::STATX:
+            sqe->opcode = IORING_OP_STATX;
+            sqe->addr = reinterpret_cast<uint64_t>(op->path);
+            sqe->len = STATX_BASIC_STATS;
+            sqe->off = reinterpret_cast<uint64_t>(op->stx);
+            sqe->statx_flags = op->flags;
+            break;
+        case uring_kind::FSYNC:
+            sqe->opcode = IORING_OP_FSYNC;
+            sqe->fsync_flags = op->flags;
+            break;
+        }
+        sqe->user_data = reinterpret_cast<uint64_t>(op);
+    }
+    sqArray[index] = index;
+    store_release(sqTail, tail + 1);
+}
+
+unsigned uring_queue::reap(bool& woken)
+{
+    unsigned completed = 0;
+    unsigned head = *cqHead;
+    unsigned tail = load_acquire(cqTail);
+    for (; head != tail; head++) {
+        auto cqe = static_cast<io_uring_cqe*>(cqes) + (head & *cqMask);
+        if (cqe->user_data == URING_WAKE_TAG) {
+            uint64_t count;
+            (void)::read(wakeFd, &count, sizeof(count));
+            woken = true;
+        } else {
+            complete(reinterpret_cast<uring_op*>(cqe->user_data), cqe->res);
+            completed++;
+        }
+    }
+    store_release(cqHead, head);
+    return completed;
+}
+
+void uring_queue::loop()
+{
+    // Operations the kernel holds, the wake poll is not counted
+    unsigned inflight = 0;
+    // Entries written to the SQ but not yet taken by io_uring_enter
+    unsigned unsubmitted = 0;
+    bool pollArmed = false;
+    for (;;) {
+        {
+            boost::lock_guard<boost::mutex> guard(queueLock);
+            if (stopping && waiting.empty() && inflight == 0) {
+                break;
+            }
+            // One SQ and CQ slot stays free for the wake poll
+            while (!waiting.empty() && unsubmitted + 1 < sqEntries && inflight + 1 < cqEntries) {
+                prepare(waiting.front());
+                waiting.pop_front();
+                unsubmitted++;
+                inflight++;
+            }
+        }
+        if (!pollArmed) {
+            prepare(nullptr);
+            unsubmitted++;
+            pollArmed = true;
+        }
+
+        int submitted = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+        if (submitted > 0) {
+            unsubmitted -= static_cast<unsigned>(submitted);
+        } else if (submitted < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            LOG_ERROR << "io_uring_enter failed " << strerror(errno);
+        }
+
+        bool woken = false;
+        inflight -= reap(woken);
+        if (woken) {
+            pollArmed = false;
+        }
+    }
+}
+
+void uring_queue::execute(uring_op* op)
+{
+    ssize_t result = 0;
+    switch (op->kind) {
+    case uring_kind::READ:
+        result = pread(op->fd, op->buf, op->len, static_cast<off_t>(op->offset));
+        break;
+    case uring_kind::WRITE:
+        result = pwrite(op->fd, op->buf, op->len, static_cast<off_t>(op->offset));
+        break;
+    case uring_kind::STATX:
+        result = statx(op->fd, op->path, static_cast<int>(op->flags), STATX_BASIC_STATS, op->stx);
+        break;
+    case uring_kind::FSYNC:
+        result = (op->flags & IORING_FSYNC_DATASYNC) ? fdatasync(op->fd) : fsync(op->fd);
+        break;
+    }
+    op->result = result < 0 ? -errno : static_cast<int>(result);
+}
+
+void uring_queue::complete(uring_op* op, int result)
+{
+    op->result = result;
+    auto batch = op->batch;
+    boost::lock_guard<boost::mutex> guard(batch->lock);
+    if (--batch->pending == 0) {
+        batch->done.notify_all();
+    }
+}
+#endif
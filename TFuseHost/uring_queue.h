@@ -0,0 +1,141 @@
+/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+#pragma once
+
+#if defined(__linux__)
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+// Submission queue size when [HOST] URING_ENTRIES is not set
+#define URING_DEFAULT_ENTRIES 256
+
+enum class uring_kind {
+    READ,
+    WRITE,
+    STATX,
+    FSYNC
+};
+
+struct uring_batch;
+
+/*
+ * One system call run through the ring. READ and WRITE use fd, buf, len and
+ * offset, STATX looks up path relative to fd with flags (AT_*) into stx,
+ * FSYNC syncs fd and takes IORING_FSYNC_DATASYNC in flags. result is what the
+ * call returned, -errno on failure.
+ */
+struct uring_op {
+    uring_kind kind;
+    int fd = -1;
+    const char* path = "";
+    unsigned flags = 0;
+    void* buf = nullptr;
+    size_t len = 0;
+    uint64_t offset = 0;
+    struct statx* stx = nullptr;
+    int result = 0;
+
+    uring_batch* batch = nullptr;
+};
+
+struct uring_batch {
+    boost::mutex lock;
+    boost::condition_variable done;
+    size_t pending;
+};
+
+/*
+ * io_uring driven by one thread. Callers hand over a batch of operations and
+ * sleep until all of them completed, every batch waiting at that moment goes
+ * to the kernel with a single io_uring_enter. An eventfd poll kept in the ring
+ * wakes the thread for new work while earlier operations are still in flight.
+ *
+ * The ring is set up with raw system calls so there is no liburing to build
+ * against. When the kernel lacks io_uring or one of the operations (before
+ * 5.6, or blocked by seccomp) or entries is 0, run executes the calls
+ * directly on the calling thread.
+ */
+class uring_queue {
+public:
+    explicit uring_queue(unsigned entries = URING_DEFAULT_ENTRIES);
+    ~uring_queue();
+
+    void run(uring_op* ops, size_t count);
+
+    inline int run(uring_op& op)
+    {
+        run(&op, 1);
+        return op.result;
+    }
+
+    inline bool active() const
+    {
+        return ringFd >= 0;
+    }
+
+private:
+    bool setup(unsigned entries);
+    void teardown();
+    void loop();
+    void prepare(uring_op* op);
+    // Completes finished operations and returns their number, woken tells
+    // whether the wake poll fired
+    unsigned reap(bool& woken);
+    static void execute(uring_op* op);
+    static void complete(uring_op* op, int result);
+
+    int ringFd = -1;
+    int wakeFd = -1;
+
+    // Mapped rings, see io_uring_setup(2)
+    void* sqRing = nullptr;
+    size_t sqRingSize = 0;
+    void* cqRing = nullptr;
+    size_t cqRingSize = 0;
+    void* sqeMap = nullptr;
+    size_t sqeMapSize = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    void* cqes = nullptr;
+    void* sqes = nullptr;
+    unsigned sqEntries = 0;
+    unsigned cqEntries = 0;
+
+    boost::mutex queueLock;
+    std::deque<uring_op*> waiting;
+    bool stopping = false;
+    std::unique_ptr<boost::thread> ringThread;
+};
+#endif
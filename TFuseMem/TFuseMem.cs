@@ -1,951 +1,1090 @@
-﻿/*
- ***************************************************************************** 
- * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
- *
- * Copyright (c) 2022 Yogender Solanki
- *
- * This program is free software: you can redistribute it and/or modify it
- * under the terms of the GNU Lesser General Public License as published by the
- * Free Software Foundation, either version 3 of the License, or (at your
- * option) any later version.
- *
- * This program is distributed in the hope that it will be useful, but WITHOUT
- * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
- * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
- * for more details.
- *
- * You should have received a copy of the GNU Lesser General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- *****************************************************************************
- */
-namespace TFuse
-{
-    using Serilog;
-    using System;
-    using System.Collections.Concurrent;
-    using System.Collections.Generic;
-    using System.IO;
-    using System.Threading;
-    using System.Threading.Tasks;
-
-    internal class FuseFileOpenContext
-    {
-        public FuseHandleInfo Handle { get; set; }
-
-        public MemNode Node { get; set; }
-    }
-
-    internal class MemNode
-    {
-        public string Link { get; private set; }
-
-        public string Name { get; set; }
-
-        public int refCount;
-
-        internal MemoryStream dataStream;
-
-        internal ConcurrentDictionary<string, MemNode> Child { get; set; } = new ConcurrentDictionary<string, MemNode>();
-
-        public FuseStat FileStat { get; private set; }
-
-        public bool IsDirectory
-        {
-            get { return (FileStat.Mode & FuseConstants.FUSE_MODE_MASK_IFMT) == FuseConstants.FUSE_MODE_MASK_IFDIR; }
-        }
-
-        public bool IsLink
-        {
-            get { return (FileStat.Mode & FuseConstants.FUSE_MODE_MASK_IFMT) == FuseConstants.FUSE_MODE_MASK_IFLNK; }
-        }
-
-        public int DataSize => (int)(dataStream != null ? dataStream.Length : 0);
-
-        public MemNode(string name, FuseStat stat)
-        {
-            FileStat = stat;
-            Name = name;
-            dataStream = new MemoryStream();
-        }
-
-        public MemNode(string name, FuseStat stat, string link)
-        {
-            FileStat = stat;
-            Name = name;
-            dataStream = new MemoryStream();
-            Link = link;
-        }
-
-        public MemNode(string name, FuseStat stat, int size)
-        {
-            FileStat = stat;
-            Name = name;
-            dataStream = new MemoryStream(size);
-        }
-
-        public void Resize(long size)
-        {
-            dataStream.SetLength(size);
-            FileStat.Size = size;
-        }
-
-        public int Read(byte[] data, int offset, int size)
-        {
-            if (data != null)
-            {
-                lock (data)
-                {
-                    Log.Logger.Debug($"Reading at {offset} for {size} byte Buffer {data.Length}");
-                    dataStream.Seek(offset, SeekOrigin.Begin);
-                    dataStream.Read(data, 0, data.Length);
-                    return size;
-                }
-            }
-            return 0;
-        }
-
-        public int Write(byte[] data, int offset)
-        {
-            if (data != null)
-            {
-                lock (data)
-                {
-
-
-                    dataStream.Seek(offset, SeekOrigin.Begin);
-                    dataStream.Write(data, 0, data.Length);
-                    FileStat.Size = dataStream.Length;
-                    return data.Length;
-                }
-            }
-            return 0;
-        }
-
-        public MemNode GetChild(string name)
-        {
-            MemNode found;
-            if (Child.TryGetValue(name, out found))
-            {
-                return found;
-            }
-            else
-            {
-                return null;
-            }
-        }
-
-        public bool AddChild(string name, MemNode node)
-        {
-            return Child.TryAdd(name, node);
-        }
-
-        public bool RemoveChild(string name, out MemNode node)
-        {
-            if (!Child.TryGetValue(name, out node))
-            {
-                node = null;
-                return false;
-            }
-            else
-            {
-                if (!node.Child.IsEmpty)
-                {
-                    return false;
-                }
-                else
-                {
-                    return Child.Remove(name, out node);
-                }
-
-            }
-        }
-
-        public void FillChildItems(List<FuseDirEntry> dirResult)
-        {
-            foreach (var item in Child.Values)
-            {
-                dirResult.Add(new FuseDirEntry()
-                {
-                    Name = item.Name,
-                    Stats = item.FileStat
-                });
-            }
-        }
-
-        internal static int GetUnixTime(DateTime time)
-        {
-            return (int)((DateTimeOffset)time).ToUnixTimeSeconds();
-        }
-
-        public static FuseStat CreateNewDirectoryStat(long inode)
-        {
-            return new FuseStat()
-            {
-                AccessTime = GetUnixTime(DateTime.Now),
-                ModificationTime = GetUnixTime(DateTime.Now),
-                ChangeTime = GetUnixTime(DateTime.Now),
-                Mode = FuseConstants.FUSE_MODE_MASK_IFDIR | FuseConstants.FUSE_MODE_MASK_IRWXO | FuseConstants.FUSE_MODE_MASK_IRWXG | FuseConstants.FUSE_MODE_MASK_IRWXU,
-                Gid = 0,
-                Uid = 0,
-                Nlink = 1,
-                Ino = inode,
-                Rdev = 0,
-            };
-        }
-
-        public static FuseStat CreateNewFileStat(long inode)
-        {
-            return new FuseStat()
-            {
-                AccessTime = GetUnixTime(DateTime.Now),
-                ModificationTime = GetUnixTime(DateTime.Now),
-                ChangeTime = GetUnixTime(DateTime.Now),
-                Mode = FuseConstants.FUSE_MODE_MASK_IFREG | FuseConstants.FUSE_MODE_MASK_IRWXO | FuseConstants.FUSE_MODE_MASK_IRWXG | FuseConstants.FUSE_MODE_MASK_IRWXU,
-                Gid = 0,
-                Uid = 0,
-                Nlink = 1,
-                Ino = inode,
-                Rdev = 0,
-            };
-        }
-
-        public static FuseStat CreateSymLinkStat(long inode)
-        {
-            return new FuseStat()
-            {
-                AccessTime = GetUnixTime(DateTime.Now),
-                ModificationTime = GetUnixTime(DateTime.Now),
-                ChangeTime = GetUnixTime(DateTime.Now),
-                Mode = FuseConstants.FUSE_MODE_MASK_IFLNK | FuseConstants.FUSE_MODE_MASK_IRWXO | FuseConstants.FUSE_MODE_MASK_IRWXG | FuseConstants.FUSE_MODE_MASK_IRWXU,
-                Gid = 0,
-                Uid = 0,
-                Nlink = 1,
-                Ino = inode,
-                Rdev = 0,
-            };
-        }
-    }
-
-    internal class TFuseMem : FuseService.IAsync
-    {
-        private long HandleIdx;
-
-        private ConcurrentDictionary<long, FuseFileOpenContext> Handles;
-
-        private FuseStatFS FileSystemStats;
-
-        internal readonly MemNode Root;
-
-        private long InodeCount;
-
-        private MemNode GetNode(string path, long handle)
-        {
-            FuseFileOpenContext context = null;
-            if (handle > 0 && Handles.TryGetValue(handle, out context))
-            {
-                return context.Node;
-            }
-            else
-            {
-                return GetNode(path);
-            }
-        }
-
-        private MemNode GetNode(string path)
-        {
-            path.Trim(new char[] { '/', '\\' });
-            string[] splitPath = path.Split(new char[] { '/', '\\' }, StringSplitOptions.RemoveEmptyEntries);
-            MemNode current = Root;
-
-            for (int i = 0; i < splitPath.Length; i++)
-            {
-                current = current.GetChild(splitPath[i]);
-                if (current == null)
-                {
-                    break;
-                }
-            }
-            return current;
-        }
-
-        internal static int GetUnixTime(DateTime time)
-        {
-            return (int)((DateTimeOffset)time).ToUnixTimeSeconds();
-        }
-
-        public TFuseMem()
-        {
-            HandleIdx = 0;
-            Handles = new ConcurrentDictionary<long, FuseFileOpenContext>();
-            FileSystemStats = new FuseStatFS()
-            {
-                Bavail = 1024 * 1024 * 25,
-                Bfree = 1024 * 1024 * 10,
-                Blocks = 1024 * 25 * 1024,
-                BSize = 4 * 1024,
-                Flags = FuseFSFlags.FUSE_ST_NODEV | FuseFSFlags.FUSE_ST_VALID,
-                Files = 1024,
-                Namemax = 256,
-                Fsid = 0,
-                Free = 1024,
-                FrSize = 1024,
-                Favail = 10
-            };
-
-
-
-            Log.Debug("Initiailzing file system interface");
-
-            Root = new MemNode("", new FuseStat()
-            {
-                AccessTime = GetUnixTime(DateTime.Now),
-                ModificationTime = GetUnixTime(DateTime.Now),
-                ChangeTime = GetUnixTime(DateTime.Now),
-                Mode = FuseConstants.FUSE_MODE_MASK_IFDIR | FuseConstants.FUSE_MODE_MASK_IRWXO | FuseConstants.FUSE_MODE_MASK_IRWXG | FuseConstants.FUSE_MODE_MASK_IRWXU,
-                Gid = 0,
-                Uid = 0,
-                Nlink = 1,
-                Ino = Interlocked.Increment(ref InodeCount),
-                Rdev = 0,
-            });
-        }
-
-        public Task<FileSystemResponse> accessAsync(string path, FuseAccessMode accessMask, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            var node = GetNode(path);
-            //TDOD:: Match the access rights
-            return Task.FromResult(new FileSystemResponse() { Status = node != null ? StatusCode.FUSE_SUCCESS : StatusCode.FUSE_ERRORENOENT }); ;
-        }
-
-        public Task<FileSystemResponse> bmapAsync(string path, long blocksize, long blockIndex, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            throw new NotImplementedException();
-        }
-
-        public Task<FileSystemResponse> chmodAsync(string path, int mode, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-
-            var node = GetNode(path, handleInfo.Fh);
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                node.FileStat.Mode = (node.FileStat.Mode & FuseConstants.FUSE_MODE_MASK_IFMT) | (mode & 0xFFF);
-                node.FileStat.ChangeTime = GetUnixTime(DateTime.Now);
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-            }
-        }
-
-        public Task<FileSystemResponse> chownAsync(string path, int uid, int gid, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            var node = GetNode(path, handleInfo.Fh);
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                if (uid != -1)
-                    node.FileStat.Uid = uid;
-                if (gid != -1)
-                    node.FileStat.Gid = gid;
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-            }
-        }
-
-        public Task<FileSystemResponse> createAsync(string path, int mode, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            if ((mode & FuseConstants.FUSE_MODE_MASK_IFMT) != FuseConstants.FUSE_MODE_MASK_IFDIR)
-            {
-                return mknodAsync(path, mode, 0, context, cancellationToken);
-            }
-            else
-            {
-                return mkdirAsync(path, mode, context, cancellationToken);
-            }
-        }
-
-        public Task destroyAsync(short fsPrivateId, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            throw new NotImplementedException();
-        }
-
-        public Task<FileSystemResponse> flushAsync(string path, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-        }
-
-        public Task<FileSystemResponse> fsyncAsync(string path, long isdatasync, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-        }
-
-        public Task<FileSystemResponse> fsyncdirAsync(string path, long isdatasync, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            throw new NotImplementedException();
-        }
-
-        public Task<FileSystemResponse> getattrAsync(string path, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-
-            Log.Debug($"Request arrived ");
-            var node = GetNode(path, handleInfo.Fh);
-            if (node == null)
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            else
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS, Stats = node.FileStat });
-            }
-        }
-
-        public Task<FileSystemResponse> getxattrAsync(string path, string name, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            throw new NotImplementedException();
-        }
-
-        public Task<FileSystemResponse> initAsync(FuseConnectionInfo connn, FuseConfig config, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            throw new NotImplementedException();
-        }
-
-        public Task<FileSystemResponse> linkAsync(string source, string destination, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            var srcNode = GetNode(source);
-            var dstDir = GetNode(Path.GetDirectoryName(destination));
-            if (srcNode == null || dstDir == null)
-            {
-                return Task.FromResult(new FileSystemResponse()
-                {
-                    Status = StatusCode.FUSE_ERRORENOENT
-                });
-            }
-            else
-            {
-                dstDir.AddChild(srcNode.Name, srcNode);
-                return Task.FromResult(new FileSystemResponse()
-                {
-                    Status = StatusCode.FUSE_SUCCESS
-                });
-            }
-        }
-
-        public Task<FileSystemResponse> listxattrAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            return Task.FromResult(new FileSystemResponse()
-            {
-                Status = StatusCode.FUSE_ERROREINVAL
-            });
-        }
-
-        public Task<FileSystemResponse> lockAsync(string path, FuseHandleInfo handleInfo, int cmd, FuseFlock flock, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            return Task.FromResult(new FileSystemResponse()
-            {
-                Status = StatusCode.FUSE_ERROREINVAL
-            });
-        }
-
-        public Task<FileSystemResponse> mkdirAsync(string path, int mode, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            var node = GetNode(path);
-            if (node != null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREEXIST });
-            }
-
-            var name = Path.GetFileName(path);
-            var dir = Path.GetDirectoryName(path);
-
-            node = GetNode(dir);
-            if (node == null || !node.IsDirectory)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-
-            Log.Debug($"Creating directory {name} in {dir}");
-            var newNode = new MemNode(name, MemNode.CreateNewDirectoryStat(Interlocked.Increment(ref InodeCount)));
-            newNode.FileStat.Uid = context.Uid;
-            newNode.FileStat.Gid = context.Gid;
-            node.AddChild(name, newNode);
-            return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-        }
-
-        public Task<FileSystemResponse> mknodAsync(string path, int mode, long deviceId, FuseContext context, CancellationToken cancellationToken = default)
-        {
-
-            Log.Debug($"Request arrived ");
-            var node = GetNode(path);
-            if (node != null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREEXIST });
-            }
-
-            var name = Path.GetFileName(path);
-            var dir = Path.GetDirectoryName(path);
-            node = GetNode(dir);
-
-            if (node == null || !node.IsDirectory)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-
-            Log.Debug($"Creating file {name} in {dir}");
-            var newNode = new MemNode(name, MemNode.CreateNewFileStat(Interlocked.Increment(ref InodeCount)));
-            newNode.FileStat.Uid = context.Uid;
-            newNode.FileStat.Gid = context.Gid;
-            node.AddChild(name, newNode);
-
-            return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-        }
-
-        public Task<FileSystemResponse> openAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            var node = GetNode(path);
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                if (!node.IsDirectory)
-                {
-                    lock (node)
-                    {
-                        var handleIdx = Interlocked.Increment(ref HandleIdx);
-                        var handle = new FuseHandleInfo()
-                        {
-                            Fh = handleIdx
-                        };
-                        Handles.TryAdd(handleIdx, new FuseFileOpenContext
-                        {
-                            Handle = handle,
-                            Node = node
-                        });
-                        Interlocked.Increment(ref node.refCount);
-                        return Task.FromResult(new FileSystemResponse()
-                        {
-                            Info = handle,
-                            Status = StatusCode.FUSE_SUCCESS
-                        });
-                    }
-                }
-                else
-                {
-                    return Task.FromResult(new FileSystemResponse()
-                    {
-                        Status = StatusCode.FUSE_ERROREISDIR
-                    });
-                }
-            }
-        }
-
-        public Task<FileSystemResponse> opendirAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            var node = GetNode(path);
-
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                if (node.IsDirectory)
-                {
-                    lock (node)
-                    {
-                        var handleIdx = Interlocked.Increment(ref HandleIdx);
-                        var handle = new FuseHandleInfo()
-                        {
-                            Fh = handleIdx
-                        };
-                        Handles.TryAdd(handleIdx, new FuseFileOpenContext
-                        {
-                            Handle = handle,
-                            Node = node
-                        });
-                        Interlocked.Increment(ref node.refCount);
-                        return Task.FromResult(new FileSystemResponse()
-                        {
-                            Info = handle,
-                            Status = StatusCode.FUSE_SUCCESS
-                        });
-                    }
-                }
-                else
-                {
-                    return Task.FromResult(new FileSystemResponse()
-                    {
-                        Status = StatusCode.FUSE_ERRORENOTDIR
-                    });
-                }
-            }
-        }
-
-        public Task<FileSystemResponse> readAsync(string path, int size, long offset, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            var node = GetNode(path, handleInfo.Fh);
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                var readSize = Math.Min(size, node.DataSize - offset);
-
-                if (readSize < 1)
-                {
-                    return Task.FromResult(new FileSystemResponse()
-                    {
-                        Status = StatusCode.FUSE_SUCCESS,
-                    });
-                }
-                byte[] data = new byte[Math.Min(size, node.DataSize - offset)];
-                node.Read(data, (int)offset, data.Length);
-                return Task.FromResult(new FileSystemResponse()
-                {
-                    Status = StatusCode.FUSE_SUCCESS,
-                    Data = data
-                });
-            }
-        }
-
-        public Task<FileSystemResponse> readdirAsync(string path, long offset, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            try
-            {
-                Log.Debug("Request arrived ");
-                FuseFileOpenContext openContext;
-                MemNode node;
-                if (handleInfo.__isset.fh && Handles.TryGetValue(handleInfo.Fh, out openContext))
-                {
-                    node = openContext.Node;
-                }
-                else
-                {
-                    node = GetNode(path);
-                }
-
-                if (node == null)
-                {
-                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
-                }
-                else if ((node.FileStat.Mode & FuseConstants.FUSE_MODE_MASK_IFMT) != FuseConstants.FUSE_MODE_MASK_IFDIR)
-                {
-                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOTDIR });
-                }
-                else
-                {
-                    List<FuseDirEntry> items = new List<FuseDirEntry>();
-                    node.FillChildItems(items);
-                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS, DirEntry = items });
-                }
-            }
-            catch (Exception e)
-            {
-                Log.Debug($"Request got exception " + e.Message);
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
-            }
-        }
-
-        public Task<FileSystemResponse> readlinkAsync(string path, int maxSize, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            var node = GetNode(path);
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                lock (node)
-                {
-                    if (FuseConstants.FUSE_MODE_MASK_IFLNK != (node.FileStat.Mode & FuseConstants.FUSE_MODE_MASK_IFMT))
-                    {
-                        return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
-                    }
-                    else
-                    {
-                        return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREACCES, LinkPath = node.Link }); ;
-                    }
-                }
-            }
-        }
-
-        public Task<FileSystemResponse> releaseAsync(string path, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            FuseFileOpenContext openContext;
-            if (Handles.TryRemove(handleInfo.Fh, out openContext))
-            {
-                Interlocked.Decrement(ref openContext.Node.refCount);
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-            }
-            else
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
-            }
-        }
-
-        public Task<FileSystemResponse> releasedirAsync(string path, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            FuseFileOpenContext openContext;
-            if (Handles.TryRemove(handleInfo.Fh, out openContext))
-            {
-                Interlocked.Decrement(ref openContext.Node.refCount);
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-            }
-            else
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
-            }
-        }
-
-        public Task<FileSystemResponse> removexattrAsync(string path, string attributeKey, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            throw new NotImplementedException();
-        }
-
-        public Task<FileSystemResponse> renameAsync(string source, string destination, long flags, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            var destDir = Path.GetDirectoryName(destination);
-            var srcDir = Path.GetDirectoryName(source);
-
-            var srcDirNode = GetNode(srcDir);
-
-            var destNode = GetNode(destination);
-
-            if (destNode != null)
-            {
-                return Task.FromResult(new FileSystemResponse()
-                {
-                    Status = StatusCode.FUSE_ERROREEXIST
-                });
-            }
-
-            var destDirNode = GetNode(Path.GetDirectoryName(destination));
-
-            MemNode srcNode = null;
-            var srcName = Path.GetFileName(source);
-
-            if (destDirNode == null || !srcDirNode.RemoveChild(srcName, out srcNode))
-            {
-                return Task.FromResult(new FileSystemResponse()
-                {
-                    Status = StatusCode.FUSE_ERROREINVAL
-                });
-            }
-
-            var destName = Path.GetFileName(destination);
-            lock (destDirNode)
-            {
-                lock (srcNode)
-                {
-                    if (!destDirNode.AddChild(destName, srcNode))
-                    {
-                        srcDirNode.AddChild(srcName, srcNode);
-                        return Task.FromResult(new FileSystemResponse()
-                        {
-                            Status = StatusCode.FUSE_ERROREEXIST
-                        });
-                    }
-                    else
-                    {
-                        srcNode.Name = destName;
-                        return Task.FromResult(new FileSystemResponse()
-                        {
-                            Status = StatusCode.FUSE_SUCCESS
-                        });
-                    }
-                }
-            }
-        }
-
-        public Task<FileSystemResponse> rmdirAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            var node = GetNode(path);
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                var parentNode = GetNode(Path.GetDirectoryName(path));
-                if (!parentNode.RemoveChild(node.Name, out node))
-                {
-                    if (node != null)
-                    {
-                        return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ENOTEMPTY });
-                    }
-                    else
-                    {
-                        return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-                    }
-                }
-                else
-                {
-                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-                }
-            }
-        }
-
-        public Task<FileSystemResponse> setxattrAsync(string path, string name, string val, short valsize, int flags, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            return Task.FromResult(new FileSystemResponse()
-            {
-                Statfs = FileSystemStats,
-                Status = StatusCode.FUSE_ERROREPERM
-            });
-        }
-
-        public Task<FileSystemResponse> statfsAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            return Task.FromResult(new FileSystemResponse()
-            {
-                Statfs = FileSystemStats,
-                Status = StatusCode.FUSE_SUCCESS
-            });
-        }
-
-        public Task<FileSystemResponse> symlinkAsync(string destination, string source, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived ");
-            var dir = Path.GetDirectoryName(destination);
-            var name = Path.GetFileName(destination);
-            var destDir = GetNode(dir);
-            var srcnode = GetNode(source);
-
-            if (srcnode == null)
-            {
-                return Task.FromResult(new FileSystemResponse()
-                {
-                    Status = StatusCode.FUSE_ERRORENOENT
-                });
-            }
-
-            if (destDir == null)
-            {
-                return Task.FromResult(new FileSystemResponse()
-                {
-                    Status = StatusCode.FUSE_ERRORENOENT
-                });
-            }
-            lock (destDir)
-            {
-                MemNode symLinkNode = new MemNode(name, MemNode.CreateSymLinkStat(Interlocked.Increment(ref InodeCount)), source);
-                if (!destDir.AddChild(name, symLinkNode))
-                {
-                    return Task.FromResult(new FileSystemResponse()
-                    {
-                        Status = StatusCode.FUSE_ERROREEXIST
-                    });
-                }
-                else
-                {
-                    return Task.FromResult(new FileSystemResponse()
-                    {
-                        Status = StatusCode.FUSE_SUCCESS
-                    });
-                }
-            }
-        }
-
-        public Task<FileSystemResponse> truncateAsync(string path, long offset, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived {path}");
-            var node = GetNode(path);
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                node.Resize(offset);
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-            }
-        }
-
-        public Task<FileSystemResponse> unlinkAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived {path}");
-            var node = GetNode(path);
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                //   Log.Information($"Removing node {path}");
-                var parent = GetNode(Path.GetDirectoryName(path));
-                if (parent.RemoveChild(node.Name, out node))
-                {
-                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-                }
-                else
-                {
-                    Log.Error($"Not found node {node.Name} while removing");
-                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-                }
-            }
-        }
-
-        public Task<FileSystemResponse> utimensAsync(string path, FuseTimeSpec timeSpec, FuseHandleInfo info, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            Log.Debug($"Request arrived {path}");
-            var node = GetNode(path);
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                if (timeSpec != null)
-                {
-                    node.FileStat.AccessTime = timeSpec.AccessTime;
-                    node.FileStat.ModificationTime = timeSpec.ModificationTime;
-                    node.FileStat.ChangeTime = GetUnixTime(DateTime.Now);
-                }
-                else
-                {
-                    node.FileStat.ChangeTime = node.FileStat.AccessTime = node.FileStat.ModificationTime = GetUnixTime(DateTime.Now);
-                }
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
-            }
-        }
-
-        public Task<FileSystemResponse> writeAsync(string path, byte[] buffer, long offset, int size, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
-        {
-            var node = GetNode(path);
-            if (node == null)
-            {
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
-            }
-            else
-            {
-                node.Write(buffer, (int)offset);
-                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS, DataWritten = buffer.Length });
-            }
-        }
-    }
-}
+﻿/*
+ ***************************************************************************** 
+ * Author: Yogender Solanki <yogendersolanki91@gmail.com> 
+ *
+ * Copyright (c) 2022 Yogender Solanki
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************
+ */
+namespace TFuse
+{
+    using Serilog;
+    using System;
+    using System.Collections.Concurrent;
+    using System.Collections.Generic;
+    using System.IO;
+    using System.Threading;
+    using System.Threading.Tasks;
+
+    internal class FuseFileOpenContext
+    {
+        public FuseHandleInfo Handle { get; set; }
+
+        public MemNode Node { get; set; }
+
+        // Snapshot of a directory taken at readdir offset 0, later pages index into it
+        public List<FuseDirEntry> Listing { get; set; }
+    }
+
+    // Snapshot of a directory listed without a handle, kept by path for a short while
+    internal class DirListing
+    {
+        public List<FuseDirEntry> Entries { get; set; }
+
+        public long Taken { get; set; }
+    }
+
+    internal class MemNode
+    {
+        public string Link { get; private set; }
+
+        public string Name { get; set; }
+
+        public int refCount;
+
+        // 0 while empty from creation, a fresh tick of VersionClock on every change of the content
+        public long version;
+
+        // Shared by all nodes, so a version names one content even after the path is recreated
+        private static long VersionClock;
+
+        internal MemoryStream dataStream;
+
+        internal ConcurrentDictionary<string, MemNode> Child { get; set; } = new ConcurrentDictionary<string, MemNode>();
+
+        public FuseStat FileStat { get; private set; }
+
+        public bool IsDirectory
+        {
+            get { return (FileStat.Mode & FuseConstants.FUSE_MODE_MASK_IFMT) == FuseConstants.FUSE_MODE_MASK_IFDIR; }
+        }
+
+        public bool IsLink
+        {
+            get { return (FileStat.Mode & FuseConstants.FUSE_MODE_MASK_IFMT) == FuseConstants.FUSE_MODE_MASK_IFLNK; }
+        }
+
+        public int DataSize => (int)(dataStream != null ? dataStream.Length : 0);
+
+        public MemNode(string name, FuseStat stat)
+        {
+            FileStat = stat;
+            Name = name;
+            dataStream = new MemoryStream();
+        }
+
+        public MemNode(string name, FuseStat stat, string link)
+        {
+            FileStat = stat;
+            Name = name;
+            dataStream = new MemoryStream();
+            Link = link;
+        }
+
+        public MemNode(string name, FuseStat stat, int size)
+        {
+            FileStat = stat;
+            Name = name;
+            dataStream = new MemoryStream(size);
+        }
+
+        public void Resize(long size)
+        {
+            dataStream.SetLength(size);
+            FileStat.Size = size;
+            Interlocked.Exchange(ref version, Interlocked.Increment(ref VersionClock));
+        }
+
+        public int Read(byte[] data, int offset, int size)
+        {
+            if (data != null)
+            {
+                lock (data)
+                {
+                    Log.Logger.Debug($"Reading at {offset} for {size} byte Buffer {data.Length}");
+                    dataStream.Seek(offset, SeekOrigin.Begin);
+                    dataStream.Read(data, 0, data.Length);
+                    return size;
+                }
+            }
+            return 0;
+        }
+
+        public int Write(byte[] data, int offset)
+        {
+            if (data != null)
+            {
+                lock (data)
+                {
+
+
+                    dataStream.Seek(offset, SeekOrigin.Begin);
+                    dataStream.Write(data, 0, data.Length);
+                    FileStat.Size = dataStream.Length;
+                    Interlocked.Exchange(ref version, Interlocked.Increment(ref VersionClock));
+                    return data.Length;
+                }
+            }
+            return 0;
+        }
+
+        public MemNode GetChild(string name)
+        {
+            MemNode found;
+            if (Child.TryGetValue(name, out found))
+            {
+                return found;
+            }
+            else
+            {
+                return null;
+            }
+        }
+
+        public bool AddChild(string name, MemNode node)
+        {
+            return Child.TryAdd(name, node);
+        }
+
+        public bool RemoveChild(string name, out MemNode node)
+        {
+            if (!Child.TryGetValue(name, out node))
+            {
+                node = null;
+                return false;
+            }
+            else
+            {
+                if (!node.Child.IsEmpty)
+                {
+                    return false;
+                }
+                else
+                {
+                    return Child.Remove(name, out node);
+                }
+
+            }
+        }
+
+        public void FillChildItems(List<FuseDirEntry> dirResult)
+        {
+            foreach (var item in Child.Values)
+            {
+                dirResult.Add(new FuseDirEntry()
+                {
+                    Name = item.Name,
+                    Stats = item.FileStat
+                });
+            }
+        }
+
+        internal static int GetUnixTime(DateTime time)
+        {
+            return (int)((DateTimeOffset)time).ToUnixTimeSeconds();
+        }
+
+        public static FuseStat CreateNewDirectoryStat(long inode)
+        {
+            return new FuseStat()
+            {
+                AccessTime = GetUnixTime(DateTime.Now),
+                ModificationTime = GetUnixTime(DateTime.Now),
+                ChangeTime = GetUnixTime(DateTime.Now),
+                Mode = FuseConstants.FUSE_MODE_MASK_IFDIR | FuseConstants.FUSE_MODE_MASK_IRWXO | FuseConstants.FUSE_MODE_MASK_IRWXG | FuseConstants.FUSE_MODE_MASK_IRWXU,
+                Gid = 0,
+                Uid = 0,
+                Nlink = 1,
+                Ino = inode,
+                Rdev = 0,
+            };
+        }
+
+        public static FuseStat CreateNewFileStat(long inode)
+        {
+            return new FuseStat()
+            {
+                AccessTime = GetUnixTime(DateTime.Now),
+                ModificationTime = GetUnixTime(DateTime.Now),
+                ChangeTime = GetUnixTime(DateTime.Now),
+                Mode = FuseConstants.FUSE_MODE_MASK_IFREG | FuseConstants.FUSE_MODE_MASK_IRWXO | FuseConstants.FUSE_MODE_MASK_IRWXG | FuseConstants.FUSE_MODE_MASK_IRWXU,
+                Gid = 0,
+                Uid = 0,
+                Nlink = 1,
+                Ino = inode,
+                Rdev = 0,
+            };
+        }
+
+        public static FuseStat CreateSymLinkStat(long inode)
+        {
+            return new FuseStat()
+            {
+                AccessTime = GetUnixTime(DateTime.Now),
+                ModificationTime = GetUnixTime(DateTime.Now),
+                ChangeTime = GetUnixTime(DateTime.Now),
+                Mode = FuseConstants.FUSE_MODE_MASK_IFLNK | FuseConstants.FUSE_MODE_MASK_IRWXO | FuseConstants.FUSE_MODE_MASK_IRWXG | FuseConstants.FUSE_MODE_MASK_IRWXU,
+                Gid = 0,
+                Uid = 0,
+                Nlink = 1,
+                Ino = inode,
+                Rdev = 0,
+            };
+        }
+    }
+
+    internal class TFuseMem : FuseService.IAsync
+    {
+        private long HandleIdx;
+
+        private ConcurrentDictionary<long, FuseFileOpenContext> Handles;
+
+        // readdir without a handle, as sent to every shard, pages through these
+        private const long ListingTtlMs = 2000;
+
+        private const int ListingCacheSize = 64;
+
+        private readonly ConcurrentDictionary<string, DirListing> Listings = new ConcurrentDictionary<string, DirListing>();
+
+        private FuseStatFS FileSystemStats;
+
+        internal readonly MemNode Root;
+
+        private long InodeCount;
+
+        private MemNode GetNode(string path, long handle)
+        {
+            FuseFileOpenContext context = null;
+            if (handle > 0 && Handles.TryGetValue(handle, out context))
+            {
+                return context.Node;
+            }
+            else
+            {
+                return GetNode(path);
+            }
+        }
+
+        private MemNode GetNode(string path)
+        {
+            path.Trim(new char[] { '/', '\\' });
+            string[] splitPath = path.Split(new char[] { '/', '\\' }, StringSplitOptions.RemoveEmptyEntries);
+            MemNode current = Root;
+
+            for (int i = 0; i < splitPath.Length; i++)
+            {
+                current = current.GetChild(splitPath[i]);
+                if (current == null)
+                {
+                    break;
+                }
+            }
+            return current;
+        }
+
+        internal static int GetUnixTime(DateTime time)
+        {
+            return (int)((DateTimeOffset)time).ToUnixTimeSeconds();
+        }
+
+        private void KeepListing(string path, List<FuseDirEntry> items)
+        {
+            long now = Environment.TickCount64;
+            if (Listings.Count >= ListingCacheSize && !Listings.ContainsKey(path))
+            {
+                // Expired ones first, the oldest when none is
+                KeyValuePair<string, DirListing>? oldest = null;
+                foreach (var kept in Listings)
+                {
+                    if (now - kept.Value.Taken >= ListingTtlMs)
+                    {
+                        Listings.TryRemove(kept.Key, out _);
+                    }
+                    else if (oldest == null || kept.Value.Taken < oldest.Value.Value.Taken)
+                    {
+                        oldest = kept;
+                    }
+                }
+                if (Listings.Count >= ListingCacheSize && oldest != null)
+                {
+                    Listings.TryRemove(oldest.Value.Key, out _);
+                }
+            }
+            Listings[path] = new DirListing() { Entries = items, Taken = now };
+        }
+
+        public TFuseMem()
+        {
+            HandleIdx = 0;
+            Handles = new ConcurrentDictionary<long, FuseFileOpenContext>();
+            FileSystemStats = new FuseStatFS()
+            {
+                Bavail = 1024 * 1024 * 25,
+                Bfree = 1024 * 1024 * 10,
+                Blocks = 1024 * 25 * 1024,
+                BSize = 4 * 1024,
+                Flags = FuseFSFlags.FUSE_ST_NODEV | FuseFSFlags.FUSE_ST_VALID,
+                Files = 1024,
+                Namemax = 256,
+                Fsid = 0,
+                Free = 1024,
+                FrSize = 1024,
+                Favail = 10
+            };
+
+
+
+            Log.Debug("Initiailzing file system interface");
+
+            Root = new MemNode("", new FuseStat()
+            {
+                AccessTime = GetUnixTime(DateTime.Now),
+                ModificationTime = GetUnixTime(DateTime.Now),
+                ChangeTime = GetUnixTime(DateTime.Now),
+                Mode = FuseConstants.FUSE_MODE_MASK_IFDIR | FuseConstants.FUSE_MODE_MASK_IRWXO | FuseConstants.FUSE_MODE_MASK_IRWXG | FuseConstants.FUSE_MODE_MASK_IRWXU,
+                Gid = 0,
+                Uid = 0,
+                Nlink = 1,
+                Ino = Interlocked.Increment(ref InodeCount),
+                Rdev = 0,
+            });
+        }
+
+        public Task<FileSystemResponse> accessAsync(string path, FuseAccessMode accessMask, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            var node = GetNode(path);
+            //TDOD:: Match the access rights
+            return Task.FromResult(new FileSystemResponse() { Status = node != null ? StatusCode.FUSE_SUCCESS : StatusCode.FUSE_ERRORENOENT }); ;
+        }
+
+        public Task<FileSystemResponse> bmapAsync(string path, long blocksize, long blockIndex, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            throw new NotImplementedException();
+        }
+
+        public Task<FileSystemResponse> chmodAsync(string path, int mode, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+
+            var node = GetNode(path, handleInfo.Fh);
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                node.FileStat.Mode = (node.FileStat.Mode & FuseConstants.FUSE_MODE_MASK_IFMT) | (mode & 0xFFF);
+                node.FileStat.ChangeTime = GetUnixTime(DateTime.Now);
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+            }
+        }
+
+        public Task<FileSystemResponse> chownAsync(string path, int uid, int gid, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            var node = GetNode(path, handleInfo.Fh);
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                if (uid != -1)
+                    node.FileStat.Uid = uid;
+                if (gid != -1)
+                    node.FileStat.Gid = gid;
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+            }
+        }
+
+        public Task<FileSystemResponse> createAsync(string path, int mode, FuseContext context, int inlineLimit, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            if ((mode & FuseConstants.FUSE_MODE_MASK_IFMT) != FuseConstants.FUSE_MODE_MASK_IFDIR)
+            {
+                return mknodAsync(path, mode, 0, context, cancellationToken);
+            }
+            else
+            {
+                return mkdirAsync(path, mode, context, cancellationToken);
+            }
+        }
+
+        public Task destroyAsync(short fsPrivateId, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            throw new NotImplementedException();
+        }
+
+        public Task<FileSystemResponse> flushAsync(string path, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+        }
+
+        public Task<FileSystemResponse> fsyncAsync(string path, long isdatasync, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+        }
+
+        public Task<FileSystemResponse> fsyncdirAsync(string path, long isdatasync, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            throw new NotImplementedException();
+        }
+
+        public Task<FileSystemResponse> getattrAsync(string path, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+
+            Log.Debug($"Request arrived ");
+            var node = GetNode(path, handleInfo.Fh);
+            if (node == null)
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            else
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS, Stats = node.FileStat });
+            }
+        }
+
+        public Task<FileSystemResponse> getxattrAsync(string path, string name, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            throw new NotImplementedException();
+        }
+
+        public Task<FileSystemResponse> initAsync(FuseConnectionInfo connn, FuseConfig config, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            throw new NotImplementedException();
+        }
+
+        public Task<FileSystemResponse> linkAsync(string source, string destination, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            var srcNode = GetNode(source);
+            var dstDir = GetNode(Path.GetDirectoryName(destination));
+            if (srcNode == null || dstDir == null)
+            {
+                return Task.FromResult(new FileSystemResponse()
+                {
+                    Status = StatusCode.FUSE_ERRORENOENT
+                });
+            }
+            else
+            {
+                dstDir.AddChild(srcNode.Name, srcNode);
+                return Task.FromResult(new FileSystemResponse()
+                {
+                    Status = StatusCode.FUSE_SUCCESS
+                });
+            }
+        }
+
+        public Task<FileSystemResponse> listxattrAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            return Task.FromResult(new FileSystemResponse()
+            {
+                Status = StatusCode.FUSE_ERROREINVAL
+            });
+        }
+
+        public Task<FileSystemResponse> lockAsync(string path, FuseHandleInfo handleInfo, int cmd, FuseFlock flock, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            return Task.FromResult(new FileSystemResponse()
+            {
+                Status = StatusCode.FUSE_ERROREINVAL
+            });
+        }
+
+        public Task<FileSystemResponse> mkdirAsync(string path, int mode, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            var node = GetNode(path);
+            if (node != null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREEXIST });
+            }
+
+            var name = Path.GetFileName(path);
+            var dir = Path.GetDirectoryName(path);
+
+            node = GetNode(dir);
+            if (node == null || !node.IsDirectory)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+
+            Log.Debug($"Creating directory {name} in {dir}");
+            var newNode = new MemNode(name, MemNode.CreateNewDirectoryStat(Interlocked.Increment(ref InodeCount)));
+            newNode.FileStat.Uid = context.Uid;
+            newNode.FileStat.Gid = context.Gid;
+            node.AddChild(name, newNode);
+            return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+        }
+
+        public Task<FileSystemResponse> mknodAsync(string path, int mode, long deviceId, FuseContext context, CancellationToken cancellationToken = default)
+        {
+
+            Log.Debug($"Request arrived ");
+            var node = GetNode(path);
+            if (node != null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREEXIST });
+            }
+
+            var name = Path.GetFileName(path);
+            var dir = Path.GetDirectoryName(path);
+            node = GetNode(dir);
+
+            if (node == null || !node.IsDirectory)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+
+            Log.Debug($"Creating file {name} in {dir}");
+            var newNode = new MemNode(name, MemNode.CreateNewFileStat(Interlocked.Increment(ref InodeCount)));
+            newNode.FileStat.Uid = context.Uid;
+            newNode.FileStat.Gid = context.Gid;
+            node.AddChild(name, newNode);
+
+            return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+        }
+
+        public Task<FileSystemResponse> openAsync(string path, FuseContext context, int inlineLimit, long knownVersion, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            var node = GetNode(path);
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                if (!node.IsDirectory)
+                {
+                    lock (node)
+                    {
+                        var handleIdx = Interlocked.Increment(ref HandleIdx);
+                        var handle = new FuseHandleInfo()
+                        {
+                            Fh = handleIdx
+                        };
+                        Handles.TryAdd(handleIdx, new FuseFileOpenContext
+                        {
+                            Handle = handle,
+                            Node = node
+                        });
+                        Interlocked.Increment(ref node.refCount);
+                        var response = new FileSystemResponse()
+                        {
+                            Info = handle,
+                            Status = StatusCode.FUSE_SUCCESS
+                        };
+                        if (inlineLimit > 0)
+                        {
+                            // Small files travel with the handle, the client skips the reads
+                            long version = Interlocked.Read(ref node.version);
+                            if (knownVersion < 0 || knownVersion != version)
+                            {
+                                byte[] data = new byte[Math.Min(inlineLimit, node.DataSize)];
+                                if (data.Length > 0)
+                                {
+                                    node.Read(data, 0, data.Length);
+                                }
+                                response.Data = data;
+                            }
+                            response.Stats = node.FileStat;
+                            response.Version = version;
+                        }
+                        return Task.FromResult(response);
+                    }
+                }
+                else
+                {
+                    return Task.FromResult(new FileSystemResponse()
+                    {
+                        Status = StatusCode.FUSE_ERROREISDIR
+                    });
+                }
+            }
+        }
+
+        public Task<FileSystemResponse> opendirAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            var node = GetNode(path);
+
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                if (node.IsDirectory)
+                {
+                    lock (node)
+                    {
+                        var handleIdx = Interlocked.Increment(ref HandleIdx);
+                        var handle = new FuseHandleInfo()
+                        {
+                            Fh = handleIdx
+                        };
+                        Handles.TryAdd(handleIdx, new FuseFileOpenContext
+                        {
+                            Handle = handle,
+                            Node = node
+                        });
+                        Interlocked.Increment(ref node.refCount);
+                        return Task.FromResult(new FileSystemResponse()
+                        {
+                            Info = handle,
+                            Status = StatusCode.FUSE_SUCCESS
+                        });
+                    }
+                }
+                else
+                {
+                    return Task.FromResult(new FileSystemResponse()
+                    {
+                        Status = StatusCode.FUSE_ERRORENOTDIR
+                    });
+                }
+            }
+        }
+
+        public Task<FileSystemResponse> readAsync(string path, int size, long offset, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            var node = GetNode(path, handleInfo.Fh);
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                var readSize = Math.Min(size, node.DataSize - offset);
+
+                if (readSize < 1)
+                {
+                    return Task.FromResult(new FileSystemResponse()
+                    {
+                        Status = StatusCode.FUSE_SUCCESS,
+                    });
+                }
+                byte[] data = new byte[Math.Min(size, node.DataSize - offset)];
+                node.Read(data, (int)offset, data.Length);
+                return Task.FromResult(new FileSystemResponse()
+                {
+                    Status = StatusCode.FUSE_SUCCESS,
+                    Data = data
+                });
+            }
+        }
+
+        public Task<FileSystemResponse> readdirAsync(string path, long offset, FuseHandleInfo handleInfo, FuseContext context, int maxEntries, CancellationToken cancellationToken = default)
+        {
+            try
+            {
+                Log.Debug("Request arrived ");
+                FuseFileOpenContext openContext = null;
+                MemNode node;
+                if (handleInfo.__isset.fh && Handles.TryGetValue(handleInfo.Fh, out openContext))
+                {
+                    node = openContext.Node;
+                }
+                else
+                {
+                    node = GetNode(path);
+                }
+
+                if (node == null)
+                {
+                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
+                }
+                else if ((node.FileStat.Mode & FuseConstants.FUSE_MODE_MASK_IFMT) != FuseConstants.FUSE_MODE_MASK_IFDIR)
+                {
+                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOTDIR });
+                }
+                else
+                {
+                    List<FuseDirEntry> items = null;
+                    if (offset != 0 && openContext != null)
+                    {
+                        items = openContext.Listing;
+                    }
+                    else if (offset != 0 && Listings.TryGetValue(path, out DirListing kept) && Environment.TickCount64 - kept.Taken < ListingTtlMs)
+                    {
+                        items = kept.Entries;
+                    }
+                    if (items == null)
+                    {
+                        items = new List<FuseDirEntry>();
+                        node.FillChildItems(items);
+                        for (int i = 0; i < items.Count; i++)
+                        {
+                            items[i].Offset = i + 1;
+                        }
+                        if (openContext != null)
+                        {
+                            openContext.Listing = items;
+                        }
+                        else
+                        {
+                            KeepListing(path, items);
+                        }
+                    }
+
+                    if (offset < 0 || offset > items.Count)
+                    {
+                        return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
+                    }
+
+                    int count = items.Count - (int)offset;
+                    if (maxEntries > 0 && count > maxEntries)
+                    {
+                        count = maxEntries;
+                    }
+                    var response = new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS, DirEntry = items.GetRange((int)offset, count) };
+                    if (offset + count < items.Count)
+                    {
+                        response.NextOffset = offset + count;
+                    }
+                    return Task.FromResult(response);
+                }
+            }
+            catch (Exception e)
+            {
+                Log.Debug($"Request got exception " + e.Message);
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
+            }
+        }
+
+        public Task<FileSystemResponse> readlinkAsync(string path, int maxSize, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            var node = GetNode(path);
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                lock (node)
+                {
+                    if (FuseConstants.FUSE_MODE_MASK_IFLNK != (node.FileStat.Mode & FuseConstants.FUSE_MODE_MASK_IFMT))
+                    {
+                        return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
+                    }
+                    else
+                    {
+                        return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREACCES, LinkPath = node.Link }); ;
+                    }
+                }
+            }
+        }
+
+        public Task<FileSystemResponse> releaseAsync(string path, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            FuseFileOpenContext openContext;
+            if (Handles.TryRemove(handleInfo.Fh, out openContext))
+            {
+                Interlocked.Decrement(ref openContext.Node.refCount);
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+            }
+            else
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
+            }
+        }
+
+        public Task<FileSystemResponse> releasedirAsync(string path, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            FuseFileOpenContext openContext;
+            if (Handles.TryRemove(handleInfo.Fh, out openContext))
+            {
+                Interlocked.Decrement(ref openContext.Node.refCount);
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+            }
+            else
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
+            }
+        }
+
+        public Task<FileSystemResponse> removexattrAsync(string path, string attributeKey, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            throw new NotImplementedException();
+        }
+
+        public Task<FileSystemResponse> renameAsync(string source, string destination, long flags, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            var destDir = Path.GetDirectoryName(destination);
+            var srcDir = Path.GetDirectoryName(source);
+
+            var srcDirNode = GetNode(srcDir);
+
+            var destNode = GetNode(destination);
+
+            if (destNode != null)
+            {
+                return Task.FromResult(new FileSystemResponse()
+                {
+                    Status = StatusCode.FUSE_ERROREEXIST
+                });
+            }
+
+            var destDirNode = GetNode(Path.GetDirectoryName(destination));
+
+            MemNode srcNode = null;
+            var srcName = Path.GetFileName(source);
+
+            if (destDirNode == null || !srcDirNode.RemoveChild(srcName, out srcNode))
+            {
+                return Task.FromResult(new FileSystemResponse()
+                {
+                    Status = StatusCode.FUSE_ERROREINVAL
+                });
+            }
+
+            var destName = Path.GetFileName(destination);
+            lock (destDirNode)
+            {
+                lock (srcNode)
+                {
+                    if (!destDirNode.AddChild(destName, srcNode))
+                    {
+                        srcDirNode.AddChild(srcName, srcNode);
+                        return Task.FromResult(new FileSystemResponse()
+                        {
+                            Status = StatusCode.FUSE_ERROREEXIST
+                        });
+                    }
+                    else
+                    {
+                        srcNode.Name = destName;
+                        return Task.FromResult(new FileSystemResponse()
+                        {
+                            Status = StatusCode.FUSE_SUCCESS
+                        });
+                    }
+                }
+            }
+        }
+
+        public Task<FileSystemResponse> rmdirAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            var node = GetNode(path);
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                var parentNode = GetNode(Path.GetDirectoryName(path));
+                if (!parentNode.RemoveChild(node.Name, out node))
+                {
+                    if (node != null)
+                    {
+                        return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ENOTEMPTY });
+                    }
+                    else
+                    {
+                        return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+                    }
+                }
+                else
+                {
+                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+                }
+            }
+        }
+
+        public Task<FileSystemResponse> setxattrAsync(string path, string name, string val, short valsize, int flags, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            return Task.FromResult(new FileSystemResponse()
+            {
+                Statfs = FileSystemStats,
+                Status = StatusCode.FUSE_ERROREPERM
+            });
+        }
+
+        public Task pingAsync(CancellationToken cancellationToken = default)
+        {
+            return Task.CompletedTask;
+        }
+
+        public async Task<List<FileSystemResponse>> batchAsync(List<BatchRequest> requests, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived with {requests.Count} operations");
+            var responses = new List<FileSystemResponse>(requests.Count);
+            foreach (var request in requests)
+            {
+                switch (request.Op)
+                {
+                    case BatchOp.GETATTR:
+                        responses.Add(await getattrAsync(request.Path, request.HandleInfo ?? new FuseHandleInfo(), request.Context, cancellationToken));
+                        break;
+                    case BatchOp.UNLINK:
+                        responses.Add(await unlinkAsync(request.Path, request.Context, cancellationToken));
+                        break;
+                    case BatchOp.RMDIR:
+                        responses.Add(await rmdirAsync(request.Path, request.Context, cancellationToken));
+                        break;
+                    default:
+                        responses.Add(new FileSystemResponse() { Status = StatusCode.FUSE_ERROREINVAL });
+                        break;
+                }
+            }
+            return responses;
+        }
+
+        public Task<FileSystemResponse> statfsAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            return Task.FromResult(new FileSystemResponse()
+            {
+                Statfs = FileSystemStats,
+                Status = StatusCode.FUSE_SUCCESS
+            });
+        }
+
+        public Task<FileSystemResponse> symlinkAsync(string destination, string source, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived ");
+            var dir = Path.GetDirectoryName(destination);
+            var name = Path.GetFileName(destination);
+            var destDir = GetNode(dir);
+            var srcnode = GetNode(source);
+
+            if (srcnode == null)
+            {
+                return Task.FromResult(new FileSystemResponse()
+                {
+                    Status = StatusCode.FUSE_ERRORENOENT
+                });
+            }
+
+            if (destDir == null)
+            {
+                return Task.FromResult(new FileSystemResponse()
+                {
+                    Status = StatusCode.FUSE_ERRORENOENT
+                });
+            }
+            lock (destDir)
+            {
+                MemNode symLinkNode = new MemNode(name, MemNode.CreateSymLinkStat(Interlocked.Increment(ref InodeCount)), source);
+                if (!destDir.AddChild(name, symLinkNode))
+                {
+                    return Task.FromResult(new FileSystemResponse()
+                    {
+                        Status = StatusCode.FUSE_ERROREEXIST
+                    });
+                }
+                else
+                {
+                    return Task.FromResult(new FileSystemResponse()
+                    {
+                        Status = StatusCode.FUSE_SUCCESS
+                    });
+                }
+            }
+        }
+
+        public Task<FileSystemResponse> truncateAsync(string path, long offset, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived {path}");
+            var node = GetNode(path);
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                node.Resize(offset);
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+            }
+        }
+
+        public Task<FileSystemResponse> unlinkAsync(string path, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived {path}");
+            var node = GetNode(path);
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                //   Log.Information($"Removing node {path}");
+                var parent = GetNode(Path.GetDirectoryName(path));
+                if (parent.RemoveChild(node.Name, out node))
+                {
+                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+                }
+                else
+                {
+                    Log.Error($"Not found node {node.Name} while removing");
+                    return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+                }
+            }
+        }
+
+        public Task<FileSystemResponse> utimensAsync(string path, FuseTimeSpec timeSpec, FuseHandleInfo info, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            Log.Debug($"Request arrived {path}");
+            var node = GetNode(path);
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                if (timeSpec != null)
+                {
+                    node.FileStat.AccessTime = timeSpec.AccessTime;
+                    node.FileStat.ModificationTime = timeSpec.ModificationTime;
+                    node.FileStat.ChangeTime = GetUnixTime(DateTime.Now);
+                }
+                else
+                {
+                    node.FileStat.ChangeTime = node.FileStat.AccessTime = node.FileStat.ModificationTime = GetUnixTime(DateTime.Now);
+                }
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS });
+            }
+        }
+
+        public Task<FileSystemResponse> writeAsync(string path, byte[] buffer, long offset, int size, FuseHandleInfo handleInfo, FuseContext context, CancellationToken cancellationToken = default)
+        {
+            var node = GetNode(path);
+            if (node == null)
+            {
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_ERRORENOENT });
+            }
+            else
+            {
+                node.Write(buffer, (int)offset);
+                return Task.FromResult(new FileSystemResponse() { Status = StatusCode.FUSE_SUCCESS, DataWritten = buffer.Length });
+            }
+        }
+    }
+}